@@ -0,0 +1,78 @@
+// =============================================================================
+// CICS Emulation - Monitoring Report
+// Version: 3.4.6
+// =============================================================================
+//
+// Summarizes the performance records in one or more monitoring data sets by
+// transaction id, heaviest consumers first.
+//
+//   cics-cmf-report [--sort=cpu|response|dispatch|wait|storage|requests|tasks]
+//                   [--top=N] FILE...
+// =============================================================================
+
+#include <iostream>
+#include <string>
+
+#include "cics/common/types.hpp"
+#include "cics/common/error.hpp"
+#include "cics/cics/monitoring.hpp"
+
+namespace cc = cics::cics;
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: cics-cmf-report [--sort=cpu|response|dispatch|wait|storage|requests|tasks]"
+                 " [--top=N] FILE...\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    cc::ReportOrder order = cc::ReportOrder::CPU;
+    cics::Size top = 0;
+    std::vector<cics::Path> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--sort=")) {
+            auto parsed = cc::parse_report_order(arg.substr(7));
+            if (!parsed) {
+                usage();
+                return 2;
+            }
+            order = *parsed;
+        } else if (arg.starts_with("--top=")) {
+            try {
+                top = std::stoul(std::string(arg.substr(6)));
+            } catch (const std::exception&) {
+                usage();
+                return 2;
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (files.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::vector<cc::PerformanceRecord> records;
+    for (const auto& file : files) {
+        auto loaded = cc::read_monitoring_file(file);
+        if (!loaded) {
+            std::cerr << "cics-cmf-report: " << loaded.error().message << "\n";
+            return 1;
+        }
+        records.insert(records.end(), loaded->begin(), loaded->end());
+    }
+
+    auto summaries = cc::summarize_records(records, order);
+    std::cout << records.size() << " records, " << summaries.size() << " transactions\n\n";
+    std::cout << cc::format_report(summaries, top);
+    return 0;
+}
@@ -12,9 +12,12 @@
 
 #include <cics/common/types.hpp>
 #include <cics/common/error.hpp>
+#include <cics/common/threading.hpp>
 #include <functional>
 #include <vector>
-#include <stack>
+#include <array>
+#include <deque>
+#include <unordered_map>
 #include <memory>
 #include <mutex>
 #include <chrono>
@@ -111,6 +114,7 @@ struct HandlerDefinition {
 // Handler Stack (for PUSH/POP)
 // =============================================================================
 
+// Owned by a single task (see AbendManager::TaskState), so no locking.
 class HandlerStack {
 public:
     void push(const HandlerDefinition& handler);
@@ -121,8 +125,7 @@ public:
     void clear();
     
 private:
-    std::stack<HandlerDefinition> stack_;
-    mutable std::mutex mutex_;
+    std::deque<HandlerDefinition> stack_;  // stable references across push
 };
 
 // =============================================================================
@@ -148,6 +151,60 @@ struct AbendStats {
     std::unordered_map<String, UInt64> abend_by_code;
 };
 
+// =============================================================================
+// Abend Code Counters
+// =============================================================================
+
+// Per-code abend counts keyed by the 4-byte code packed into a UInt32.
+// Open addressing over a fixed table; slots are claimed with a CAS and
+// never freed until reset(), so counting is lock-free and allocation-free.
+// Codes that arrive after the table fills are counted in overflow().
+class AbendCodeCounters {
+public:
+    static constexpr UInt32 CAPACITY = 256;
+    
+    void increment(const FixedString<4>& code);
+    [[nodiscard]] UInt64 count(const FixedString<4>& code) const;
+    [[nodiscard]] UInt64 overflow() const { return overflow_.get(); }
+    void snapshot(std::unordered_map<String, UInt64>& out) const;
+    void reset();
+    
+private:
+    [[nodiscard]] static UInt32 pack(const FixedString<4>& code);
+    
+    std::array<std::atomic<UInt32>, CAPACITY> keys_{};
+    std::array<AtomicCounter<UInt64>, CAPACITY> counts_{};
+    AtomicCounter<UInt64> overflow_;
+};
+
+// =============================================================================
+// Abend History
+// =============================================================================
+
+// Fixed-size ring of the most recent abends. Writers claim a slot with a
+// single fetch_add on the head, so concurrent abends land in different
+// slots; the per-slot spin lock only matters when a reader copies a slot
+// that is being overwritten, or when writers lap the whole ring.
+class AbendHistory {
+public:
+    static constexpr UInt32 CAPACITY = 128;
+    
+    void record(const AbendInfo& info);
+    [[nodiscard]] std::vector<AbendInfo> recent(UInt32 count) const;
+    [[nodiscard]] UInt64 total_recorded() const { return head_.load(std::memory_order_acquire); }
+    void clear();
+    
+private:
+    struct Slot {
+        mutable threading::SpinLock lock;
+        UInt64 sequence = 0;   // 1-based position in the history; 0 = empty
+        AbendInfo info;
+    };
+    
+    std::array<Slot, CAPACITY> slots_;
+    std::atomic<UInt64> head_{0};
+};
+
 // =============================================================================
 // Abend Manager
 // =============================================================================
@@ -187,42 +244,78 @@ public:
     void reset_stats();
     
     // Dump control
-    void set_dump_enabled(bool enabled) { dump_enabled_ = enabled; }
+    void set_dump_enabled(bool enabled) { dump_enabled_.store(enabled, std::memory_order_relaxed); }
     [[nodiscard]] bool is_dump_enabled() const { return dump_enabled_; }
     void set_dump_directory(StringView dir) { dump_directory_ = String(dir); }
     [[nodiscard]] const String& dump_directory() const { return dump_directory_; }
     
-    // Context
-    void set_current_transaction(StringView transid) { current_transid_ = String(transid); }
-    void set_current_program(StringView program) { current_program_ = String(program); }
-    void set_current_task(UInt32 task_id) { current_task_id_ = task_id; }
+    // Context (per task)
+    void set_current_transaction(StringView transid) { task_state().current_transid = String(transid); }
+    void set_current_program(StringView program) { task_state().current_program = String(program); }
+    void set_current_task(UInt32 task_id) { task_state().current_task_id = task_id; }
+    
+    // Discard the calling task's handler stack, condition handlers and
+    // context. The task end hook does this for each task as it ends, so a
+    // pooled thread starts the next task clean and ending a nested task
+    // leaves the task around it alone.
+    void end_task();
     
 private:
-    AbendManager() = default;
-    ~AbendManager() = default;
+    // HANDLE ABEND/CONDITION state belongs to the task, not the region. It is
+    // kept by task number (current_task_id()), so a task bound inside another
+    // on the same thread has state of its own, and tagged with the manager
+    // generation so initialize()/shutdown() invalidate every task's state
+    // lazily. Code outside any task has a state per thread.
+    struct TaskState {
+        UInt64 generation = 0;
+        HandlerStack handler_stack;
+        std::unordered_map<ErrorCode, ConditionHandler> condition_handlers;
+        String current_transid;
+        String current_program;
+        UInt32 current_task_id = 0;
+    };
+    
+    // The calling thread's last state; cleared by the end hook of its task
+    struct StateCache {
+        UInt32 task_id = 0;
+        TaskState* state = nullptr;
+    };
+    
+    AbendManager();
+    ~AbendManager();
     AbendManager(const AbendManager&) = delete;
     AbendManager& operator=(const AbendManager&) = delete;
     
+    [[nodiscard]] TaskState& task_state() const;
+    void release_task(UInt32 task_id);      // The task end hook
+    [[nodiscard]] AbendInfo make_abend_info(StringView code) const;
     void record_abend(const AbendInfo& info);
     String create_dump(const AbendInfo& info);
     void invoke_handler(const AbendInfo& info);
     
-    bool initialized_ = false;
-    bool dump_enabled_ = true;
+    std::atomic<bool> initialized_{false};
+    std::atomic<bool> dump_enabled_{true};
     String dump_directory_ = "/tmp/cics_dumps";
     
-    HandlerStack handler_stack_;
     HandlerDefinition default_handler_;
-    std::unordered_map<ErrorCode, ConditionHandler> condition_handlers_;
     
-    String current_transid_;
-    String current_program_;
-    UInt32 current_task_id_ = 0;
+    thread_local static TaskState unbound_state_;
+    thread_local static StateCache state_cache_;
+    mutable std::unordered_map<UInt32, std::unique_ptr<TaskState>> task_states_;
+    mutable std::mutex states_mutex_;
+    std::atomic<UInt64> generation_{1};
+    UInt64 end_hook_ = 0;
+    
+    AbendHistory recent_abends_;
+    AbendCodeCounters abend_by_code_;
     
-    std::vector<AbendInfo> recent_abends_;
-    static constexpr UInt32 MAX_RECENT_ABENDS = 100;
+    AtomicCounter<UInt64> abends_total_;
+    AtomicCounter<UInt64> abends_handled_;
+    AtomicCounter<UInt64> abends_terminated_;
+    AtomicCounter<UInt64> dumps_taken_;
+    AtomicCounter<UInt64> handlers_pushed_;
+    AtomicCounter<UInt64> handlers_popped_;
     
-    AbendStats stats_;
     mutable std::mutex mutex_;
 };
 
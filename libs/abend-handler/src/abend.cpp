@@ -3,6 +3,7 @@
 // =============================================================================
 
 #include <cics/abend/abend.hpp>
+#include <cics/common/task_context.hpp>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
@@ -17,7 +18,7 @@ namespace abend {
 // =============================================================================
 
 String abend_code_description(StringView code) {
-    static const std::unordered_map<String, String> descriptions = {
+    static const StringMap<String> descriptions = {
         {"ASRA", "Program check exception"},
         {"ASRB", "Operating system abend"},
         {"ASRD", "External CICS interface error"},
@@ -39,7 +40,7 @@ String abend_code_description(StringView code) {
         {"AFCE", "File control - duplicate key"}
     };
     
-    auto it = descriptions.find(String(code));
+    auto it = descriptions.find(code);
     if (it != descriptions.end()) {
         return it->second;
     }
@@ -63,44 +64,144 @@ bool is_user_abend(StringView code) {
 // =============================================================================
 
 void HandlerStack::push(const HandlerDefinition& handler) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    stack_.push(handler);
+    stack_.push_back(handler);
 }
 
 bool HandlerStack::pop() {
-    std::lock_guard<std::mutex> lock(mutex_);
     if (stack_.empty()) {
         return false;
     }
-    stack_.pop();
+    stack_.pop_back();
     return true;
 }
 
 const HandlerDefinition* HandlerStack::current() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     if (stack_.empty()) {
         return nullptr;
     }
-    return &stack_.top();
+    return &stack_.back();
 }
 
 bool HandlerStack::empty() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return stack_.empty();
 }
 
 UInt32 HandlerStack::depth() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return static_cast<UInt32>(stack_.size());
 }
 
 void HandlerStack::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    while (!stack_.empty()) {
-        stack_.pop();
+    stack_.clear();
+}
+
+// =============================================================================
+// AbendCodeCounters Implementation
+// =============================================================================
+
+UInt32 AbendCodeCounters::pack(const FixedString<4>& code) {
+    return static_cast<UInt32>(static_cast<unsigned char>(code[0])) << 24 |
+           static_cast<UInt32>(static_cast<unsigned char>(code[1])) << 16 |
+           static_cast<UInt32>(static_cast<unsigned char>(code[2])) << 8 |
+           static_cast<UInt32>(static_cast<unsigned char>(code[3]));
+}
+
+void AbendCodeCounters::increment(const FixedString<4>& code) {
+    const UInt32 key = pack(code);
+    UInt32 slot = (key * 2654435761u) % CAPACITY;
+    for (UInt32 probe = 0; probe < CAPACITY; ++probe) {
+        UInt32 current = keys_[slot].load(std::memory_order_acquire);
+        if (current == 0) {
+            if (keys_[slot].compare_exchange_strong(current, key,
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                ++counts_[slot];
+                return;
+            }
+            // Lost the race; current now holds the winner's key
+        }
+        if (current == key) {
+            ++counts_[slot];
+            return;
+        }
+        slot = (slot + 1) % CAPACITY;
+    }
+    ++overflow_;
+}
+
+UInt64 AbendCodeCounters::count(const FixedString<4>& code) const {
+    const UInt32 key = pack(code);
+    UInt32 slot = (key * 2654435761u) % CAPACITY;
+    for (UInt32 probe = 0; probe < CAPACITY; ++probe) {
+        UInt32 current = keys_[slot].load(std::memory_order_acquire);
+        if (current == 0) return 0;
+        if (current == key) return counts_[slot].get();
+        slot = (slot + 1) % CAPACITY;
+    }
+    return 0;
+}
+
+void AbendCodeCounters::snapshot(std::unordered_map<String, UInt64>& out) const {
+    for (UInt32 i = 0; i < CAPACITY; ++i) {
+        UInt32 key = keys_[i].load(std::memory_order_acquire);
+        if (key == 0) continue;
+        String code(4, ' ');
+        code[0] = static_cast<char>(key >> 24);
+        code[1] = static_cast<char>(key >> 16);
+        code[2] = static_cast<char>(key >> 8);
+        code[3] = static_cast<char>(key);
+        out[code] += counts_[i].get();
+    }
+}
+
+void AbendCodeCounters::reset() {
+    for (UInt32 i = 0; i < CAPACITY; ++i) {
+        keys_[i].store(0, std::memory_order_release);
+        counts_[i].reset();
+    }
+    overflow_.reset();
+}
+
+// =============================================================================
+// AbendHistory Implementation
+// =============================================================================
+
+void AbendHistory::record(const AbendInfo& info) {
+    UInt64 sequence = head_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    Slot& slot = slots_[(sequence - 1) % CAPACITY];
+    std::lock_guard<threading::SpinLock> lock(slot.lock);
+    // A writer that lapped us may already have filled this slot
+    if (slot.sequence < sequence) {
+        slot.info = info;
+        slot.sequence = sequence;
     }
 }
 
+std::vector<AbendInfo> AbendHistory::recent(UInt32 count) const {
+    UInt64 head = head_.load(std::memory_order_acquire);
+    UInt64 available = std::min<UInt64>(head, CAPACITY);
+    UInt64 wanted = std::min<UInt64>(count, available);
+    
+    std::vector<AbendInfo> result;
+    result.reserve(static_cast<Size>(wanted));
+    for (UInt64 sequence = head - wanted + 1; sequence <= head; ++sequence) {
+        const Slot& slot = slots_[(sequence - 1) % CAPACITY];
+        std::lock_guard<threading::SpinLock> lock(slot.lock);
+        // Skip slots still being written or already overwritten
+        if (slot.sequence == sequence) {
+            result.push_back(slot.info);
+        }
+    }
+    return result;
+}
+
+void AbendHistory::clear() {
+    for (auto& slot : slots_) {
+        std::lock_guard<threading::SpinLock> lock(slot.lock);
+        slot.sequence = 0;
+        slot.info = AbendInfo{};
+    }
+    head_.store(0, std::memory_order_release);
+}
+
 // =============================================================================
 // AbendException Implementation
 // =============================================================================
@@ -127,17 +228,50 @@ const char* AbendException::what() const noexcept {
 // AbendManager Implementation
 // =============================================================================
 
+thread_local AbendManager::TaskState AbendManager::unbound_state_;
+thread_local AbendManager::StateCache AbendManager::state_cache_;
+
 AbendManager& AbendManager::instance() {
     static AbendManager instance;
     return instance;
 }
 
+AbendManager::AbendManager()
+    : end_hook_(add_task_end_hook([this](UInt32 task_id) { release_task(task_id); })) {}
+
+AbendManager::~AbendManager() {
+    remove_task_end_hook(end_hook_);
+}
+
+AbendManager::TaskState& AbendManager::task_state() const {
+    const UInt32 task_id = current_task_id();
+    StateCache& cache = state_cache_;
+    if (cache.state == nullptr || cache.task_id != task_id) {
+        TaskState* state = &unbound_state_;
+        if (task_id != 0) {
+            std::lock_guard<std::mutex> lock(states_mutex_);
+            auto& slot = task_states_[task_id];
+            if (!slot) slot = std::make_unique<TaskState>();
+            state = slot.get();
+        }
+        cache = StateCache{task_id, state};
+    }
+    
+    TaskState& state = *cache.state;
+    const UInt64 generation = generation_.load(std::memory_order_acquire);
+    if (state.generation != generation) {
+        state = TaskState{};
+        state.generation = generation;
+    }
+    return state;
+}
+
 void AbendManager::initialize() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (initialized_) return;
     
-    handler_stack_.clear();
-    condition_handlers_.clear();
+    // Invalidates every task's handler stack and condition handlers
+    generation_.fetch_add(1, std::memory_order_acq_rel);
     recent_abends_.clear();
     
     // Set default handler
@@ -150,129 +284,142 @@ void AbendManager::initialize() {
 
 void AbendManager::shutdown() {
     std::lock_guard<std::mutex> lock(mutex_);
-    handler_stack_.clear();
-    condition_handlers_.clear();
+    generation_.fetch_add(1, std::memory_order_acq_rel);
     initialized_ = false;
 }
 
+void AbendManager::end_task() {
+    const UInt32 task_id = current_task_id();
+    if (task_id != 0) {
+        release_task(task_id);
+        return;
+    }
+    unbound_state_ = TaskState{};
+    unbound_state_.generation = generation_.load(std::memory_order_acquire);
+}
+
+void AbendManager::release_task(UInt32 task_id) {
+    std::unique_ptr<TaskState> state;
+    {
+        std::lock_guard<std::mutex> lock(states_mutex_);
+        auto it = task_states_.find(task_id);
+        if (it == task_states_.end()) return;
+        state = std::move(it->second);
+        task_states_.erase(it);
+    }
+    // End hooks run on the task's own thread, the only one caching its state
+    if (state_cache_.state == state.get()) state_cache_ = StateCache{};
+}
+
 Result<void> AbendManager::handle_abend_program(StringView program) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     HandlerDefinition handler;
     handler.type = HandlerType::PROGRAM;
     handler.program_name = String(program);
     handler.active = true;
     
-    handler_stack_.push(handler);
+    task_state().handler_stack.push(handler);
     return make_success();
 }
 
 Result<void> AbendManager::handle_abend_cancel() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     HandlerDefinition handler;
     handler.type = HandlerType::CANCEL;
     handler.active = true;
     
-    handler_stack_.push(handler);
+    task_state().handler_stack.push(handler);
     return make_success();
 }
 
 Result<void> AbendManager::handle_abend_reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     HandlerDefinition handler;
     handler.type = HandlerType::RESET;
     handler.active = true;
     
-    handler_stack_.push(handler);
+    task_state().handler_stack.push(handler);
     return make_success();
 }
 
 Result<void> AbendManager::handle_abend_callback(AbendCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     HandlerDefinition handler;
     handler.type = HandlerType::PROGRAM;
     handler.callback = std::move(callback);
     handler.active = true;
     
-    handler_stack_.push(handler);
+    task_state().handler_stack.push(handler);
     return make_success();
 }
 
 Result<void> AbendManager::handle_condition(ErrorCode condition, HandlerType type, StringView program) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     ConditionHandler ch;
     ch.condition = condition;
     ch.handler.type = type;
     ch.handler.program_name = String(program);
     ch.handler.active = true;
     
-    condition_handlers_[condition] = ch;
+    task_state().condition_handlers[condition] = ch;
     return make_success();
 }
 
 Result<void> AbendManager::ignore_condition(ErrorCode condition) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    condition_handlers_.erase(condition);
+    task_state().condition_handlers.erase(condition);
     return make_success();
 }
 
 Result<void> AbendManager::push_handler() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    HandlerStack& stack = task_state().handler_stack;
     
     // Push a copy of the current handler state
-    const HandlerDefinition* current = handler_stack_.current();
+    const HandlerDefinition* current = stack.current();
     if (current) {
-        handler_stack_.push(*current);
+        HandlerDefinition copy = *current;
+        stack.push(copy);
     } else {
-        handler_stack_.push(default_handler_);
+        stack.push(default_handler_);
     }
     
-    ++stats_.handlers_pushed;
+    ++handlers_pushed_;
     return make_success();
 }
 
 Result<void> AbendManager::pop_handler() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (!handler_stack_.pop()) {
+    if (!task_state().handler_stack.pop()) {
         return make_error<void>(ErrorCode::INVALID_STATE,
             "Handler stack is empty");
     }
     
-    ++stats_.handlers_popped;
+    ++handlers_popped_;
     return make_success();
 }
 
-void AbendManager::abend(StringView code) {
-    abend(code, false);
-}
-
-void AbendManager::abend(StringView code, bool nodump) {
+AbendInfo AbendManager::make_abend_info(StringView code) const {
+    const TaskState& state = task_state();
     AbendInfo info;
     info.code = code;
     info.message = abend_code_description(code);
-    info.program = current_program_;
-    info.transaction_id = current_transid_;
-    info.task_id = current_task_id_;
+    info.program = state.current_program;
+    info.transaction_id = state.current_transid;
+    info.task_id = state.current_task_id;
     info.timestamp = std::chrono::system_clock::now();
     info.dump_taken = false;
+    return info;
+}
+
+void AbendManager::abend(StringView code) {
+    abend(code, false);
+}
+
+void AbendManager::abend(StringView code, bool nodump) {
+    AbendInfo info = make_abend_info(code);
     
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        ++stats_.abends_total;
-        ++stats_.abend_by_code[info.code.str()];
-    }
+    ++abends_total_;
+    abend_by_code_.increment(info.code);
     
     // Take dump if enabled
     if (dump_enabled_ && !nodump) {
         info.dump_id = create_dump(info);
         info.dump_taken = !info.dump_id.empty();
         if (info.dump_taken) {
-            ++stats_.dumps_taken;
+            ++dumps_taken_;
         }
     }
     
@@ -281,37 +428,27 @@ void AbendManager::abend(StringView code, bool nodump) {
     // Check for handler
     const HandlerDefinition* handler = current_handler();
     if (handler && handler->type != HandlerType::CANCEL) {
-        ++stats_.abends_handled;
+        ++abends_handled_;
         invoke_handler(info);
         // If handler returns, re-throw
     }
     
-    ++stats_.abends_terminated;
+    ++abends_terminated_;
     throw AbendException(code, info.message);
 }
 
 Result<void> AbendManager::abend_handled(StringView code) {
-    AbendInfo info;
-    info.code = code;
-    info.message = abend_code_description(code);
-    info.program = current_program_;
-    info.transaction_id = current_transid_;
-    info.task_id = current_task_id_;
-    info.timestamp = std::chrono::system_clock::now();
-    info.dump_taken = false;
+    AbendInfo info = make_abend_info(code);
     
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        ++stats_.abends_total;
-        ++stats_.abend_by_code[info.code.str()];
-    }
+    ++abends_total_;
+    abend_by_code_.increment(info.code);
     
     record_abend(info);
     
     // Check for handler
     const HandlerDefinition* handler = current_handler();
     if (handler && handler->callback) {
-        ++stats_.abends_handled;
+        ++abends_handled_;
         handler->callback(info);
         return make_success();
     }
@@ -321,12 +458,7 @@ Result<void> AbendManager::abend_handled(StringView code) {
 }
 
 void AbendManager::record_abend(const AbendInfo& info) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    recent_abends_.push_back(info);
-    if (recent_abends_.size() > MAX_RECENT_ABENDS) {
-        recent_abends_.erase(recent_abends_.begin());
-    }
+    recent_abends_.record(info);
 }
 
 String AbendManager::create_dump(const AbendInfo& info) {
@@ -359,7 +491,7 @@ String AbendManager::create_dump(const AbendInfo& info) {
     dump_file << "-------------------------------------------------------------------\n";
     dump_file << "HANDLER INFORMATION\n";
     dump_file << "-------------------------------------------------------------------\n";
-    dump_file << "Handler Stack Depth: " << handler_stack_.depth() << "\n";
+    dump_file << "Handler Stack Depth: " << task_state().handler_stack.depth() << "\n";
     
     const HandlerDefinition* handler = current_handler();
     if (handler) {
@@ -395,37 +527,33 @@ void AbendManager::invoke_handler(const AbendInfo& info) {
 }
 
 AbendStats AbendManager::get_stats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stats_;
+    AbendStats stats;
+    stats.abends_total = abends_total_.get();
+    stats.abends_handled = abends_handled_.get();
+    stats.abends_terminated = abends_terminated_.get();
+    stats.dumps_taken = dumps_taken_.get();
+    stats.handlers_pushed = handlers_pushed_.get();
+    stats.handlers_popped = handlers_popped_.get();
+    abend_by_code_.snapshot(stats.abend_by_code);
+    return stats;
 }
 
 std::vector<AbendInfo> AbendManager::get_recent_abends(UInt32 count) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    UInt32 actual_count = std::min(count, static_cast<UInt32>(recent_abends_.size()));
-    std::vector<AbendInfo> result;
-    result.reserve(actual_count);
-    
-    auto start = recent_abends_.end() - actual_count;
-    for (auto it = start; it != recent_abends_.end(); ++it) {
-        result.push_back(*it);
-    }
-    
-    return result;
+    return recent_abends_.recent(count);
 }
 
 const HandlerDefinition* AbendManager::current_handler() const {
-    return handler_stack_.current();
+    return task_state().handler_stack.current();
 }
 
 void AbendManager::reset_stats() {
-    stats_.abends_total = 0;
-    stats_.abends_handled = 0;
-    stats_.abends_terminated = 0;
-    stats_.dumps_taken = 0;
-    stats_.handlers_pushed = 0;
-    stats_.handlers_popped = 0;
-    stats_.abend_by_code.clear();
+    abends_total_.reset();
+    abends_handled_.reset();
+    abends_terminated_.reset();
+    dumps_taken_.reset();
+    handlers_pushed_.reset();
+    handlers_popped_.reset();
+    abend_by_code_.reset();
 }
 
 // =============================================================================
@@ -4,6 +4,15 @@
 // Provides PUT CONTAINER, GET CONTAINER, DELETE CONTAINER functionality.
 // Implements modern CICS data passing mechanism between programs.
 //
+// Channels belong to the task that creates them, as in CICS: they live in
+// a scope kept by task number (current_task_id()), which a task end hook
+// releases. The running thread caches its task's scope, so channels are
+// reached without the manager's lock and their containers are not locked
+// at all. Deleted containers and channels go to a pool kept per thread,
+// buffers and all, for the next task the thread runs. Code outside any
+// task has a scope per thread. Channels created with create_shared_channel
+// are visible to every task and lock as before.
+//
 // Copyright (c) 2025 Bennie Shearer. All rights reserved.
 // =============================================================================
 
@@ -12,12 +21,14 @@
 
 #include <cics/common/types.hpp>
 #include <cics/common/error.hpp>
+#include <cics/common/task_context.hpp>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
 #include <chrono>
 #include <atomic>
 #include <optional>
+#include <vector>
 
 namespace cics {
 namespace channel {
@@ -103,13 +114,26 @@ public:
     // Set container type
     void set_container_type(ContainerType type) { container_type_ = type; }
     
+    // In a shared channel, so reached from more than one task
+    [[nodiscard]] bool is_shared() const { return shared_; }
+    
 private:
+    friend class Channel;
+    
+    // Take a pooled container under a new name, keeping its buffer
+    void reset(StringView name, DataType type);
+    
+    [[nodiscard]] std::unique_lock<std::mutex> guard() const {
+        return shared_ ? std::unique_lock<std::mutex>(mutex_) : std::unique_lock<std::mutex>();
+    }
+    
     String name_;
     ByteBuffer data_;
     DataType data_type_;
     ContainerType container_type_ = ContainerType::NORMAL;
     std::chrono::steady_clock::time_point created_;
     std::chrono::steady_clock::time_point modified_;
+    bool shared_ = false;
     mutable std::mutex mutex_;
 };
 
@@ -126,10 +150,11 @@ struct ChannelInfo {
 
 class Channel {
 public:
-    explicit Channel(StringView name);
+    explicit Channel(StringView name, bool shared = false);
     
     // Properties
     [[nodiscard]] const String& name() const { return name_; }
+    [[nodiscard]] bool is_shared() const { return shared_; }
     [[nodiscard]] UInt32 container_count() const;
     [[nodiscard]] UInt64 total_size() const;
     
@@ -150,16 +175,36 @@ public:
     [[nodiscard]] std::vector<String> list_containers() const;
     [[nodiscard]] std::vector<ContainerInfo> list_container_info() const;
     
-    // Clear all containers
+    // Clear all containers; they go back to the calling task's pool
     void clear();
     
     // Information
     [[nodiscard]] ChannelInfo get_info() const;
     
 private:
+    friend class ChannelManager;
+    
+    // A channel holds a handful of containers: a flat map, searched by
+    // comparing names a word at a time
+    struct Slot {
+        FixedString<MAX_CONTAINER_NAME_LENGTH> key;
+        std::unique_ptr<Container> container;
+    };
+    
+    [[nodiscard]] std::vector<Slot>::iterator find(StringView name);
+    [[nodiscard]] std::vector<Slot>::const_iterator find(StringView name) const;
+    Container* insert(StringView name, std::unique_ptr<Container> container);
+    void release(std::unique_ptr<Container> container);
+    void reuse(StringView name);
+    
+    [[nodiscard]] std::unique_lock<std::mutex> guard() const {
+        return shared_ ? std::unique_lock<std::mutex>(mutex_) : std::unique_lock<std::mutex>();
+    }
+    
     String name_;
-    std::unordered_map<String, std::unique_ptr<Container>> containers_;
+    std::vector<Slot> containers_;
     std::chrono::steady_clock::time_point created_;
+    bool shared_;
     mutable std::mutex mutex_;
 };
 
@@ -191,8 +236,10 @@ public:
     void shutdown();
     [[nodiscard]] bool is_initialized() const { return initialized_; }
     
-    // Channel operations
+    // Channel operations; names resolve in the calling task's channels,
+    // then in the shared ones
     Result<Channel*> create_channel(StringView name);
+    Result<Channel*> create_shared_channel(StringView name);
     Result<Channel*> get_channel(StringView name);
     Result<void> delete_channel(StringView name);
     [[nodiscard]] bool has_channel(StringView name) const;
@@ -200,7 +247,11 @@ public:
     // Current channel (for implicit operations)
     void set_current_channel(StringView name);
     [[nodiscard]] Channel* current_channel();
-    [[nodiscard]] const String& current_channel_name() const { return current_channel_name_; }
+    [[nodiscard]] const String& current_channel_name() const { return task_scope().current_name; }
+    
+    // Release the calling task's channels, recycling their containers;
+    // the task end hook does this for every task
+    void end_task();
     
     // Container operations on current channel
     Result<void> put_container(StringView container, const void* data, UInt32 length);
@@ -222,15 +273,54 @@ public:
     void reset_stats();
     
 private:
-    ChannelManager() = default;
-    ~ChannelManager() = default;
+    ChannelManager();
+    ~ChannelManager();
     ChannelManager(const ChannelManager&) = delete;
     ChannelManager& operator=(const ChannelManager&) = delete;
     
-    bool initialized_ = false;
-    std::unordered_map<String, std::unique_ptr<Channel>> channels_;
-    thread_local static String current_channel_name_;
-    ChannelStats stats_;
+    // One task's channels; only the thread running the task touches it
+    struct TaskScope {
+        std::vector<std::unique_ptr<Channel>> channels;
+        String current_name;
+        Channel* current = nullptr;    // Cached when the current channel is the task's
+        UInt64 generation = 0;         // Of the thread's own scope, outside a task
+    };
+    
+    // The calling thread's last scope; stale once shutdown moves the
+    // generation on, and cleared by the end hook of the task it names
+    struct ScopeCache {
+        UInt32 task_id = 0;
+        UInt64 generation = 0;
+        TaskScope* scope = nullptr;
+    };
+    
+    struct Counters {
+        AtomicCounter<> channels_created;
+        AtomicCounter<> channels_deleted;
+        AtomicCounter<> containers_created;
+        AtomicCounter<> containers_deleted;
+        AtomicCounter<> puts_executed;
+        AtomicCounter<> gets_executed;
+        AtomicCounter<> bytes_written;
+        AtomicCounter<> bytes_read;
+    };
+    
+    TaskScope& task_scope() const;
+    Channel* find_task_channel(StringView name) const;
+    Channel* find_shared_channel(StringView name) const;
+    void release_scope(TaskScope& scope);
+    void release_task(UInt32 task_id);      // The task end hook
+    
+    thread_local static TaskScope unbound_scope_;
+    thread_local static ScopeCache scope_cache_;
+    
+    std::atomic<bool> initialized_{false};
+    std::atomic<UInt64> generation_{1};
+    mutable std::unordered_map<UInt32, std::unique_ptr<TaskScope>> task_scopes_;
+    mutable std::mutex scopes_mutex_;
+    UInt64 end_hook_ = 0;
+    StringMap<std::unique_ptr<Channel>> shared_channels_;
+    Counters stats_;
     mutable std::mutex mutex_;
 };
 
@@ -5,12 +5,31 @@
 #include <cics/channel/channel.hpp>
 #include <algorithm>
 #include <cstring>
+#include <utility>
 
 namespace cics {
 namespace channel {
 
-// Thread-local current channel
-thread_local String ChannelManager::current_channel_name_;
+namespace {
+
+// Containers and channels a task let go of wait here for the next PUT on
+// the same thread, whichever task makes it; large buffers are given back
+// rather than kept
+constexpr Size POOLED_CONTAINERS = 256;
+constexpr Size POOLED_BUFFER_LIMIT = 64 * 1024;
+constexpr Size SPARE_CHANNELS = 8;
+
+std::vector<std::unique_ptr<Container>>& container_pool() {
+    thread_local std::vector<std::unique_ptr<Container>> pool;
+    return pool;
+}
+
+std::vector<std::unique_ptr<Channel>>& spare_channels() {
+    thread_local std::vector<std::unique_ptr<Channel>> spare;
+    return spare;
+}
+
+} // namespace
 
 // =============================================================================
 // Utility Functions
@@ -47,8 +66,17 @@ Container::Container(StringView name, DataType type)
 {
 }
 
+void Container::reset(StringView name, DataType type) {
+    name_.assign(name);
+    data_.clear();
+    data_type_ = type;
+    container_type_ = ContainerType::NORMAL;
+    created_ = std::chrono::steady_clock::now();
+    modified_ = created_;
+}
+
 Result<void> Container::put(const void* data, UInt32 length) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     if (length > MAX_CONTAINER_SIZE) {
         return make_error<void>(ErrorCode::LENGERR,
@@ -73,12 +101,12 @@ Result<void> Container::put(StringView str) {
 }
 
 Result<ByteBuffer> Container::get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     return make_success(data_);
 }
 
 Result<UInt32> Container::get(void* buffer, UInt32 max_length) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     if (!buffer) {
         return make_error<UInt32>(ErrorCode::INVREQ, "Null buffer provided");
@@ -93,12 +121,12 @@ Result<UInt32> Container::get(void* buffer, UInt32 max_length) const {
 }
 
 Result<String> Container::get_string() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     return make_success(String(reinterpret_cast<const char*>(data_.data()), data_.size()));
 }
 
 Result<void> Container::append(const void* data, UInt32 length) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     if (data_.size() + length > MAX_CONTAINER_SIZE) {
         return make_error<void>(ErrorCode::LENGERR,
@@ -116,7 +144,7 @@ Result<void> Container::append(const void* data, UInt32 length) {
 }
 
 Result<void> Container::replace(UInt32 offset, const void* data, UInt32 length) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     if (offset + length > data_.size()) {
         return make_error<void>(ErrorCode::LENGERR,
@@ -132,13 +160,13 @@ Result<void> Container::replace(UInt32 offset, const void* data, UInt32 length)
 }
 
 void Container::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     data_.clear();
     modified_ = std::chrono::steady_clock::now();
 }
 
 ContainerInfo Container::get_info() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     ContainerInfo info;
     info.name = name_;
@@ -154,169 +182,211 @@ ContainerInfo Container::get_info() const {
 // Channel Implementation
 // =============================================================================
 
-Channel::Channel(StringView name)
+Channel::Channel(StringView name, bool shared)
     : name_(name)
     , created_(std::chrono::steady_clock::now())
+    , shared_(shared)
 {
 }
 
+std::vector<Channel::Slot>::const_iterator Channel::find(StringView name) const {
+    if (name.size() > MAX_CONTAINER_NAME_LENGTH) return containers_.end();
+    const FixedString<MAX_CONTAINER_NAME_LENGTH> key(name);
+    return std::find_if(containers_.begin(), containers_.end(),
+        [&key](const Slot& slot) { return slot.key == key; });
+}
+
+std::vector<Channel::Slot>::iterator Channel::find(StringView name) {
+    auto it = std::as_const(*this).find(name);
+    return containers_.begin() + (it - containers_.cbegin());
+}
+
+Container* Channel::insert(StringView name, std::unique_ptr<Container> container) {
+    container->shared_ = shared_;
+    Container* ptr = container.get();
+    containers_.push_back(Slot{FixedString<MAX_CONTAINER_NAME_LENGTH>(name), std::move(container)});
+    return ptr;
+}
+
+void Channel::release(std::unique_ptr<Container> container) {
+    auto& pool = container_pool();
+    if (pool.size() >= POOLED_CONTAINERS) return;
+    if (container->data_.capacity() > POOLED_BUFFER_LIMIT) container->data_ = ByteBuffer();
+    pool.push_back(std::move(container));
+}
+
+void Channel::reuse(StringView name) {
+    name_.assign(name);
+    created_ = std::chrono::steady_clock::now();
+}
+
 UInt32 Channel::container_count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     return static_cast<UInt32>(containers_.size());
 }
 
 UInt64 Channel::total_size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     UInt64 total = 0;
-    for (const auto& [name, container] : containers_) {
-        total += container->size();
+    for (const auto& slot : containers_) {
+        total += slot.container->size();
     }
     return total;
 }
 
 Result<Container*> Channel::create_container(StringView name, DataType type) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     if (name.length() > MAX_CONTAINER_NAME_LENGTH) {
         return make_error<Container*>(ErrorCode::INVREQ,
             "Container name exceeds maximum length");
     }
     
-    String key(name);
-    auto it = containers_.find(key);
+    auto it = find(name);
     if (it != containers_.end()) {
         // Return existing container
-        return make_success(it->second.get());
+        return make_success(it->container.get());
     }
     
-    auto container = std::make_unique<Container>(name, type);
-    Container* ptr = container.get();
-    containers_[key] = std::move(container);
+    std::unique_ptr<Container> container;
+    auto& pool = container_pool();
+    if (!pool.empty()) {
+        container = std::move(pool.back());
+        pool.pop_back();
+        container->reset(name, type);
+    } else {
+        container = std::make_unique<Container>(name, type);
+    }
     
-    return make_success(ptr);
+    return make_success(insert(name, std::move(container)));
 }
 
 Result<Container*> Channel::get_container(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
-    auto it = containers_.find(String(name));
+    auto it = find(name);
     if (it == containers_.end()) {
         return make_error<Container*>(ErrorCode::CONTAINERERR,
             "Container not found: " + String(name));
     }
     
-    return make_success(it->second.get());
+    return make_success(it->container.get());
 }
 
 const Container* Channel::get_container(StringView name) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
-    auto it = containers_.find(String(name));
-    if (it == containers_.end()) {
-        return nullptr;
-    }
-    
-    return it->second.get();
+    auto it = find(name);
+    return it != containers_.end() ? it->container.get() : nullptr;
 }
 
 Result<void> Channel::delete_container(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
-    auto it = containers_.find(String(name));
+    auto it = find(name);
     if (it == containers_.end()) {
         return make_error<void>(ErrorCode::CONTAINERERR,
             "Container not found: " + String(name));
     }
     
+    auto container = std::move(it->container);
     containers_.erase(it);
+    release(std::move(container));
     return make_success();
 }
 
 bool Channel::has_container(StringView name) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return containers_.find(String(name)) != containers_.end();
+    auto lock = guard();
+    return find(name) != containers_.end();
 }
 
 Result<void> Channel::move_container(StringView name, Channel& target) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    if (&target == this) return make_success();
+    auto lock = guard();
     
-    auto it = containers_.find(String(name));
+    auto it = find(name);
     if (it == containers_.end()) {
         return make_error<void>(ErrorCode::CONTAINERERR,
             "Container not found: " + String(name));
     }
     
-    // Move to target
-    {
-        std::lock_guard<std::mutex> target_lock(target.mutex_);
-        target.containers_[String(name)] = std::move(it->second);
-    }
-    
+    auto container = std::move(it->container);
     containers_.erase(it);
+    
+    // Move to target, replacing any container of the same name
+    auto target_lock = target.guard();
+    auto existing = target.find(name);
+    if (existing != target.containers_.end()) {
+        release(std::move(existing->container));
+        target.containers_.erase(existing);
+    }
+    target.insert(name, std::move(container));
     return make_success();
 }
 
 Result<void> Channel::copy_container(StringView name, Channel& target, StringView new_name) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = containers_.find(String(name));
-    if (it == containers_.end()) {
-        return make_error<void>(ErrorCode::CONTAINERERR,
-            "Container not found: " + String(name));
+    ByteBuffer data;
+    DataType type;
+    {
+        auto lock = guard();
+        auto it = find(name);
+        if (it == containers_.end()) {
+            return make_error<void>(ErrorCode::CONTAINERERR,
+                "Container not found: " + String(name));
+        }
+        const Container& source = *it->container;
+        auto source_lock = source.guard();
+        data = source.data_;
+        type = source.data_type_;
     }
     
-    String target_name = new_name.empty() ? String(name) : String(new_name);
-    
     // Create copy in target
-    auto result = target.create_container(target_name, it->second->data_type());
+    auto result = target.create_container(new_name.empty() ? name : new_name, type);
     if (result.is_error()) {
         return make_error<void>(result.error().code, result.error().message);
     }
-    
-    auto data = it->second->get();
-    if (data.is_success()) {
-        result.value()->put(data.value());
-    }
-    
-    return make_success();
+    return result.value()->put(data);
 }
 
 std::vector<String> Channel::list_containers() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     std::vector<String> names;
     names.reserve(containers_.size());
-    for (const auto& [name, container] : containers_) {
-        names.push_back(name);
+    for (const auto& slot : containers_) {
+        names.push_back(slot.container->name());
     }
     return names;
 }
 
 std::vector<ContainerInfo> Channel::list_container_info() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     std::vector<ContainerInfo> infos;
     infos.reserve(containers_.size());
-    for (const auto& [name, container] : containers_) {
-        infos.push_back(container->get_info());
+    for (const auto& slot : containers_) {
+        infos.push_back(slot.container->get_info());
     }
     return infos;
 }
 
 void Channel::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
+    for (auto& slot : containers_) {
+        release(std::move(slot.container));
+    }
     containers_.clear();
 }
 
 ChannelInfo Channel::get_info() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = guard();
     
     ChannelInfo info;
     info.name = name_;
     info.container_count = static_cast<UInt32>(containers_.size());
     info.total_size = 0;
-    for (const auto& [name, container] : containers_) {
-        info.total_size += container->size();
+    for (const auto& slot : containers_) {
+        info.total_size += slot.container->size();
     }
     info.created = created_;
     return info;
@@ -326,30 +396,116 @@ ChannelInfo Channel::get_info() const {
 // ChannelManager Implementation
 // =============================================================================
 
+thread_local ChannelManager::TaskScope ChannelManager::unbound_scope_;
+thread_local ChannelManager::ScopeCache ChannelManager::scope_cache_;
+
 ChannelManager& ChannelManager::instance() {
     static ChannelManager instance;
     return instance;
 }
 
+ChannelManager::ChannelManager()
+    : end_hook_(add_task_end_hook([this](UInt32 task_id) { release_task(task_id); })) {}
+
+ChannelManager::~ChannelManager() {
+    remove_task_end_hook(end_hook_);
+}
+
+ChannelManager::TaskScope& ChannelManager::task_scope() const {
+    const UInt32 task_id = current_task_id();
+    const UInt64 generation = generation_.load(std::memory_order_acquire);
+    ScopeCache& cache = scope_cache_;
+    if (cache.scope != nullptr && cache.task_id == task_id && cache.generation == generation) {
+        return *cache.scope;
+    }
+    
+    TaskScope* scope = &unbound_scope_;
+    if (task_id != 0) {
+        std::lock_guard<std::mutex> lock(scopes_mutex_);
+        auto& slot = task_scopes_[task_id];
+        if (!slot) slot = std::make_unique<TaskScope>();
+        scope = slot.get();
+    } else if (unbound_scope_.generation != generation) {
+        // Shut down since this thread last looked
+        unbound_scope_ = TaskScope{};
+        unbound_scope_.generation = generation;
+    }
+    cache = ScopeCache{task_id, generation, scope};
+    return *scope;
+}
+
+Channel* ChannelManager::find_task_channel(StringView name) const {
+    for (auto& channel : task_scope().channels) {
+        if (channel->name() == name) return channel.get();
+    }
+    return nullptr;
+}
+
+Channel* ChannelManager::find_shared_channel(StringView name) const {
+    auto it = shared_channels_.find(name);
+    return it != shared_channels_.end() ? it->second.get() : nullptr;
+}
+
 void ChannelManager::initialize() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (initialized_) return;
     
-    channels_.clear();
+    shared_channels_.clear();
     reset_stats();
     initialized_ = true;
 }
 
 void ChannelManager::shutdown() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    channels_.clear();
-    current_channel_name_.clear();
-    initialized_ = false;
+    std::unordered_map<UInt32, std::unique_ptr<TaskScope>> scopes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shared_channels_.clear();
+        initialized_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(scopes_mutex_);
+        scopes.swap(task_scopes_);
+    }
+    // Every thread's cached scope, and its scope outside a task, is stale
+    generation_.fetch_add(1, std::memory_order_acq_rel);
 }
 
 Result<Channel*> ChannelManager::create_channel(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    if (!initialized_) {
+        return make_error<Channel*>(ErrorCode::NOT_INITIALIZED,
+            "ChannelManager not initialized");
+    }
     
+    if (name.length() > MAX_CHANNEL_NAME_LENGTH) {
+        return make_error<Channel*>(ErrorCode::INVREQ,
+            "Channel name exceeds maximum length");
+    }
+    
+    if (Channel* existing = find_task_channel(name)) return make_success(existing);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Channel* shared = find_shared_channel(name)) return make_success(shared);
+    }
+    
+    auto& scope = task_scope();
+    auto& spare = spare_channels();
+    std::unique_ptr<Channel> channel;
+    if (!spare.empty()) {
+        channel = std::move(spare.back());
+        spare.pop_back();
+        channel->reuse(name);
+    } else {
+        channel = std::make_unique<Channel>(name);
+    }
+    Channel* ptr = channel.get();
+    scope.channels.push_back(std::move(channel));
+    if (scope.current == nullptr && scope.current_name == name) scope.current = ptr;
+    
+    ++stats_.channels_created;
+    return make_success(ptr);
+}
+
+Result<Channel*> ChannelManager::create_shared_channel(StringView name) {
     if (!initialized_) {
         return make_error<Channel*>(ErrorCode::NOT_INITIALIZED,
             "ChannelManager not initialized");
@@ -360,67 +516,115 @@ Result<Channel*> ChannelManager::create_channel(StringView name) {
             "Channel name exceeds maximum length");
     }
     
-    String key(name);
-    auto it = channels_.find(key);
-    if (it != channels_.end()) {
-        return make_success(it->second.get());
+    if (find_task_channel(name)) {
+        return make_error<Channel*>(ErrorCode::INVREQ,
+            "Channel is already owned by this task: " + String(name));
     }
     
-    auto channel = std::make_unique<Channel>(name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Channel* existing = find_shared_channel(name)) return make_success(existing);
+    
+    auto channel = std::make_unique<Channel>(name, true);
     Channel* ptr = channel.get();
-    channels_[key] = std::move(channel);
+    shared_channels_.emplace(String(name), std::move(channel));
     
     ++stats_.channels_created;
     return make_success(ptr);
 }
 
 Result<Channel*> ChannelManager::get_channel(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    if (Channel* channel = find_task_channel(name)) return make_success(channel);
     
-    auto it = channels_.find(String(name));
-    if (it == channels_.end()) {
-        return make_error<Channel*>(ErrorCode::CHANNELERR,
-            "Channel not found: " + String(name));
-    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Channel* channel = find_shared_channel(name)) return make_success(channel);
     
-    return make_success(it->second.get());
+    return make_error<Channel*>(ErrorCode::CHANNELERR,
+        "Channel not found: " + String(name));
 }
 
 Result<void> ChannelManager::delete_channel(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto& scope = task_scope();
+    auto it = std::find_if(scope.channels.begin(), scope.channels.end(),
+        [name](const auto& channel) { return channel->name() == name; });
+    if (it != scope.channels.end()) {
+        if (scope.current == it->get()) scope.current = nullptr;
+        if (scope.current_name == name) scope.current_name.clear();
+        (*it)->clear();
+        if (spare_channels().size() < SPARE_CHANNELS) spare_channels().push_back(std::move(*it));
+        scope.channels.erase(it);
+        ++stats_.channels_deleted;
+        return make_success();
+    }
     
-    auto it = channels_.find(String(name));
-    if (it == channels_.end()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto shared = shared_channels_.find(name);
+    if (shared == shared_channels_.end()) {
         return make_error<void>(ErrorCode::CHANNELERR,
             "Channel not found: " + String(name));
     }
     
-    channels_.erase(it);
+    shared->second->clear();
+    shared_channels_.erase(shared);
     ++stats_.channels_deleted;
-    
-    if (current_channel_name_ == name) {
-        current_channel_name_.clear();
-    }
-    
+    if (scope.current_name == name) scope.current_name.clear();
     return make_success();
 }
 
 bool ChannelManager::has_channel(StringView name) const {
+    if (find_task_channel(name)) return true;
     std::lock_guard<std::mutex> lock(mutex_);
-    return channels_.find(String(name)) != channels_.end();
+    return find_shared_channel(name) != nullptr;
 }
 
 void ChannelManager::set_current_channel(StringView name) {
-    current_channel_name_ = String(name);
+    auto& scope = task_scope();
+    scope.current_name.assign(name);
+    scope.current = find_task_channel(name);
 }
 
 Channel* ChannelManager::current_channel() {
-    if (current_channel_name_.empty()) {
-        return nullptr;
-    }
+    auto& scope = task_scope();
+    if (scope.current != nullptr) return scope.current;
+    if (scope.current_name.empty()) return nullptr;
     
-    auto result = get_channel(current_channel_name_);
-    return result.is_success() ? result.value() : nullptr;
+    // A shared channel can be deleted by another task, so is not cached
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find_shared_channel(scope.current_name);
+}
+
+void ChannelManager::end_task() {
+    const UInt32 task_id = current_task_id();
+    if (task_id != 0) {
+        release_task(task_id);
+    } else {
+        release_scope(unbound_scope_);
+    }
+}
+
+void ChannelManager::release_task(UInt32 task_id) {
+    std::unique_ptr<TaskScope> scope;
+    {
+        std::lock_guard<std::mutex> lock(scopes_mutex_);
+        auto it = task_scopes_.find(task_id);
+        if (it == task_scopes_.end()) return;
+        scope = std::move(it->second);
+        task_scopes_.erase(it);
+    }
+    // End hooks run on the task's own thread, the only one caching its scope
+    if (scope_cache_.scope == scope.get()) scope_cache_ = ScopeCache{};
+    release_scope(*scope);
+}
+
+void ChannelManager::release_scope(TaskScope& scope) {
+    auto& spare = spare_channels();
+    for (auto& channel : scope.channels) {
+        channel->clear();
+        ++stats_.channels_deleted;
+        if (spare.size() < SPARE_CHANNELS) spare.push_back(std::move(channel));
+    }
+    scope.channels.clear();
+    scope.current = nullptr;
+    scope.current_name.clear();
 }
 
 Result<void> ChannelManager::put_container(StringView container, const void* data, UInt32 length) {
@@ -451,13 +655,10 @@ Result<void> ChannelManager::put_container(StringView container, const void* dat
 
 Result<void> ChannelManager::put_container(StringView container, StringView channel_name,
                                             const void* data, UInt32 length) {
-    auto channel_result = get_channel(channel_name);
+    // Finds the channel, or creates it
+    auto channel_result = create_channel(channel_name);
     if (channel_result.is_error()) {
-        // Auto-create channel
-        channel_result = create_channel(channel_name);
-        if (channel_result.is_error()) {
-            return make_error<void>(channel_result.error().code, channel_result.error().message);
-        }
+        return make_error<void>(channel_result.error().code, channel_result.error().message);
     }
     
     Channel* channel = channel_result.value();
@@ -545,54 +746,63 @@ Result<void> ChannelManager::move_container(StringView container, StringView fro
         return make_error<void>(from_result.error().code, from_result.error().message);
     }
     
-    auto to_result = get_channel(to_channel);
+    // Finds the target channel, or creates it
+    auto to_result = create_channel(to_channel);
     if (to_result.is_error()) {
-        // Auto-create target channel
-        to_result = create_channel(to_channel);
-        if (to_result.is_error()) {
-            return make_error<void>(to_result.error().code, to_result.error().message);
-        }
+        return make_error<void>(to_result.error().code, to_result.error().message);
     }
     
     return from_result.value()->move_container(container, *to_result.value());
 }
 
 std::vector<String> ChannelManager::list_channels() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     std::vector<String> names;
-    names.reserve(channels_.size());
-    for (const auto& [name, channel] : channels_) {
+    for (const auto& channel : task_scope().channels) {
+        names.push_back(channel->name());
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, channel] : shared_channels_) {
         names.push_back(name);
     }
     return names;
 }
 
 std::vector<ChannelInfo> ChannelManager::list_channel_info() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     std::vector<ChannelInfo> infos;
-    infos.reserve(channels_.size());
-    for (const auto& [name, channel] : channels_) {
+    for (const auto& channel : task_scope().channels) {
+        infos.push_back(channel->get_info());
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, channel] : shared_channels_) {
         infos.push_back(channel->get_info());
     }
     return infos;
 }
 
 ChannelStats ChannelManager::get_stats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stats_;
+    ChannelStats stats;
+    stats.channels_created = stats_.channels_created.get();
+    stats.channels_deleted = stats_.channels_deleted.get();
+    stats.containers_created = stats_.containers_created.get();
+    stats.containers_deleted = stats_.containers_deleted.get();
+    stats.puts_executed = stats_.puts_executed.get();
+    stats.gets_executed = stats_.gets_executed.get();
+    stats.bytes_written = stats_.bytes_written.get();
+    stats.bytes_read = stats_.bytes_read.get();
+    return stats;
 }
 
 void ChannelManager::reset_stats() {
-    stats_.channels_created = 0;
-    stats_.channels_deleted = 0;
-    stats_.containers_created = 0;
-    stats_.containers_deleted = 0;
-    stats_.puts_executed = 0;
-    stats_.gets_executed = 0;
-    stats_.bytes_written = 0;
-    stats_.bytes_read = 0;
+    stats_.channels_created.reset();
+    stats_.channels_deleted.reset();
+    stats_.containers_created.reset();
+    stats_.containers_deleted.reset();
+    stats_.puts_executed.reset();
+    stats_.gets_executed.reset();
+    stats_.bytes_written.reset();
+    stats_.bytes_read.reset();
 }
 
 // =============================================================================
@@ -8,6 +8,7 @@
 
 #include "cics/common/types.hpp"
 #include "cics/common/error.hpp"
+#include "cics/cics/monitoring.hpp"
 #include <functional>
 #include <any>
 
@@ -181,52 +182,69 @@ struct EIB {
 // COMMAREA (Communication Area)
 // =============================================================================
 
+// Storage is allocated once at full capacity, or borrowed from the caller
+// so a LINK hands its area down in place; only the length moves after that.
+// Filling the area never reallocates and passing it down a chain never copies.
 class Commarea {
 private:
-    ByteBuffer data_;
+    UniquePtr<Byte[]> owned_;
+    Byte* data_ = nullptr;        // owned_, or storage borrowed from the caller
+    Size length_ = 0;
     Size max_length_;
     
+    void ensure_storage();
+    
 public:
     static constexpr Size MAX_COMMAREA_LENGTH = 32767;
     
     Commarea() : max_length_(MAX_COMMAREA_LENGTH) {}
-    explicit Commarea(Size size) : data_(size), max_length_(MAX_COMMAREA_LENGTH) {}
-    explicit Commarea(ConstByteSpan data) 
-        : data_(data.begin(), data.end()), max_length_(MAX_COMMAREA_LENGTH) {}
+    explicit Commarea(Size size) : max_length_(MAX_COMMAREA_LENGTH) { resize(size); }
+    explicit Commarea(ConstByteSpan data) : max_length_(MAX_COMMAREA_LENGTH) { set_data(data); }
+    
+    // A view of storage owned elsewhere, such as the caller's area on a LINK;
+    // changes, including to the length, are made in that storage
+    Commarea(ByteSpan storage, Size length)
+        : data_(storage.data()), length_(std::min(length, storage.size())), max_length_(storage.size()) {}
+    
+    // Copies are deep and own their storage
+    Commarea(const Commarea& other);
+    Commarea& operator=(const Commarea& other);
+    Commarea(Commarea&& other) noexcept;
+    Commarea& operator=(Commarea&& other) noexcept;
     
     // Access
-    [[nodiscard]] Byte* data() { return data_.data(); }
-    [[nodiscard]] const Byte* data() const { return data_.data(); }
-    [[nodiscard]] Size length() const { return data_.size(); }
+    [[nodiscard]] Byte* data() { return data_; }
+    [[nodiscard]] const Byte* data() const { return data_; }
+    [[nodiscard]] Size length() const { return length_; }
     [[nodiscard]] Size capacity() const { return max_length_; }
-    [[nodiscard]] bool empty() const { return data_.empty(); }
+    [[nodiscard]] bool empty() const { return length_ == 0; }
+    [[nodiscard]] bool borrowed() const { return data_ != nullptr && !owned_; }
     
-    [[nodiscard]] ByteSpan span() { return data_; }
-    [[nodiscard]] ConstByteSpan span() const { return data_; }
+    [[nodiscard]] ByteSpan span() { return {data_, length_}; }
+    [[nodiscard]] ConstByteSpan span() const { return {data_, length_}; }
     
-    // Modify
+    // Modify; lengths are capped at the capacity
     void resize(Size new_size);
-    void clear() { data_.clear(); }
+    void clear() { length_ = 0; }
     void set_data(ConstByteSpan data);
     
     // String helpers
     void set_string(Size offset, StringView str, Size field_length);
     [[nodiscard]] String get_string(Size offset, Size length) const;
     
-    // Numeric helpers
+    // Numeric helpers; a value past the capacity is not stored
     template<Integral T>
     void set_value(Size offset, T value) {
-        if (offset + sizeof(T) > data_.size()) {
-            data_.resize(offset + sizeof(T));
-        }
-        std::memcpy(data_.data() + offset, &value, sizeof(T));
+        if (offset + sizeof(T) > max_length_) return;
+        if (offset + sizeof(T) > length_) resize(offset + sizeof(T));
+        std::memcpy(data_ + offset, &value, sizeof(T));
     }
     
     template<Integral T>
     [[nodiscard]] T get_value(Size offset) const {
         T value{};
-        if (offset + sizeof(T) <= data_.size()) {
-            std::memcpy(&value, data_.data() + offset, sizeof(T));
+        if (offset + sizeof(T) <= length_) {
+            std::memcpy(&value, data_ + offset, sizeof(T));
         }
         return value;
     }
@@ -351,13 +369,14 @@ private:
     FixedString<4> terminal_id_;
     TransactionStatus status_;
     EIB eib_;
-    Commarea commarea_;
+    Commarea commarea_;           // Full-length storage taken on first use
     ByteBuffer twa_;              // Transaction Work Area
     SystemTimePoint start_time_;
     String user_id_;
     Duration cpu_time_;
     UInt32 storage_used_;
     SharedPtr<void> context_;     // Application-specific context
+    TaskMonitor monitor_;         // Performance data for the monitoring record
     
 public:
     CicsTask(UInt32 task_num, StringView txn_id, StringView term_id = "");
@@ -377,6 +396,21 @@ public:
     [[nodiscard]] Duration elapsed_time() const { 
         return std::chrono::duration_cast<Duration>(SystemClock::now() - start_time_); 
     }
+    [[nodiscard]] TaskMonitor& monitor() { return monitor_; }
+    [[nodiscard]] const TaskMonitor& monitor() const { return monitor_; }
+    
+    // Runs a program as this task on the calling thread. The task stays
+    // bound to the thread, with its monitor collecting what it does, until
+    // the body returns or throws. It is then ended there - every facility
+    // releases its per-task state, so a pooled thread can run task after
+    // task - and its monitoring record is written.
+    using Body = std::function<Result<void>(CicsTask&)>;
+    Result<void> run(const Body& body);
+
+    // Close the task's performance record and hand it to the monitoring
+    // facility; false if monitoring is off or its buffer is full. run()
+    // calls this at task end.
+    bool write_monitoring_record();
     
     // Modifiers
     void set_status(TransactionStatus status) { status_ = status; }
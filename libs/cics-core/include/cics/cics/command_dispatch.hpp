@@ -0,0 +1,160 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - EXEC CICS Command Dispatch
+// Version: 3.4.6
+// =============================================================================
+//
+// Routes EXEC CICS commands to the manager that implements them. Each call
+// site owns a TranslatedCommand - the counterpart of the stub the CICS
+// translator generates - holding the command and its fixed options. On first
+// execution the stub validates those options, resolves the named resource
+// (file, program, queue, transaction) to a handle and looks up the handler;
+// later executions reuse all three and only pass the per-call data areas.
+//
+// Registering a handler, or any manager noting a resource change (install,
+// discard, open, close, enable, disable), bumps the dispatcher's generation;
+// each stub re-translates on its next execution. The shared dispatcher
+// starts with the region's own handlers and resolvers registered.
+//
+//   static TranslatedCommand read_cust(CicsCommand::READ, options);
+//   auto resp = read_cust.execute(task, {.ridfld = key, .into = &rec, .length = sizeof rec});
+// =============================================================================
+
+#include "cics/cics/cics_types.hpp"
+#include "cics/common/name_table.hpp"
+#include <shared_mutex>
+
+namespace cics::cics {
+
+enum class ResourceType : UInt8 {
+    NONE = 0,
+    FILE,
+    PROGRAM,
+    TS_QUEUE,
+    TD_QUEUE,
+    TRANSACTION
+};
+
+[[nodiscard]] ResourceType command_resource_type(CicsCommand cmd);
+
+// The option naming the command's resource, trimmed; empty if none
+[[nodiscard]] String command_resource_name(CicsCommand cmd, const CommandOptions& options);
+
+// Checks the options a command can be translated with: required resource
+// names, and flags that are meaningless or contradictory for the command
+[[nodiscard]] Result<void> validate_options(CicsCommand cmd, const CommandOptions& options);
+
+// The data areas of one execution; everything else is fixed at the call site
+struct CommandArgs {
+    ConstByteSpan ridfld;
+    void* into = nullptr;
+    const void* from = nullptr;
+    UInt32 length = 0;              // FROM length, or INTO capacity on input
+    UInt32 returned_length = 0;     // Set by the handler for INTO commands
+    UInt32 item = 0;                // TS ITEM: read on READQ (0 = first), set by READQ and WRITEQ
+};
+
+// What translation produced; immutable once published
+struct ResolvedCommand {
+    CicsCommand command{};
+    CommandOptions options;
+    SharedPtr<void> resource;       // From the resolver; null for ResourceType::NONE
+    FixedString<8> eibfn;
+    FixedString<8> eibrsrce;
+
+    template<typename T>
+    [[nodiscard]] T* resource_as() const { return static_cast<T*>(resource.get()); }
+};
+
+using CommandHandler = std::function<CicsResponse(CicsTask&, const ResolvedCommand&, CommandArgs&)>;
+using ResourceResolver = std::function<SharedPtr<void>(StringView name)>;
+
+struct DispatchStatistics {
+    AtomicCounter<> translations;
+    AtomicCounter<> translation_failures;
+
+    [[nodiscard]] String to_string() const;
+};
+
+class CommandDispatcher {
+public:
+    static CommandDispatcher& instance();
+
+    CommandDispatcher() = default;
+    CommandDispatcher(const CommandDispatcher&) = delete;
+    CommandDispatcher& operator=(const CommandDispatcher&) = delete;
+
+    void register_handler(CicsCommand cmd, CommandHandler handler);
+    void unregister_handler(CicsCommand cmd);
+
+    // Resolvers return null for an unknown name
+    void register_resolver(ResourceType type, ResourceResolver resolver);
+
+    // Resources this dispatcher's resolvers see have changed; managers
+    // report their own changes through note_resource_change()
+    void invalidate() { generation_.fetch_add(1, std::memory_order_release); }
+    [[nodiscard]] UInt64 generation() const {
+        return generation_.load(std::memory_order_acquire) + resource_generation();
+    }
+
+    // Resolve and validate a call site; the response on failure is the one
+    // CICS raises for it (FILENOTFOUND, PGMIDERR, QIDERR, INVREQ...)
+    [[nodiscard]] Result<SharedPtr<const ResolvedCommand>> translate(
+        CicsCommand cmd, const CommandOptions& options, CicsResponse& failure) const;
+    [[nodiscard]] SharedPtr<const CommandHandler> handler(CicsCommand cmd) const;
+
+    // Uncached dispatch, translating on every call
+    CicsResponse execute(CicsTask& task, CicsCommand cmd, const CommandOptions& options, CommandArgs& args);
+
+    [[nodiscard]] DispatchStatistics& statistics() { return stats_; }
+    [[nodiscard]] const DispatchStatistics& statistics() const { return stats_; }
+
+private:
+    std::unordered_map<CicsCommand, SharedPtr<const CommandHandler>> handlers_;
+    std::unordered_map<ResourceType, ResourceResolver> resolvers_;
+    mutable std::shared_mutex mutex_;
+    std::atomic<UInt64> generation_{1};
+    mutable DispatchStatistics stats_;
+};
+
+// Handlers and resolvers for the commands the region's managers implement:
+// READ, WRITE and DELETE on installed files; LINK, XCTL and RELEASE; TS and
+// TD queue commands; ENQ and DEQ on the RIDFLD bytes. instance() starts
+// with these registered.
+void register_standard_commands(CommandDispatcher& dispatcher);
+
+// One EXEC CICS call site
+class TranslatedCommand {
+public:
+    TranslatedCommand(CicsCommand cmd, CommandOptions options,
+                      CommandDispatcher& dispatcher = CommandDispatcher::instance());
+    TranslatedCommand(const TranslatedCommand&) = delete;
+    TranslatedCommand& operator=(const TranslatedCommand&) = delete;
+
+    CicsResponse execute(CicsTask& task, CommandArgs&& args = {}) { return execute(task, args); }
+    CicsResponse execute(CicsTask& task, CommandArgs& args);
+
+    [[nodiscard]] CicsCommand command() const { return command_; }
+    [[nodiscard]] bool translated() const;
+
+private:
+    struct Translation {
+        UInt64 generation = 0;
+        SharedPtr<const ResolvedCommand> resolved;
+        SharedPtr<const CommandHandler> handler;
+    };
+
+    SharedPtr<const Translation> retranslate(UInt64 generation, CicsResponse& failure);
+
+    CicsCommand command_;
+    CommandOptions options_;
+    CommandDispatcher& dispatcher_;
+
+    // Swapped whole on re-translation; an execute still holding the old
+    // translation keeps it alive until it returns
+    std::atomic<SharedPtr<const Translation>> current_;
+    std::mutex translate_mutex_;
+};
+
+} // namespace cics::cics
@@ -0,0 +1,47 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - File Control Table
+// Version: 3.4.6
+// =============================================================================
+//
+// Binds CICS file names to the VSAM files behind them; EXEC CICS file
+// commands find their file here.
+//
+//   auto& files = FileControl::instance();
+//   files.install("CUSTFILE", vsam::create_vsam_file(def, path));
+//   files.open("CUSTFILE");
+//
+// Installing, discarding, opening and closing a file are resource changes,
+// so translated call sites naming the file resolve it again.
+// =============================================================================
+
+#include "cics/cics/cics_types.hpp"
+#include "cics/vsam/vsam_types.hpp"
+#include <shared_mutex>
+
+namespace cics::cics {
+
+class FileControl {
+public:
+    static FileControl& instance();
+
+    FileControl() = default;
+    FileControl(const FileControl&) = delete;
+    FileControl& operator=(const FileControl&) = delete;
+
+    Result<void> install(StringView name, SharedPtr<vsam::IVsamFile> file);
+    Result<void> discard(StringView name);      // Closes the file if it is open
+    Result<void> open(StringView name, vsam::AccessMode mode = vsam::AccessMode::IO);
+    Result<void> close(StringView name);
+
+    // Null if no file of that name is installed
+    [[nodiscard]] SharedPtr<vsam::IVsamFile> file(StringView name) const;
+    [[nodiscard]] std::vector<String> list() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    StringMap<SharedPtr<vsam::IVsamFile>> files_;     // By trimmed name
+};
+
+} // namespace cics::cics
@@ -0,0 +1,240 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - Monitoring Facility
+// Version: 3.4.6
+// =============================================================================
+//
+// Per-task performance records in the style of the CICS Monitoring Facility.
+// Each task accumulates its dispatch and CPU time, suspend time by wait type,
+// GETMAIN activity and file/TS/TD request counts and bytes in a TaskMonitor.
+// When CicsTask::run ends the task the totals become one fixed-size
+// PerformanceRecord, which is encoded into a lock-free ring; a writer thread
+// drains the ring in batches to a sink - an SMF-like file from file_sink(),
+// or any callable, such as one that writes the batch to a journal.
+//
+// read_monitoring_file() and summarize_records() back the cics-cmf-report
+// tool, which ranks transactions by the resources they consume.
+// =============================================================================
+
+#include "cics/common/types.hpp"
+#include "cics/common/error.hpp"
+#include "cics/common/task_context.hpp"
+#include <array>
+#include <condition_variable>
+#include <thread>
+
+namespace cics::cics {
+
+// =============================================================================
+// Record Contents
+// =============================================================================
+
+// Defined with the task context so every facility can report them
+using ::cics::WaitType;
+using ::cics::RequestType;
+using ::cics::WAIT_TYPE_COUNT;
+using ::cics::REQUEST_TYPE_COUNT;
+
+[[nodiscard]] StringView wait_type_name(WaitType type);
+[[nodiscard]] StringView request_type_name(RequestType type);
+
+struct PerformanceRecord {
+    FixedString<4> transaction_id;
+    FixedString<4> terminal_id;
+    FixedString<8> user_id;
+    FixedString<8> program_name;
+    FixedString<4> abend_code;          // Blank unless the task abended
+    UInt32 task_number = 0;
+
+    Int64 start_us = 0;                 // Microseconds since the epoch
+    Int64 stop_us = 0;
+    Int64 dispatch_us = 0;              // Time spent dispatched
+    Int64 cpu_us = 0;                   // Thread CPU time while dispatched
+
+    std::array<Int64, WAIT_TYPE_COUNT> wait_us{};
+    std::array<UInt32, WAIT_TYPE_COUNT> wait_count{};
+
+    UInt32 getmain_count = 0;
+    UInt64 getmain_bytes = 0;
+    UInt64 storage_peak = 0;            // High-water mark of task storage
+
+    std::array<UInt32, REQUEST_TYPE_COUNT> request_count{};
+    std::array<UInt64, REQUEST_TYPE_COUNT> request_bytes{};
+
+    // Encoded layout: little-endian, fixed size, no padding
+    static constexpr UInt16 FORMAT_VERSION = 1;
+    static constexpr Size ENCODED_SIZE =
+        2 + 28 + 4 + 4 * 8 + WAIT_TYPE_COUNT * (8 + 4) + 4 + 8 + 8 + REQUEST_TYPE_COUNT * (4 + 8);
+
+    [[nodiscard]] Int64 response_us() const { return stop_us - start_us; }
+    [[nodiscard]] Int64 total_wait_us() const;
+    [[nodiscard]] UInt64 total_requests() const;
+    [[nodiscard]] bool abended() const { return !abend_code.empty(); }
+
+    void encode(Byte* out) const;
+    [[nodiscard]] static Result<PerformanceRecord> decode(ConstByteSpan in);
+};
+
+// =============================================================================
+// TaskMonitor - per-task accumulation
+// =============================================================================
+
+// Owned by one task and updated only from the thread running it. A task
+// run by CicsTask::run binds its monitor, so facilities feed it through
+// the note_* functions.
+class TaskMonitor : public TaskActivity {
+public:
+    TaskMonitor();
+
+    // Bracket each period the task runs on a thread
+    void dispatch_begin();
+    void dispatch_end();
+
+    void add_wait(WaitType type, Duration waited) override;
+    void add_request(RequestType type, UInt64 bytes = 0, UInt32 count = 1) override;
+    void add_getmain(UInt64 bytes) override;
+    void add_freemain(UInt64 bytes) override;
+    void set_program(StringView program) { record_.program_name = FixedString<8>(program); }
+    void set_abend_code(StringView code) { record_.abend_code = FixedString<4>(code); }
+
+    // Times a suspend from construction to destruction
+    class WaitScope {
+    public:
+        WaitScope(TaskMonitor& monitor, WaitType type) : monitor_(monitor), type_(type), start_(Clock::now()) {}
+        ~WaitScope() { monitor_.add_wait(type_, Clock::now() - start_); }
+        WaitScope(const WaitScope&) = delete;
+        WaitScope& operator=(const WaitScope&) = delete;
+    private:
+        TaskMonitor& monitor_;
+        WaitType type_;
+        TimePoint start_;
+    };
+    [[nodiscard]] WaitScope wait(WaitType type) { return WaitScope(*this, type); }
+
+    [[nodiscard]] const PerformanceRecord& record() const { return record_; }
+
+    // Close the record: ends any open dispatch and stamps the stop time
+    [[nodiscard]] const PerformanceRecord& finish();
+
+private:
+    PerformanceRecord record_;
+    TimePoint dispatched_at_{};
+    Int64 cpu_at_dispatch_ = 0;
+    bool dispatched_ = false;
+    UInt64 storage_current_ = 0;
+};
+
+// =============================================================================
+// Monitoring Facility
+// =============================================================================
+
+// Receives encoded records back to back, `count` of them per call
+using MonitoringSink = std::function<Result<void>(ConstByteSpan records, Size count)>;
+
+// An SMF-like data set: a header naming the format, then the records.
+// Appends to an existing file of the same format.
+[[nodiscard]] Result<MonitoringSink> file_sink(const Path& path);
+
+struct MonitoringConfig {
+    MonitoringSink sink;
+    Size ring_capacity = 4096;          // Records; rounded up to a power of two
+    Size batch_records = 256;           // Most records handed to the sink per call
+    Milliseconds flush_interval{1000};  // Longest a record sits in the ring
+};
+
+struct MonitoringStatistics {
+    AtomicCounter<> recorded;
+    AtomicCounter<> dropped;            // Ring full; the writer has fallen behind
+    AtomicCounter<> written;
+    AtomicCounter<> batches;
+    AtomicCounter<> sink_errors;
+
+    [[nodiscard]] String to_string() const;
+};
+
+class MonitoringFacility {
+public:
+    static MonitoringFacility& instance();
+
+    MonitoringFacility() = default;
+    ~MonitoringFacility();
+    MonitoringFacility(const MonitoringFacility&) = delete;
+    MonitoringFacility& operator=(const MonitoringFacility&) = delete;
+
+    Result<void> start(MonitoringConfig config);
+    void stop();                        // Drains the ring before returning
+    [[nodiscard]] bool active() const { return active_.load(std::memory_order_acquire); }
+
+    // Never blocks; false if monitoring is off or the ring is full
+    bool record(const PerformanceRecord& record);
+
+    // Wait until everything recorded so far has reached the sink
+    void flush();
+
+    [[nodiscard]] const MonitoringStatistics& statistics() const { return stats_; }
+
+private:
+    struct Slot {
+        std::atomic<UInt64> sequence{0};
+        std::array<Byte, PerformanceRecord::ENCODED_SIZE> data{};
+    };
+
+    void writer_loop();
+    Size drain(std::vector<Byte>& batch);
+
+    MonitoringConfig config_;
+    UniquePtr<Slot[]> slots_;
+    Size mask_ = 0;
+    alignas(64) std::atomic<UInt64> head_{0};   // Next slot to fill
+    alignas(64) UInt64 tail_ = 0;               // Next slot to drain; writer thread only
+    std::atomic<UInt64> drained_{0};            // tail_ as of the last completed batch
+    std::atomic<UInt32> producers_{0};          // Tasks inside record()
+
+    std::atomic<bool> active_{false};
+    std::mutex lifecycle_mutex_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable drained_cv_;
+    bool stopping_ = false;
+    bool flush_requested_ = false;
+    std::thread writer_;
+
+    MonitoringStatistics stats_;
+};
+
+// =============================================================================
+// Reporting
+// =============================================================================
+
+[[nodiscard]] Result<std::vector<PerformanceRecord>> read_monitoring_file(const Path& path);
+
+struct TransactionSummary {
+    String transaction_id;
+    UInt64 tasks = 0;
+    UInt64 abends = 0;
+    Int64 response_us = 0;              // Totals over all tasks
+    Int64 max_response_us = 0;
+    Int64 dispatch_us = 0;
+    Int64 cpu_us = 0;
+    std::array<Int64, WAIT_TYPE_COUNT> wait_us{};
+    UInt64 getmain_bytes = 0;
+    std::array<UInt64, REQUEST_TYPE_COUNT> request_count{};
+    std::array<UInt64, REQUEST_TYPE_COUNT> request_bytes{};
+
+    [[nodiscard]] Int64 total_wait_us() const;
+    [[nodiscard]] UInt64 total_requests() const;
+    [[nodiscard]] UInt64 total_request_bytes() const;
+};
+
+enum class ReportOrder : UInt8 { CPU, RESPONSE, DISPATCH, WAIT, STORAGE, REQUESTS, TASKS };
+
+[[nodiscard]] Optional<ReportOrder> parse_report_order(StringView name);
+
+// One summary per transaction id, heaviest first
+[[nodiscard]] std::vector<TransactionSummary> summarize_records(
+    const std::vector<PerformanceRecord>& records, ReportOrder order = ReportOrder::CPU);
+
+[[nodiscard]] String format_report(const std::vector<TransactionSummary>& summaries, Size limit = 0);
+
+} // namespace cics::cics
@@ -0,0 +1,137 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - Dynamic Transaction Routing
+// Version: 3.4.6
+// =============================================================================
+//
+// Chooses, per transaction attach, which of several regions runs it - a
+// stand-in for the CICSPlex SM workload manager. Each region is scored on
+// its live load (active and queued tasks against MAXTASK) and its recent
+// average response time, and the attach goes to the region with the best
+// expected response. Regions already at MAXTASK are used only when every
+// region is.
+//
+// Pseudo-conversations that keep state in TS can name an affinity key (the
+// terminal id, say); every attach with that key goes to the region the
+// first one was routed to until the affinity is ended or times out.
+// =============================================================================
+
+#include "cics/cics/cics_types.hpp"
+#include <shared_mutex>
+
+namespace cics::cics {
+
+// A region's load as its probe reports it
+struct RegionLoad {
+    UInt32 active_tasks = 0;
+    UInt32 queued_tasks = 0;        // Waiting for a MAXTASK slot
+    UInt32 max_tasks = 0;           // 0 = no limit
+    UInt64 completed = 0;           // Running totals, used to derive the
+    Int64 total_response_ms = 0;    // response time since the last sample
+    bool available = true;
+};
+
+using LoadProbe = std::function<RegionLoad()>;
+
+// Probe a region in this process through its CicsStatistics; its queued
+// tasks are the attaches held at this process's admission gate
+[[nodiscard]] LoadProbe statistics_probe(const CicsStatistics& stats, UInt32 max_tasks);
+
+struct TransactionRouterConfig {
+    Milliseconds sample_interval{100};          // Minimum time between probes of one region
+    double response_smoothing = 0.3;            // Weight of the newest interval's average
+    Duration affinity_timeout = std::chrono::minutes(30);
+};
+
+struct RouteDecision {
+    String sysid;
+    bool affinity = false;          // Forced by an existing affinity
+};
+
+struct RegionStatus {
+    String sysid;
+    UInt32 estimated_tasks = 0;     // Last sample plus routed-but-unfinished since
+    UInt32 max_tasks = 0;
+    double response_ms = 0.0;       // Smoothed
+    bool available = true;
+    UInt64 routed = 0;
+};
+
+struct RouterStatistics {
+    AtomicCounter<> routed;
+    AtomicCounter<> affinity_routed;
+    AtomicCounter<> at_maxtask;     // Routed to a region with no MAXTASK headroom
+    AtomicCounter<> rejected;
+    AtomicCounter<> probes;
+
+    [[nodiscard]] String to_string() const;
+};
+
+class TransactionRouter {
+public:
+    explicit TransactionRouter(TransactionRouterConfig config = {});
+    TransactionRouter(const TransactionRouter&) = delete;
+    TransactionRouter& operator=(const TransactionRouter&) = delete;
+
+    Result<void> add_region(StringView sysid, LoadProbe probe);
+    Result<void> remove_region(StringView sysid);
+
+    // Pick the region for one attach; SYSIDERR if none can take it
+    Result<RouteDecision> route(StringView transid, StringView affinity_key = {});
+
+    // The routed task has finished
+    void complete(const RouteDecision& decision);
+
+    // The pseudo-conversation is over; its next attach routes freely
+    void end_affinity(StringView affinity_key);
+
+    [[nodiscard]] Size affinity_count() const;
+    [[nodiscard]] std::vector<RegionStatus> regions() const;
+    [[nodiscard]] const RouterStatistics& statistics() const { return stats_; }
+
+private:
+    struct Region {
+        String sysid;
+        LoadProbe probe;
+
+        std::mutex sample_mutex;
+        TimePoint sampled_at{};
+        UInt64 last_completed = 0;
+        Int64 last_response_ms = 0;
+        bool sampled = false;
+
+        // Read on every route without the sample mutex
+        std::atomic<UInt32> sampled_tasks{0};
+        std::atomic<UInt32> max_tasks{0};
+        std::atomic<double> response_ms{0.0};
+        std::atomic<bool> available{true};
+        std::atomic<Int64> since_sample{0};     // Routed minus completed since the sample
+        AtomicCounter<> routed;
+
+        [[nodiscard]] UInt32 estimated_tasks() const;
+    };
+
+    struct Affinity {
+        String sysid;
+        TimePoint last_used;
+    };
+
+    void sample(Region& region, TimePoint now);
+    [[nodiscard]] Region* find_region(StringView sysid) const;
+    void prune_affinities(TimePoint now);
+
+    TransactionRouterConfig config_;
+
+    std::vector<UniquePtr<Region>> regions_;
+    mutable std::shared_mutex regions_mutex_;
+    std::atomic<UInt64> rotor_{0};      // Spreads ties between equally loaded regions
+
+    std::unordered_map<String, Affinity> affinities_;
+    mutable std::mutex affinity_mutex_;
+    TimePoint last_prune_{};
+
+    RouterStatistics stats_;
+};
+
+} // namespace cics::cics
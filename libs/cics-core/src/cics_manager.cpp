@@ -1,4 +1,6 @@
 #include "cics/cics/cics_types.hpp"
+#include "cics/common/task_context.hpp"
+#include <utility>
 
 namespace cics::cics {
 
@@ -33,27 +35,62 @@ String EIB::response_name() const {
     return String(::cics::cics::response_name(eibresp));
 }
 
+void Commarea::ensure_storage() {
+    if (data_ != nullptr) return;
+    owned_ = std::make_unique_for_overwrite<Byte[]>(max_length_);
+    data_ = owned_.get();
+}
+
+Commarea::Commarea(const Commarea& other) : max_length_(other.max_length_) {
+    set_data(other.span());
+}
+
+Commarea& Commarea::operator=(const Commarea& other) {
+    // Into this area's own storage, which may be the caller's
+    if (this != &other) set_data(other.span());
+    return *this;
+}
+
+Commarea::Commarea(Commarea&& other) noexcept
+    : owned_(std::move(other.owned_)), data_(std::exchange(other.data_, nullptr))
+    , length_(std::exchange(other.length_, 0)), max_length_(other.max_length_) {}
+
+Commarea& Commarea::operator=(Commarea&& other) noexcept {
+    if (this == &other) return *this;
+    owned_ = std::move(other.owned_);
+    data_ = std::exchange(other.data_, nullptr);
+    length_ = std::exchange(other.length_, 0);
+    max_length_ = other.max_length_;
+    return *this;
+}
+
 void Commarea::resize(Size new_size) {
-    if (new_size > MAX_COMMAREA_LENGTH) new_size = MAX_COMMAREA_LENGTH;
-    data_.resize(new_size);
+    new_size = std::min(new_size, max_length_);
+    ensure_storage();
+    if (new_size > length_) std::memset(data_ + length_, 0, new_size - length_);
+    length_ = new_size;
 }
 
 void Commarea::set_data(ConstByteSpan data) {
-    Size len = std::min(data.size(), max_length_);
-    data_.assign(data.begin(), data.begin() + len);
+    const Size len = std::min(data.size(), max_length_);
+    ensure_storage();
+    if (len > 0) std::memmove(data_, data.data(), len);
+    length_ = len;
 }
 
 void Commarea::set_string(Size offset, StringView str, Size field_length) {
-    if (offset + field_length > data_.size()) data_.resize(offset + field_length);
+    if (offset >= max_length_) return;
+    field_length = std::min(field_length, max_length_ - offset);
+    if (offset + field_length > length_) resize(offset + field_length);
     Size copy_len = std::min(str.size(), field_length);
-    std::copy_n(str.begin(), copy_len, reinterpret_cast<char*>(data_.data() + offset));
-    std::fill_n(reinterpret_cast<char*>(data_.data() + offset + copy_len), field_length - copy_len, ' ');
+    std::copy_n(str.begin(), copy_len, reinterpret_cast<char*>(data_ + offset));
+    std::fill_n(reinterpret_cast<char*>(data_ + offset + copy_len), field_length - copy_len, ' ');
 }
 
 String Commarea::get_string(Size offset, Size length) const {
-    if (offset >= data_.size()) return "";
-    length = std::min(length, data_.size() - offset);
-    return String(reinterpret_cast<const char*>(data_.data() + offset), length);
+    if (offset >= length_) return "";
+    length = std::min(length, length_ - offset);
+    return String(reinterpret_cast<const char*>(data_ + offset), length);
 }
 
 TransactionDefinition::TransactionDefinition(StringView txn_id, StringView pgm_name)
@@ -74,6 +111,40 @@ CicsTask::CicsTask(UInt32 task_num, StringView txn_id, StringView term_id)
     eib_.set_time_date();
 }
 
+Result<void> CicsTask::run(const Body& body) {
+    TaskBinding binding(task_number_, &monitor_);
+    status_ = TransactionStatus::RUNNING;
+    monitor_.dispatch_begin();
+    auto end = [&] {
+        binding.end();
+        (void)write_monitoring_record();
+    };
+    try {
+        auto result = body(*this);
+        status_ = TransactionStatus::COMPLETED;
+        end();
+        return result;
+    } catch (...) {
+        status_ = TransactionStatus::ABENDED;
+        end();
+        throw;
+    }
+}
+
+bool CicsTask::write_monitoring_record() {
+    auto& facility = MonitoringFacility::instance();
+    if (!facility.active()) return false;
+    PerformanceRecord record = monitor_.finish();
+    record.transaction_id = transaction_id_;
+    record.terminal_id = terminal_id_;
+    record.user_id = FixedString<8>(user_id_);
+    record.task_number = task_number_;
+    if (status_ == TransactionStatus::ABENDED && record.abend_code.empty()) {
+        record.abend_code = FixedString<4>("????");
+    }
+    return facility.record(record);
+}
+
 void CicsStatistics::record_transaction(Duration response_time, bool success, bool abend) {
     total_transactions++;
     if (success) successful_transactions++;
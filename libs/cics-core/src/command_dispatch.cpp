@@ -0,0 +1,256 @@
+#include "cics/cics/command_dispatch.hpp"
+
+namespace cics::cics {
+// EXEC CICS command translation and dispatch
+
+namespace {
+
+bool is_file_command(CicsCommand cmd) {
+    return static_cast<UInt16>(cmd) <= static_cast<UInt16>(CicsCommand::UNLOCK);
+}
+
+CicsResponse not_found_response(ResourceType type) {
+    switch (type) {
+        case ResourceType::FILE: return CicsResponse::FILENOTFOUND;
+        case ResourceType::PROGRAM: return CicsResponse::PGMIDERR;
+        case ResourceType::TS_QUEUE:
+        case ResourceType::TD_QUEUE: return CicsResponse::QIDERR;
+        case ResourceType::TRANSACTION: return CicsResponse::TRANSIDERR;
+        case ResourceType::NONE: break;
+    }
+    return CicsResponse::INVREQ;
+}
+
+} // namespace
+
+ResourceType command_resource_type(CicsCommand cmd) {
+    if (is_file_command(cmd)) return ResourceType::FILE;
+    switch (cmd) {
+        case CicsCommand::LINK:
+        case CicsCommand::XCTL:
+        case CicsCommand::LOAD:
+        case CicsCommand::RELEASE:
+            return ResourceType::PROGRAM;
+        case CicsCommand::WRITEQ_TS:
+        case CicsCommand::READQ_TS:
+        case CicsCommand::DELETEQ_TS:
+            return ResourceType::TS_QUEUE;
+        case CicsCommand::WRITEQ_TD:
+        case CicsCommand::READQ_TD:
+        case CicsCommand::DELETEQ_TD:
+            return ResourceType::TD_QUEUE;
+        case CicsCommand::START:
+            return ResourceType::TRANSACTION;
+        default:
+            return ResourceType::NONE;
+    }
+}
+
+String command_resource_name(CicsCommand cmd, const CommandOptions& options) {
+    switch (command_resource_type(cmd)) {
+        case ResourceType::FILE:
+            if (options.file) return options.file->trimmed();
+            if (options.dataset) return options.dataset->trimmed();
+            break;
+        case ResourceType::PROGRAM:
+            if (options.program) return options.program->trimmed();
+            break;
+        case ResourceType::TS_QUEUE:
+        case ResourceType::TD_QUEUE:
+            if (options.queue) return options.queue->trimmed();
+            break;
+        case ResourceType::TRANSACTION:
+            if (options.transid) return options.transid->trimmed();
+            break;
+        case ResourceType::NONE:
+            break;
+    }
+    return {};
+}
+
+Result<void> validate_options(CicsCommand cmd, const CommandOptions& options) {
+    auto invalid = [cmd](StringView why) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, std::format("{}: {}", command_name(cmd), why));
+    };
+
+    const ResourceType type = command_resource_type(cmd);
+    if (type != ResourceType::NONE && command_resource_name(cmd, options).empty()) {
+        return invalid("the resource name option is required");
+    }
+
+    if (is_file_command(cmd)) {
+        if (options.rba && options.rrn) return invalid("RBA and RRN are mutually exclusive");
+        if (options.gteq && options.equal) return invalid("GTEQ and EQUAL are mutually exclusive");
+        if (options.generic && (options.rba || options.rrn)) return invalid("GENERIC needs a key");
+        if (options.generic && options.keylength == 0) return invalid("GENERIC needs KEYLENGTH");
+        if (options.update && cmd != CicsCommand::READ && cmd != CicsCommand::READNEXT &&
+            cmd != CicsCommand::READPREV) {
+            return invalid("UPDATE is only valid on READ, READNEXT and READPREV");
+        }
+    }
+    if (options.set && options.into_data) return invalid("SET and INTO are mutually exclusive");
+    if (options.interval && options.time) return invalid("INTERVAL and TIME are mutually exclusive");
+    return make_success();
+}
+
+// =============================================================================
+// CommandDispatcher
+// =============================================================================
+
+String DispatchStatistics::to_string() const {
+    return std::format("Translations: {}, Failures: {}", translations.get(), translation_failures.get());
+}
+
+CommandDispatcher& CommandDispatcher::instance() {
+    static CommandDispatcher dispatcher;
+    static const bool registered = (register_standard_commands(dispatcher), true);
+    (void)registered;
+    return dispatcher;
+}
+
+void CommandDispatcher::register_handler(CicsCommand cmd, CommandHandler handler) {
+    {
+        std::unique_lock lock(mutex_);
+        handlers_.insert_or_assign(cmd, std::make_shared<const CommandHandler>(std::move(handler)));
+    }
+    invalidate();
+}
+
+void CommandDispatcher::unregister_handler(CicsCommand cmd) {
+    {
+        std::unique_lock lock(mutex_);
+        handlers_.erase(cmd);
+    }
+    invalidate();
+}
+
+void CommandDispatcher::register_resolver(ResourceType type, ResourceResolver resolver) {
+    {
+        std::unique_lock lock(mutex_);
+        resolvers_.insert_or_assign(type, std::move(resolver));
+    }
+    invalidate();
+}
+
+SharedPtr<const CommandHandler> CommandDispatcher::handler(CicsCommand cmd) const {
+    std::shared_lock lock(mutex_);
+    auto it = handlers_.find(cmd);
+    return it != handlers_.end() ? it->second : nullptr;
+}
+
+Result<SharedPtr<const ResolvedCommand>> CommandDispatcher::translate(
+    CicsCommand cmd, const CommandOptions& options, CicsResponse& failure) const {
+    using ResultType = SharedPtr<const ResolvedCommand>;
+    ++stats_.translations;
+
+    if (auto valid = validate_options(cmd, options); !valid) {
+        ++stats_.translation_failures;
+        failure = CicsResponse::INVREQ;
+        return make_error<ResultType>(valid.error());
+    }
+
+    auto resolved = std::make_shared<ResolvedCommand>();
+    resolved->command = cmd;
+    resolved->options = options;
+    resolved->eibfn = FixedString<8>(command_name(cmd));
+
+    const ResourceType type = command_resource_type(cmd);
+    if (type != ResourceType::NONE) {
+        const String name = command_resource_name(cmd, options);
+        resolved->eibrsrce = FixedString<8>(name);
+
+        // Resolvers run unlocked; they may consult managers that invalidate
+        ResourceResolver resolver;
+        {
+            std::shared_lock lock(mutex_);
+            auto it = resolvers_.find(type);
+            if (it != resolvers_.end()) resolver = it->second;
+        }
+        if (resolver) resolved->resource = resolver(name);
+        if (!resolved->resource) {
+            ++stats_.translation_failures;
+            failure = not_found_response(type);
+            return make_error<ResultType>(ErrorCode::NOTFND,
+                std::format("{}: resource {} is not defined", command_name(cmd), name));
+        }
+    }
+    return make_success<ResultType>(std::move(resolved));
+}
+
+CicsResponse CommandDispatcher::execute(CicsTask& task, CicsCommand cmd, const CommandOptions& options,
+                                        CommandArgs& args) {
+    CicsResponse response = CicsResponse::NORMAL;
+    auto resolved = translate(cmd, options, response);
+    auto target = handler(cmd);
+    EIB& eib = task.eib();
+    if (resolved && target) {
+        eib.eibfn = (*resolved)->eibfn;
+        eib.eibrsrce = (*resolved)->eibrsrce;
+        response = (*target)(task, **resolved, args);
+    } else if (resolved) {
+        response = CicsResponse::INVREQ;
+    }
+    eib.eibresp = response;
+    return response;
+}
+
+// =============================================================================
+// TranslatedCommand
+// =============================================================================
+
+TranslatedCommand::TranslatedCommand(CicsCommand cmd, CommandOptions options, CommandDispatcher& dispatcher)
+    : command_(cmd), options_(std::move(options)), dispatcher_(dispatcher) {}
+
+bool TranslatedCommand::translated() const {
+    const auto current = current_.load(std::memory_order_acquire);
+    return current != nullptr && current->generation == dispatcher_.generation();
+}
+
+SharedPtr<const TranslatedCommand::Translation> TranslatedCommand::retranslate(UInt64 generation,
+                                                                              CicsResponse& failure) {
+    std::lock_guard lock(translate_mutex_);
+    auto current = current_.load(std::memory_order_acquire);
+    if (current != nullptr && current->generation >= generation) return current;
+
+    // Failures are not cached; the resource may be installed before the next call
+    auto resolved = dispatcher_.translate(command_, options_, failure);
+    if (!resolved) return nullptr;
+    auto target = dispatcher_.handler(command_);
+    if (!target) {
+        failure = CicsResponse::INVREQ;
+        return nullptr;
+    }
+
+    auto translation = std::make_shared<Translation>();
+    translation->generation = generation;
+    translation->resolved = std::move(*resolved);
+    translation->handler = std::move(target);
+    current_.store(translation, std::memory_order_release);
+    return translation;
+}
+
+CicsResponse TranslatedCommand::execute(CicsTask& task, CommandArgs& args) {
+    // Sample the generation first: an invalidation during translation then
+    // leaves the new translation already stale, never wrongly current
+    const UInt64 generation = dispatcher_.generation();
+    auto current = current_.load(std::memory_order_acquire);
+    EIB& eib = task.eib();
+    if (current == nullptr || current->generation != generation) {
+        CicsResponse failure = CicsResponse::INVREQ;
+        current = retranslate(generation, failure);
+        if (current == nullptr) {
+            eib.eibfn = FixedString<8>(command_name(command_));
+            eib.eibresp = failure;
+            return failure;
+        }
+    }
+
+    const ResolvedCommand& resolved = *current->resolved;
+    eib.eibfn = resolved.eibfn;
+    eib.eibrsrce = resolved.eibrsrce;
+    const CicsResponse response = (*current->handler)(task, resolved, args);
+    eib.eibresp = response;
+    return response;
+}
+
+} // namespace cics::cics
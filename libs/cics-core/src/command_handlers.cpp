@@ -0,0 +1,256 @@
+#include "cics/cics/command_dispatch.hpp"
+#include "cics/cics/file_control.hpp"
+#include "cics/program/program_control.hpp"
+#include "cics/tsq/tsq_types.hpp"
+#include "cics/tdq/tdq_types.hpp"
+#include "cics/task/task_control.hpp"
+#include <cstring>
+
+namespace cics::cics {
+// The region's EXEC CICS command handlers and resource resolvers
+
+namespace {
+
+// A program or queue resolved to its interned name; the manager indexes
+// the id, so the handle never goes stale
+struct NamedResource {
+    NameId id = NameId::NONE;
+    String name;
+};
+
+SharedPtr<void> named(StringView name) {
+    auto resource = std::make_shared<NamedResource>();
+    resource->id = NameTable::instance().intern(name);
+    resource->name = String(name);
+    return resource;
+}
+
+CicsResponse response_for(const ErrorInfo& error) {
+    switch (error.code) {
+        case ErrorCode::RECORD_NOT_FOUND:
+        case ErrorCode::VSAM_RECORD_NOT_FOUND:
+        case ErrorCode::NOTFND:
+            return CicsResponse::NOTFND;
+        case ErrorCode::DUPLICATE_KEY:
+        case ErrorCode::VSAM_DUPLICATE_KEY:
+            return CicsResponse::DUPREC;
+        case ErrorCode::VSAM_FILE_NOT_OPEN:
+            return CicsResponse::NOTOPEN;
+        case ErrorCode::VSAM_END_OF_FILE:
+        case ErrorCode::ENDFILE:
+            return CicsResponse::ENDFILE;
+        case ErrorCode::VSAM_CI_FULL:
+        case ErrorCode::DISK_FULL:
+        case ErrorCode::RESOURCE_EXHAUSTED:
+            return CicsResponse::NOSPACE;
+        case ErrorCode::LENGERR:
+            return CicsResponse::LENGERR;
+        case ErrorCode::CICS_QUEUE_NOT_FOUND:
+        case ErrorCode::QIDERR:
+            return CicsResponse::QIDERR;
+        case ErrorCode::ITEMERR:
+            return CicsResponse::ITEMERR;
+        case ErrorCode::CICS_PROGRAM_NOT_FOUND:
+            return CicsResponse::PGMIDERR;
+        case ErrorCode::IO_ERROR:
+        case ErrorCode::READ_ERROR:
+        case ErrorCode::WRITE_ERROR:
+        case ErrorCode::IOERR:
+            return CicsResponse::IOERR;
+        default:
+            return CicsResponse::INVREQ;
+    }
+}
+
+ConstByteSpan from_area(const CommandArgs& args) {
+    if (args.from == nullptr) return {};
+    return ConstByteSpan(static_cast<const Byte*>(args.from), args.length);
+}
+
+// INTO: as much as fits, the full length in returned_length
+CicsResponse copy_into(CommandArgs& args, ConstByteSpan data) {
+    const Size copied = args.into != nullptr ? std::min<Size>(data.size(), args.length) : 0;
+    if (copied > 0) std::memcpy(args.into, data.data(), copied);
+    args.returned_length = static_cast<UInt32>(data.size());
+    return copied < data.size() ? CicsResponse::LENGERR : CicsResponse::NORMAL;
+}
+
+StringView enq_resource(const CommandArgs& args) {
+    return StringView(reinterpret_cast<const char*>(args.ridfld.data()), args.ridfld.size());
+}
+
+// =============================================================================
+// File Control
+// =============================================================================
+
+void register_file_commands(CommandDispatcher& dispatcher) {
+    dispatcher.register_resolver(ResourceType::FILE, [](StringView name) -> SharedPtr<void> {
+        return FileControl::instance().file(name);
+    });
+
+    dispatcher.register_handler(CicsCommand::READ, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+        // READ UPDATE returns a token for REWRITE or DELETE, which the
+        // file's own interface carries; a call site has nowhere to keep it
+        if (cmd.options.update) return CicsResponse::INVREQ;
+        auto record = cmd.resource_as<vsam::IVsamFile>()->read(vsam::VsamKey(args.ridfld));
+        if (!record) return response_for(record.error());
+        return copy_into(args, record.value().span());
+    });
+    dispatcher.register_handler(CicsCommand::WRITE, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+        auto result = cmd.resource_as<vsam::IVsamFile>()->write(
+            vsam::VsamRecord(vsam::VsamKey(args.ridfld), from_area(args)));
+        return result ? CicsResponse::NORMAL : response_for(result.error());
+    });
+    dispatcher.register_handler(CicsCommand::DELETE_, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+        auto result = cmd.resource_as<vsam::IVsamFile>()->erase(vsam::VsamKey(args.ridfld));
+        return result ? CicsResponse::NORMAL : response_for(result.error());
+    });
+}
+
+// =============================================================================
+// Program Control
+// =============================================================================
+
+void register_program_commands(CommandDispatcher& dispatcher) {
+    dispatcher.register_resolver(ResourceType::PROGRAM, [](StringView name) -> SharedPtr<void> {
+        if (!program::ProgramControlManager::instance().program_exists(name)) return nullptr;
+        return named(name);
+    });
+
+    // A program that is defined but disabled, or fails to load, is PGMIDERR
+    auto program_response = [](const ErrorInfo& error) {
+        if (error.code == ErrorCode::RECORD_NOT_FOUND || error.code == ErrorCode::INVALID_STATE ||
+            error.code == ErrorCode::CICS_PROGRAM_NOT_FOUND) {
+            return CicsResponse::PGMIDERR;
+        }
+        return response_for(error);
+    };
+
+    // LINK and XCTL pass INTO as the COMMAREA
+    dispatcher.register_handler(CicsCommand::LINK,
+        [program_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+            const auto& program = *cmd.resource_as<NamedResource>();
+            UInt32 length = args.length;
+            ByteSpan commarea(static_cast<Byte*>(args.into), args.into != nullptr ? args.length : 0);
+            auto result = program::ProgramControlManager::instance().link(program.id, commarea, length);
+            if (!result) return program_response(result.error());
+            args.returned_length = length;
+            return CicsResponse::NORMAL;
+        });
+    dispatcher.register_handler(CicsCommand::XCTL,
+        [program_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+            const auto& program = *cmd.resource_as<NamedResource>();
+            auto result = program::ProgramControlManager::instance().xctl(program.name, args.into, args.length);
+            return result ? CicsResponse::NORMAL : program_response(result.error());
+        });
+    dispatcher.register_handler(CicsCommand::RELEASE,
+        [program_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs&) {
+            const auto& program = *cmd.resource_as<NamedResource>();
+            auto result = program::ProgramControlManager::instance().release(program.name);
+            return result ? CicsResponse::NORMAL : program_response(result.error());
+        });
+}
+
+// =============================================================================
+// Temporary Storage
+// =============================================================================
+
+void register_ts_commands(CommandDispatcher& dispatcher) {
+    // WRITEQ TS creates the queue, so every name resolves
+    dispatcher.register_resolver(ResourceType::TS_QUEUE, [](StringView name) { return named(name); });
+
+    dispatcher.register_handler(CicsCommand::WRITEQ_TS, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+        const auto& queue = *cmd.resource_as<NamedResource>();
+        auto item = tsq::TSQManager::instance().writeq(queue.id, from_area(args));
+        if (!item) return response_for(item.error());
+        args.item = item.value();
+        return CicsResponse::NORMAL;
+    });
+    dispatcher.register_handler(CicsCommand::READQ_TS, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+        const auto& queue = *cmd.resource_as<NamedResource>();
+        const UInt32 wanted = args.item > 0 ? args.item : 1;
+        auto item = tsq::TSQManager::instance().readq(queue.id, wanted);
+        if (!item) {
+            const ErrorCode code = item.error().code;
+            if (code == ErrorCode::RECORD_NOT_FOUND || code == ErrorCode::VSAM_END_OF_FILE) {
+                return CicsResponse::ITEMERR;
+            }
+            if (code == ErrorCode::INVALID_STATE) return CicsResponse::QIDERR;
+            return response_for(item.error());
+        }
+        args.item = wanted;
+        return copy_into(args, item.value().span());
+    });
+    dispatcher.register_handler(CicsCommand::DELETEQ_TS, [](CicsTask&, const ResolvedCommand& cmd, CommandArgs&) {
+        const auto& queue = *cmd.resource_as<NamedResource>();
+        auto result = tsq::TSQManager::instance().deleteq(queue.id);
+        return result ? CicsResponse::NORMAL : response_for(result.error());
+    });
+}
+
+// =============================================================================
+// Transient Data
+// =============================================================================
+
+void register_td_commands(CommandDispatcher& dispatcher) {
+    dispatcher.register_resolver(ResourceType::TD_QUEUE, [](StringView name) -> SharedPtr<void> {
+        if (!tdq::TDQManager::instance().destination_exists(name)) return nullptr;
+        return named(name);
+    });
+
+    auto td_response = [](const ErrorInfo& error) {
+        if (error.code == ErrorCode::VSAM_END_OF_FILE) return CicsResponse::QZERO;
+        if (error.code == ErrorCode::INVALID_STATE) return CicsResponse::DISABLED;
+        return response_for(error);
+    };
+
+    dispatcher.register_handler(CicsCommand::WRITEQ_TD,
+        [td_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+            const auto& queue = *cmd.resource_as<NamedResource>();
+            auto result = tdq::TDQManager::instance().writeq(queue.id, from_area(args));
+            return result ? CicsResponse::NORMAL : td_response(result.error());
+        });
+    dispatcher.register_handler(CicsCommand::READQ_TD,
+        [td_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs& args) {
+            const auto& queue = *cmd.resource_as<NamedResource>();
+            auto record = tdq::TDQManager::instance().readq(queue.id);
+            if (!record) return td_response(record.error());
+            return copy_into(args, record.value().span());
+        });
+    dispatcher.register_handler(CicsCommand::DELETEQ_TD,
+        [td_response](CicsTask&, const ResolvedCommand& cmd, CommandArgs&) {
+            const auto& queue = *cmd.resource_as<NamedResource>();
+            auto result = tdq::TDQManager::instance().deleteq(queue.name);
+            return result ? CicsResponse::NORMAL : td_response(result.error());
+        });
+}
+
+// =============================================================================
+// Task Control
+// =============================================================================
+
+void register_task_commands(CommandDispatcher& dispatcher) {
+    // The resource is the RIDFLD bytes, which differ from call to call
+    dispatcher.register_handler(CicsCommand::ENQ, [](CicsTask&, const ResolvedCommand&, CommandArgs& args) {
+        if (args.ridfld.empty()) return CicsResponse::INVREQ;
+        auto result = task::TaskControlManager::instance().enq(enq_resource(args));
+        return result ? CicsResponse::NORMAL : response_for(result.error());
+    });
+    dispatcher.register_handler(CicsCommand::DEQ, [](CicsTask&, const ResolvedCommand&, CommandArgs& args) {
+        if (args.ridfld.empty()) return CicsResponse::INVREQ;
+        auto result = task::TaskControlManager::instance().deq(enq_resource(args));
+        return result ? CicsResponse::NORMAL : response_for(result.error());
+    });
+}
+
+} // namespace
+
+void register_standard_commands(CommandDispatcher& dispatcher) {
+    register_file_commands(dispatcher);
+    register_program_commands(dispatcher);
+    register_ts_commands(dispatcher);
+    register_td_commands(dispatcher);
+    register_task_commands(dispatcher);
+}
+
+} // namespace cics::cics
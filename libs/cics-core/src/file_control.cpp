@@ -1,4 +1,83 @@
-#include "cics/cics/cics_types.hpp"
+#include "cics/cics/file_control.hpp"
+#include "cics/common/name_table.hpp"
+
 namespace cics::cics {
-// CICS file control commands
+// CICS file control table
+
+namespace {
+
+StringView trimmed(StringView name) {
+    while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+    return name;
+}
+
+} // namespace
+
+FileControl& FileControl::instance() {
+    static FileControl files;
+    return files;
+}
+
+Result<void> FileControl::install(StringView name, SharedPtr<vsam::IVsamFile> file) {
+    name = trimmed(name);
+    if (name.empty() || name.size() > 8 || !file) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "A file needs a name of 1-8 characters and a data set");
+    }
+    {
+        std::unique_lock lock(mutex_);
+        if (!files_.try_emplace(String(name), std::move(file)).second) {
+            return make_error<void>(ErrorCode::FILE_EXISTS, std::format("File {} already installed", name));
+        }
+    }
+    note_resource_change();
+    return make_success();
+}
+
+Result<void> FileControl::discard(StringView name) {
+    SharedPtr<vsam::IVsamFile> file;
+    {
+        std::unique_lock lock(mutex_);
+        auto it = files_.find(trimmed(name));
+        if (it == files_.end()) {
+            return make_error<void>(ErrorCode::CICS_FILE_NOT_FOUND, std::format("File {} not installed", name));
+        }
+        file = std::move(it->second);
+        files_.erase(it);
+    }
+    note_resource_change();
+    // Commands already holding the file finish against it
+    if (file->is_open()) return file->close();
+    return make_success();
+}
+
+Result<void> FileControl::open(StringView name, vsam::AccessMode mode) {
+    auto target = file(name);
+    if (!target) return make_error<void>(ErrorCode::CICS_FILE_NOT_FOUND, std::format("File {} not installed", name));
+    auto result = target->open(mode);
+    if (result) note_resource_change();
+    return result;
+}
+
+Result<void> FileControl::close(StringView name) {
+    auto target = file(name);
+    if (!target) return make_error<void>(ErrorCode::CICS_FILE_NOT_FOUND, std::format("File {} not installed", name));
+    auto result = target->close();
+    if (result) note_resource_change();
+    return result;
+}
+
+SharedPtr<vsam::IVsamFile> FileControl::file(StringView name) const {
+    std::shared_lock lock(mutex_);
+    auto it = files_.find(trimmed(name));
+    return it != files_.end() ? it->second : nullptr;
+}
+
+std::vector<String> FileControl::list() const {
+    std::shared_lock lock(mutex_);
+    std::vector<String> names;
+    names.reserve(files_.size());
+    for (const auto& [name, file] : files_) names.push_back(name);
+    return names;
+}
+
 } // namespace cics::cics
@@ -0,0 +1,581 @@
+#include "cics/cics/monitoring.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+namespace cics::cics {
+// CICS Monitoring Facility style performance records
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = {'C', 'M', 'F', 'R'};
+constexpr Size FILE_HEADER_SIZE = 16;
+
+Int64 thread_cpu_us() {
+#ifdef _WIN32
+    return 0;
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<Int64>(ts.tv_sec) * 1'000'000 + ts.tv_nsec / 1'000;
+#endif
+}
+
+Int64 epoch_us(SystemTimePoint tp) {
+    return std::chrono::duration_cast<Microseconds>(tp.time_since_epoch()).count();
+}
+
+template<typename T>
+void put(Byte*& out, T value) {
+    using U = std::make_unsigned_t<T>;
+    auto bits = static_cast<U>(value);
+    for (Size i = 0; i < sizeof(T); ++i) {
+        *out++ = static_cast<Byte>(bits & 0xFF);
+        bits = static_cast<U>(bits >> 8);
+    }
+}
+
+template<typename T>
+T get(const Byte*& in) {
+    using U = std::make_unsigned_t<T>;
+    U bits = 0;
+    for (Size i = 0; i < sizeof(T); ++i) bits |= static_cast<U>(static_cast<U>(in[i]) << (8 * i));
+    in += sizeof(T);
+    return static_cast<T>(bits);
+}
+
+template<Size N>
+void put(Byte*& out, const FixedString<N>& str) {
+    std::memcpy(out, str.data(), N);
+    out += N;
+}
+
+template<Size N>
+void get(const Byte*& in, FixedString<N>& str) {
+    std::memcpy(str.data(), in, N);
+    in += N;
+}
+
+void write_file_header(Byte* out) {
+    std::memset(out, 0, FILE_HEADER_SIZE);
+    std::memcpy(out, FILE_MAGIC, sizeof(FILE_MAGIC));
+    out += sizeof(FILE_MAGIC);
+    put<UInt16>(out, PerformanceRecord::FORMAT_VERSION);
+    put<UInt16>(out, static_cast<UInt16>(PerformanceRecord::ENCODED_SIZE));
+}
+
+Result<void> check_file_header(const Byte* in, const Path& path) {
+    if (std::memcmp(in, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("{} is not a monitoring data set", path.string()));
+    }
+    in += sizeof(FILE_MAGIC);
+    const auto version = get<UInt16>(in);
+    const auto record_size = get<UInt16>(in);
+    if (version != PerformanceRecord::FORMAT_VERSION || record_size != PerformanceRecord::ENCODED_SIZE) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("{} holds format {} records of {} bytes", path.string(), version, record_size));
+    }
+    return make_success();
+}
+
+} // namespace
+
+// =============================================================================
+// PerformanceRecord
+// =============================================================================
+
+StringView wait_type_name(WaitType type) {
+    switch (type) {
+        case WaitType::ENQ: return "ENQ";
+        case WaitType::FILE_IO: return "FILE";
+        case WaitType::INTERVAL: return "INTERVAL";
+        case WaitType::TEMP_STORAGE: return "TS";
+        case WaitType::TRANSIENT_DATA: return "TD";
+        case WaitType::STORAGE: return "STORAGE";
+        case WaitType::DISPATCH: return "DISPATCH";
+        case WaitType::OTHER: return "OTHER";
+    }
+    return "UNKNOWN";
+}
+
+StringView request_type_name(RequestType type) {
+    switch (type) {
+        case RequestType::FILE_READ: return "FC READ";
+        case RequestType::FILE_WRITE: return "FC WRITE";
+        case RequestType::FILE_BROWSE: return "FC BROWSE";
+        case RequestType::FILE_DELETE: return "FC DELETE";
+        case RequestType::TS_GET: return "TS GET";
+        case RequestType::TS_PUT: return "TS PUT";
+        case RequestType::TD_GET: return "TD GET";
+        case RequestType::TD_PUT: return "TD PUT";
+    }
+    return "UNKNOWN";
+}
+
+Int64 PerformanceRecord::total_wait_us() const {
+    Int64 total = 0;
+    for (Int64 us : wait_us) total += us;
+    return total;
+}
+
+UInt64 PerformanceRecord::total_requests() const {
+    UInt64 total = 0;
+    for (UInt32 count : request_count) total += count;
+    return total;
+}
+
+void PerformanceRecord::encode(Byte* out) const {
+    put<UInt16>(out, FORMAT_VERSION);
+    put(out, transaction_id);
+    put(out, terminal_id);
+    put(out, user_id);
+    put(out, program_name);
+    put(out, abend_code);
+    put(out, task_number);
+    put(out, start_us);
+    put(out, stop_us);
+    put(out, dispatch_us);
+    put(out, cpu_us);
+    for (Int64 us : wait_us) put(out, us);
+    for (UInt32 count : wait_count) put(out, count);
+    put(out, getmain_count);
+    put(out, getmain_bytes);
+    put(out, storage_peak);
+    for (UInt32 count : request_count) put(out, count);
+    for (UInt64 bytes : request_bytes) put(out, bytes);
+}
+
+Result<PerformanceRecord> PerformanceRecord::decode(ConstByteSpan in) {
+    if (in.size() < ENCODED_SIZE) {
+        return make_error<PerformanceRecord>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Performance record needs {} bytes, got {}", ENCODED_SIZE, in.size()));
+    }
+    const Byte* p = in.data();
+    const auto version = get<UInt16>(p);
+    if (version != FORMAT_VERSION) {
+        return make_error<PerformanceRecord>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Unsupported performance record version {}", version));
+    }
+    PerformanceRecord record;
+    get(p, record.transaction_id);
+    get(p, record.terminal_id);
+    get(p, record.user_id);
+    get(p, record.program_name);
+    get(p, record.abend_code);
+    record.task_number = get<UInt32>(p);
+    record.start_us = get<Int64>(p);
+    record.stop_us = get<Int64>(p);
+    record.dispatch_us = get<Int64>(p);
+    record.cpu_us = get<Int64>(p);
+    for (Int64& us : record.wait_us) us = get<Int64>(p);
+    for (UInt32& count : record.wait_count) count = get<UInt32>(p);
+    record.getmain_count = get<UInt32>(p);
+    record.getmain_bytes = get<UInt64>(p);
+    record.storage_peak = get<UInt64>(p);
+    for (UInt32& count : record.request_count) count = get<UInt32>(p);
+    for (UInt64& bytes : record.request_bytes) bytes = get<UInt64>(p);
+    return make_success(std::move(record));
+}
+
+// =============================================================================
+// TaskMonitor
+// =============================================================================
+
+TaskMonitor::TaskMonitor() {
+    record_.start_us = epoch_us(SystemClock::now());
+}
+
+void TaskMonitor::dispatch_begin() {
+    if (dispatched_) return;
+    dispatched_ = true;
+    dispatched_at_ = Clock::now();
+    cpu_at_dispatch_ = thread_cpu_us();
+}
+
+void TaskMonitor::dispatch_end() {
+    if (!dispatched_) return;
+    dispatched_ = false;
+    record_.dispatch_us += std::chrono::duration_cast<Microseconds>(Clock::now() - dispatched_at_).count();
+    record_.cpu_us += std::max<Int64>(thread_cpu_us() - cpu_at_dispatch_, 0);
+}
+
+void TaskMonitor::add_wait(WaitType type, Duration waited) {
+    const auto index = static_cast<Size>(type);
+    record_.wait_us[index] += std::chrono::duration_cast<Microseconds>(waited).count();
+    ++record_.wait_count[index];
+}
+
+void TaskMonitor::add_request(RequestType type, UInt64 bytes, UInt32 count) {
+    const auto index = static_cast<Size>(type);
+    record_.request_count[index] += count;
+    record_.request_bytes[index] += bytes;
+}
+
+void TaskMonitor::add_getmain(UInt64 bytes) {
+    ++record_.getmain_count;
+    record_.getmain_bytes += bytes;
+    storage_current_ += bytes;
+    record_.storage_peak = std::max(record_.storage_peak, storage_current_);
+}
+
+void TaskMonitor::add_freemain(UInt64 bytes) {
+    storage_current_ -= std::min(bytes, storage_current_);
+}
+
+const PerformanceRecord& TaskMonitor::finish() {
+    dispatch_end();
+    record_.stop_us = epoch_us(SystemClock::now());
+    return record_;
+}
+
+// =============================================================================
+// Sinks
+// =============================================================================
+
+Result<MonitoringSink> file_sink(const Path& path) {
+    std::error_code ec;
+    const bool existing = std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0;
+    if (existing) {
+        std::ifstream in(path, std::ios::binary);
+        std::array<Byte, FILE_HEADER_SIZE> header{};
+        if (!in.read(reinterpret_cast<char*>(header.data()), header.size())) {
+            return make_error<MonitoringSink>(ErrorCode::IO_ERROR,
+                std::format("Cannot read header of {}", path.string()));
+        }
+        if (auto checked = check_file_header(header.data(), path); !checked) {
+            return make_error<MonitoringSink>(checked.error());
+        }
+    }
+
+    auto out = std::make_shared<std::ofstream>(path, std::ios::binary | std::ios::app);
+    if (!*out) {
+        return make_error<MonitoringSink>(ErrorCode::IO_ERROR, std::format("Cannot open {}", path.string()));
+    }
+    if (!existing) {
+        std::array<Byte, FILE_HEADER_SIZE> header{};
+        write_file_header(header.data());
+        out->write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+    MonitoringSink sink = [out, path](ConstByteSpan records, Size) -> Result<void> {
+        out->write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size()));
+        out->flush();
+        if (!*out) {
+            out->clear();
+            return make_error<void>(ErrorCode::IO_ERROR, std::format("Write to {} failed", path.string()));
+        }
+        return make_success();
+    };
+    return make_success(std::move(sink));
+}
+
+// =============================================================================
+// MonitoringFacility
+// =============================================================================
+
+String MonitoringStatistics::to_string() const {
+    return std::format("Recorded: {}, Written: {}, Dropped: {}, Batches: {}, Sink errors: {}",
+        recorded.get(), written.get(), dropped.get(), batches.get(), sink_errors.get());
+}
+
+MonitoringFacility& MonitoringFacility::instance() {
+    static MonitoringFacility facility;
+    return facility;
+}
+
+MonitoringFacility::~MonitoringFacility() {
+    stop();
+}
+
+Result<void> MonitoringFacility::start(MonitoringConfig config) {
+    std::lock_guard lifecycle(lifecycle_mutex_);
+    if (active()) return make_error<void>(ErrorCode::INVALID_STATE, "Monitoring is already active");
+    if (!config.sink) return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Monitoring needs a sink");
+
+    config.ring_capacity = std::bit_ceil(std::max<Size>(config.ring_capacity, 2));
+    config.batch_records = std::clamp<Size>(config.batch_records, 1, config.ring_capacity);
+    config_ = std::move(config);
+
+    slots_ = std::make_unique<Slot[]>(config_.ring_capacity);
+    for (Size i = 0; i < config_.ring_capacity; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    mask_ = config_.ring_capacity - 1;
+    head_.store(0, std::memory_order_relaxed);
+    tail_ = 0;
+    drained_.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = false;
+        flush_requested_ = false;
+    }
+    active_.store(true, std::memory_order_release);
+    writer_ = std::thread([this] { writer_loop(); });
+    return make_success();
+}
+
+void MonitoringFacility::stop() {
+    std::lock_guard lifecycle(lifecycle_mutex_);
+    if (!active()) return;
+    active_.store(false, std::memory_order_release);
+
+    // A task that saw the facility active may still be filling its slot
+    while (producers_.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+    drained_cv_.notify_all();
+    slots_.reset();
+}
+
+bool MonitoringFacility::record(const PerformanceRecord& record) {
+    producers_.fetch_add(1, std::memory_order_acq_rel);
+    struct Leave {
+        std::atomic<UInt32>& producers;
+        ~Leave() { producers.fetch_sub(1, std::memory_order_release); }
+    } leave{producers_};
+    if (!active()) return false;
+
+    // Bounded multi-producer ring: each slot's sequence says whose turn it is
+    UInt64 pos = head_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        const UInt64 sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<Int64>(sequence - pos);
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            ++stats_.dropped;
+            return false;
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    record.encode(slot->data.data());
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    ++stats_.recorded;
+
+    // Wake the writer early once a full batch is waiting
+    if ((pos + 1) % config_.batch_records == 0) wake_cv_.notify_one();
+    return true;
+}
+
+void MonitoringFacility::flush() {
+    if (!active()) return;
+    const UInt64 target = head_.load(std::memory_order_acquire);
+    std::unique_lock lock(wake_mutex_);
+    flush_requested_ = true;
+    wake_cv_.notify_one();
+    drained_cv_.wait(lock, [&] {
+        return drained_.load(std::memory_order_acquire) >= target || !active();
+    });
+}
+
+Size MonitoringFacility::drain(std::vector<Byte>& batch) {
+    batch.clear();
+    Size count = 0;
+    while (count < config_.batch_records) {
+        Slot& slot = slots_[tail_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) break;
+        batch.insert(batch.end(), slot.data.begin(), slot.data.end());
+        slot.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+        ++tail_;
+        ++count;
+    }
+    if (count == 0) return 0;
+
+    if (auto written = config_.sink(ConstByteSpan(batch.data(), batch.size()), count); written) {
+        stats_.written += count;
+    } else {
+        ++stats_.sink_errors;
+    }
+    ++stats_.batches;
+    drained_.store(tail_, std::memory_order_release);
+    return count;
+}
+
+void MonitoringFacility::writer_loop() {
+    std::vector<Byte> batch;
+    batch.reserve(config_.batch_records * PerformanceRecord::ENCODED_SIZE);
+
+    std::unique_lock lock(wake_mutex_);
+    for (;;) {
+        wake_cv_.wait_for(lock, config_.flush_interval, [&] {
+            return stopping_ || flush_requested_ ||
+                   head_.load(std::memory_order_relaxed) - tail_ >= config_.batch_records;
+        });
+        const bool stopping = stopping_;
+        flush_requested_ = false;
+        lock.unlock();
+
+        while (drain(batch) == config_.batch_records) {}
+
+        lock.lock();
+        drained_cv_.notify_all();
+        if (stopping) break;
+    }
+}
+
+// =============================================================================
+// Reporting
+// =============================================================================
+
+Result<std::vector<PerformanceRecord>> read_monitoring_file(const Path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return make_error<std::vector<PerformanceRecord>>(ErrorCode::IO_ERROR,
+            std::format("Cannot open {}", path.string()));
+    }
+    std::array<Byte, FILE_HEADER_SIZE> header{};
+    if (!in.read(reinterpret_cast<char*>(header.data()), header.size())) {
+        return make_error<std::vector<PerformanceRecord>>(ErrorCode::IO_ERROR,
+            std::format("{} has no header", path.string()));
+    }
+    if (auto checked = check_file_header(header.data(), path); !checked) {
+        return make_error<std::vector<PerformanceRecord>>(checked.error());
+    }
+
+    // A record cut short by a crash mid-write is ignored
+    std::vector<PerformanceRecord> records;
+    std::array<Byte, PerformanceRecord::ENCODED_SIZE> buffer{};
+    while (in.read(reinterpret_cast<char*>(buffer.data()), buffer.size())) {
+        auto record = PerformanceRecord::decode(buffer);
+        if (!record) return make_error<std::vector<PerformanceRecord>>(record.error());
+        records.push_back(std::move(*record));
+    }
+    return make_success(std::move(records));
+}
+
+Int64 TransactionSummary::total_wait_us() const {
+    Int64 total = 0;
+    for (Int64 us : wait_us) total += us;
+    return total;
+}
+
+UInt64 TransactionSummary::total_requests() const {
+    UInt64 total = 0;
+    for (UInt64 count : request_count) total += count;
+    return total;
+}
+
+UInt64 TransactionSummary::total_request_bytes() const {
+    UInt64 total = 0;
+    for (UInt64 bytes : request_bytes) total += bytes;
+    return total;
+}
+
+Optional<ReportOrder> parse_report_order(StringView name) {
+    if (name == "cpu") return ReportOrder::CPU;
+    if (name == "response") return ReportOrder::RESPONSE;
+    if (name == "dispatch") return ReportOrder::DISPATCH;
+    if (name == "wait") return ReportOrder::WAIT;
+    if (name == "storage") return ReportOrder::STORAGE;
+    if (name == "requests") return ReportOrder::REQUESTS;
+    if (name == "tasks") return ReportOrder::TASKS;
+    return std::nullopt;
+}
+
+std::vector<TransactionSummary> summarize_records(const std::vector<PerformanceRecord>& records, ReportOrder order) {
+    std::unordered_map<String, TransactionSummary> by_transaction;
+    for (const auto& record : records) {
+        auto transid = record.transaction_id.trimmed();
+        auto& summary = by_transaction[transid];
+        if (summary.tasks == 0) summary.transaction_id = std::move(transid);
+        ++summary.tasks;
+        if (record.abended()) ++summary.abends;
+        summary.response_us += record.response_us();
+        summary.max_response_us = std::max(summary.max_response_us, record.response_us());
+        summary.dispatch_us += record.dispatch_us;
+        summary.cpu_us += record.cpu_us;
+        for (Size i = 0; i < WAIT_TYPE_COUNT; ++i) summary.wait_us[i] += record.wait_us[i];
+        summary.getmain_bytes += record.getmain_bytes;
+        for (Size i = 0; i < REQUEST_TYPE_COUNT; ++i) {
+            summary.request_count[i] += record.request_count[i];
+            summary.request_bytes[i] += record.request_bytes[i];
+        }
+    }
+
+    std::vector<TransactionSummary> summaries;
+    summaries.reserve(by_transaction.size());
+    for (auto& [transid, summary] : by_transaction) summaries.push_back(std::move(summary));
+
+    auto weight = [order](const TransactionSummary& s) -> UInt64 {
+        switch (order) {
+            case ReportOrder::CPU: return static_cast<UInt64>(s.cpu_us);
+            case ReportOrder::RESPONSE: return static_cast<UInt64>(s.response_us);
+            case ReportOrder::DISPATCH: return static_cast<UInt64>(s.dispatch_us);
+            case ReportOrder::WAIT: return static_cast<UInt64>(s.total_wait_us());
+            case ReportOrder::STORAGE: return s.getmain_bytes;
+            case ReportOrder::REQUESTS: return s.total_requests();
+            case ReportOrder::TASKS: return s.tasks;
+        }
+        return 0;
+    };
+    std::sort(summaries.begin(), summaries.end(), [&](const auto& a, const auto& b) {
+        const UInt64 wa = weight(a), wb = weight(b);
+        return wa != wb ? wa > wb : a.transaction_id < b.transaction_id;
+    });
+    return summaries;
+}
+
+String format_report(const std::vector<TransactionSummary>& summaries, Size limit) {
+    const Size rows = limit == 0 ? summaries.size() : std::min(limit, summaries.size());
+    auto avg_ms = [](Int64 total_us, UInt64 tasks) {
+        return tasks > 0 ? static_cast<double>(total_us) / 1000.0 / static_cast<double>(tasks) : 0.0;
+    };
+
+    String out = std::format("{:<4} {:>9} {:>6} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>8} {:>10}\n",
+        "TRAN", "TASKS", "ABENDS", "AVG RESP", "MAX RESP", "AVG DISP", "AVG CPU", "AVG WAIT",
+        "TOTAL CPU", "REQ/TASK", "GETMAIN/T");
+    for (Size i = 0; i < rows; ++i) {
+        const auto& s = summaries[i];
+        out += std::format("{:<4} {:>9} {:>6} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.1f} {:>8.1f} {:>10}\n",
+            s.transaction_id, s.tasks, s.abends, avg_ms(s.response_us, s.tasks),
+            static_cast<double>(s.max_response_us) / 1000.0, avg_ms(s.dispatch_us, s.tasks),
+            avg_ms(s.cpu_us, s.tasks), avg_ms(s.total_wait_us(), s.tasks),
+            static_cast<double>(s.cpu_us) / 1000.0,
+            s.tasks > 0 ? static_cast<double>(s.total_requests()) / static_cast<double>(s.tasks) : 0.0,
+            s.tasks > 0 ? s.getmain_bytes / s.tasks : 0);
+    }
+
+    // Where the waiting goes, average milliseconds per task
+    out += std::format("\n{:<4}", "TRAN");
+    for (Size w = 0; w < WAIT_TYPE_COUNT; ++w) {
+        out += std::format(" {:>10}", wait_type_name(static_cast<WaitType>(w)));
+    }
+    out += '\n';
+    for (Size i = 0; i < rows; ++i) {
+        const auto& s = summaries[i];
+        out += std::format("{:<4}", s.transaction_id);
+        for (Size w = 0; w < WAIT_TYPE_COUNT; ++w) out += std::format(" {:>10.3f}", avg_ms(s.wait_us[w], s.tasks));
+        out += '\n';
+    }
+
+    // Request mix, count and bytes per task
+    out += std::format("\n{:<4}", "TRAN");
+    for (Size r = 0; r < REQUEST_TYPE_COUNT; ++r) {
+        out += std::format(" {:>10}", request_type_name(static_cast<RequestType>(r)));
+    }
+    out += std::format(" {:>12}\n", "BYTES/TASK");
+    for (Size i = 0; i < rows; ++i) {
+        const auto& s = summaries[i];
+        out += std::format("{:<4}", s.transaction_id);
+        for (Size r = 0; r < REQUEST_TYPE_COUNT; ++r) {
+            out += std::format(" {:>10.1f}", s.tasks > 0
+                ? static_cast<double>(s.request_count[r]) / static_cast<double>(s.tasks) : 0.0);
+        }
+        out += std::format(" {:>12}\n", s.tasks > 0 ? s.total_request_bytes() / s.tasks : 0);
+    }
+    return out;
+}
+
+} // namespace cics::cics
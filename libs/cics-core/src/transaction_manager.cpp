@@ -1,4 +1,201 @@
 #include "cics/cics/cics_types.hpp"
+#include "cics/cics/transaction_router.hpp"
+#include "cics/task/task_control.hpp"
+#include <algorithm>
+
 namespace cics::cics {
 // Transaction routing and management
+
+LoadProbe statistics_probe(const CicsStatistics& stats, UInt32 max_tasks) {
+    return [&stats, max_tasks] {
+        RegionLoad load;
+        load.active_tasks = static_cast<UInt32>(std::min<UInt64>(stats.active_tasks.get(), UINT32_MAX));
+        load.queued_tasks = task::TaskControlManager::instance().admission_queue_depth();
+        load.max_tasks = max_tasks;
+        load.completed = stats.total_transactions.get();
+        load.total_response_ms = stats.total_response_time_ms.load(std::memory_order_relaxed);
+        return load;
+    };
+}
+
+String RouterStatistics::to_string() const {
+    return std::format("Routed: {}, Affinity: {}, At MAXTASK: {}, Rejected: {}, Probes: {}",
+        routed.get(), affinity_routed.get(), at_maxtask.get(), rejected.get(), probes.get());
+}
+
+UInt32 TransactionRouter::Region::estimated_tasks() const {
+    const Int64 tasks = static_cast<Int64>(sampled_tasks.load(std::memory_order_relaxed)) +
+                        since_sample.load(std::memory_order_relaxed);
+    return static_cast<UInt32>(std::clamp<Int64>(tasks, 0, UINT32_MAX));
+}
+
+TransactionRouter::TransactionRouter(TransactionRouterConfig config) : config_(config) {}
+
+Result<void> TransactionRouter::add_region(StringView sysid, LoadProbe probe) {
+    if (sysid.empty() || !probe) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Region needs a sysid and a load probe");
+    }
+    std::unique_lock lock(regions_mutex_);
+    for (const auto& region : regions_) {
+        if (region->sysid == sysid) {
+            return make_error<void>(ErrorCode::INVALID_ARGUMENT, std::format("Region {} already defined", sysid));
+        }
+    }
+    auto region = std::make_unique<Region>();
+    region->sysid = String(sysid);
+    region->probe = std::move(probe);
+    regions_.push_back(std::move(region));
+    return make_success();
+}
+
+Result<void> TransactionRouter::remove_region(StringView sysid) {
+    std::unique_lock lock(regions_mutex_);
+    auto removed = std::erase_if(regions_, [&](const UniquePtr<Region>& region) { return region->sysid == sysid; });
+    if (removed == 0) return make_error<void>(ErrorCode::NOTFND, std::format("Region {} not defined", sysid));
+    return make_success();
+}
+
+TransactionRouter::Region* TransactionRouter::find_region(StringView sysid) const {
+    for (const auto& region : regions_) {
+        if (region->sysid == sysid) return region.get();
+    }
+    return nullptr;
+}
+
+void TransactionRouter::sample(Region& region, TimePoint now) {
+    std::unique_lock lock(region.sample_mutex, std::try_to_lock);
+    if (!lock || (region.sampled && now - region.sampled_at < config_.sample_interval)) return;
+
+    const RegionLoad load = region.probe();
+    ++stats_.probes;
+
+    // Response time over the interval since the last sample, not the
+    // region's lifetime average, so a region that has slowed down shows it
+    if (load.completed > region.last_completed) {
+        const double interval_ms = static_cast<double>(load.total_response_ms - region.last_response_ms) /
+                                   static_cast<double>(load.completed - region.last_completed);
+        const double previous = region.response_ms.load(std::memory_order_relaxed);
+        region.response_ms.store(region.sampled
+            ? previous + config_.response_smoothing * (interval_ms - previous)
+            : interval_ms, std::memory_order_relaxed);
+    }
+    region.last_completed = load.completed;
+    region.last_response_ms = load.total_response_ms;
+
+    region.sampled_tasks.store(load.active_tasks + load.queued_tasks, std::memory_order_relaxed);
+    region.max_tasks.store(load.max_tasks, std::memory_order_relaxed);
+    region.available.store(load.available, std::memory_order_relaxed);
+    region.since_sample.store(0, std::memory_order_relaxed);
+    region.sampled_at = now;
+    region.sampled = true;
+}
+
+Result<RouteDecision> TransactionRouter::route(StringView transid, StringView affinity_key) {
+    const TimePoint now = Clock::now();
+    std::shared_lock lock(regions_mutex_);
+
+    // Keyed attaches hold the affinity lock throughout so two first attaches
+    // of one pseudo-conversation cannot pick different regions
+    std::unique_lock affinity_lock(affinity_mutex_, std::defer_lock);
+    if (!affinity_key.empty()) {
+        affinity_lock.lock();
+        prune_affinities(now);
+        auto it = affinities_.find(String(affinity_key));
+        if (it != affinities_.end() && now - it->second.last_used > config_.affinity_timeout) {
+            affinities_.erase(it);
+            it = affinities_.end();
+        }
+        if (it != affinities_.end()) {
+            Region* region = find_region(it->second.sysid);
+            if (region == nullptr || !region->available.load(std::memory_order_relaxed)) {
+                ++stats_.rejected;
+                return make_error<RouteDecision>(ErrorCode::SYSIDERR,
+                    std::format("{} has affinity to region {}, which is not available", transid, it->second.sysid));
+            }
+            it->second.last_used = now;
+            region->since_sample.fetch_add(1, std::memory_order_relaxed);
+            ++region->routed;
+            ++stats_.routed;
+            ++stats_.affinity_routed;
+            return RouteDecision{region->sysid, true};
+        }
+    }
+
+    // Expected response: smoothed response time scaled by the tasks ahead,
+    // and by how close the region is to MAXTASK
+    Region* best = nullptr;
+    double best_score = 0.0;
+    bool best_full = false;
+    const Size count = regions_.size();
+    const Size start = count == 0 ? 0 : rotor_.fetch_add(1, std::memory_order_relaxed) % count;
+    for (Size i = 0; i < count; ++i) {
+        Region& region = *regions_[(start + i) % count];
+        sample(region, now);
+        if (!region.available.load(std::memory_order_relaxed)) continue;
+
+        const double tasks = region.estimated_tasks();
+        const double max_tasks = region.max_tasks.load(std::memory_order_relaxed);
+        const double service = std::max(region.response_ms.load(std::memory_order_relaxed), 1.0);
+        const bool full = max_tasks > 0 && tasks >= max_tasks;
+        double score = service * (tasks + 1.0);
+        if (max_tasks > 0 && !full) score *= max_tasks / (max_tasks - tasks);
+
+        if (best == nullptr || (best_full && !full) || (best_full == full && score < best_score)) {
+            best = &region;
+            best_score = score;
+            best_full = full;
+        }
+    }
+
+    if (best == nullptr) {
+        ++stats_.rejected;
+        return make_error<RouteDecision>(ErrorCode::SYSIDERR, std::format("No region available for {}", transid));
+    }
+
+    best->since_sample.fetch_add(1, std::memory_order_relaxed);
+    ++best->routed;
+    ++stats_.routed;
+    if (best_full) ++stats_.at_maxtask;
+    if (!affinity_key.empty()) affinities_.insert_or_assign(String(affinity_key), Affinity{best->sysid, now});
+    return RouteDecision{best->sysid, false};
+}
+
+void TransactionRouter::complete(const RouteDecision& decision) {
+    std::shared_lock lock(regions_mutex_);
+    if (Region* region = find_region(decision.sysid)) {
+        region->since_sample.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void TransactionRouter::end_affinity(StringView affinity_key) {
+    std::lock_guard lock(affinity_mutex_);
+    affinities_.erase(String(affinity_key));
+}
+
+void TransactionRouter::prune_affinities(TimePoint now) {
+    // Abandoned pseudo-conversations; swept a few times per timeout period
+    if (now - last_prune_ < config_.affinity_timeout / 4) return;
+    last_prune_ = now;
+    std::erase_if(affinities_, [&](const auto& entry) {
+        return now - entry.second.last_used > config_.affinity_timeout;
+    });
+}
+
+Size TransactionRouter::affinity_count() const {
+    std::lock_guard lock(affinity_mutex_);
+    return affinities_.size();
+}
+
+std::vector<RegionStatus> TransactionRouter::regions() const {
+    std::shared_lock lock(regions_mutex_);
+    std::vector<RegionStatus> result;
+    result.reserve(regions_.size());
+    for (const auto& region : regions_) {
+        result.push_back(RegionStatus{region->sysid, region->estimated_tasks(),
+            region->max_tasks.load(std::memory_order_relaxed), region->response_ms.load(std::memory_order_relaxed),
+            region->available.load(std::memory_order_relaxed), region->routed.get()});
+    }
+    return result;
+}
+
 } // namespace cics::cics
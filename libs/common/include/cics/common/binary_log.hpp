@@ -0,0 +1,270 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - Binary Structured Logging
+// Version: 3.4.6
+// =============================================================================
+//
+// Trace logging for hot paths. A call site's format string is registered
+// once and gets an id; each line then records only that id, a timestamp and
+// its raw arguments (integers, floating point, bool, char and strings) into
+// a staging buffer owned by the calling thread. Nothing is formatted and no
+// lock is taken on the way in. A writer thread drains the buffers in
+// batches to a sink, emitting each format the first time a line refers to
+// it, and the cics-log-decode tool renders the file as text offline.
+//
+//   BinaryLog::instance().start({.sink = *binary_log_file_sink("trace.blog")});
+//   CICS_BLOG(LogLevel::DBG, "READ {} key {} took {}us", file_name, key, elapsed);
+//
+// Format strings use std::format syntax and are checked at compile time.
+// Lines that do not fit in the thread's buffer are dropped and counted.
+// =============================================================================
+
+#include "cics/common/types.hpp"
+#include "cics/common/error.hpp"
+#include "cics/common/logging.hpp"
+#include <cstring>
+#include <variant>
+
+namespace cics::logging {
+
+// =============================================================================
+// Format Registry
+// =============================================================================
+
+struct LogFormat {
+    UInt32 id = 0;
+    LogLevel level = LogLevel::INFO;
+    String format;
+    String file;
+    UInt32 line = 0;
+};
+
+class FormatRegistry {
+public:
+    static FormatRegistry& instance();
+
+    // Ids are dense and start at 1; each call registers a new format
+    UInt32 add(LogLevel level, StringView format, const std::source_location& location);
+
+    [[nodiscard]] UInt32 size() const { return count_.load(std::memory_order_acquire); }
+    [[nodiscard]] std::vector<LogFormat> since(UInt32 first_id) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<LogFormat> formats_;
+    std::atomic<UInt32> count_{0};
+};
+
+// =============================================================================
+// Binary Log
+// =============================================================================
+
+// Receives whole frames, on the writer thread only
+using BinaryLogSink = std::function<Result<void>(ConstByteSpan frames)>;
+
+// A header naming the format, then frames; appends to an existing log
+[[nodiscard]] Result<BinaryLogSink> binary_log_file_sink(const Path& path);
+
+enum class BinaryArgType : UInt8 { INT = 1, UINT, DOUBLE, BOOL, CHAR, STRING };
+
+struct BinaryLogConfig {
+    BinaryLogSink sink;
+    Size buffer_size = 1024 * 1024;     // Per-thread staging buffer
+    Milliseconds flush_interval{100};   // Longest a line sits in a buffer
+    LogLevel level = LogLevel::TRACE;
+};
+
+struct BinaryLogStatistics {
+    AtomicCounter<> written;            // Lines handed to the sink
+    AtomicCounter<> dropped;            // Staging buffer full; the writer has fallen behind
+    AtomicCounter<> bytes;
+    AtomicCounter<> batches;
+    AtomicCounter<> sink_errors;
+
+    [[nodiscard]] String to_string() const;
+};
+
+class BinaryLog {
+public:
+    // Staged line: total size, format id, timestamp, then tagged arguments
+    static constexpr Size RECORD_HEADER_SIZE = 4 + 4 + 8;
+
+    static BinaryLog& instance();
+
+    BinaryLog() = default;
+    ~BinaryLog();
+    BinaryLog(const BinaryLog&) = delete;
+    BinaryLog& operator=(const BinaryLog&) = delete;
+
+    Result<void> start(BinaryLogConfig config);
+    void stop();                        // Drains every line logged before it returns
+    [[nodiscard]] bool active() const { return active_.load(std::memory_order_acquire); }
+    [[nodiscard]] bool enabled(LogLevel level) const {
+        return active() && level >= level_.load(std::memory_order_relaxed);
+    }
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+    // Wait until every line logged so far has reached the sink
+    void flush();
+
+    template<typename... Args>
+    void log(UInt32 format_id, const Args&... args) {
+        if (!active()) return;
+        const Size size = RECORD_HEADER_SIZE + (Size{0} + ... + encoded_size(args));
+        Staging* staging = thread_staging();
+        if (staging == nullptr) {
+            ++stats_.dropped;
+            return;
+        }
+        // Announced before looking again, so stop() either waits for this
+        // line to be committed or this thread sees logging has stopped
+        staging->writing.store(true);
+        Byte* out = active_.load() ? reserve(*staging, size) : nullptr;
+        if (out == nullptr) {
+            staging->writing.store(false, std::memory_order_release);
+            ++stats_.dropped;
+            return;
+        }
+        const UInt64 now = static_cast<UInt64>(std::chrono::duration_cast<Nanoseconds>(
+            SystemClock::now().time_since_epoch()).count());
+        put(out, static_cast<UInt32>(size));
+        put(out, format_id);
+        put(out, now);
+        (encode(out, args), ...);
+        commit(*staging, size);
+        staging->writing.store(false, std::memory_order_release);
+    }
+
+    [[nodiscard]] const BinaryLogStatistics& statistics() const { return stats_; }
+
+private:
+    // Single producer (its thread), single consumer (the writer)
+    struct Staging {
+        UniquePtr<Byte[]> data;
+        Size capacity = 0;
+        UInt32 thread = 0;
+        UInt64 session = 0;
+        alignas(64) std::atomic<UInt64> head{0};
+        std::atomic<bool> writing{false};  // Producer: between the active check and commit
+        UInt64 pending = 0;             // Producer: where the reserved line starts
+        UInt64 cached_tail = 0;         // Producer: last tail seen
+        bool nudged = false;            // Producer: writer woken since the tail was read
+        alignas(64) std::atomic<UInt64> tail{0};
+        std::atomic<bool> retired{false};   // Its thread has exited
+    };
+
+    template<typename T>
+    static void put(Byte*& out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+
+    template<typename T>
+    static Size encoded_size(const T& value) {
+        if constexpr (std::is_convertible_v<const T&, StringView>) {
+            return 1 + 4 + StringView(value).size();
+        } else {
+            static_assert(std::is_arithmetic_v<T>,
+                          "Binary log arguments are numbers, bools, chars and strings");
+            return 1 + (std::is_same_v<T, bool> || std::is_same_v<T, char> ? 1 : 8);
+        }
+    }
+
+    template<typename T>
+    static void encode(Byte*& out, const T& value) {
+        if constexpr (std::is_convertible_v<const T&, StringView>) {
+            const StringView text(value);
+            put(out, BinaryArgType::STRING);
+            put(out, static_cast<UInt32>(text.size()));
+            std::memcpy(out, text.data(), text.size());
+            out += text.size();
+        } else if constexpr (std::is_same_v<T, bool>) {
+            put(out, BinaryArgType::BOOL);
+            put(out, static_cast<UInt8>(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            put(out, BinaryArgType::CHAR);
+            put(out, value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put(out, BinaryArgType::DOUBLE);
+            put(out, static_cast<double>(value));
+        } else if constexpr (std::is_signed_v<T>) {
+            put(out, BinaryArgType::INT);
+            put(out, static_cast<Int64>(value));
+        } else {
+            put(out, BinaryArgType::UINT);
+            put(out, static_cast<UInt64>(value));
+        }
+    }
+
+    Staging* thread_staging();
+    Byte* reserve(Staging& staging, Size size);
+    static void commit(Staging& staging, Size size) {
+        staging.head.store(staging.pending + size, std::memory_order_release);
+    }
+
+    void writer_loop();
+    void drain();
+
+    BinaryLogConfig config_;
+    std::atomic<LogLevel> level_{LogLevel::TRACE};
+    std::atomic<UInt64> session_{0};
+    UInt32 formats_written_ = 0;        // Writer thread only
+    std::vector<Byte> records_;         // Writer thread only
+    std::vector<Byte> batch_;
+
+    std::mutex stagings_mutex_;
+    std::vector<SharedPtr<Staging>> stagings_;
+    UInt32 next_thread_ = 1;
+
+    std::atomic<bool> active_{false};
+    std::mutex lifecycle_mutex_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable drained_cv_;
+    bool stopping_ = false;
+    bool flush_requested_ = false;
+    std::atomic<bool> nudged_{false};   // A buffer is filling; drain before the interval
+    UInt64 passes_started_ = 0;
+    UInt64 passes_done_ = 0;
+    std::thread writer_;
+
+    BinaryLogStatistics stats_;
+};
+
+// Log through the process's BinaryLog; the format is registered on first use
+#define CICS_BLOG(level, fmt, ...)                                                                \
+    do {                                                                                          \
+        if (::cics::logging::BinaryLog::instance().enabled(level)) {                             \
+            if (false) (void)std::format(fmt __VA_OPT__(,) __VA_ARGS__);                         \
+            static const ::cics::UInt32 cics_blog_format_ = ::cics::logging::FormatRegistry::instance().add( \
+                level, fmt, std::source_location::current());                                     \
+            ::cics::logging::BinaryLog::instance().log(cics_blog_format_ __VA_OPT__(,) __VA_ARGS__); \
+        }                                                                                         \
+    } while (false)
+
+// =============================================================================
+// Decoding
+// =============================================================================
+
+using BinaryArg = std::variant<Int64, UInt64, double, bool, char, String>;
+
+struct DecodedLogLine {
+    SystemTimePoint timestamp;
+    LogLevel level = LogLevel::INFO;
+    UInt32 thread = 0;
+    String message;
+    String file;
+    UInt32 line = 0;
+
+    // As LogEntry::format renders it, the thread in place of a logger name
+    [[nodiscard]] String format(bool include_location = true) const;
+};
+
+// Substitute arguments into a std::format-style string at run time
+[[nodiscard]] String render_format(StringView format, const std::vector<BinaryArg>& args);
+
+// Lines in file order: batches per thread, so only roughly by time
+[[nodiscard]] Result<std::vector<DecodedLogLine>> read_binary_log(const Path& path);
+
+} // namespace cics::logging
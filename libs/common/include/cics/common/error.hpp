@@ -66,6 +66,8 @@ enum class ErrorCode : Int32 {
     VSAM_RBA_NOT_FOUND = 4008,
     VSAM_CI_FULL = 4009,
     VSAM_KEY_CHANGE = 4010,
+    VSAM_RECORD_BUSY = 4011,
+    VSAM_DEADLOCK = 4012,
     
     // CICS Errors (5000-5099)
     CICS_ERROR = 5000,
@@ -104,6 +106,7 @@ enum class ErrorCode : Int32 {
     CONTAINERERR = 7013,
     NOT_INITIALIZED = 7014,
     NOT_SUPPORTED = 7015,
+    SYSIDERR = 7016,
     
     // Syncpoint Errors (7100-7149)
     SYNCPOINT_ERROR = 7100,
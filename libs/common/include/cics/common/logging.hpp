@@ -4,6 +4,8 @@
 #pragma once
 
 #include "cics/common/types.hpp"
+#include <array>
+#include <atomic>
 #include <fstream>
 #include <queue>
 #include <mutex>
@@ -114,6 +116,63 @@ public:
     void set_level(LogLevel level) override { level_ = level; }
 };
 
+// File sink writing into memory-mapped, preallocated segments. Writers
+// reserve room with an atomic add on the segment's tail and copy their line
+// in parallel without a lock. A full segment is swapped for a spare that a
+// background thread has already preallocated; that thread also trims,
+// renames and unmaps the old one. Past the last line the live file is
+// NUL-padded until the sink closes and trims it, so a crash leaves the
+// padding behind; configure_default only uses this sink when asked to.
+class MappedFileSink : public LogSink {
+private:
+    struct Segment {
+        std::atomic<Size> tail{0};          // Next free offset; may overshoot capacity
+        std::atomic<Size> committed{0};     // Bytes fully copied in
+        std::atomic<UInt32> writers{0};     // Writers that may touch the mapping
+        Byte* base = nullptr;
+        Size capacity = 0;
+        int fd = -1;
+    };
+    
+    LogLevel level_;
+    Path file_path_;
+    Path spare_path_;                       // Where the next segment waits
+    Size segment_size_;
+    UInt32 max_backup_count_;
+    
+    std::array<Segment, 3> segments_;       // Current, spare and retiring
+    std::atomic<Segment*> current_{nullptr};
+    Segment* spare_ = nullptr;
+    Segment* retiring_ = nullptr;
+    std::mutex rotate_mutex_;
+    std::condition_variable rotate_cv_;
+    std::thread maintenance_;
+    bool stopping_ = false;
+    bool spare_failed_ = false;
+    
+    AtomicCounter<UInt64> rotations_;
+    AtomicCounter<UInt64> dropped_;
+    UniquePtr<FileSink> fallback_;          // Platforms without mmap
+    
+    bool map_segment(Segment& segment, const Path& path, Size used);
+    void unmap_segment(Segment& segment, bool keep);
+    bool switch_segment(Segment* full);  // False if no segment could be had
+    void maintenance_loop();
+    
+public:
+    MappedFileSink(const Path& path, LogLevel level = LogLevel::DBG,
+                   Size segment_size = 64 * 1024 * 1024, UInt32 max_backups = 5);
+    ~MappedFileSink() override;
+    
+    void write(const LogEntry& entry) override;
+    void flush() override;
+    [[nodiscard]] LogLevel get_level() const override { return level_; }
+    void set_level(LogLevel level) override { level_ = level; }
+    
+    [[nodiscard]] UInt64 rotations() const { return rotations_.get(); }
+    [[nodiscard]] UInt64 dropped() const { return dropped_.get(); }  // Too long, or no segment to hold them
+};
+
 // Async sink wrapper
 class AsyncSink : public LogSink {
 private:
@@ -228,9 +287,11 @@ public:
     void add_global_sink(SharedPtr<LogSink> sink);
     void shutdown();
     
+    // mapped_file logs to a MappedFileSink rather than a FileSink
     void configure_default(LogLevel console_level = LogLevel::INFO,
                           Optional<Path> log_file = std::nullopt,
-                          LogLevel file_level = LogLevel::DBG);
+                          LogLevel file_level = LogLevel::DBG,
+                          bool mapped_file = false);
 };
 
 // Scoped timer for performance logging
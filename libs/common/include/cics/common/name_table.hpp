@@ -0,0 +1,99 @@
+#pragma once
+// =============================================================================
+// CICS Emulation - Interned Resource Names
+// Version: 3.4.6
+// =============================================================================
+//
+// Resource names (queues, programs, files, transactions, terminals) are
+// short blank-padded identifiers. NameTable interns each once for the life
+// of the process and hands back a dense NameId, so a caller resolving the
+// same name on every EXEC CICS call can do it once, up front:
+//
+//   static const NameId queue = NameTable::instance().intern("PAYQ");
+//   tsq_manager.writeq(queue, data);
+//
+// Managers keep a NameIndex beside their name-keyed maps; with an id, the
+// lookup is an array index. Ids are never reused and names never removed.
+//
+// A manager that installs, discards, opens, closes, enables or disables a
+// resource calls note_resource_change(), so whatever has resolved a name to
+// a resource ahead of time (EXEC CICS call-site stubs) resolves it again.
+// =============================================================================
+
+#include "cics/common/types.hpp"
+#include <deque>
+
+namespace cics {
+
+enum class NameId : UInt32 { NONE = 0 };
+
+// =============================================================================
+// Name Table
+// =============================================================================
+class NameTable {
+public:
+    // Names up to this long are keyed as two machine words
+    static constexpr Size SHORT_NAME = 16;
+
+    static NameTable& instance();
+
+    // Trailing blanks are not part of the name; the empty name is NONE
+    NameId intern(StringView name);
+
+    // NONE if the name was never interned
+    [[nodiscard]] NameId find(StringView name) const;
+
+    // Empty for NONE or an id this table did not issue
+    [[nodiscard]] StringView name(NameId id) const;
+
+    [[nodiscard]] Size size() const;
+
+private:
+    static StringView canonical(StringView name);
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<FixedString<SHORT_NAME>, NameId> short_names_;
+    StringMap<NameId> long_names_;
+    std::deque<String> names_;          // By id - 1; elements never move
+};
+
+// =============================================================================
+// Name Index - a manager's id-to-resource table
+// =============================================================================
+// Not synchronised; guarded by the owning manager's lock
+template<typename T>
+class NameIndex {
+public:
+    [[nodiscard]] T* find(NameId id) const noexcept {
+        const auto slot = static_cast<Size>(id);
+        return slot < slots_.size() ? slots_[slot] : nullptr;
+    }
+
+    void set(NameId id, T* value) {
+        const auto slot = static_cast<Size>(id);
+        if (slot == 0) return;
+        if (slot >= slots_.size()) slots_.resize(std::max(slot + 1, slots_.size() * 2), nullptr);
+        slots_[slot] = value;
+    }
+
+    void erase(NameId id) noexcept {
+        const auto slot = static_cast<Size>(id);
+        if (slot < slots_.size()) slots_[slot] = nullptr;
+    }
+
+    void clear() noexcept { slots_.clear(); }
+
+private:
+    std::vector<T*> slots_;
+};
+
+// =============================================================================
+// Resource Changes
+// =============================================================================
+
+void note_resource_change();
+
+// Moves on with every note_resource_change(); never goes back
+[[nodiscard]] UInt64 resource_generation();
+
+} // namespace cics
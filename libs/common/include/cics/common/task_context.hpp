@@ -0,0 +1,125 @@
+#pragma once
+// =============================================================================
+// CICS Emulation - Task Context
+// Version: 3.4.6
+// =============================================================================
+//
+// Ties a task to the thread running it. The task runner binds the task for
+// as long as it is dispatched and ends it on the same thread:
+//
+//   TaskBinding binding(task_number);
+//   ...run the program...
+//   binding.end();
+//
+// Facilities that keep state per task (handler stacks, channels) register
+// an end hook. Hooks run on the task's own thread as its binding ends, so a
+// pooled thread never carries one task's state into the next.
+//
+// A binding may also carry the task's TaskActivity (its monitoring data).
+// File, TS, TD, ENQ and storage calls report what they do through the
+// note_* functions, which cost a thread-local load outside a monitored task.
+// =============================================================================
+
+#include "cics/common/types.hpp"
+
+namespace cics {
+
+// =============================================================================
+// Task Activity
+// =============================================================================
+
+enum class WaitType : UInt8 {
+    ENQ = 0,                // ENQ and record locks
+    FILE_IO = 1,
+    INTERVAL = 2,           // DELAY, RETRIEVE WAIT, POST
+    TEMP_STORAGE = 3,
+    TRANSIENT_DATA = 4,
+    STORAGE = 5,            // GETMAIN suspended on short-on-storage
+    DISPATCH = 6,           // Ready but waiting for a MAXTASK slot or a TCB
+    OTHER = 7
+};
+inline constexpr Size WAIT_TYPE_COUNT = 8;
+
+enum class RequestType : UInt8 {
+    FILE_READ = 0,
+    FILE_WRITE = 1,         // WRITE and REWRITE
+    FILE_BROWSE = 2,        // READNEXT and READPREV
+    FILE_DELETE = 3,
+    TS_GET = 4,
+    TS_PUT = 5,
+    TD_GET = 6,
+    TD_PUT = 7
+};
+inline constexpr Size REQUEST_TYPE_COUNT = 8;
+
+// Receives one task's activity, on the thread running the task
+class TaskActivity {
+public:
+    virtual void add_wait(WaitType type, Duration waited) = 0;
+    virtual void add_request(RequestType type, UInt64 bytes, UInt32 count) = 0;
+    virtual void add_getmain(UInt64 bytes) = 0;
+    virtual void add_freemain(UInt64 bytes) = 0;
+
+protected:
+    ~TaskActivity() = default;
+};
+
+// Report to the bound task's TaskActivity, if it has one
+void note_wait(WaitType type, Duration waited);
+void note_request(RequestType type, UInt64 bytes = 0, UInt32 count = 1);
+void note_getmain(UInt64 bytes);
+void note_freemain(UInt64 bytes);
+
+// Times a suspend from construction to destruction; reads no clock unless
+// the task is monitored
+class WaitTimer {
+public:
+    explicit WaitTimer(WaitType type);
+    ~WaitTimer();
+    WaitTimer(const WaitTimer&) = delete;
+    WaitTimer& operator=(const WaitTimer&) = delete;
+
+private:
+    TaskActivity* activity_;
+    WaitType type_;
+    TimePoint start_{};
+};
+
+// =============================================================================
+// Task End Hooks
+// =============================================================================
+
+// Called with the ending task's number; must not add or remove hooks
+using TaskEndHook = std::function<void(UInt32 task_id)>;
+
+// Returns an id for remove_task_end_hook
+UInt64 add_task_end_hook(TaskEndHook hook);
+void remove_task_end_hook(UInt64 id);
+
+// The task bound to the calling thread; 0 outside a task
+[[nodiscard]] UInt32 current_task_id();
+
+// =============================================================================
+// Task Binding
+// =============================================================================
+class TaskBinding {
+public:
+    explicit TaskBinding(UInt32 task_id, TaskActivity* activity = nullptr);
+    ~TaskBinding() { end(); }
+    TaskBinding(const TaskBinding&) = delete;
+    TaskBinding& operator=(const TaskBinding&) = delete;
+
+    // Runs the end hooks, then restores whatever was bound before; later
+    // calls do nothing
+    void end();
+
+    [[nodiscard]] UInt32 task_id() const { return task_id_; }
+
+private:
+    UInt32 task_id_;
+    UInt32 previous_task_id_;
+    TaskActivity* previous_activity_;
+    bool ended_ = false;
+};
+
+} // namespace cics
@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -52,6 +53,25 @@ using StringView = std::string_view;
 using WString = std::wstring;
 using WStringView = std::wstring_view;
 
+// Transparent hash/equality so String-keyed unordered containers can be
+// probed with a StringView (or const char*) without building a temporary.
+struct StringHash {
+    using is_transparent = void;
+    [[nodiscard]] Size operator()(StringView sv) const noexcept {
+        return std::hash<StringView>{}(sv);
+    }
+};
+
+struct StringEqual {
+    using is_transparent = void;
+    [[nodiscard]] bool operator()(StringView a, StringView b) const noexcept {
+        return a == b;
+    }
+};
+
+template<typename T>
+using StringMap = std::unordered_map<String, T, StringHash, StringEqual>;
+
 // =============================================================================
 // Container Types
 // =============================================================================
@@ -175,7 +195,28 @@ public:
     constexpr const char& operator[](Size i) const { return data_[i]; }
     
     constexpr auto operator<=>(const FixedString&) const = default;
-    constexpr bool operator==(const FixedString&) const = default;
+    
+    // Names are one or two machine words; compare them as such
+    constexpr bool operator==(const FixedString& other) const noexcept {
+        if (std::is_constant_evaluated()) return data_ == other.data_;
+        return std::memcmp(data_.data(), other.data_.data(), N) == 0;
+    }
+    
+    [[nodiscard]] UInt64 hash() const noexcept {
+        UInt64 h = 0x9E3779B97F4A7C15ULL ^ N;
+        Size i = 0;
+        for (; i + 8 <= N; i += 8) {
+            UInt64 word;
+            std::memcpy(&word, data_.data() + i, 8);
+            h = mix(h ^ word);
+        }
+        if (i < N) {
+            UInt64 word = 0;
+            std::memcpy(&word, data_.data() + i, N - i);
+            h = mix(h ^ word);
+        }
+        return h;
+    }
     
     [[nodiscard]] constexpr bool empty() const noexcept {
         for (Size i = 0; i < N; ++i) if (data_[i] != ' ') return false;
@@ -183,6 +224,12 @@ public:
     }
     
     constexpr void clear() noexcept { data_.fill(' '); }
+    
+private:
+    static constexpr UInt64 mix(UInt64 h) noexcept {
+        h *= 0xFF51AFD7ED558CCDULL;
+        return h ^ (h >> 33);
+    }
 };
 
 // =============================================================================
@@ -438,3 +485,10 @@ template<Integral T>
 }
 
 } // namespace cics
+
+template<cics::Size N>
+struct std::hash<cics::FixedString<N>> {
+    [[nodiscard]] std::size_t operator()(const cics::FixedString<N>& name) const noexcept {
+        return static_cast<std::size_t>(name.hash());
+    }
+};
@@ -0,0 +1,559 @@
+// =============================================================================
+// CICS Emulation - Binary Structured Logging Implementation
+// =============================================================================
+
+#include "cics/common/binary_log.hpp"
+#include <bit>
+#include <fstream>
+
+namespace cics::logging {
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = {'C', 'B', 'L', 'G'};
+constexpr Size FILE_HEADER_SIZE = 16;
+constexpr UInt16 FORMAT_VERSION = 1;
+constexpr UInt8 FILE_BYTE_ORDER = std::endian::native == std::endian::little ? 1 : 2;
+
+// Frames following the file header; multi-byte fields in the writer's byte order
+enum class FrameKind : UInt8 {
+    SESSION = 0,    // A process started logging; format ids start over
+    FORMAT = 1,     // id, level, line, file, format string
+    RECORD = 2      // thread, then the staged line as logged
+};
+
+std::atomic<UInt64> next_session{1};
+
+template<typename T>
+void append(std::vector<Byte>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const Byte*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void append(std::vector<Byte>& out, StringView text) {
+    out.insert(out.end(), reinterpret_cast<const Byte*>(text.data()),
+               reinterpret_cast<const Byte*>(text.data()) + text.size());
+}
+
+// Bounds-checked reads over a decoded file
+class FrameReader {
+public:
+    explicit FrameReader(ConstByteSpan data) : data_(data) {}
+
+    [[nodiscard]] bool at_end() const { return pos_ >= data_.size(); }
+    [[nodiscard]] Size remaining() const { return data_.size() - pos_; }
+
+    template<typename T>
+    bool read(T& value) {
+        if (remaining() < sizeof(T)) return false;
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read(String& text, Size length) {
+        if (remaining() < length) return false;
+        text.assign(reinterpret_cast<const char*>(data_.data() + pos_), length);
+        pos_ += length;
+        return true;
+    }
+
+    bool sub(FrameReader& reader, Size length) {
+        if (remaining() < length) return false;
+        reader = FrameReader(data_.subspan(pos_, length));
+        pos_ += length;
+        return true;
+    }
+
+private:
+    ConstByteSpan data_;
+    Size pos_ = 0;
+};
+
+Result<void> check_file_header(const Byte* in, const Path& path) {
+    if (std::memcmp(in, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("{} is not a binary log", path.string()));
+    }
+    UInt16 version = 0;
+    std::memcpy(&version, in + 4, sizeof(version));
+    if (in[6] != FILE_BYTE_ORDER) {
+        return make_error<void>(ErrorCode::NOT_SUPPORTED,
+            std::format("{} was written on a host of the other byte order", path.string()));
+    }
+    if (version != FORMAT_VERSION) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("{} holds binary log format {}", path.string(), version));
+    }
+    return make_success();
+}
+
+void write_file_header(Byte* out) {
+    std::memcpy(out, FILE_MAGIC, sizeof(FILE_MAGIC));
+    std::memcpy(out + 4, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+    out[6] = FILE_BYTE_ORDER;
+}
+
+template<typename T>
+String format_one(StringView spec, const T& value) {
+    String field = "{";
+    if (!spec.empty()) {
+        field += ':';
+        field += spec;
+    }
+    field += '}';
+    try {
+        return std::vformat(field, std::make_format_args(value));
+    } catch (const std::format_error&) {
+        return std::format("{}", value);
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// FormatRegistry
+// =============================================================================
+
+FormatRegistry& FormatRegistry::instance() {
+    static FormatRegistry registry;
+    return registry;
+}
+
+UInt32 FormatRegistry::add(LogLevel level, StringView format, const std::source_location& location) {
+    std::lock_guard lock(mutex_);
+    LogFormat entry;
+    entry.id = static_cast<UInt32>(formats_.size() + 1);
+    entry.level = level;
+    entry.format = String(format);
+    entry.file = location.file_name() != nullptr ? location.file_name() : "";
+    entry.line = location.line();
+    formats_.push_back(std::move(entry));
+    count_.store(static_cast<UInt32>(formats_.size()), std::memory_order_release);
+    return formats_.back().id;
+}
+
+std::vector<LogFormat> FormatRegistry::since(UInt32 first_id) const {
+    std::lock_guard lock(mutex_);
+    if (first_id == 0) first_id = 1;
+    if (first_id > formats_.size()) return {};
+    return {formats_.begin() + (first_id - 1), formats_.end()};
+}
+
+// =============================================================================
+// Sinks
+// =============================================================================
+
+Result<BinaryLogSink> binary_log_file_sink(const Path& path) {
+    std::error_code ec;
+    const bool existing = std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0;
+    if (existing) {
+        std::ifstream in(path, std::ios::binary);
+        std::array<Byte, FILE_HEADER_SIZE> header{};
+        if (!in.read(reinterpret_cast<char*>(header.data()), header.size())) {
+            return make_error<BinaryLogSink>(ErrorCode::IO_ERROR,
+                std::format("Cannot read header of {}", path.string()));
+        }
+        if (auto checked = check_file_header(header.data(), path); !checked) {
+            return make_error<BinaryLogSink>(checked.error());
+        }
+    }
+
+    auto out = std::make_shared<std::ofstream>(path, std::ios::binary | std::ios::app);
+    if (!*out) {
+        return make_error<BinaryLogSink>(ErrorCode::IO_ERROR, std::format("Cannot open {}", path.string()));
+    }
+    if (!existing) {
+        std::array<Byte, FILE_HEADER_SIZE> header{};
+        write_file_header(header.data());
+        out->write(reinterpret_cast<const char*>(header.data()), header.size());
+    }
+
+    BinaryLogSink sink = [out, path](ConstByteSpan frames) -> Result<void> {
+        out->write(reinterpret_cast<const char*>(frames.data()), static_cast<std::streamsize>(frames.size()));
+        out->flush();
+        if (!*out) {
+            out->clear();
+            return make_error<void>(ErrorCode::IO_ERROR, std::format("Write to {} failed", path.string()));
+        }
+        return make_success();
+    };
+    return make_success(std::move(sink));
+}
+
+// =============================================================================
+// BinaryLog
+// =============================================================================
+
+String BinaryLogStatistics::to_string() const {
+    return std::format("Written: {}, Dropped: {}, Bytes: {}, Batches: {}, Sink errors: {}",
+        written.get(), dropped.get(), bytes.get(), batches.get(), sink_errors.get());
+}
+
+BinaryLog& BinaryLog::instance() {
+    static BinaryLog log;
+    return log;
+}
+
+BinaryLog::~BinaryLog() {
+    stop();
+}
+
+Result<void> BinaryLog::start(BinaryLogConfig config) {
+    std::lock_guard lifecycle(lifecycle_mutex_);
+    if (active()) return make_error<void>(ErrorCode::INVALID_STATE, "Binary logging is already active");
+    if (!config.sink) return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Binary logging needs a sink");
+
+    config.buffer_size = std::max<Size>(config.buffer_size, 4096);
+    config_ = std::move(config);
+    level_.store(config_.level, std::memory_order_relaxed);
+    formats_written_ = 0;
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = false;
+        flush_requested_ = false;
+    }
+    // Buffers from an earlier session are left to their threads
+    session_.store(next_session.fetch_add(1), std::memory_order_release);
+    active_.store(true, std::memory_order_release);
+    writer_ = std::thread([this] { writer_loop(); });
+    return make_success();
+}
+
+void BinaryLog::stop() {
+    std::lock_guard lifecycle(lifecycle_mutex_);
+    if (!active()) return;
+    active_.store(false);
+
+    // A line that got past the check commits before the final drain takes it
+    std::vector<SharedPtr<Staging>> stagings;
+    {
+        std::lock_guard lock(stagings_mutex_);
+        stagings = stagings_;
+    }
+    for (const auto& staging : stagings) {
+        while (staging->writing.load()) std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+    drained_cv_.notify_all();
+
+    std::lock_guard lock(stagings_mutex_);
+    stagings_.clear();
+}
+
+void BinaryLog::flush() {
+    if (!active()) return;
+    std::unique_lock lock(wake_mutex_);
+    const UInt64 wanted = passes_started_ + 1;
+    flush_requested_ = true;
+    wake_cv_.notify_one();
+    drained_cv_.wait(lock, [&] { return passes_done_ >= wanted || !active(); });
+}
+
+BinaryLog::Staging* BinaryLog::thread_staging() {
+    struct Holder {
+        SharedPtr<Staging> staging;
+        ~Holder() {
+            if (staging) staging->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder holder;
+
+    const UInt64 session = session_.load(std::memory_order_acquire);
+    if (holder.staging && holder.staging->session == session) return holder.staging.get();
+
+    if (holder.staging) holder.staging->retired.store(true, std::memory_order_release);
+    auto staging = std::make_shared<Staging>();
+    staging->capacity = config_.buffer_size;
+    staging->data = std::make_unique_for_overwrite<Byte[]>(staging->capacity);
+    staging->session = session;
+    {
+        std::lock_guard lock(stagings_mutex_);
+        if (!active()) return nullptr;
+        staging->thread = next_thread_++;
+        stagings_.push_back(staging);
+    }
+    holder.staging = std::move(staging);
+    return holder.staging.get();
+}
+
+Byte* BinaryLog::reserve(Staging& staging, Size size) {
+    // A line never wraps; the end of the buffer is skipped instead, marked
+    // with a zero size when there is room for one
+    UInt64 head = staging.head.load(std::memory_order_relaxed);
+    const Size offset = head % staging.capacity;
+    const Size contiguous = staging.capacity - offset;
+    const Size skip = size > contiguous ? contiguous : 0;
+    if (head + skip + size - staging.cached_tail > staging.capacity) {
+        staging.cached_tail = staging.tail.load(std::memory_order_acquire);
+        staging.nudged = false;
+        if (head + skip + size - staging.cached_tail > staging.capacity) return nullptr;
+    }
+    if (skip != 0) {
+        if (contiguous >= sizeof(UInt32)) std::memset(staging.data.get() + offset, 0, sizeof(UInt32));
+        head += skip;
+    }
+    staging.pending = head;
+
+    // Half full: wake the writer rather than wait out its interval
+    if (!staging.nudged && head + size - staging.cached_tail > staging.capacity / 2) {
+        staging.nudged = true;
+        nudged_.store(true, std::memory_order_relaxed);
+        wake_cv_.notify_one();
+    }
+    return staging.data.get() + head % staging.capacity;
+}
+
+void BinaryLog::drain() {
+    records_.clear();
+    std::vector<SharedPtr<Staging>> stagings;
+    {
+        std::lock_guard lock(stagings_mutex_);
+        stagings = stagings_;
+    }
+
+    UInt64 lines = 0;
+    for (const auto& staging : stagings) {
+        const bool retired = staging->retired.load(std::memory_order_acquire);
+        UInt64 tail = staging->tail.load(std::memory_order_relaxed);
+        const UInt64 head = staging->head.load(std::memory_order_acquire);
+        while (tail < head) {
+            const Size offset = tail % staging->capacity;
+            const Size contiguous = staging->capacity - offset;
+            UInt32 size = 0;
+            if (contiguous >= sizeof(size)) std::memcpy(&size, staging->data.get() + offset, sizeof(size));
+            if (size == 0) {
+                tail += contiguous;
+                continue;
+            }
+            records_.push_back(static_cast<Byte>(FrameKind::RECORD));
+            append(records_, staging->thread);
+            const Byte* line = staging->data.get() + offset;
+            records_.insert(records_.end(), line, line + size);
+            tail += size;
+            ++lines;
+        }
+        staging->tail.store(tail, std::memory_order_release);
+
+        if (retired && tail == head) {
+            std::lock_guard lock(stagings_mutex_);
+            std::erase(stagings_, staging);
+        }
+    }
+
+    // Formats go after the lines are taken, so every line's format is
+    // registered by now, and ahead of them in the batch
+    batch_.clear();
+    if (FormatRegistry::instance().size() > formats_written_) {
+        for (const auto& format : FormatRegistry::instance().since(formats_written_ + 1)) {
+            batch_.push_back(static_cast<Byte>(FrameKind::FORMAT));
+            append(batch_, format.id);
+            append(batch_, static_cast<UInt8>(format.level));
+            append(batch_, format.line);
+            append(batch_, static_cast<UInt16>(format.file.size()));
+            append(batch_, StringView(format.file));
+            append(batch_, static_cast<UInt32>(format.format.size()));
+            append(batch_, StringView(format.format));
+            formats_written_ = format.id;
+        }
+    }
+    if (batch_.empty() && records_.empty()) return;
+    batch_.insert(batch_.end(), records_.begin(), records_.end());
+
+    if (auto written = config_.sink(ConstByteSpan(batch_.data(), batch_.size())); written) {
+        stats_.written += lines;
+        stats_.bytes += batch_.size();
+    } else {
+        ++stats_.sink_errors;
+    }
+    ++stats_.batches;
+}
+
+void BinaryLog::writer_loop() {
+    batch_.clear();
+    batch_.push_back(static_cast<Byte>(FrameKind::SESSION));
+    append(batch_, static_cast<UInt64>(std::chrono::duration_cast<Nanoseconds>(
+        SystemClock::now().time_since_epoch()).count()));
+    if (!config_.sink(ConstByteSpan(batch_.data(), batch_.size()))) ++stats_.sink_errors;
+
+    std::unique_lock lock(wake_mutex_);
+    for (;;) {
+        wake_cv_.wait_for(lock, config_.flush_interval, [&] {
+            return stopping_ || flush_requested_ || nudged_.load(std::memory_order_relaxed);
+        });
+        const bool stopping = stopping_;
+        flush_requested_ = false;
+        nudged_.store(false, std::memory_order_relaxed);
+        const UInt64 pass = ++passes_started_;
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+        passes_done_ = pass;
+        drained_cv_.notify_all();
+        if (stopping) break;
+    }
+}
+
+// =============================================================================
+// Decoding
+// =============================================================================
+
+String DecodedLogLine::format(bool include_location) const {
+    LogEntry entry;
+    entry.level = level;
+    entry.timestamp = timestamp;
+    entry.message = message;
+    entry.logger_name = std::format("T{}", thread);
+    String text = entry.format(false, false);
+    if (include_location && !file.empty()) text += std::format(" ({}:{})", file, line);
+    return text;
+}
+
+String render_format(StringView format, const std::vector<BinaryArg>& args) {
+    String out;
+    out.reserve(format.size() + args.size() * 8);
+    Size next_arg = 0;
+    for (Size i = 0; i < format.size(); ++i) {
+        const char ch = format[i];
+        if (ch == '}') {
+            if (i + 1 < format.size() && format[i + 1] == '}') ++i;
+            out += '}';
+            continue;
+        }
+        if (ch != '{') {
+            out += ch;
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '{') {
+            out += '{';
+            ++i;
+            continue;
+        }
+
+        const Size close = format.find('}', i);
+        if (close == StringView::npos) {
+            out.append(format.substr(i));
+            break;
+        }
+        StringView field = format.substr(i + 1, close - i - 1);
+        i = close;
+
+        // "{index:spec}", either part optional
+        const Size colon = field.find(':');
+        const StringView index = field.substr(0, colon);
+        const StringView spec = colon == StringView::npos ? StringView{} : field.substr(colon + 1);
+        Size arg = next_arg++;
+        if (!index.empty()) {
+            arg = 0;
+            for (char digit : index) arg = arg * 10 + static_cast<Size>(digit - '0');
+        }
+        if (arg >= args.size()) {
+            out += "{?}";
+            continue;
+        }
+        out += std::visit([spec](const auto& value) { return format_one(spec, value); }, args[arg]);
+    }
+    return out;
+}
+
+Result<std::vector<DecodedLogLine>> read_binary_log(const Path& path) {
+    using ResultType = std::vector<DecodedLogLine>;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return make_error<ResultType>(ErrorCode::IO_ERROR, std::format("Cannot open {}", path.string()));
+    std::vector<Byte> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if (data.size() < FILE_HEADER_SIZE) {
+        return make_error<ResultType>(ErrorCode::IO_ERROR, std::format("{} has no header", path.string()));
+    }
+    if (auto checked = check_file_header(data.data(), path); !checked) {
+        return make_error<ResultType>(checked.error());
+    }
+
+    // A frame cut short by a crash mid-write ends the log
+    std::unordered_map<UInt32, LogFormat> formats;
+    std::vector<DecodedLogLine> lines;
+    FrameReader reader(ConstByteSpan(data).subspan(FILE_HEADER_SIZE));
+    while (!reader.at_end()) {
+        UInt8 kind = 0;
+        reader.read(kind);
+        if (kind == static_cast<UInt8>(FrameKind::SESSION)) {
+            UInt64 started = 0;
+            if (!reader.read(started)) break;
+            formats.clear();
+        } else if (kind == static_cast<UInt8>(FrameKind::FORMAT)) {
+            LogFormat format;
+            UInt8 level = 0;
+            UInt16 file_length = 0;
+            UInt32 format_length = 0;
+            if (!reader.read(format.id) || !reader.read(level) || !reader.read(format.line) ||
+                !reader.read(file_length) || !reader.read(format.file, file_length) ||
+                !reader.read(format_length) || !reader.read(format.format, format_length)) {
+                break;
+            }
+            format.level = static_cast<LogLevel>(level);
+            formats[format.id] = std::move(format);
+        } else if (kind == static_cast<UInt8>(FrameKind::RECORD)) {
+            UInt32 thread = 0;
+            UInt32 size = 0;
+            FrameReader record(ConstByteSpan{});
+            if (!reader.read(thread) || !reader.read(size) || size < BinaryLog::RECORD_HEADER_SIZE ||
+                !reader.sub(record, size - sizeof(size))) {
+                break;
+            }
+            UInt32 format_id = 0;
+            UInt64 nanos = 0;
+            record.read(format_id);
+            record.read(nanos);
+
+            std::vector<BinaryArg> args;
+            while (!record.at_end()) {
+                BinaryArgType type{};
+                record.read(type);
+                switch (type) {
+                    case BinaryArgType::INT: { Int64 v = 0; record.read(v); args.emplace_back(v); break; }
+                    case BinaryArgType::UINT: { UInt64 v = 0; record.read(v); args.emplace_back(v); break; }
+                    case BinaryArgType::DOUBLE: { double v = 0; record.read(v); args.emplace_back(v); break; }
+                    case BinaryArgType::BOOL: { UInt8 v = 0; record.read(v); args.emplace_back(v != 0); break; }
+                    case BinaryArgType::CHAR: { char v = 0; record.read(v); args.emplace_back(v); break; }
+                    case BinaryArgType::STRING: {
+                        UInt32 length = 0;
+                        String v;
+                        record.read(length);
+                        record.read(v, length);
+                        args.emplace_back(std::move(v));
+                        break;
+                    }
+                    default:
+                        return make_error<ResultType>(ErrorCode::INVALID_ARGUMENT,
+                            std::format("{}: unknown argument type {}", path.string(), static_cast<int>(type)));
+                }
+            }
+
+            DecodedLogLine line;
+            line.timestamp = SystemTimePoint(std::chrono::duration_cast<SystemClock::duration>(Nanoseconds(nanos)));
+            line.thread = thread;
+            if (auto it = formats.find(format_id); it != formats.end()) {
+                line.level = it->second.level;
+                line.message = render_format(it->second.format, args);
+                line.file = it->second.file;
+                line.line = it->second.line;
+            } else {
+                line.message = std::format("<format {} not in log>", format_id);
+            }
+            lines.push_back(std::move(line));
+        } else {
+            return make_error<ResultType>(ErrorCode::INVALID_ARGUMENT,
+                std::format("{}: unknown frame type {}", path.string(), kind));
+        }
+    }
+    return make_success(std::move(lines));
+}
+
+} // namespace cics::logging
@@ -32,6 +32,8 @@ String CicsErrorCategory::message(int code) const {
         case ErrorCode::VSAM_END_OF_FILE: return "VSAM end of file";
         case ErrorCode::VSAM_DUPLICATE_KEY: return "VSAM duplicate key";
         case ErrorCode::VSAM_RECORD_NOT_FOUND: return "VSAM record not found";
+        case ErrorCode::VSAM_RECORD_BUSY: return "VSAM record locked by another task";
+        case ErrorCode::VSAM_DEADLOCK: return "VSAM record lock deadlock";
         case ErrorCode::CICS_ERROR: return "CICS error";
         case ErrorCode::CICS_ABEND: return "CICS abend";
         case ErrorCode::CICS_PROGRAM_NOT_FOUND: return "Program not found";
@@ -39,6 +41,7 @@ String CicsErrorCategory::message(int code) const {
         case ErrorCode::GDG_ERROR: return "GDG error";
         case ErrorCode::GDG_BASE_NOT_FOUND: return "GDG base not found";
         case ErrorCode::HSM_ERROR: return "HSM error";
+        case ErrorCode::SYSIDERR: return "Remote system not available";
         default: return "Unknown CICS error";
     }
 }
@@ -147,6 +150,7 @@ bool is_recoverable_error(ErrorCode code) {
         case ErrorCode::TIMEOUT:
         case ErrorCode::RESOURCE_EXHAUSTED:
         case ErrorCode::VSAM_END_OF_FILE:
+        case ErrorCode::VSAM_RECORD_BUSY:
         case ErrorCode::RECORD_NOT_FOUND:
             return true;
         default:
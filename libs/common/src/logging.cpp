@@ -6,18 +6,50 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace cics::logging {
 
+namespace {
+
+// Moves path to path.1, path.1 to path.2 and so on, dropping the oldest.
+// Both file sinks rotate through here; failures are ignored, since the
+// mapped sink rotates on its own thread
+void rotate_backup_chain(const Path& path, UInt32 max_backups) {
+    const auto backup = [&path](UInt32 n) { return Path(std::format("{}.{}", path.string(), n)); };
+    std::error_code ec;
+    for (UInt32 i = max_backups; i-- > 0;) {
+        const Path old_path = i > 0 ? backup(i) : path;
+        if (!std::filesystem::exists(old_path, ec)) continue;
+        if (i + 1 >= max_backups) std::filesystem::remove(old_path, ec);
+        else std::filesystem::rename(old_path, backup(i + 1), ec);
+    }
+}
+
+} // namespace
+
 // LogEntry implementation
 String LogEntry::format(bool colored, bool include_location) const {
     std::ostringstream oss;
     
     // Timestamp
     auto time_t = SystemClock::to_time_t(timestamp);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &time_t);
+#else
+    localtime_r(&time_t, &local);
+#endif
     auto ms = std::chrono::duration_cast<Milliseconds>(
         timestamp.time_since_epoch()) % 1000;
-    oss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    oss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
     oss << '.' << std::setfill('0') << std::setw(3) << ms.count();
     
     // Level with optional color
@@ -93,18 +125,214 @@ void FileSink::rotate_if_needed() {
 
 void FileSink::rotate_files() {
     file_.close();
-    for (int i = static_cast<int>(max_backup_count_) - 1; i >= 0; --i) {
-        Path old_path = file_path_.string() + (i > 0 ? "." + std::to_string(i) : "");
-        Path new_path = file_path_.string() + "." + std::to_string(i + 1);
-        if (std::filesystem::exists(old_path)) {
-            if (i + 1 >= static_cast<int>(max_backup_count_)) std::filesystem::remove(old_path);
-            else std::filesystem::rename(old_path, new_path);
-        }
-    }
+    rotate_backup_chain(file_path_, max_backup_count_);
     file_.open(file_path_, std::ios::out);
     current_size_ = 0;
 }
 
+// MappedFileSink implementation
+#ifdef _WIN32
+
+MappedFileSink::MappedFileSink(const Path& path, LogLevel level, Size segment_size, UInt32 max_backups)
+    : level_(level), file_path_(path), segment_size_(segment_size), max_backup_count_(max_backups),
+      fallback_(std::make_unique<FileSink>(path, level, segment_size, max_backups)) {}
+
+MappedFileSink::~MappedFileSink() = default;
+
+bool MappedFileSink::map_segment(Segment&, const Path&, Size) { return false; }
+void MappedFileSink::unmap_segment(Segment&, bool) {}
+bool MappedFileSink::switch_segment(Segment*) { return false; }
+void MappedFileSink::maintenance_loop() {}
+
+#else
+
+MappedFileSink::MappedFileSink(const Path& path, LogLevel level, Size segment_size, UInt32 max_backups)
+    : level_(level), file_path_(path), spare_path_(path.string() + ".next"),
+      segment_size_(std::max<Size>(segment_size, 4096)), max_backup_count_(max_backups) {
+    std::error_code ec;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), ec);
+    
+    // Carry on from an earlier run's file, as FileSink does
+    Size used = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    if (ec) used = 0;
+    if (used >= segment_size_) {
+        rotate_backup_chain(file_path_, max_backup_count_);
+        used = 0;
+    }
+    if (!map_segment(segments_[0], file_path_, used)) {
+        fallback_ = std::make_unique<FileSink>(path, level, segment_size, max_backups);
+        return;
+    }
+    current_.store(&segments_[0]);
+    maintenance_ = std::thread(&MappedFileSink::maintenance_loop, this);
+}
+
+MappedFileSink::~MappedFileSink() {
+    if (fallback_) return;
+    {
+        std::lock_guard<std::mutex> lock(rotate_mutex_);
+        stopping_ = true;
+    }
+    rotate_cv_.notify_all();
+    if (maintenance_.joinable()) maintenance_.join();
+    
+    if (Segment* current = current_.load()) unmap_segment(*current, true);
+    if (spare_ != nullptr) {
+        unmap_segment(*spare_, false);
+        std::error_code ec;
+        std::filesystem::remove(spare_path_, ec);
+    }
+}
+
+bool MappedFileSink::map_segment(Segment& segment, const Path& path, Size used) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    
+    // Reserve the blocks up front so a full disk fails here, not as SIGBUS
+    // on a store into the mapping; fall back where fallocate is unsupported
+    const int rc = ::posix_fallocate(fd, 0, static_cast<off_t>(segment_size_));
+    if (rc != 0 && ::ftruncate(fd, static_cast<off_t>(segment_size_)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void* base = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    segment.fd = fd;
+    segment.base = static_cast<Byte*>(base);
+    segment.capacity = segment_size_;
+    segment.tail.store(used);
+    segment.committed.store(used);
+    return true;
+}
+
+void MappedFileSink::unmap_segment(Segment& segment, bool keep) {
+    if (segment.base == nullptr) return;
+    ::munmap(segment.base, segment.capacity);
+    // Drop the preallocated tail so the file ends at its last line
+    if (keep) (void)::ftruncate(segment.fd, static_cast<off_t>(segment.committed.load()));
+    ::close(segment.fd);
+    segment.base = nullptr;
+    segment.fd = -1;
+}
+
+bool MappedFileSink::switch_segment(Segment* full) {
+    std::unique_lock<std::mutex> lock(rotate_mutex_);
+    // Everyone who overflowed the segment gets here; the first one switches
+    rotate_cv_.wait(lock, [&] {
+        return current_.load() != full || stopping_ || spare_failed_ ||
+            (spare_ != nullptr && retiring_ == nullptr);
+    });
+    if (current_.load() != full) return true;
+    if (spare_ == nullptr) return false;
+    
+    retiring_ = full;
+    current_.store(spare_);
+    spare_ = nullptr;
+    ++rotations_;
+    lock.unlock();
+    rotate_cv_.notify_all();
+    return true;
+}
+
+void MappedFileSink::maintenance_loop() {
+    std::unique_lock<std::mutex> lock(rotate_mutex_);
+    for (;;) {
+        rotate_cv_.wait(lock, [this] { return stopping_ || retiring_ != nullptr || spare_ == nullptr; });
+        
+        if (Segment* old = retiring_) {
+            lock.unlock();
+            // Writers that reserved space in it are still copying
+            while (old->writers.load() != 0) std::this_thread::yield();
+            unmap_segment(*old, true);
+            rotate_backup_chain(file_path_, max_backup_count_);
+            std::error_code ec;
+            std::filesystem::rename(spare_path_, file_path_, ec);
+            lock.lock();
+            retiring_ = nullptr;
+            rotate_cv_.notify_all();
+        }
+        if (stopping_) return;
+        
+        if (spare_ == nullptr) {
+            Segment* slot = nullptr;
+            for (auto& segment : segments_) {
+                if (&segment != current_.load() && segment.base == nullptr) slot = &segment;
+            }
+            lock.unlock();
+            const bool mapped = slot != nullptr && map_segment(*slot, spare_path_, 0);
+            lock.lock();
+            spare_failed_ = !mapped;
+            if (!mapped) {
+                // Writers drop lines while the disk refuses a new segment
+                rotate_cv_.notify_all();
+                rotate_cv_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_; });
+                continue;
+            }
+            spare_ = slot;
+            rotate_cv_.notify_all();
+        }
+    }
+}
+
+#endif // _WIN32
+
+void MappedFileSink::write(const LogEntry& entry) {
+    if (entry.level < level_) return;
+    if (fallback_) {
+        fallback_->write(entry);
+        return;
+    }
+    
+    const String line = entry.format(false, true) + "\n";
+    if (line.size() > segment_size_) {
+        ++dropped_;
+        return;
+    }
+    for (;;) {
+        Segment* segment = current_.load();
+        // Announce before re-checking, so a switch either sees this writer
+        // or this writer sees the switch
+        segment->writers.fetch_add(1);
+        if (current_.load() != segment) {
+            segment->writers.fetch_sub(1);
+            continue;
+        }
+        
+        const Size offset = segment->tail.fetch_add(line.size(), std::memory_order_relaxed);
+        if (offset + line.size() <= segment->capacity) {
+            std::memcpy(segment->base + offset, line.data(), line.size());
+            segment->committed.fetch_add(line.size(), std::memory_order_release);
+            segment->writers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        
+        // Space is handed out in order, so everything below the first
+        // overflowing reservation was written and nothing after it was
+        segment->writers.fetch_sub(1, std::memory_order_release);
+        if (!switch_segment(segment)) {
+            ++dropped_;
+            return;
+        }
+    }
+}
+
+void MappedFileSink::flush() {
+    if (fallback_) {
+        fallback_->flush();
+        return;
+    }
+#ifndef _WIN32
+    // Lines are in the page cache as soon as they are copied; start writeback
+    Segment* segment = current_.load();
+    segment->writers.fetch_add(1);
+    if (current_.load() == segment) ::msync(segment->base, segment->committed.load(), MS_ASYNC);
+    segment->writers.fetch_sub(1);
+#endif
+}
+
 // AsyncSink implementation
 AsyncSink::AsyncSink(UniquePtr<LogSink> sink)
     : inner_sink_(std::move(sink)), level_(LogLevel::TRACE) {
@@ -232,10 +460,14 @@ void LogManager::shutdown() {
     root_logger_->flush();
 }
 
-void LogManager::configure_default(LogLevel console_level, Optional<Path> log_file, LogLevel file_level) {
+void LogManager::configure_default(LogLevel console_level, Optional<Path> log_file, LogLevel file_level,
+                                   bool mapped_file) {
     root_logger_->remove_all_sinks();
     root_logger_->add_sink(std::make_shared<ConsoleSink>(console_level));
-    if (log_file) {
+    if (!log_file) return;
+    if (mapped_file) {
+        root_logger_->add_sink(std::make_shared<MappedFileSink>(*log_file, file_level, 10 * 1024 * 1024));
+    } else {
         root_logger_->add_sink(std::make_shared<FileSink>(*log_file, file_level));
     }
 }
@@ -0,0 +1,80 @@
+// =============================================================================
+// CICS Emulation - Interned Resource Names Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include "cics/common/name_table.hpp"
+
+namespace cics {
+
+namespace {
+
+std::atomic<UInt64> resource_changes{0};
+
+} // namespace
+
+NameTable& NameTable::instance() {
+    static NameTable table;
+    return table;
+}
+
+StringView NameTable::canonical(StringView name) {
+    while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+    return name;
+}
+
+NameId NameTable::find(StringView name) const {
+    name = canonical(name);
+    if (name.empty()) return NameId::NONE;
+
+    std::shared_lock lock(mutex_);
+    if (name.size() <= SHORT_NAME) {
+        auto it = short_names_.find(FixedString<SHORT_NAME>(name));
+        return it != short_names_.end() ? it->second : NameId::NONE;
+    }
+    auto it = long_names_.find(name);
+    return it != long_names_.end() ? it->second : NameId::NONE;
+}
+
+NameId NameTable::intern(StringView name) {
+    if (NameId id = find(name); id != NameId::NONE) return id;
+    name = canonical(name);
+    if (name.empty()) return NameId::NONE;
+
+    std::unique_lock lock(mutex_);
+    const auto next = static_cast<NameId>(names_.size() + 1);
+    NameId id;
+    if (name.size() <= SHORT_NAME) {
+        id = short_names_.try_emplace(FixedString<SHORT_NAME>(name), next).first->second;
+    } else {
+        id = long_names_.try_emplace(String(name), next).first->second;
+    }
+    if (id == next) names_.emplace_back(name);
+    return id;
+}
+
+StringView NameTable::name(NameId id) const {
+    const auto slot = static_cast<Size>(id);
+    std::shared_lock lock(mutex_);
+    if (slot == 0 || slot > names_.size()) return {};
+    return names_[slot - 1];
+}
+
+Size NameTable::size() const {
+    std::shared_lock lock(mutex_);
+    return names_.size();
+}
+
+// =============================================================================
+// Resource Changes
+// =============================================================================
+
+void note_resource_change() {
+    resource_changes.fetch_add(1, std::memory_order_release);
+}
+
+UInt64 resource_generation() {
+    return resource_changes.load(std::memory_order_acquire);
+}
+
+} // namespace cics
@@ -0,0 +1,97 @@
+// =============================================================================
+// CICS Emulation - Task Context Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include "cics/common/task_context.hpp"
+
+namespace cics {
+
+namespace {
+
+thread_local UInt32 bound_task_id = 0;
+thread_local TaskActivity* bound_activity = nullptr;
+
+// Constructed before any manager that registers a hook, so outlives them all
+struct EndHooks {
+    std::shared_mutex mutex;
+    std::vector<std::pair<UInt64, TaskEndHook>> hooks;
+    UInt64 next_id = 1;
+};
+
+EndHooks& end_hooks() {
+    static EndHooks hooks;
+    return hooks;
+}
+
+} // namespace
+
+UInt64 add_task_end_hook(TaskEndHook hook) {
+    auto& registry = end_hooks();
+    std::unique_lock lock(registry.mutex);
+    const UInt64 id = registry.next_id++;
+    registry.hooks.emplace_back(id, std::move(hook));
+    return id;
+}
+
+void remove_task_end_hook(UInt64 id) {
+    auto& registry = end_hooks();
+    std::unique_lock lock(registry.mutex);
+    std::erase_if(registry.hooks, [id](const auto& entry) { return entry.first == id; });
+}
+
+UInt32 current_task_id() {
+    return bound_task_id;
+}
+
+// =============================================================================
+// Task Activity
+// =============================================================================
+
+void note_wait(WaitType type, Duration waited) {
+    if (bound_activity) bound_activity->add_wait(type, waited);
+}
+
+void note_request(RequestType type, UInt64 bytes, UInt32 count) {
+    if (bound_activity) bound_activity->add_request(type, bytes, count);
+}
+
+void note_getmain(UInt64 bytes) {
+    if (bound_activity) bound_activity->add_getmain(bytes);
+}
+
+void note_freemain(UInt64 bytes) {
+    if (bound_activity) bound_activity->add_freemain(bytes);
+}
+
+WaitTimer::WaitTimer(WaitType type) : activity_(bound_activity), type_(type) {
+    if (activity_) start_ = Clock::now();
+}
+
+WaitTimer::~WaitTimer() {
+    if (activity_) activity_->add_wait(type_, Clock::now() - start_);
+}
+
+// =============================================================================
+// TaskBinding Implementation
+// =============================================================================
+
+TaskBinding::TaskBinding(UInt32 task_id, TaskActivity* activity)
+    : task_id_(task_id), previous_task_id_(bound_task_id), previous_activity_(bound_activity) {
+    bound_task_id = task_id;
+    bound_activity = activity;
+}
+
+void TaskBinding::end() {
+    if (ended_) return;
+    ended_ = true;
+    {
+        auto& registry = end_hooks();
+        std::shared_lock lock(registry.mutex);
+        for (const auto& [id, hook] : registry.hooks) hook(task_id_);
+    }
+    bound_task_id = previous_task_id_;
+    bound_activity = previous_activity_;
+}
+
+} // namespace cics
@@ -13,6 +13,7 @@
 #include <cics/common/error.hpp>
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <unordered_map>
 
 namespace cics {
@@ -83,8 +84,11 @@ struct CopybookField {
     std::vector<std::unique_ptr<CopybookField>> children;  // For group items
     CopybookField* parent = nullptr;
     
-    [[nodiscard]] bool is_group() const { return !children.empty(); }
-    [[nodiscard]] bool is_elementary() const { return children.empty() && level != 88; }
+    [[nodiscard]] bool is_group() const {
+        return std::any_of(children.begin(), children.end(),
+                           [](const auto& child) { return !child->is_condition(); });
+    }
+    [[nodiscard]] bool is_elementary() const { return !is_group() && !is_condition(); }
     [[nodiscard]] bool is_condition() const { return level == 88; }
     [[nodiscard]] bool is_array() const { return occurs > 0; }
     [[nodiscard]] UInt32 total_size() const;
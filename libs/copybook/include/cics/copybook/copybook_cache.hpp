@@ -0,0 +1,143 @@
+// =============================================================================
+// CICS Emulation - Copybook Layout Cache
+// Version: 3.4.6
+// =============================================================================
+// Keeps laid-out copybooks (fields, offsets and sizes already computed) in a
+// compact binary file keyed by a hash of each copybook's name and source. An
+// entry also records the name and the source's length and CRC-32, and is used
+// only if all three match, so two sources sharing a key never mix. At
+// region start the file is memory-mapped; a copybook whose source is
+// unchanged is decoded from the map on first use instead of being parsed,
+// and only new or edited copybooks go through CopybookParser:
+//
+//   auto cache = CopybookCache::open("copybooks.cache").value();
+//   auto library = cache->load_library("/prod/copylib");
+//   cache->save();
+//
+// The file is in native byte order; one written by another platform or
+// parser version is ignored, as is a damaged entry.
+// =============================================================================
+
+#ifndef CICS_COPYBOOK_CACHE_HPP
+#define CICS_COPYBOOK_CACHE_HPP
+
+#include <cics/copybook/copybook.hpp>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace cics {
+namespace copybook {
+
+// =============================================================================
+// Binary Layout Form
+// =============================================================================
+
+[[nodiscard]] ByteBuffer serialize_copybook(const CopybookDefinition& copybook);
+[[nodiscard]] Result<CopybookDefinition> deserialize_copybook(ConstByteSpan data);
+
+// =============================================================================
+// Copybook Library
+// =============================================================================
+
+struct CopybookLibrary {
+    // By member name: the file name without its extension, in upper case
+    std::unordered_map<String, SharedPtr<const CopybookDefinition>> copybooks;
+    std::vector<String> errors;     // "file: reason" for members that did not load
+    UInt32 from_cache = 0;
+    UInt32 parsed = 0;
+};
+
+// =============================================================================
+// Copybook Cache
+// =============================================================================
+
+struct CopybookCacheStatistics {
+    AtomicCounter<> hits;           // Decoded from the mapped file or already in memory
+    AtomicCounter<> misses;         // Parsed from source
+    AtomicCounter<> damaged;        // Mapped entries that failed to decode and were parsed again
+    AtomicCounter<> collisions;     // Keys whose entry held another name or source
+    AtomicCounter<> saves;
+
+    [[nodiscard]] String to_string() const;
+};
+
+class CopybookCache {
+public:
+    // Bumped whenever the parser's output or the binary form changes
+    static constexpr UInt32 FORMAT_VERSION = 2;
+
+    // A missing, foreign or stale file gives an empty cache
+    [[nodiscard]] static Result<UniquePtr<CopybookCache>> open(const Path& path);
+    ~CopybookCache();
+    CopybookCache(const CopybookCache&) = delete;
+    CopybookCache& operator=(const CopybookCache&) = delete;
+
+    // The layout of this source; parsed and added if the cache lacks it
+    Result<SharedPtr<const CopybookDefinition>> get(StringView name, StringView source);
+    Result<SharedPtr<const CopybookDefinition>> load_file(const Path& path);
+
+    // Every copybook in a directory (.cpy, .cbl, .cob, .copy), read and
+    // parsed on the global thread pool
+    [[nodiscard]] CopybookLibrary load_library(const Path& directory);
+
+    // Rewrites the file: entries used since open and everything added, plus
+    // the untouched mapped entries unless they are being pruned. The new file
+    // replaces the old by rename, so a reader never sees half of it.
+    Result<void> save(bool prune_unused = false);
+
+    [[nodiscard]] Size size() const;
+    [[nodiscard]] const Path& path() const { return path_; }
+    [[nodiscard]] const CopybookCacheStatistics& statistics() const { return stats_; }
+
+private:
+    // What a key cannot tell apart: checked on every hit
+    struct SourceCheck {
+        UInt64 length = 0;
+        UInt32 crc = 0;
+
+        [[nodiscard]] static SourceCheck of(StringView source);
+        bool operator==(const SourceCheck&) const = default;
+    };
+
+    struct IndexEntry {
+        UInt64 key;
+        UInt64 offset;
+        UInt64 length;
+        UInt64 source_length;
+        UInt32 source_crc;
+        UInt32 reserved;
+    };
+
+    struct Entry {
+        SharedPtr<const CopybookDefinition> definition;
+        SourceCheck check;
+    };
+
+    explicit CopybookCache(Path path) : path_(std::move(path)) {}
+
+    void map_file();
+    void unmap_file();
+    [[nodiscard]] const IndexEntry* find_mapped(UInt64 key) const;
+    Result<SharedPtr<const CopybookDefinition>> resolve(StringView name, StringView source,
+                                                        const Path* file, bool* parsed);
+
+    Path path_;
+    const Byte* mapped_ = nullptr;
+    Size mapped_size_ = 0;
+    ByteBuffer read_copy_;                  // The file's bytes where mmap is unavailable
+    const IndexEntry* index_ = nullptr;     // Sorted by key, inside the mapping
+    UInt32 index_count_ = 0;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<UInt64, Entry> loaded_;
+    std::unordered_set<UInt64> added_;      // Parsed this run; not in the mapping
+    CopybookCacheStatistics stats_;
+};
+
+// Key for a copybook's name and source text
+[[nodiscard]] UInt64 copybook_cache_key(StringView name, StringView source);
+
+} // namespace copybook
+} // namespace cics
+
+#endif // CICS_COPYBOOK_CACHE_HPP
@@ -0,0 +1,98 @@
+// =============================================================================
+// CICS Emulation - Copybook JSON Transformer
+// Version: 3.4.6
+// =============================================================================
+// Converts between JSON documents and fixed-layout records described by a
+// copybook, in the manner of the CICS JSON assistant. The copybook is
+// compiled once into a flat mapping plan; each conversion is then a single
+// pass over the input that writes straight into the output:
+//
+//   auto transformer = JsonTransformer::compile(copybook).value();
+//   auto record = transformer.to_record(R"({"CUST-ID": 42, "BALANCE": -1.5})");
+//   auto json = transformer.to_json(record.value());
+//
+// Groups map to objects and OCCURS to arrays. Alphanumeric fields are JSON
+// strings; zoned, packed and binary fields are JSON numbers (numeric strings
+// are accepted too) and are encoded digit by digit, never through a double.
+// FILLER, REDEFINES and 88-level entries have no JSON member.
+// =============================================================================
+
+#ifndef CICS_COPYBOOK_JSON_TRANSFORM_HPP
+#define CICS_COPYBOOK_JSON_TRANSFORM_HPP
+
+#include <cics/copybook/copybook.hpp>
+
+namespace cics {
+namespace copybook {
+
+// =============================================================================
+// Transform Options
+// =============================================================================
+
+enum class JsonNaming : UInt8 {
+    COBOL,          // Member names are the data names: "CUST-ID"
+    CAMEL_CASE      // As cobol_to_cpp_name: "custId"
+};
+
+struct JsonTransformOptions {
+    JsonNaming naming = JsonNaming::COBOL;
+    bool ebcdic = true;             // Character and zoned data in IBM-037, else ASCII
+    bool reject_unknown = false;    // A member with no field is an error, not skipped
+};
+
+// =============================================================================
+// JSON Transformer
+// =============================================================================
+
+class JsonTransformer {
+public:
+    enum class NodeKind : UInt8 { OBJECT, STRING, ZONED, PACKED, BINARY, FLOAT };
+
+    // One JSON member; an OBJECT's children are contiguous in the plan
+    struct Node {
+        String key;
+        NodeKind kind = NodeKind::OBJECT;
+        UInt32 offset = 0;          // Of the first occurrence
+        UInt32 size = 0;            // Of one occurrence
+        UInt16 occurs = 0;          // 0 = not an array
+        UInt16 digits = 0;
+        UInt16 scale = 0;
+        bool is_signed = false;
+        UInt32 first_child = 0;
+        UInt32 child_count = 0;
+    };
+
+    // The record is the single 01 level, or every top-level field if there
+    // are several
+    [[nodiscard]] static Result<JsonTransformer> compile(const CopybookDefinition& copybook,
+                                                         JsonTransformOptions options = {});
+
+    [[nodiscard]] UInt32 record_length() const { return record_length_; }
+    [[nodiscard]] const std::vector<Node>& plan() const { return nodes_; }
+
+    // Fields the document leaves out keep their initial value: spaces, or zero
+    Result<void> to_record(StringView json, ByteSpan record) const;
+    [[nodiscard]] Result<ByteBuffer> to_record(StringView json) const;
+
+    // Appends one JSON object; trailing blanks of character fields are dropped
+    Result<void> to_json(ConstByteSpan record, String& out) const;
+    [[nodiscard]] Result<String> to_json(ConstByteSpan record) const;
+
+private:
+    JsonTransformer() = default;
+
+    Result<void> add_members(UInt32 parent, const std::vector<std::unique_ptr<CopybookField>>& fields,
+                             UInt32 occurrences);
+    void fill_initial(const Node& object, UInt32 shift);
+
+    JsonTransformOptions options_;
+    std::vector<Node> nodes_;       // nodes_[0] is the record
+    ByteBuffer initial_;            // The record before any member is applied
+    UInt32 record_length_ = 0;
+    Size json_size_hint_ = 0;       // Keys and punctuation for a whole record
+};
+
+} // namespace copybook
+} // namespace cics
+
+#endif // CICS_COPYBOOK_JSON_TRANSFORM_HPP
@@ -403,6 +403,11 @@ String CopybookParser::read_picture() {
     String pic;
     while (!at_end()) {
         char c = peek();
+        // A period followed by a blank ends the entry, not the picture
+        if (c == '.' && (position_ + 1 >= source_.length() ||
+                         std::isspace(static_cast<unsigned char>(source_[position_ + 1])))) {
+            break;
+        }
         if (std::isalnum(c) || c == '(' || c == ')' || c == 'V' || c == 'S' ||
             c == '.' || c == ',' || c == '+' || c == '-' || c == '*' ||
             c == 'Z' || c == '$' || c == 'P') {
@@ -465,20 +470,18 @@ Result<CopybookDefinition> CopybookParser::parse(StringView source) {
                 }
             } else if (upper_word == "COMP" || upper_word == "BINARY" || upper_word == "COMP-4") {
                 field->usage = UsageClause::COMP;
-                field->picture.type = DataType::NUMERIC_BINARY;
-                field->size = comp_storage_size(field->picture.total_digits);
+            } else if (upper_word == "COMP-5") {
+                field->usage = UsageClause::COMP_5;
             } else if (upper_word == "COMP-1") {
                 field->usage = UsageClause::COMP_1;
-                field->picture.type = DataType::NUMERIC_FLOAT;
-                field->size = 4;
             } else if (upper_word == "COMP-2") {
                 field->usage = UsageClause::COMP_2;
-                field->picture.type = DataType::NUMERIC_FLOAT;
-                field->size = 8;
             } else if (upper_word == "COMP-3" || upper_word == "PACKED-DECIMAL") {
                 field->usage = UsageClause::COMP_3;
-                field->picture.type = DataType::NUMERIC_PACKED;
-                field->size = static_cast<UInt16>((field->picture.total_digits + 2) / 2);
+            } else if (word.empty()) {
+                // Punctuation this parser does not model, such as the commas
+                // between VALUE literals
+                advance();
             } else if (upper_word == "OCCURS") {
                 skip_whitespace();
                 String count = read_word();
@@ -511,6 +514,29 @@ Result<CopybookDefinition> CopybookParser::parse(StringView source) {
         // Skip period
         match('.');
         
+        // USAGE may come before or after PIC; apply it once both are known
+        switch (field->usage) {
+            case UsageClause::COMP:
+            case UsageClause::COMP_5:
+                field->picture.type = DataType::NUMERIC_BINARY;
+                field->size = comp_storage_size(field->picture.total_digits);
+                break;
+            case UsageClause::COMP_1:
+                field->picture.type = DataType::NUMERIC_FLOAT;
+                field->size = 4;
+                break;
+            case UsageClause::COMP_2:
+                field->picture.type = DataType::NUMERIC_FLOAT;
+                field->size = 8;
+                break;
+            case UsageClause::COMP_3:
+                field->picture.type = DataType::NUMERIC_PACKED;
+                field->size = static_cast<UInt16>((field->picture.total_digits + 2) / 2);
+                break;
+            default:
+                break;
+        }
+        
         // If no size set and no PIC, it's a group
         if (field->size == 0 && field->picture.raw_picture.empty()) {
             field->picture.type = DataType::GROUP;
@@ -579,23 +605,32 @@ void CopybookParser::calculate_offsets(CopybookDefinition& copybook) {
     std::function<void(std::vector<std::unique_ptr<CopybookField>>&)> calc;
     calc = [&](std::vector<std::unique_ptr<CopybookField>>& fields) {
         for (auto& field : fields) {
+            // 88-levels name values of their parent and take no storage
+            if (field->is_condition()) continue;
+            
+            UInt32 start = offset;
             if (!field->redefines.empty()) {
                 // REDEFINES - use same offset as redefined field
                 if (auto redef = copybook.find_field(field->redefines)) {
-                    field->offset = redef->offset;
+                    start = redef->offset;
                 }
-            } else {
-                field->offset = offset;
+            }
+            field->offset = start;
+            for (auto& child : field->children) {
+                if (child->is_condition()) child->offset = start;
             }
             
             if (field->is_group()) {
-                UInt32 group_start = offset;
+                // Children are laid out for the first occurrence
+                const UInt32 following = offset;
+                offset = start;
                 calc(field->children);
-                field->size = static_cast<UInt16>(offset - group_start);
+                field->size = static_cast<UInt16>(offset - start);
+                offset = following;
             }
             
             if (field->redefines.empty()) {
-                offset += field->total_size();
+                offset = start + field->total_size();
             }
         }
     };
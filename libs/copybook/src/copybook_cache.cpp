@@ -0,0 +1,488 @@
+// =============================================================================
+// CICS Emulation - Copybook Layout Cache Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include <cics/copybook/copybook_cache.hpp>
+#include <cics/common/threading.hpp>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cics {
+namespace copybook {
+
+namespace {
+
+constexpr UInt64 CACHE_MAGIC = 0x4548434B42595043ULL;   // "CPYBKCHE" on little-endian
+constexpr UInt32 MAX_FIELD_DEPTH = 64;
+
+struct FileHeader {
+    UInt64 magic;
+    UInt32 version;
+    UInt32 entry_count;
+    UInt64 index_offset;
+    UInt64 file_size;
+};
+
+// =============================================================================
+// Binary Form
+// =============================================================================
+
+class BlobWriter {
+public:
+    explicit BlobWriter(ByteBuffer& out) : out_(out) {}
+
+    template<typename T>
+    void put(T value) {
+        const auto* bytes = reinterpret_cast<const Byte*>(&value);
+        out_.insert(out_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void put_string(StringView text) {
+        put(static_cast<UInt32>(text.size()));
+        out_.insert(out_.end(), text.begin(), text.end());
+    }
+
+    void put_fields(const std::vector<std::unique_ptr<CopybookField>>& fields) {
+        put(static_cast<UInt32>(fields.size()));
+        for (const auto& field : fields) {
+            put(field->level);
+            put(static_cast<UInt8>(field->usage));
+            put(static_cast<UInt8>(field->picture.type));
+            put(static_cast<UInt8>((field->picture.is_signed ? 1 : 0) | (field->picture.has_decimal ? 2 : 0)));
+            put(field->picture.sign_position);
+            put(field->picture.total_digits);
+            put(field->picture.decimal_digits);
+            put(field->occurs);
+            put(field->occurs_min);
+            put(field->size);
+            put(field->offset);
+            put_string(field->name);
+            put_string(field->picture.raw_picture);
+            put_string(field->occurs_depending);
+            put_string(field->redefines);
+            put_string(field->value);
+            put_fields(field->children);
+        }
+    }
+
+private:
+    ByteBuffer& out_;
+};
+
+class BlobReader {
+public:
+    explicit BlobReader(ConstByteSpan data) : data_(data) {}
+
+    template<typename T>
+    bool get(T& value) {
+        if (data_.size() - position_ < sizeof(T)) return false;
+        std::memcpy(&value, data_.data() + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+
+    bool get_string(String& text) {
+        UInt32 length = 0;
+        if (!get(length) || data_.size() - position_ < length) return false;
+        text.assign(reinterpret_cast<const char*>(data_.data() + position_), length);
+        position_ += length;
+        return true;
+    }
+
+    bool get_fields(std::vector<std::unique_ptr<CopybookField>>& fields, CopybookField* parent,
+                    UInt32 depth) {
+        UInt32 count = 0;
+        if (depth > MAX_FIELD_DEPTH || !get(count)) return false;
+        for (UInt32 i = 0; i < count; ++i) {
+            auto field = std::make_unique<CopybookField>();
+            UInt8 usage = 0;
+            UInt8 type = 0;
+            UInt8 flags = 0;
+            if (!get(field->level) || !get(usage) || !get(type) || !get(flags) ||
+                !get(field->picture.sign_position) || !get(field->picture.total_digits) ||
+                !get(field->picture.decimal_digits) || !get(field->occurs) ||
+                !get(field->occurs_min) || !get(field->size) || !get(field->offset) ||
+                !get_string(field->name) || !get_string(field->picture.raw_picture) ||
+                !get_string(field->occurs_depending) || !get_string(field->redefines) ||
+                !get_string(field->value)) {
+                return false;
+            }
+            if (usage > static_cast<UInt8>(UsageClause::INDEX) || type > static_cast<UInt8>(DataType::FILLER)) {
+                return false;
+            }
+            field->usage = static_cast<UsageClause>(usage);
+            field->picture.type = static_cast<DataType>(type);
+            field->picture.is_signed = (flags & 1) != 0;
+            field->picture.has_decimal = (flags & 2) != 0;
+            field->parent = parent;
+            if (!get_fields(field->children, field.get(), depth + 1)) return false;
+            fields.push_back(std::move(field));
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool at_end() const { return position_ == data_.size(); }
+
+private:
+    ConstByteSpan data_;
+    Size position_ = 0;
+};
+
+Result<String> read_source(const Path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return make_error<String>(ErrorCode::FILE_NOT_FOUND, "Cannot open file: " + path.string());
+    }
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    return make_success(ss.str());
+}
+
+bool is_copybook_file(const Path& path) {
+    String extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".cpy" || extension == ".cbl" || extension == ".cob" || extension == ".copy";
+}
+
+String member_name(const Path& path) {
+    String name = path.stem().string();
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    return name;
+}
+
+} // namespace
+
+// =============================================================================
+// Binary Layout Form
+// =============================================================================
+
+ByteBuffer serialize_copybook(const CopybookDefinition& copybook) {
+    ByteBuffer out;
+    BlobWriter writer(out);
+    writer.put_string(copybook.name);
+    writer.put_string(copybook.source_file);
+    writer.put(copybook.record_length);
+    writer.put_fields(copybook.fields);
+    return out;
+}
+
+Result<CopybookDefinition> deserialize_copybook(ConstByteSpan data) {
+    CopybookDefinition copybook;
+    BlobReader reader(data);
+    if (!reader.get_string(copybook.name) || !reader.get_string(copybook.source_file) ||
+        !reader.get(copybook.record_length) || !reader.get_fields(copybook.fields, nullptr, 0) ||
+        !reader.at_end()) {
+        return make_error<CopybookDefinition>(ErrorCode::MEMORY_CORRUPTION, "Damaged copybook layout");
+    }
+    return make_success(std::move(copybook));
+}
+
+UInt64 copybook_cache_key(StringView name, StringView source) {
+    String keyed;
+    keyed.reserve(name.size() + 1 + source.size());
+    keyed.append(name);
+    keyed += '\0';
+    keyed.append(source);
+    return fnv1a_hash(ConstByteSpan(reinterpret_cast<const Byte*>(keyed.data()), keyed.size()));
+}
+
+// =============================================================================
+// CopybookCache Implementation
+// =============================================================================
+
+String CopybookCacheStatistics::to_string() const {
+    return std::format("Copybook cache: hits {}, misses {}, damaged {}, collisions {}, saves {}",
+        hits.get(), misses.get(), damaged.get(), collisions.get(), saves.get());
+}
+
+CopybookCache::SourceCheck CopybookCache::SourceCheck::of(StringView source) {
+    return {source.size(), crc32(ConstByteSpan(reinterpret_cast<const Byte*>(source.data()), source.size()))};
+}
+
+Result<UniquePtr<CopybookCache>> CopybookCache::open(const Path& path) {
+    if (path.empty()) {
+        return make_error<UniquePtr<CopybookCache>>(ErrorCode::INVALID_ARGUMENT, "Cache path is empty");
+    }
+    UniquePtr<CopybookCache> cache(new CopybookCache(path));
+    cache->map_file();
+    return make_success(std::move(cache));
+}
+
+CopybookCache::~CopybookCache() {
+    unmap_file();
+}
+
+void CopybookCache::map_file() {
+#ifdef _WIN32
+    std::ifstream file(path_, std::ios::binary);
+    if (!file) return;
+    read_copy_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    mapped_ = read_copy_.data();
+    mapped_size_ = read_copy_.size();
+#else
+    const int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<Size>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        return;
+    }
+    void* mapped = ::mmap(nullptr, static_cast<Size>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return;
+    mapped_ = static_cast<const Byte*>(mapped);
+    mapped_size_ = static_cast<Size>(st.st_size);
+#endif
+
+    // Anything that does not check out is ignored, and the cache starts empty
+    FileHeader header{};
+    if (mapped_size_ >= sizeof(header)) std::memcpy(&header, mapped_, sizeof(header));
+    const UInt64 index_bytes = static_cast<UInt64>(header.entry_count) * sizeof(IndexEntry);
+    if (header.magic != CACHE_MAGIC || header.version != FORMAT_VERSION ||
+        header.file_size != mapped_size_ || header.index_offset % alignof(IndexEntry) != 0 ||
+        header.index_offset < sizeof(header) || header.index_offset > mapped_size_ ||
+        index_bytes > mapped_size_ - header.index_offset) {
+        unmap_file();
+        return;
+    }
+    index_ = reinterpret_cast<const IndexEntry*>(mapped_ + header.index_offset);
+    index_count_ = header.entry_count;
+    for (UInt32 i = 0; i < index_count_; ++i) {
+        const IndexEntry& entry = index_[i];
+        if (entry.offset < sizeof(header) || entry.offset > header.index_offset ||
+            entry.length > header.index_offset - entry.offset ||
+            (i > 0 && index_[i - 1].key >= entry.key)) {
+            unmap_file();
+            return;
+        }
+    }
+}
+
+void CopybookCache::unmap_file() {
+#ifndef _WIN32
+    if (mapped_ != nullptr && read_copy_.empty()) {
+        ::munmap(const_cast<Byte*>(mapped_), mapped_size_);
+    }
+#endif
+    read_copy_.clear();
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    index_ = nullptr;
+    index_count_ = 0;
+}
+
+const CopybookCache::IndexEntry* CopybookCache::find_mapped(UInt64 key) const {
+    const IndexEntry* end = index_ + index_count_;
+    const IndexEntry* it = std::lower_bound(index_, end, key,
+        [](const IndexEntry& entry, UInt64 wanted) { return entry.key < wanted; });
+    return it != end && it->key == key ? it : nullptr;
+}
+
+Result<SharedPtr<const CopybookDefinition>> CopybookCache::get(StringView name, StringView source) {
+    return resolve(name, source, nullptr, nullptr);
+}
+
+Result<SharedPtr<const CopybookDefinition>> CopybookCache::resolve(StringView name, StringView source,
+                                                                   const Path* file, bool* parsed) {
+    using Definition = SharedPtr<const CopybookDefinition>;
+    const UInt64 key = copybook_cache_key(name, source);
+    const SourceCheck check = SourceCheck::of(source);
+    bool collided = false;
+    {
+        std::shared_lock lock(mutex_);
+        if (auto it = loaded_.find(key); it != loaded_.end()) {
+            if (it->second.check == check && it->second.definition->name == name) {
+                ++stats_.hits;
+                if (parsed) *parsed = false;
+                return make_success(it->second.definition);
+            }
+            collided = true;
+        }
+    }
+
+    // The mapping never changes once open, so decoding and parsing need no lock
+    Definition definition;
+    bool from_map = false;
+    const IndexEntry* entry = collided ? nullptr : find_mapped(key);
+    if (entry && SourceCheck{entry->source_length, entry->source_crc} != check) {
+        collided = true;
+        entry = nullptr;
+    }
+    if (entry) {
+        auto decoded = deserialize_copybook(ConstByteSpan(mapped_ + entry->offset, entry->length));
+        if (!decoded) {
+            ++stats_.damaged;
+        } else if (decoded.value().name != name) {
+            collided = true;
+        } else {
+            definition = std::make_shared<const CopybookDefinition>(std::move(decoded.value()));
+            from_map = true;
+            ++stats_.hits;
+        }
+    }
+    if (collided) ++stats_.collisions;
+    if (!definition) {
+        CopybookParser parser;
+        auto result = parser.parse(source);
+        if (!result) return make_error<Definition>(result.error());
+        result.value().name = String(name);
+        if (file) result.value().source_file = file->string();
+        definition = std::make_shared<const CopybookDefinition>(std::move(result.value()));
+        ++stats_.misses;
+    }
+    if (parsed) *parsed = !from_map;
+
+    // A key already held by another copybook keeps it; this one is not cached
+    std::unique_lock lock(mutex_);
+    auto [it, inserted] = loaded_.try_emplace(key, Entry{definition, check});
+    if (!inserted) {
+        const Entry& held = it->second;
+        if (held.check != check || held.definition->name != name) return make_success(definition);
+    }
+    if (inserted && !from_map) added_.insert(key);
+    return make_success(it->second.definition);
+}
+
+Result<SharedPtr<const CopybookDefinition>> CopybookCache::load_file(const Path& path) {
+    auto source = read_source(path);
+    if (!source) return make_error<SharedPtr<const CopybookDefinition>>(source.error());
+    return resolve(member_name(path), source.value(), &path, nullptr);
+}
+
+CopybookLibrary CopybookCache::load_library(const Path& directory) {
+    CopybookLibrary library;
+    std::vector<Path> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && is_copybook_file(entry.path())) files.push_back(entry.path());
+    }
+    if (ec) {
+        library.errors.push_back(std::format("{}: {}", directory.string(), ec.message()));
+        return library;
+    }
+    std::sort(files.begin(), files.end());
+
+    struct Loaded {
+        SharedPtr<const CopybookDefinition> definition;
+        String error;
+        bool parsed = false;
+    };
+    std::vector<Loaded> loaded(files.size());
+    std::vector<Size> order(files.size());
+    std::iota(order.begin(), order.end(), Size{0});
+
+    threading::parallel_for(order.begin(), order.end(), [&](Size i) {
+        auto source = read_source(files[i]);
+        if (!source) {
+            loaded[i].error = source.error().message;
+            return;
+        }
+        auto definition = resolve(member_name(files[i]), source.value(), &files[i], &loaded[i].parsed);
+        if (definition) {
+            loaded[i].definition = std::move(definition.value());
+        } else {
+            loaded[i].error = definition.error().message;
+        }
+    });
+
+    for (Size i = 0; i < files.size(); ++i) {
+        if (!loaded[i].definition) {
+            library.errors.push_back(std::format("{}: {}", files[i].string(), loaded[i].error));
+            continue;
+        }
+        ++(loaded[i].parsed ? library.parsed : library.from_cache);
+        library.copybooks[member_name(files[i])] = std::move(loaded[i].definition);
+    }
+    return library;
+}
+
+Result<void> CopybookCache::save(bool prune_unused) {
+    struct Pending {
+        UInt64 key;
+        ConstByteSpan blob;
+        SourceCheck check;
+    };
+    std::vector<Pending> entries;
+    std::vector<ByteBuffer> serialized;
+
+    std::shared_lock lock(mutex_);
+    serialized.reserve(added_.size());
+    for (const auto& [key, loaded] : loaded_) {
+        if (added_.contains(key)) {
+            serialized.push_back(serialize_copybook(*loaded.definition));
+            entries.push_back({key, ConstByteSpan(serialized.back()), loaded.check});
+        } else if (const IndexEntry* entry = find_mapped(key)) {
+            entries.push_back({key, ConstByteSpan(mapped_ + entry->offset, entry->length), loaded.check});
+        }
+    }
+    if (!prune_unused) {
+        for (UInt32 i = 0; i < index_count_; ++i) {
+            const IndexEntry& entry = index_[i];
+            if (!loaded_.contains(entry.key)) {
+                entries.push_back({entry.key, ConstByteSpan(mapped_ + entry.offset, entry.length),
+                                   SourceCheck{entry.source_length, entry.source_crc}});
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Pending& a, const Pending& b) { return a.key < b.key; });
+
+    // Blobs, then the index on an aligned offset, then the header over the front
+    std::vector<IndexEntry> index;
+    index.reserve(entries.size());
+    ByteBuffer image(sizeof(FileHeader));
+    for (const auto& entry : entries) {
+        index.push_back({entry.key, image.size(), entry.blob.size(), entry.check.length, entry.check.crc, 0});
+        image.insert(image.end(), entry.blob.begin(), entry.blob.end());
+    }
+    image.resize((image.size() + alignof(IndexEntry) - 1) / alignof(IndexEntry) * alignof(IndexEntry));
+    const UInt64 index_offset = image.size();
+    const auto* index_bytes = reinterpret_cast<const Byte*>(index.data());
+    image.insert(image.end(), index_bytes, index_bytes + index.size() * sizeof(IndexEntry));
+    const FileHeader header{CACHE_MAGIC, FORMAT_VERSION, static_cast<UInt32>(index.size()),
+                            index_offset, image.size()};
+    std::memcpy(image.data(), &header, sizeof(header));
+    lock.unlock();
+
+    Path temporary = path_;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()))) {
+            return make_error<void>(ErrorCode::WRITE_ERROR, "Cannot write " + temporary.string());
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, path_, ec);
+    if (ec) {
+        const String reason = ec.message();
+        std::filesystem::remove(temporary, ec);
+        return make_error<void>(ErrorCode::IO_ERROR, std::format("Cannot replace {}: {}", path_.string(), reason));
+    }
+    ++stats_.saves;
+    return make_success();
+}
+
+Size CopybookCache::size() const {
+    std::shared_lock lock(mutex_);
+    Size untouched = 0;
+    for (UInt32 i = 0; i < index_count_; ++i) {
+        if (!loaded_.contains(index_[i].key)) ++untouched;
+    }
+    return loaded_.size() + untouched;
+}
+
+} // namespace copybook
+} // namespace cics
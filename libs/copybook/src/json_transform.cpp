@@ -0,0 +1,880 @@
+// =============================================================================
+// CICS Emulation - Copybook JSON Transformer Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include <cics/copybook/json_transform.hpp>
+#include <cics/ebcdic/ebcdic.hpp>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <format>
+
+namespace cics {
+namespace copybook {
+
+namespace {
+
+using Node = JsonTransformer::Node;
+using NodeKind = JsonTransformer::NodeKind;
+
+// COBOL's limit for zoned and packed decimal
+constexpr UInt16 MAX_DECIMAL_DIGITS = 31;
+constexpr UInt16 MAX_BINARY_DIGITS = 18;
+constexpr UInt32 MAX_SKIP_DEPTH = 256;
+
+// =============================================================================
+// Record Character Set
+// =============================================================================
+
+struct Charset {
+    const std::array<Byte, 256>* encode;    // Latin-1 to record
+    const std::array<Byte, 256>* decode;    // Record to Latin-1
+    Byte space;
+    Byte digit_zone;
+    Byte positive_zone;                     // Zone of a signed field's last digit
+    Byte negative_zone;
+};
+
+const std::array<Byte, 256>& identity_table() {
+    static const auto table = [] {
+        std::array<Byte, 256> result{};
+        for (Size i = 0; i < result.size(); ++i) result[i] = static_cast<Byte>(i);
+        return result;
+    }();
+    return table;
+}
+
+const Charset& charset(bool ebcdic) {
+    static const Charset ebcdic_set{&ebcdic::ASCII_TO_EBCDIC, &ebcdic::EBCDIC_TO_ASCII,
+                                    0x40, 0xF0, 0xC0, 0xD0};
+    // ASCII zoned decimal carries a negative sign as zone 7, as Micro Focus does
+    static const Charset ascii_set{&identity_table(), &identity_table(), 0x20, 0x30, 0x30, 0x70};
+    return ebcdic ? ebcdic_set : ascii_set;
+}
+
+bool is_negative_zone(Byte zone, const Charset& chars) {
+    return chars.digit_zone == 0xF0 ? zone == 0xD0 || zone == 0xB0 : zone == 0x70;
+}
+
+// =============================================================================
+// Word-at-a-time Scanning
+// =============================================================================
+// Portable SIMD-within-a-register: each test sets the high bit of a byte that
+// matches. Borrows can also mark bytes after a true match, never before it,
+// so only the first marked byte is used.
+
+constexpr UInt64 ONES = 0x0101010101010101ULL;
+constexpr UInt64 HIGHS = 0x8080808080808080ULL;
+
+constexpr UInt64 zero_bytes(UInt64 word) { return (word - ONES) & ~word & HIGHS; }
+constexpr UInt64 bytes_below(UInt64 word, UInt8 limit) { return (word - ONES * limit) & ~word & HIGHS; }
+
+// Quotes, backslashes, control characters and anything outside ASCII
+constexpr UInt64 string_stops(UInt64 word) {
+    return zero_bytes(word ^ (ONES * '"')) | zero_bytes(word ^ (ONES * '\\')) |
+           bytes_below(word, 0x20) | (word & HIGHS);
+}
+
+inline UInt64 load_word(const void* p) {
+    UInt64 word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+inline Size first_marked(UInt64 mask) {
+    if constexpr (std::endian::native == std::endian::little) {
+        return static_cast<Size>(std::countr_zero(mask)) / 8;
+    } else {
+        return static_cast<Size>(std::countl_zero(mask)) / 8;
+    }
+}
+
+inline bool is_string_stop(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20 || c >= 0x80;
+}
+
+// The first byte at or after p that ends a run of plain string characters
+const char* scan_plain(const char* p, const char* end) {
+    while (end - p >= 8) {
+        if (UInt64 mask = string_stops(load_word(p))) return p + first_marked(mask);
+        p += 8;
+    }
+    while (p < end && !is_string_stop(static_cast<unsigned char>(*p))) ++p;
+    return p;
+}
+
+// Length of a field once its trailing blanks are dropped
+Size trimmed_length(const Byte* data, Size length, Byte space) {
+    const UInt64 blanks = ONES * space;
+    while (length >= 8 && load_word(data + length - 8) == blanks) length -= 8;
+    while (length > 0 && data[length - 1] == space) --length;
+    return length;
+}
+
+// Length of the JSON number at the start of [p, end), 0 if there is none
+Size number_length(const char* p, const char* end) {
+    const char* q = p;
+    auto digits = [&] {
+        const char* start = q;
+        while (q < end && *q >= '0' && *q <= '9') ++q;
+        return q != start;
+    };
+    if (q < end && *q == '-') ++q;
+    if (q < end && *q == '0') {
+        ++q;
+    } else if (!digits()) {
+        return 0;
+    }
+    if (q < end && *q == '.') {
+        ++q;
+        if (!digits()) return 0;
+    }
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        ++q;
+        if (q < end && (*q == '+' || *q == '-')) ++q;
+        if (!digits()) return 0;
+    }
+    return static_cast<Size>(q - p);
+}
+
+// =============================================================================
+// Decimal Encoding
+// =============================================================================
+
+// The digits of a JSON number times 10^scale, right-aligned in `digits`
+// places. Fraction digits beyond the scale are truncated, as a COBOL MOVE
+// does; integer digits that do not fit are an error.
+Result<bool> scale_digits(StringView number, const Node& node, Byte* out) {
+    const char* p = number.data();
+    const char* end = p + number.size();
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+
+    // Only as many significant digits as can survive are kept
+    constexpr Size KEEP = 64;
+    char significant[KEEP];
+    Size count = 0;
+    Int64 fraction = 0;
+    bool after_point = false;
+    for (; p < end && *p != 'e' && *p != 'E'; ++p) {
+        if (*p == '.') {
+            after_point = true;
+            continue;
+        }
+        if (after_point) ++fraction;
+        if (count == 0 && *p == '0') continue;
+        if (count < KEEP) significant[count] = *p;
+        ++count;
+    }
+    Int64 exponent = 0;
+    if (p < end) {
+        ++p;
+        const bool negative_exponent = *p == '-';
+        if (*p == '+' || *p == '-') ++p;
+        for (; p < end && exponent < 100000; ++p) exponent = exponent * 10 + (*p - '0');
+        if (negative_exponent) exponent = -exponent;
+    }
+
+    const Int64 shift = exponent - fraction + node.scale;
+    const Int64 kept = count == 0 ? 0 : std::max<Int64>(static_cast<Int64>(count) + shift, 0);
+    if (kept > node.digits) {
+        return make_error<bool>(ErrorCode::OUT_OF_RANGE,
+            std::format("{} does not fit {}: {} digits, {} after the point",
+                        number, node.key, node.digits, node.scale));
+    }
+
+    const Size width = static_cast<Size>(kept);
+    const Size from_number = std::min(width, count);
+    std::memset(out, 0, node.digits);
+    for (Size i = 0, at = node.digits - width; i < from_number && at < MAX_DECIMAL_DIGITS; ++i, ++at) {
+        out[at] = static_cast<Byte>(significant[i] - '0');
+    }
+
+    const bool zero = std::all_of(out, out + node.digits, [](Byte d) { return d == 0; });
+    return make_success(negative && !zero);
+}
+
+void put_zoned(const Byte* digits, bool negative, const Node& node, const Charset& chars, Byte* out) {
+    for (UInt16 i = 0; i < node.digits; ++i) out[i] = static_cast<Byte>(chars.digit_zone | digits[i]);
+    if (node.is_signed) {
+        const Byte zone = negative ? chars.negative_zone : chars.positive_zone;
+        out[node.digits - 1] = static_cast<Byte>(zone | digits[node.digits - 1]);
+    }
+}
+
+void put_packed(const Byte* digits, bool negative, const Node& node, Byte* out) {
+    std::memset(out, 0, node.size);
+    const Size sign = node.size * 2 - 1;          // Nibble index of the sign
+    Size nibble = sign - node.digits;
+    for (UInt16 i = 0; i < node.digits; ++i, ++nibble) {
+        out[nibble / 2] |= static_cast<Byte>(nibble % 2 == 0 ? digits[i] << 4 : digits[i]);
+    }
+    out[node.size - 1] |= static_cast<Byte>(node.is_signed ? (negative ? 0x0D : 0x0C) : 0x0F);
+}
+
+void put_binary(const Byte* digits, bool negative, const Node& node, Byte* out) {
+    UInt64 magnitude = 0;
+    for (UInt16 i = 0; i < node.digits; ++i) magnitude = magnitude * 10 + digits[i];
+    const UInt64 value = negative ? 0 - magnitude : magnitude;
+    switch (node.size) {
+        case 2: ebcdic::uint16_to_binary(static_cast<UInt16>(value), out); break;
+        case 4: ebcdic::uint32_to_binary(static_cast<UInt32>(value), out); break;
+        default: ebcdic::uint64_to_binary(value, out); break;
+    }
+}
+
+// =============================================================================
+// Decimal Decoding
+// =============================================================================
+
+// ASCII digits, most significant first, with the point `scale` from the right
+void append_scaled(String& out, bool negative, const char* digits, Size count, UInt16 scale) {
+    const Size integer = count > scale ? count - scale : 0;
+    Size first = 0;
+    while (first + 1 < integer && digits[first] == '0') ++first;
+    if (negative && std::any_of(digits, digits + count, [](char d) { return d != '0'; })) out += '-';
+    if (integer == 0) {
+        out += '0';
+    } else {
+        out.append(digits + first, integer - first);
+    }
+    if (scale > 0) {
+        out += '.';
+        if (count < scale) {
+            out.append(scale - count, '0');
+            out.append(digits, count);
+        } else {
+            out.append(digits + integer, scale);
+        }
+    }
+}
+
+Result<void> bad_data(const Node& node, StringView what, UInt32 offset) {
+    return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+        std::format("Invalid {} data in {} at offset {}", what, node.key, offset));
+}
+
+// =============================================================================
+// JSON Reader - a document into a record in one pass
+// =============================================================================
+
+class JsonReader {
+public:
+    JsonReader(StringView json, const std::vector<Node>& nodes, const JsonTransformOptions& options,
+               Byte* record)
+        : begin_(json.data()), p_(json.data()), end_(json.data() + json.size()),
+          nodes_(nodes), options_(options), chars_(charset(options.ebcdic)), record_(record) {}
+
+    Result<void> read() {
+        skip_whitespace();
+        if (auto result = object(nodes_[0], 0); !result) return result;
+        skip_whitespace();
+        if (p_ != end_) return fail("trailing characters after the document");
+        return make_success();
+    }
+
+private:
+    template<typename T = void>
+    Result<T> fail(StringView what) const {
+        return make_error<T>(ErrorCode::INVALID_ARGUMENT,
+            std::format("JSON offset {}: {}", p_ - begin_, what));
+    }
+
+    void skip_whitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(StringView word) {
+        if (static_cast<Size>(end_ - p_) < word.size() ||
+            std::memcmp(p_, word.data(), word.size()) != 0) {
+            return false;
+        }
+        p_ += word.size();
+        return true;
+    }
+
+    // Unescaped Latin-1 text; a view of the input unless it had escapes
+    Result<StringView> string(String& scratch) {
+        ++p_;   // Opening quote
+        const char* run = p_;
+        bool copied = false;
+        for (;;) {
+            p_ = scan_plain(p_, end_);
+            if (p_ == end_) return fail<StringView>("unterminated string");
+            const auto c = static_cast<unsigned char>(*p_);
+            if (c == '"') {
+                const StringView text(run, static_cast<Size>(p_ - run));
+                ++p_;
+                if (!copied) return make_success(text);
+                scratch.append(text);
+                return make_success(StringView(scratch));
+            }
+            if (!copied) {
+                scratch.clear();
+                copied = true;
+            }
+            scratch.append(run, p_);
+
+            UInt32 code_point = 0;
+            if (c == '\\') {
+                auto escaped = escape();
+                if (!escaped) return make_error<StringView>(escaped.error());
+                code_point = escaped.value();
+            } else if (c < 0x20) {
+                return fail<StringView>("control character in string");
+            } else if ((c & 0xE0) == 0xC0 && end_ - p_ >= 2 && (p_[1] & 0xC0) == 0x80) {
+                code_point = ((c & 0x1Fu) << 6) | (static_cast<unsigned char>(p_[1]) & 0x3Fu);
+                p_ += 2;
+            } else {
+                // Three- and four-byte sequences are all above U+00FF
+                return fail<StringView>("character has no single-byte equivalent");
+            }
+            if (code_point > 0xFF) return fail<StringView>("character has no single-byte equivalent");
+            scratch += static_cast<char>(code_point);
+            run = p_;
+        }
+    }
+
+    Result<UInt32> escape() {
+        if (end_ - p_ < 2) return fail<UInt32>("unterminated escape");
+        const char c = p_[1];
+        p_ += 2;
+        switch (c) {
+            case '"': return make_success<UInt32>('"');
+            case '\\': return make_success<UInt32>('\\');
+            case '/': return make_success<UInt32>('/');
+            case 'b': return make_success<UInt32>('\b');
+            case 'f': return make_success<UInt32>('\f');
+            case 'n': return make_success<UInt32>('\n');
+            case 'r': return make_success<UInt32>('\r');
+            case 't': return make_success<UInt32>('\t');
+            case 'u': {
+                UInt32 code_point = 0;
+                if (end_ - p_ < 4 ||
+                    std::from_chars(p_, p_ + 4, code_point, 16).ptr != p_ + 4) {
+                    return fail<UInt32>("bad \\u escape");
+                }
+                p_ += 4;
+                return make_success(code_point);
+            }
+            default:
+                return fail<UInt32>("bad escape");
+        }
+    }
+
+    Result<StringView> number() {
+        const Size length = number_length(p_, end_);
+        if (length == 0) return fail<StringView>("bad number");
+        const StringView text(p_, length);
+        p_ += length;
+        return make_success(text);
+    }
+
+    const Node* child(const Node& object, StringView key, UInt32& expected) const {
+        // Documents usually follow the copybook's order; try the next field first
+        if (expected < object.child_count) {
+            const Node& next = nodes_[object.first_child + expected];
+            if (next.key == key) {
+                ++expected;
+                return &next;
+            }
+        }
+        for (UInt32 i = 0; i < object.child_count; ++i) {
+            const Node& candidate = nodes_[object.first_child + i];
+            if (candidate.key == key) {
+                expected = i + 1;
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    Result<void> object(const Node& node, UInt32 shift) {
+        if (!consume('{')) return fail(std::format("expected an object for {}", node.key));
+        if (consume('}')) return make_success();
+        UInt32 expected = 0;
+        for (;;) {
+            skip_whitespace();
+            if (p_ == end_ || *p_ != '"') return fail("expected a member name");
+            auto key = string(key_scratch_);
+            if (!key) return make_error<void>(key.error());
+            if (!consume(':')) return fail("expected ':'");
+
+            if (const Node* field = child(node, key.value(), expected)) {
+                if (auto result = member(*field, shift); !result) return result;
+            } else if (options_.reject_unknown) {
+                return fail(std::format("no field for member {}", key.value()));
+            } else if (auto result = skip_value(0); !result) {
+                return result;
+            }
+
+            if (consume(',')) continue;
+            if (consume('}')) return make_success();
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    Result<void> member(const Node& node, UInt32 shift) {
+        skip_whitespace();
+        if (literal("null")) return make_success();
+        if (node.occurs == 0) return element(node, shift);
+
+        if (!consume('[')) return fail(std::format("expected an array for {}", node.key));
+        if (consume(']')) return make_success();
+        for (UInt32 i = 0;; ++i) {
+            if (i == node.occurs) {
+                return make_error<void>(ErrorCode::OUT_OF_RANGE,
+                    std::format("{} occurs {} times; the document has more", node.key, node.occurs));
+            }
+            skip_whitespace();
+            if (!literal("null")) {
+                if (auto result = element(node, shift + i * node.size); !result) return result;
+            }
+            if (consume(',')) continue;
+            if (consume(']')) return make_success();
+            return fail("expected ',' or ']'");
+        }
+    }
+
+    Result<void> element(const Node& node, UInt32 shift) {
+        if (node.kind == NodeKind::OBJECT) return object(node, shift);
+
+        Byte* out = record_ + node.offset + shift;
+        StringView text;
+        const bool quoted = p_ < end_ && *p_ == '"';
+        if (quoted) {
+            auto value = string(value_scratch_);
+            if (!value) return make_error<void>(value.error());
+            text = value.value();
+        } else if (p_ < end_ && (*p_ == '-' || (*p_ >= '0' && *p_ <= '9'))) {
+            auto value = number();
+            if (!value) return make_error<void>(value.error());
+            text = value.value();
+        } else {
+            return fail(std::format("expected a string or number for {}", node.key));
+        }
+
+        if (node.kind == NodeKind::STRING) return put_text(node, text, out);
+
+        // Numeric strings are accepted for numeric fields
+        if (quoted) {
+            while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+            while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+            if (text.empty() || number_length(text.data(), text.data() + text.size()) != text.size()) {
+                return fail(std::format("{} is not a number", node.key));
+            }
+        }
+        return put_number(node, text, out);
+    }
+
+    Result<void> put_text(const Node& node, StringView text, Byte* out) const {
+        if (text.size() > node.size) {
+            return make_error<void>(ErrorCode::OUT_OF_RANGE,
+                std::format("{} holds {} characters; the value has {}", node.key, node.size, text.size()));
+        }
+        const auto& encode = *chars_.encode;
+        for (Size i = 0; i < text.size(); ++i) out[i] = encode[static_cast<unsigned char>(text[i])];
+        std::memset(out + text.size(), chars_.space, node.size - text.size());
+        return make_success();
+    }
+
+    Result<void> put_number(const Node& node, StringView text, Byte* out) const {
+        if (node.kind == NodeKind::FLOAT) {
+            double value = 0;
+            if (std::from_chars(text.data(), text.data() + text.size(), value).ec != std::errc{}) {
+                return make_error<void>(ErrorCode::OUT_OF_RANGE,
+                    std::format("{} is out of range for {}", text, node.key));
+            }
+            if (node.size == 4) {
+                ebcdic::uint32_to_binary(std::bit_cast<UInt32>(static_cast<float>(value)), out);
+            } else {
+                ebcdic::uint64_to_binary(std::bit_cast<UInt64>(value), out);
+            }
+            return make_success();
+        }
+
+        Byte digits[MAX_DECIMAL_DIGITS];
+        auto negative = scale_digits(text, node, digits);
+        if (!negative) return make_error<void>(negative.error());
+        if (negative.value() && !node.is_signed) {
+            return make_error<void>(ErrorCode::OUT_OF_RANGE,
+                std::format("{} is unsigned; the value is {}", node.key, text));
+        }
+        switch (node.kind) {
+            case NodeKind::ZONED: put_zoned(digits, negative.value(), node, chars_, out); break;
+            case NodeKind::PACKED: put_packed(digits, negative.value(), node, out); break;
+            default: put_binary(digits, negative.value(), node, out); break;
+        }
+        return make_success();
+    }
+
+    Result<void> skip_value(UInt32 depth) {
+        if (depth > MAX_SKIP_DEPTH) return fail("document nested too deeply");
+        skip_whitespace();
+        if (p_ == end_) return fail("expected a value");
+        switch (*p_) {
+            case '"': {
+                auto text = string(value_scratch_);
+                return text ? make_success() : make_error<void>(text.error());
+            }
+            case '{':
+            case '[': {
+                const char close = *p_ == '{' ? '}' : ']';
+                ++p_;
+                if (consume(close)) return make_success();
+                for (;;) {
+                    if (close == '}') {
+                        skip_whitespace();
+                        if (p_ == end_ || *p_ != '"') return fail("expected a member name");
+                        if (auto key = string(key_scratch_); !key) return make_error<void>(key.error());
+                        if (!consume(':')) return fail("expected ':'");
+                    }
+                    if (auto result = skip_value(depth + 1); !result) return result;
+                    if (consume(',')) continue;
+                    if (consume(close)) return make_success();
+                    return fail("expected ',' or a closing bracket");
+                }
+            }
+            default:
+                if (literal("true") || literal("false") || literal("null")) return make_success();
+                auto value = number();
+                return value ? make_success() : make_error<void>(value.error());
+        }
+    }
+
+    const char* begin_;
+    const char* p_;
+    const char* end_;
+    const std::vector<Node>& nodes_;
+    const JsonTransformOptions& options_;
+    const Charset& chars_;
+    Byte* record_;
+    String key_scratch_;
+    String value_scratch_;
+};
+
+// =============================================================================
+// JSON Writer - a record into a document in one pass
+// =============================================================================
+
+class JsonWriter {
+public:
+    JsonWriter(const std::vector<Node>& nodes, bool ebcdic, const Byte* record, String& out)
+        : nodes_(nodes), chars_(charset(ebcdic)), record_(record), out_(out) {}
+
+    Result<void> object(const Node& node, UInt32 shift) {
+        out_ += '{';
+        for (UInt32 i = 0; i < node.child_count; ++i) {
+            const Node& field = nodes_[node.first_child + i];
+            if (i > 0) out_ += ',';
+            out_ += '"';
+            out_ += field.key;
+            out_ += "\":";
+            if (field.occurs == 0) {
+                if (auto result = element(field, shift); !result) return result;
+                continue;
+            }
+            out_ += '[';
+            for (UInt32 n = 0; n < field.occurs; ++n) {
+                if (n > 0) out_ += ',';
+                if (auto result = element(field, shift + n * field.size); !result) return result;
+            }
+            out_ += ']';
+        }
+        out_ += '}';
+        return make_success();
+    }
+
+private:
+    Result<void> element(const Node& node, UInt32 shift) {
+        const UInt32 offset = node.offset + shift;
+        const Byte* data = record_ + offset;
+        switch (node.kind) {
+            case NodeKind::OBJECT: return object(node, shift);
+            case NodeKind::STRING: text(data, node.size); return make_success();
+            case NodeKind::ZONED: return zoned(node, data, offset);
+            case NodeKind::PACKED: return packed(node, data, offset);
+            case NodeKind::BINARY: binary(node, data); return make_success();
+            case NodeKind::FLOAT: floating(node, data); return make_success();
+        }
+        return make_success();
+    }
+
+    void text(const Byte* data, Size length) {
+        length = trimmed_length(data, length, chars_.space);
+        // Room for every character escaped as \u00XX
+        const Size start = out_.size();
+        out_.resize(start + length * 6 + 2);
+        char* out = out_.data() + start;
+        *out++ = '"';
+        const auto& decode = *chars_.decode;
+        for (Size i = 0; i < length; ++i) {
+            const Byte c = decode[data[i]];
+            if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+                *out++ = static_cast<char>(c);
+            } else if (c >= 0x80) {
+                *out++ = static_cast<char>(0xC0 | (c >> 6));
+                *out++ = static_cast<char>(0x80 | (c & 0x3F));
+            } else if (c == '"' || c == '\\') {
+                *out++ = '\\';
+                *out++ = static_cast<char>(c);
+            } else {
+                static constexpr char HEX[] = "0123456789abcdef";
+                std::memcpy(out, "\\u00", 4);
+                out[4] = HEX[c >> 4];
+                out[5] = HEX[c & 0x0F];
+                out += 6;
+            }
+        }
+        *out++ = '"';
+        out_.resize(static_cast<Size>(out - out_.data()));
+    }
+
+    Result<void> zoned(const Node& node, const Byte* data, UInt32 offset) {
+        char digits[MAX_DECIMAL_DIGITS];
+        for (UInt16 i = 0; i < node.digits; ++i) {
+            const Byte digit = data[i] & 0x0F;
+            if (digit > 9) return bad_data(node, "zoned decimal", offset);
+            digits[i] = static_cast<char>('0' + digit);
+        }
+        const bool negative = node.is_signed && is_negative_zone(data[node.digits - 1] & 0xF0, chars_);
+        append_scaled(out_, negative, digits, node.digits, node.scale);
+        return make_success();
+    }
+
+    Result<void> packed(const Node& node, const Byte* data, UInt32 offset) {
+        char digits[MAX_DECIMAL_DIGITS + 1];
+        const Size count = node.size * 2 - 1;
+        for (Size nibble = 0; nibble < count; ++nibble) {
+            const Byte byte = data[nibble / 2];
+            const Byte digit = nibble % 2 == 0 ? byte >> 4 : byte & 0x0F;
+            if (digit > 9) return bad_data(node, "packed decimal", offset);
+            digits[nibble] = static_cast<char>('0' + digit);
+        }
+        const Byte sign = data[node.size - 1] & 0x0F;
+        if (sign < 0x0A) return bad_data(node, "packed decimal", offset);
+        append_scaled(out_, sign == 0x0B || sign == 0x0D, digits, count, node.scale);
+        return make_success();
+    }
+
+    void binary(const Node& node, const Byte* data) {
+        Int64 value = 0;
+        UInt64 magnitude = 0;
+        switch (node.size) {
+            case 2: value = node.is_signed ? ebcdic::binary_to_int16(data) : ebcdic::binary_to_uint16(data); break;
+            case 4: value = node.is_signed ? ebcdic::binary_to_int32(data) : ebcdic::binary_to_uint32(data); break;
+            default:
+                if (!node.is_signed) {
+                    magnitude = ebcdic::binary_to_uint64(data);
+                    break;
+                }
+                value = ebcdic::binary_to_int64(data);
+                break;
+        }
+        const bool negative = value < 0;
+        if (magnitude == 0) magnitude = negative ? 0 - static_cast<UInt64>(value) : static_cast<UInt64>(value);
+        char digits[24];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), magnitude).ptr;
+        append_scaled(out_, negative, digits, static_cast<Size>(end - digits), node.scale);
+    }
+
+    void floating(const Node& node, const Byte* data) {
+        const double value = node.size == 4
+            ? static_cast<double>(std::bit_cast<float>(ebcdic::binary_to_uint32(data)))
+            : std::bit_cast<double>(ebcdic::binary_to_uint64(data));
+        if (!std::isfinite(value)) {
+            out_ += "null";
+            return;
+        }
+        char digits[32];
+        const auto end = node.size == 4
+            ? std::to_chars(digits, digits + sizeof(digits), static_cast<float>(value)).ptr
+            : std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        out_.append(digits, end);
+    }
+
+    const std::vector<Node>& nodes_;
+    const Charset& chars_;
+    const Byte* record_;
+    String& out_;
+};
+
+bool is_edited(StringView picture) {
+    return picture.find_first_of("Z*$,.+-") != StringView::npos;
+}
+
+} // namespace
+
+// =============================================================================
+// JsonTransformer Implementation
+// =============================================================================
+
+Result<JsonTransformer> JsonTransformer::compile(const CopybookDefinition& copybook,
+                                                 JsonTransformOptions options) {
+    if (copybook.record_length == 0) {
+        return make_error<JsonTransformer>(ErrorCode::INVALID_ARGUMENT,
+            "Copybook " + copybook.name + " describes no storage");
+    }
+
+    JsonTransformer transformer;
+    transformer.options_ = options;
+    transformer.record_length_ = copybook.record_length;
+    transformer.nodes_.emplace_back().size = copybook.record_length;
+
+    const bool single_record = copybook.fields.size() == 1 && copybook.fields.front()->is_group();
+    const auto& members = single_record ? copybook.fields.front()->children : copybook.fields;
+    if (auto result = transformer.add_members(0, members, 1); !result) {
+        return make_error<JsonTransformer>(result.error());
+    }
+
+    transformer.initial_.assign(copybook.record_length, charset(options.ebcdic).space);
+    transformer.fill_initial(transformer.nodes_[0], 0);
+    transformer.json_size_hint_ += 2;
+    return make_success(std::move(transformer));
+}
+
+Result<void> JsonTransformer::add_members(UInt32 parent,
+                                          const std::vector<std::unique_ptr<CopybookField>>& fields,
+                                          UInt32 occurrences) {
+    std::vector<const CopybookField*> members;
+    for (const auto& field : fields) {
+        if (field->is_condition() || field->level == 66 || !field->redefines.empty()) continue;
+        if (field->name.empty() || field->name == "FILLER") continue;
+        members.push_back(field.get());
+    }
+
+    // Siblings are contiguous; groups append their own children afterwards
+    const auto first = static_cast<UInt32>(nodes_.size());
+    nodes_[parent].first_child = first;
+    nodes_[parent].child_count = static_cast<UInt32>(members.size());
+    nodes_.resize(first + members.size());
+
+    for (Size i = 0; i < members.size(); ++i) {
+        const CopybookField& field = *members[i];
+        Node node;
+        node.key = options_.naming == JsonNaming::CAMEL_CASE ? cobol_to_cpp_name(field.name) : field.name;
+        node.offset = field.offset;
+        node.size = field.size;
+        node.occurs = field.occurs;
+        node.digits = field.picture.total_digits;
+        node.scale = field.picture.decimal_digits;
+        node.is_signed = field.picture.is_signed;
+
+        const UInt32 count = occurrences * std::max<UInt32>(field.occurs, 1);
+        json_size_hint_ += count * (node.key.size() + 4) + (field.occurs > 0 ? 2 : 0);
+
+        auto unsupported = [&](StringView why) {
+            return make_error<void>(ErrorCode::NOT_SUPPORTED,
+                std::format("{}: {}", field.name, why));
+        };
+        if (field.is_group()) {
+            node.kind = NodeKind::OBJECT;
+        } else {
+            switch (field.picture.type) {
+                case DataType::ALPHANUMERIC:
+                case DataType::ALPHABETIC:
+                    node.kind = NodeKind::STRING;
+                    break;
+                case DataType::NUMERIC_DISPLAY:
+                    node.kind = is_edited(field.picture.raw_picture) ? NodeKind::STRING : NodeKind::ZONED;
+                    if (node.kind == NodeKind::ZONED && node.size != node.digits) {
+                        return unsupported("zoned decimal with a separate sign");
+                    }
+                    break;
+                case DataType::NUMERIC_PACKED:
+                    node.kind = NodeKind::PACKED;
+                    break;
+                case DataType::NUMERIC_BINARY:
+                    node.kind = NodeKind::BINARY;
+                    if (node.digits > MAX_BINARY_DIGITS) return unsupported("binary wider than 18 digits");
+                    break;
+                case DataType::NUMERIC_FLOAT:
+                    node.kind = NodeKind::FLOAT;
+                    break;
+                default:
+                    return unsupported("no picture");
+            }
+            if (node.kind != NodeKind::STRING && node.kind != NodeKind::FLOAT &&
+                node.digits > MAX_DECIMAL_DIGITS) {
+                return unsupported("more than 31 digits");
+            }
+            json_size_hint_ += count * (node.kind == NodeKind::STRING ? node.size + 2 : node.digits + 2);
+        }
+        nodes_[first + i] = std::move(node);
+
+        if (field.is_group()) {
+            if (auto result = add_members(first + static_cast<UInt32>(i), field.children,
+                                          occurrences * std::max<UInt32>(field.occurs, 1));
+                !result) {
+                return result;
+            }
+        }
+    }
+    return make_success();
+}
+
+void JsonTransformer::fill_initial(const Node& object, UInt32 shift) {
+    const Charset& chars = charset(options_.ebcdic);
+    const Byte zeros[MAX_DECIMAL_DIGITS] = {};
+    for (UInt32 i = 0; i < object.child_count; ++i) {
+        const Node& node = nodes_[object.first_child + i];
+        for (UInt32 n = 0; n < std::max<UInt32>(node.occurs, 1); ++n) {
+            const UInt32 element_shift = shift + n * node.size;
+            Byte* out = initial_.data() + node.offset + element_shift;
+            switch (node.kind) {
+                case NodeKind::OBJECT: fill_initial(node, element_shift); break;
+                case NodeKind::STRING: std::memset(out, chars.space, node.size); break;
+                case NodeKind::ZONED: put_zoned(zeros, false, node, chars, out); break;
+                case NodeKind::PACKED: put_packed(zeros, false, node, out); break;
+                case NodeKind::BINARY:
+                case NodeKind::FLOAT: std::memset(out, 0, node.size); break;
+            }
+        }
+    }
+}
+
+Result<void> JsonTransformer::to_record(StringView json, ByteSpan record) const {
+    if (record.size() < record_length_) {
+        return make_error<void>(ErrorCode::LENGERR,
+            std::format("Record area is {} bytes; the copybook needs {}", record.size(), record_length_));
+    }
+    std::memcpy(record.data(), initial_.data(), record_length_);
+    return JsonReader(json, nodes_, options_, record.data()).read();
+}
+
+Result<ByteBuffer> JsonTransformer::to_record(StringView json) const {
+    ByteBuffer record(record_length_);
+    if (auto result = to_record(json, ByteSpan(record)); !result) {
+        return make_error<ByteBuffer>(result.error());
+    }
+    return make_success(std::move(record));
+}
+
+Result<void> JsonTransformer::to_json(ConstByteSpan record, String& out) const {
+    if (record.size() < record_length_) {
+        return make_error<void>(ErrorCode::LENGERR,
+            std::format("Record is {} bytes; the copybook needs {}", record.size(), record_length_));
+    }
+    out.reserve(out.size() + json_size_hint_);
+    return JsonWriter(nodes_, options_.ebcdic, record.data(), out).object(nodes_[0], 0);
+}
+
+Result<String> JsonTransformer::to_json(ConstByteSpan record) const {
+    String out;
+    if (auto result = to_json(record, out); !result) return make_error<String>(result.error());
+    return make_success(std::move(out));
+}
+
+} // namespace copybook
+} // namespace cics
@@ -179,6 +179,44 @@ struct TimeDuration {
 [[nodiscard]] UInt16 days_in_year(UInt16 year);
 [[nodiscard]] bool is_leap_year(UInt16 year);
 
+// =============================================================================
+// Civil Calendar Arithmetic
+// =============================================================================
+//
+// Proleptic Gregorian day numbers counted from 1970-01-01, without tables or
+// loops, so batch conversions compile to straight-line code.
+
+struct CivilDate {
+    Int32 year = 1970;
+    UInt32 month = 1;
+    UInt32 day = 1;
+};
+
+[[nodiscard]] constexpr Int32 days_from_civil(Int32 year, UInt32 month, UInt32 day) {
+    year -= month <= 2;
+    const Int32 era = (year >= 0 ? year : year - 399) / 400;
+    const UInt32 yoe = static_cast<UInt32>(year - era * 400);                 // [0, 399]
+    const UInt32 doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const UInt32 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                 // [0, 146096]
+    return era * 146097 + static_cast<Int32>(doe) - 719468;
+}
+
+[[nodiscard]] constexpr CivilDate civil_from_days(Int32 days) {
+    days += 719468;
+    const Int32 era = (days >= 0 ? days : days - 146096) / 146097;
+    const UInt32 doe = static_cast<UInt32>(days - era * 146097);
+    const UInt32 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const UInt32 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const UInt32 mp = (5 * doy + 2) / 153;
+    const UInt32 month = mp < 10 ? mp + 3 : mp - 9;
+    return CivilDate{static_cast<Int32>(yoe) + era * 400 + (month <= 2), month, doy - (153 * mp + 2) / 5 + 1};
+}
+
+// Day of week, 0=Sunday
+[[nodiscard]] constexpr UInt8 weekday_from_days(Int32 days) {
+    return static_cast<UInt8>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+}
+
 // First/last day of month
 [[nodiscard]] DateTime first_day_of_month(const DateTime& dt);
 [[nodiscard]] DateTime last_day_of_month(const DateTime& dt);
@@ -207,6 +245,55 @@ namespace format {
     constexpr StringView FULL = "%Y-%m-%d %H:%M:%S";
 }
 
+// =============================================================================
+// Compiled Formats
+// =============================================================================
+//
+// A format pattern (the same % directives as DateTime::format) translated
+// once into a list of field and literal operations. Formatting writes
+// straight into a caller's buffer; parsing expects each numeric field at its
+// formatted width.
+
+class CompiledFormat {
+public:
+    CompiledFormat() = default;
+    explicit CompiledFormat(StringView pattern);
+
+    [[nodiscard]] const String& pattern() const { return pattern_; }
+
+    // Upper bound on the formatted length of a valid DateTime
+    [[nodiscard]] Size max_length() const { return max_length_; }
+
+    // Writes at most out.size() characters and returns the full length, so
+    // a return value greater than out.size() means the text was cut short
+    Size format_to(const DateTime& dt, std::span<char> out) const;
+    [[nodiscard]] String format(const DateTime& dt) const;
+
+    // Fields the pattern lacks default to 1900-01-01 00:00:00.000; %y
+    // reads 00-49 as 20xx and 50-99 as 19xx
+    [[nodiscard]] Result<DateTime> parse(StringView str) const;
+
+private:
+    enum class Field : UInt8 {
+        LITERAL, YEAR, YEAR2, MONTH, DAY, HOUR, MINUTE, SECOND,
+        MILLISECOND, DAY_OF_YEAR, WEEKDAY, WEEK
+    };
+
+    struct Op {
+        Field field = Field::LITERAL;
+        UInt8 width = 0;        // Digits, for numeric fields
+        UInt16 offset = 0;      // Into literals_, for LITERAL
+        UInt16 length = 0;
+    };
+
+    void add_literal(StringView text);
+
+    String pattern_;
+    String literals_;
+    std::vector<Op> ops_;
+    Size max_length_ = 0;
+};
+
 // =============================================================================
 // CICS-Specific Functions
 // =============================================================================
@@ -229,6 +316,27 @@ namespace format {
 // Create EIBTIME format  
 [[nodiscard]] UInt32 to_eibtime(const DateTime& dt);
 
+// =============================================================================
+// Batch Conversion
+// =============================================================================
+//
+// Array forms of the packed-date and ABSTIME conversions for batch jobs.
+// ABSTIME values are taken as UTC plus one fixed offset for the whole array
+// (local_timezone_offset() by default) rather than asking the C library for
+// each value; convert one at a time with from_abstime() to follow DST
+// changes within the array. Each fails with INVALID_ARGUMENT if the output
+// is shorter than the input, and the packed-date forms also if a date's day
+// of year is 0 or past the end of its year; the entries before it are then
+// already converted.
+
+Result<void> convert_packed_dates(std::span<const PackedDate> dates, std::span<DateTime> out);
+Result<void> packed_dates_to_abstimes(std::span<const PackedDate> dates, std::span<AbsTime> out,
+                                      Int16 tz_offset_minutes = local_timezone_offset());
+Result<void> convert_abstimes(std::span<const AbsTime> times, std::span<DateTime> out,
+                              Int16 tz_offset_minutes = local_timezone_offset());
+Result<void> abstimes_to_packed_dates(std::span<const AbsTime> times, std::span<PackedDate> out,
+                                      Int16 tz_offset_minutes = local_timezone_offset());
+
 // =============================================================================
 // Timer Utilities
 // =============================================================================
@@ -8,6 +8,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <format>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -67,17 +68,7 @@ bool DateTime::is_leap_year() const {
 }
 
 UInt8 DateTime::day_of_week() const {
-    // Zeller's congruence
-    int y = year;
-    int m = month;
-    if (m < 3) {
-        m += 12;
-        y--;
-    }
-    int k = y % 100;
-    int j = y / 100;
-    int h = (day + (13 * (m + 1)) / 5 + k + k / 4 + j / 4 - 2 * j) % 7;
-    return static_cast<UInt8>((h + 6) % 7);  // Convert to Sunday=0
+    return weekday_from_days(days_from_civil(year, month, day));
 }
 
 UInt16 DateTime::day_of_year() const {
@@ -90,8 +81,7 @@ UInt16 DateTime::day_of_year() const {
 
 UInt8 DateTime::week_number() const {
     // ISO 8601 week number
-    DateTime jan1 = make_datetime(year, 1, 1);
-    int jan1_dow = jan1.day_of_week();
+    int jan1_dow = weekday_from_days(days_from_civil(year, 1, 1));
     
     int doy = day_of_year();
     int week = (doy + jan1_dow - 1) / 7;
@@ -147,31 +137,10 @@ String DateTime::to_iso8601() const {
 }
 
 String DateTime::format(StringView fmt) const {
-    std::ostringstream oss;
-    
-    for (size_t i = 0; i < fmt.size(); ++i) {
-        if (fmt[i] == '%' && i + 1 < fmt.size()) {
-            switch (fmt[++i]) {
-                case 'Y': oss << std::setfill('0') << std::setw(4) << year; break;
-                case 'y': oss << std::setfill('0') << std::setw(2) << (year % 100); break;
-                case 'm': oss << std::setfill('0') << std::setw(2) << static_cast<int>(month); break;
-                case 'd': oss << std::setfill('0') << std::setw(2) << static_cast<int>(day); break;
-                case 'H': oss << std::setfill('0') << std::setw(2) << static_cast<int>(hour); break;
-                case 'M': oss << std::setfill('0') << std::setw(2) << static_cast<int>(minute); break;
-                case 'S': oss << std::setfill('0') << std::setw(2) << static_cast<int>(second); break;
-                case 'f': oss << std::setfill('0') << std::setw(3) << millisecond; break;
-                case 'j': oss << std::setfill('0') << std::setw(3) << day_of_year(); break;
-                case 'w': oss << static_cast<int>(day_of_week()); break;
-                case 'W': oss << std::setfill('0') << std::setw(2) << static_cast<int>(week_number()); break;
-                case '%': oss << '%'; break;
-                default: oss << '%' << fmt[i]; break;
-            }
-        } else {
-            oss << fmt[i];
-        }
-    }
-    
-    return oss.str();
+    // Callers nearly always repeat one pattern, so keep the last one compiled
+    thread_local CompiledFormat compiled;
+    if (compiled.pattern() != fmt) compiled = CompiledFormat(fmt);
+    return compiled.format(*this);
 }
 
 PackedDate DateTime::to_packed_date() const {
@@ -349,21 +318,9 @@ DateTime make_datetime(UInt16 year, UInt8 month, UInt8 day,
 }
 
 DateTime from_packed_date(PackedDate date) {
-    UInt16 year = date.year();
-    UInt16 doy = date.day_of_year();
-    
-    // Convert day of year to month/day
-    UInt8 month = 1;
-    UInt16 remaining = doy;
-    
-    while (month <= 12) {
-        UInt8 dim = days_in_month(year, month);
-        if (remaining <= dim) break;
-        remaining -= dim;
-        month++;
-    }
-    
-    return make_datetime(year, month, static_cast<UInt8>(remaining));
+    const CivilDate civil = civil_from_days(days_from_civil(date.year(), 1, 1) + date.day_of_year() - 1);
+    return make_datetime(static_cast<UInt16>(civil.year), static_cast<UInt8>(civil.month),
+                         static_cast<UInt8>(civil.day));
 }
 
 DateTime from_packed_time(PackedTime time) {
@@ -425,7 +382,7 @@ Result<DateTime> parse(StringView str, StringView format) {
         return parse_iso8601(str);
     }
     
-    return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT, "Unsupported format");
+    return CompiledFormat(format).parse(str);
 }
 
 Result<DateTime> parse_iso8601(StringView str) {
@@ -648,6 +605,187 @@ DateTime previous_weekday(const DateTime& dt, UInt8 weekday) {
     return add_days(dt, -days_back);
 }
 
+// =============================================================================
+// CompiledFormat Implementation
+// =============================================================================
+
+namespace {
+
+constexpr Int64 MS_PER_DAY = 86400000LL;
+
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes value with at least width digits, zero padded
+char* write_digits(char* out, UInt32 value, UInt8 width) {
+    if (value < 100 && width == 2) {
+        std::memcpy(out, DIGIT_PAIRS + value * 2, 2);
+        return out + 2;
+    }
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (int pad = width - n; pad > 0; --pad) *out++ = '0';
+    while (n > 0) *out++ = digits[--n];
+    return out;
+}
+
+Int32 floor_days(Int64 ms) {
+    return static_cast<Int32>((ms >= 0 ? ms : ms - (MS_PER_DAY - 1)) / MS_PER_DAY);
+}
+
+} // namespace
+
+CompiledFormat::CompiledFormat(StringView pattern) : pattern_(pattern) {
+    // Width is the minimum digits written and the exact digits parsed;
+    // max_length_ allows for the widest value each field's type can hold
+    auto field = [&](Field f, UInt8 width, Size max_chars) {
+        ops_.push_back(Op{f, width, 0, 0});
+        max_length_ += max_chars;
+    };
+
+    Size literal_start = 0;
+    for (Size i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != '%' || i + 1 >= pattern.size()) continue;
+        add_literal(pattern.substr(literal_start, i - literal_start));
+        literal_start = i + 2;
+        switch (pattern[++i]) {
+            case 'Y': field(Field::YEAR, 4, 5); break;
+            case 'y': field(Field::YEAR2, 2, 2); break;
+            case 'm': field(Field::MONTH, 2, 3); break;
+            case 'd': field(Field::DAY, 2, 3); break;
+            case 'H': field(Field::HOUR, 2, 3); break;
+            case 'M': field(Field::MINUTE, 2, 3); break;
+            case 'S': field(Field::SECOND, 2, 3); break;
+            case 'f': field(Field::MILLISECOND, 3, 5); break;
+            case 'j': field(Field::DAY_OF_YEAR, 3, 5); break;
+            case 'w': field(Field::WEEKDAY, 1, 1); break;
+            case 'W': field(Field::WEEK, 2, 3); break;
+            case '%': literal_start = i; break;                  // Second '%' starts the next literal
+            default: literal_start = i - 1; break;               // Unknown directive is kept as text
+        }
+    }
+    add_literal(pattern.substr(std::min(literal_start, pattern.size())));
+}
+
+void CompiledFormat::add_literal(StringView text) {
+    if (text.empty()) return;
+    // Adjacent literals (around %% or an unknown directive) merge into one op
+    if (!ops_.empty() && ops_.back().field == Field::LITERAL &&
+        ops_.back().offset + ops_.back().length == literals_.size()) {
+        ops_.back().length = static_cast<UInt16>(ops_.back().length + text.size());
+    } else {
+        ops_.push_back(Op{Field::LITERAL, 0, static_cast<UInt16>(literals_.size()),
+                          static_cast<UInt16>(text.size())});
+    }
+    literals_.append(text);
+    max_length_ += text.size();
+}
+
+Size CompiledFormat::format_to(const DateTime& dt, std::span<char> out) const {
+    if (out.size() < max_length_) {
+        // Too small to write into directly; format whole, then copy what fits
+        String full = format(dt);
+        std::memcpy(out.data(), full.data(), std::min(out.size(), full.size()));
+        return full.size();
+    }
+
+    char* p = out.data();
+    for (const Op& op : ops_) {
+        switch (op.field) {
+            case Field::LITERAL:
+                std::memcpy(p, literals_.data() + op.offset, op.length);
+                p += op.length;
+                break;
+            case Field::YEAR: p = write_digits(p, dt.year, op.width); break;
+            case Field::YEAR2: p = write_digits(p, dt.year % 100, op.width); break;
+            case Field::MONTH: p = write_digits(p, dt.month, op.width); break;
+            case Field::DAY: p = write_digits(p, dt.day, op.width); break;
+            case Field::HOUR: p = write_digits(p, dt.hour, op.width); break;
+            case Field::MINUTE: p = write_digits(p, dt.minute, op.width); break;
+            case Field::SECOND: p = write_digits(p, dt.second, op.width); break;
+            case Field::MILLISECOND: p = write_digits(p, dt.millisecond, op.width); break;
+            case Field::DAY_OF_YEAR: p = write_digits(p, dt.day_of_year(), op.width); break;
+            case Field::WEEKDAY: p = write_digits(p, dt.day_of_week(), op.width); break;
+            case Field::WEEK: p = write_digits(p, dt.week_number(), op.width); break;
+        }
+    }
+    return static_cast<Size>(p - out.data());
+}
+
+String CompiledFormat::format(const DateTime& dt) const {
+    String result(max_length_, '\0');
+    result.resize(format_to(dt, result));
+    return result;
+}
+
+Result<DateTime> CompiledFormat::parse(StringView str) const {
+    DateTime dt{};
+    dt.year = 1900;
+    dt.month = 1;
+    dt.day = 1;
+    Optional<UInt32> doy;  // %j present; its 000 is an error, not "absent"
+
+    Size pos = 0;
+    for (const Op& op : ops_) {
+        if (op.field == Field::LITERAL) {
+            if (str.substr(pos, op.length) != StringView(literals_).substr(op.offset, op.length)) {
+                return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT,
+                    std::format("Date text does not match '{}' at position {}", pattern_, pos));
+            }
+            pos += op.length;
+            continue;
+        }
+
+        if (pos + op.width > str.size()) {
+            return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT, "Date text too short for format");
+        }
+        UInt32 value = 0;
+        for (Size end = pos + op.width; pos < end; ++pos) {
+            const UInt32 digit = static_cast<UInt32>(str[pos] - '0');
+            if (digit > 9) {
+                return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT,
+                    std::format("Expected a digit at position {}", pos));
+            }
+            value = value * 10 + digit;
+        }
+
+        switch (op.field) {
+            case Field::YEAR: dt.year = static_cast<UInt16>(value); break;
+            case Field::YEAR2: dt.year = static_cast<UInt16>(value + (value < 50 ? 2000 : 1900)); break;
+            case Field::MONTH: dt.month = static_cast<UInt8>(value); break;
+            case Field::DAY: dt.day = static_cast<UInt8>(value); break;
+            case Field::HOUR: dt.hour = static_cast<UInt8>(value); break;
+            case Field::MINUTE: dt.minute = static_cast<UInt8>(value); break;
+            case Field::SECOND: dt.second = static_cast<UInt8>(value); break;
+            case Field::MILLISECOND: dt.millisecond = static_cast<UInt16>(value); break;
+            case Field::DAY_OF_YEAR: doy = value; break;
+            default: break;  // Weekday and week number follow from the date
+        }
+    }
+    if (pos != str.size()) {
+        return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT, "Unexpected text after date");
+    }
+
+    if (doy) {
+        if (*doy == 0 || *doy > days_in_year(dt.year)) {
+            return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT, "Invalid day of year");
+        }
+        const CivilDate civil = civil_from_days(days_from_civil(dt.year, 1, 1) + static_cast<Int32>(*doy) - 1);
+        dt.month = static_cast<UInt8>(civil.month);
+        dt.day = static_cast<UInt8>(civil.day);
+    }
+    if (!dt.is_valid()) {
+        return make_error<DateTime>(ErrorCode::INVALID_ARGUMENT, "Invalid date values");
+    }
+    return dt;
+}
+
 // =============================================================================
 // CICS-Specific Functions
 // =============================================================================
@@ -688,6 +826,97 @@ UInt32 to_eibtime(const DateTime& dt) {
     return dt.hour * 10000 + dt.minute * 100 + dt.second;
 }
 
+// =============================================================================
+// Batch Conversion
+// =============================================================================
+
+namespace {
+
+Result<void> check_day_of_year(PackedDate date, Size index) {
+    const UInt32 doy = date.value % 1000;
+    if (doy == 0 || doy > days_in_year(static_cast<UInt16>(date.value / 1000))) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Packed date {:07} at index {} has no day {} in its year", date.value, index, doy));
+    }
+    return make_success();
+}
+
+} // namespace
+
+Result<void> convert_packed_dates(std::span<const PackedDate> dates, std::span<DateTime> out) {
+    if (out.size() < dates.size()) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Output shorter than input");
+    }
+    const Int16 tz = local_timezone_offset();
+    for (Size i = 0; i < dates.size(); ++i) {
+        if (auto valid = check_day_of_year(dates[i], i); !valid) return valid;
+        const UInt32 value = dates[i].value;
+        const Int32 year = static_cast<Int32>(value / 1000);
+        const CivilDate civil = civil_from_days(days_from_civil(year, 1, 1) + static_cast<Int32>(value % 1000) - 1);
+        DateTime& dt = out[i];
+        dt = DateTime{};
+        dt.year = static_cast<UInt16>(civil.year);
+        dt.month = static_cast<UInt8>(civil.month);
+        dt.day = static_cast<UInt8>(civil.day);
+        dt.tz_offset_minutes = tz;
+    }
+    return make_success();
+}
+
+Result<void> packed_dates_to_abstimes(std::span<const PackedDate> dates, std::span<AbsTime> out,
+                                      Int16 tz_offset_minutes) {
+    if (out.size() < dates.size()) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Output shorter than input");
+    }
+    // Local midnight of each date
+    const Int64 bias = ABSTIME_EPOCH_OFFSET - static_cast<Int64>(tz_offset_minutes) * 60000;
+    for (Size i = 0; i < dates.size(); ++i) {
+        if (auto valid = check_day_of_year(dates[i], i); !valid) return valid;
+        const UInt32 value = dates[i].value;
+        const Int32 days = days_from_civil(static_cast<Int32>(value / 1000), 1, 1) + static_cast<Int32>(value % 1000) - 1;
+        out[i] = static_cast<Int64>(days) * MS_PER_DAY + bias;
+    }
+    return make_success();
+}
+
+Result<void> convert_abstimes(std::span<const AbsTime> times, std::span<DateTime> out,
+                              Int16 tz_offset_minutes) {
+    if (out.size() < times.size()) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Output shorter than input");
+    }
+    const Int64 bias = static_cast<Int64>(tz_offset_minutes) * 60000 - ABSTIME_EPOCH_OFFSET;
+    for (Size i = 0; i < times.size(); ++i) {
+        const Int64 local_ms = times[i] + bias;
+        const Int32 days = floor_days(local_ms);
+        const UInt32 ms_of_day = static_cast<UInt32>(local_ms - static_cast<Int64>(days) * MS_PER_DAY);
+        const CivilDate civil = civil_from_days(days);
+        DateTime& dt = out[i];
+        dt.year = static_cast<UInt16>(civil.year);
+        dt.month = static_cast<UInt8>(civil.month);
+        dt.day = static_cast<UInt8>(civil.day);
+        dt.hour = static_cast<UInt8>(ms_of_day / 3600000);
+        dt.minute = static_cast<UInt8>(ms_of_day / 60000 % 60);
+        dt.second = static_cast<UInt8>(ms_of_day / 1000 % 60);
+        dt.millisecond = static_cast<UInt16>(ms_of_day % 1000);
+        dt.tz_offset_minutes = tz_offset_minutes;
+    }
+    return make_success();
+}
+
+Result<void> abstimes_to_packed_dates(std::span<const AbsTime> times, std::span<PackedDate> out,
+                                      Int16 tz_offset_minutes) {
+    if (out.size() < times.size()) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Output shorter than input");
+    }
+    const Int64 bias = static_cast<Int64>(tz_offset_minutes) * 60000 - ABSTIME_EPOCH_OFFSET;
+    for (Size i = 0; i < times.size(); ++i) {
+        const Int32 days = floor_days(times[i] + bias);
+        const Int32 year = civil_from_days(days).year;
+        out[i].value = static_cast<UInt32>(year * 1000 + (days - days_from_civil(year, 1, 1) + 1));
+    }
+    return make_success();
+}
+
 // =============================================================================
 // StopWatch Implementation
 // =============================================================================
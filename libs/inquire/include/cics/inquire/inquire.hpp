@@ -15,6 +15,7 @@
 #include <unordered_map>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <chrono>
 #include <functional>
 
@@ -162,66 +163,137 @@ struct SystemInfo {
 // Resource Registry
 // =============================================================================
 
+// Readers never contend on the registry mutex: the registry publishes an
+// immutable snapshot through an atomic shared_ptr and every get/exists/list
+// works against whichever snapshot was current when the call began. (The
+// standard library may still guard the atomic shared_ptr with a short
+// internal lock; it is held only for the pointer copy.) Writers serialise
+// on write_mutex_, copy the current map, apply their change and swap the
+// new snapshot in, bumping generation(). Registration is rare compared with
+// INQUIRE traffic, so the copy-on-write cost is paid on the cold path only.
+
 template<typename T>
 class ResourceRegistry {
 public:
+    using Map = StringMap<T>;
+    using Snapshot = std::shared_ptr<const Map>;
+    
+    ResourceRegistry() : snapshot_(std::make_shared<const Map>()) {}
+    
     void register_resource(StringView name, const T& info) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        resources_[String(name)] = info;
+        modify([&](Map& map) {
+            auto it = map.find(name);
+            if (it != map.end()) {
+                it->second = info;
+            } else {
+                map.emplace(String(name), info);
+            }
+        });
     }
     
     void unregister_resource(StringView name) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        resources_.erase(String(name));
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto current = snapshot_.load(std::memory_order_acquire);
+        auto it = current->find(name);
+        if (it == current->end()) return;
+        auto next = std::make_shared<Map>(*current);
+        next->erase(next->find(name));
+        publish(std::move(next));
+    }
+    
+    // Atomic read-modify-write of one entry; returns false if it is absent.
+    template<typename Fn>
+    bool update(StringView name, Fn&& fn) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto current = snapshot_.load(std::memory_order_acquire);
+        if (current->find(name) == current->end()) return false;
+        auto next = std::make_shared<Map>(*current);
+        fn(next->find(name)->second);
+        publish(std::move(next));
+        return true;
     }
     
     [[nodiscard]] Optional<T> get(StringView name) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = resources_.find(String(name));
-        if (it != resources_.end()) {
+        auto current = snapshot();
+        auto it = current->find(name);
+        if (it != current->end()) {
             return it->second;
         }
         return std::nullopt;
     }
     
     [[nodiscard]] bool exists(StringView name) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return resources_.find(String(name)) != resources_.end();
+        auto current = snapshot();
+        return current->find(name) != current->end();
     }
     
     [[nodiscard]] std::vector<String> list() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        auto current = snapshot();
         std::vector<String> names;
-        names.reserve(resources_.size());
-        for (const auto& [name, info] : resources_) {
+        names.reserve(current->size());
+        for (const auto& [name, info] : *current) {
             names.push_back(name);
         }
         return names;
     }
     
     [[nodiscard]] std::vector<T> list_all() const {
-        std::lock_guard<std::mutex> lock(mutex_);
+        auto current = snapshot();
         std::vector<T> items;
-        items.reserve(resources_.size());
-        for (const auto& [name, info] : resources_) {
+        items.reserve(current->size());
+        for (const auto& [name, info] : *current) {
             items.push_back(info);
         }
         return items;
     }
     
+    // Visit every entry of the current snapshot without copying it.
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        auto current = snapshot();
+        for (const auto& [name, info] : *current) {
+            fn(name, info);
+        }
+    }
+    
+    // The snapshot stays valid (and unchanged) for as long as it is held.
+    [[nodiscard]] Snapshot snapshot() const {
+        return snapshot_.load(std::memory_order_acquire);
+    }
+    
     void clear() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        resources_.clear();
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        publish(std::make_shared<const Map>());
     }
     
     [[nodiscard]] UInt32 count() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return static_cast<UInt32>(resources_.size());
+        return static_cast<UInt32>(snapshot()->size());
+    }
+    
+    // Moves on each time a changed snapshot is published; a browse that
+    // sees the same value before and after saw an unchanged registry
+    [[nodiscard]] UInt64 generation() const {
+        return generation_.load(std::memory_order_acquire);
     }
 
 private:
-    std::unordered_map<String, T> resources_;
-    mutable std::mutex mutex_;
+    template<typename Fn>
+    void modify(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto next = std::make_shared<Map>(*snapshot_.load(std::memory_order_acquire));
+        fn(*next);
+        publish(std::move(next));
+    }
+    
+    // write_mutex_ held
+    void publish(Snapshot next) {
+        snapshot_.store(std::move(next), std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    
+    std::atomic<Snapshot> snapshot_;
+    std::atomic<UInt64> generation_{0};
+    std::mutex write_mutex_;
 };
 
 // =============================================================================
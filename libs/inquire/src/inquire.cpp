@@ -250,38 +250,26 @@ void InquireManager::set_system_info(const SystemInfo& info) {
 }
 
 Result<void> InquireManager::set_program_status(StringView name, ResourceStatus status) {
-    auto info = programs_.get(name);
-    if (!info.has_value()) {
+    if (!programs_.update(name, [status](auto& info) { info.status = status; })) {
         return make_error<void>(ErrorCode::CICS_PROGRAM_NOT_FOUND,
             "Program not found: " + String(name));
     }
-    auto updated = info.value();
-    updated.status = status;
-    programs_.register_resource(name, updated);
     return make_success();
 }
 
 Result<void> InquireManager::set_file_status(StringView name, ResourceStatus status) {
-    auto info = files_.get(name);
-    if (!info.has_value()) {
+    if (!files_.update(name, [status](auto& info) { info.status = status; })) {
         return make_error<void>(ErrorCode::CICS_FILE_NOT_FOUND,
             "File not found: " + String(name));
     }
-    auto updated = info.value();
-    updated.status = status;
-    files_.register_resource(name, updated);
     return make_success();
 }
 
 Result<void> InquireManager::set_transaction_status(StringView name, ResourceStatus status) {
-    auto info = transactions_.get(name);
-    if (!info.has_value()) {
+    if (!transactions_.update(name, [status](auto& info) { info.status = status; })) {
         return make_error<void>(ErrorCode::CICS_TRANSACTION_NOT_FOUND,
             "Transaction not found: " + String(name));
     }
-    auto updated = info.value();
-    updated.status = status;
-    transactions_.register_resource(name, updated);
     return make_success();
 }
 
@@ -12,6 +12,7 @@
 
 #include <cics/common/types.hpp>
 #include <cics/common/error.hpp>
+#include <cics/common/name_table.hpp>
 #include <fstream>
 #include <memory>
 #include <mutex>
@@ -169,6 +170,7 @@ public:
     Result<Journal*> open_journal(StringView name, UInt32 number = 0);
     Result<Journal*> get_journal(StringView name);
     Result<Journal*> get_journal(UInt32 number);
+    Result<Journal*> get_journal(NameId name);
     Result<void> close_journal(StringView name);
     
     // Write operations
@@ -178,6 +180,10 @@ public:
                          const void* data, UInt32 length);
     Result<UInt64> write(StringView journal_name, const JournalRecord& record);
     
+    // By interned name: an array index once the journal is open
+    Result<UInt64> write(NameId journal_name, StringView jtypeid,
+                         const void* data, UInt32 length);
+    
     // System log shortcut
     Result<UInt64> log(StringView message);
     Result<UInt64> log(StringView jtypeid, StringView message);
@@ -201,12 +207,15 @@ private:
     JournalManager& operator=(const JournalManager&) = delete;
     
     String generate_filename(StringView name);
+    Result<UInt64> write_to(Journal& journal, StringView journal_name, StringView jtypeid,
+                            const void* data, UInt32 length);
     
     bool initialized_ = false;
     String journal_directory_ = "/tmp/cics_journals";
     
     std::unordered_map<String, std::unique_ptr<Journal>> journals_by_name_;
     std::unordered_map<UInt32, Journal*> journals_by_number_;
+    NameIndex<Journal> journals_by_id_;
     
     String current_transid_;
     UInt32 current_task_id_ = 0;
@@ -222,6 +222,7 @@ void JournalManager::initialize() {
     
     journals_by_name_.clear();
     journals_by_number_.clear();
+    journals_by_id_.clear();
     
     // Create journal directory
     if (!fs::exists(journal_directory_)) {
@@ -251,6 +252,7 @@ void JournalManager::shutdown() {
     
     journals_by_name_.clear();
     journals_by_number_.clear();
+    journals_by_id_.clear();
     initialized_ = false;
 }
 
@@ -295,6 +297,7 @@ Result<Journal*> JournalManager::open_journal(StringView name, UInt32 number) {
     if (number > 0) {
         journals_by_number_[number] = ptr;
     }
+    journals_by_id_.set(NameTable::instance().intern(key), ptr);
     journals_by_name_[key] = std::move(journal);
     
     ++stats_.journals_opened;
@@ -324,6 +327,14 @@ Result<Journal*> JournalManager::get_journal(UInt32 number) {
     return make_success(it->second);
 }
 
+Result<Journal*> JournalManager::get_journal(NameId name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (Journal* journal = journals_by_id_.find(name)) return make_success(journal);
+    }
+    return get_journal(NameTable::instance().name(name));
+}
+
 Result<void> JournalManager::close_journal(StringView name) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -338,6 +349,7 @@ Result<void> JournalManager::close_journal(StringView name) {
     // Remove from number map
     UInt32 num = it->second->number();
     journals_by_number_.erase(num);
+    journals_by_id_.erase(NameTable::instance().find(it->first));
     journals_by_name_.erase(it);
     
     return result;
@@ -353,7 +365,24 @@ Result<UInt64> JournalManager::write(StringView journal_name, StringView jtypeid
             return make_error<UInt64>(journal_result.error().code, journal_result.error().message);
         }
     }
-    
+    return write_to(*journal_result.value(), journal_name, jtypeid, data, length);
+}
+
+Result<UInt64> JournalManager::write(NameId journal_name, StringView jtypeid,
+                                      const void* data, UInt32 length) {
+    Journal* journal = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        journal = journals_by_id_.find(journal_name);
+    }
+    // Not open yet: by name, which opens it
+    const StringView name = NameTable::instance().name(journal_name);
+    if (journal == nullptr) return write(name, jtypeid, data, length);
+    return write_to(*journal, name, jtypeid, data, length);
+}
+
+Result<UInt64> JournalManager::write_to(Journal& journal, StringView journal_name, StringView jtypeid,
+                                         const void* data, UInt32 length) {
     JournalRecord record;
     record.timestamp = std::chrono::system_clock::now();
     record.journal_name = String(journal_name);
@@ -367,7 +396,7 @@ Result<UInt64> JournalManager::write(StringView journal_name, StringView jtypeid
     }
     record.length = length;
     
-    auto result = journal_result.value()->write(record);
+    auto result = journal.write(record);
     if (result.is_success()) {
         ++stats_.records_written;
         stats_.bytes_written += length;
@@ -0,0 +1,229 @@
+#pragma once
+// =============================================================================
+// CICS Emulation - Multi-Region Operation (MRO)
+// Version: 3.4.6
+// =============================================================================
+//
+// Region-to-region function shipping over local Unix-domain sockets. An
+// application-owning region opens an MroConnection to the region that owns
+// a program, file or queue and ships LINK, file control and TS requests to
+// it; the owning region's MroServer runs each one through the mirror
+// handler registered for its function and ships the result back.
+//
+// A connection is multiplexed: every request carries an id, any number of
+// threads may ship on one connection, and responses are matched by id, so no
+// thread waits on another's round trip before sending. Requests queued while
+// the previous frame was being written travel together in the next frame,
+// and the server answers each frame with one frame. The owning region runs
+// one connection's requests one at a time, in order, so a slow request
+// holds up those behind it; open more connections to run them side by side.
+//
+// Wire format (little-endian, cics::serialization):
+//   frame   = u32 body_length, u16 message_count, u8 kind, u8 version, body
+//   message = u32 request_id, u32 body_length, ShipRequest | ShipResponse
+// =============================================================================
+
+#include "cics/common/types.hpp"
+#include "cics/common/error.hpp"
+#include "cics/serialization/serialization.hpp"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <shared_mutex>
+#include <thread>
+
+namespace cics::mro {
+
+using namespace cics;
+
+// =============================================================================
+// Shipped Functions
+// =============================================================================
+
+enum class FunctionCode : UInt8 {
+    LINK = 1,           // Distributed program link
+    FILE_READ = 2,
+    FILE_WRITE = 3,
+    FILE_REWRITE = 4,
+    FILE_DELETE = 5,
+    TS_WRITEQ = 6,
+    TS_READQ = 7,
+    TS_DELETEQ = 8
+};
+
+constexpr Size FUNCTION_CODE_COUNT = 9;
+
+[[nodiscard]] constexpr StringView to_string(FunctionCode function) {
+    switch (function) {
+        case FunctionCode::LINK: return "LINK";
+        case FunctionCode::FILE_READ: return "READ";
+        case FunctionCode::FILE_WRITE: return "WRITE";
+        case FunctionCode::FILE_REWRITE: return "REWRITE";
+        case FunctionCode::FILE_DELETE: return "DELETE";
+        case FunctionCode::TS_WRITEQ: return "WRITEQ TS";
+        case FunctionCode::TS_READQ: return "READQ TS";
+        case FunctionCode::TS_DELETEQ: return "DELETEQ TS";
+    }
+    return "UNKNOWN";
+}
+
+struct ShipRequest {
+    FunctionCode function = FunctionCode::LINK;
+    String resource;    // Program, file or queue name
+    ByteBuffer key;     // Record key (file control)
+    ByteBuffer data;    // COMMAREA, record or TS item
+    UInt32 item = 0;    // TS item number
+
+    void serialize(serialization::BinaryWriter& writer) const;
+    Result<void> deserialize(serialization::BinaryReader& reader);
+};
+
+struct ShipResponse {
+    ErrorCode code = ErrorCode::SUCCESS;
+    String message;
+    ByteBuffer data;    // Returned COMMAREA, record or TS item
+    UInt32 item = 0;    // Item number written
+
+    [[nodiscard]] bool ok() const { return code == ErrorCode::SUCCESS; }
+
+    void serialize(serialization::BinaryWriter& writer) const;
+    Result<void> deserialize(serialization::BinaryReader& reader);
+};
+
+// The owning region's mirror for one function
+using MirrorHandler = std::function<ShipResponse(const ShipRequest&)>;
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+struct MroStatistics {
+    AtomicCounter<UInt64> requests;
+    AtomicCounter<UInt64> responses;
+    AtomicCounter<UInt64> frames_sent;
+    AtomicCounter<UInt64> frames_received;
+    AtomicCounter<UInt64> bytes_sent;
+    AtomicCounter<UInt64> bytes_received;
+
+    [[nodiscard]] double requests_per_frame() const;
+    [[nodiscard]] String to_string() const;
+};
+
+// =============================================================================
+// Connection (application-owning side)
+// =============================================================================
+
+struct MroConnectionConfig {
+    Size max_batch_requests = 64;     // Capped at 65535, a frame's message limit
+    Size max_batch_bytes = 64 * 1024;
+    Microseconds batch_window{0};     // Extra wait for company before sending a short batch
+    Milliseconds timeout{30000};      // How long call() waits for its response
+};
+
+class MroConnection {
+public:
+    static Result<UniquePtr<MroConnection>> connect(const Path& socket_path, MroConnectionConfig config = {});
+
+    ~MroConnection();
+    MroConnection(const MroConnection&) = delete;
+    MroConnection& operator=(const MroConnection&) = delete;
+
+    // Queue a request and return at once; the future completes when the
+    // response arrives, or with SYSIDERR if the connection is lost first
+    [[nodiscard]] std::future<ShipResponse> ship(const ShipRequest& request);
+
+    // Ship and wait; a non-OK response comes back as its error
+    Result<ShipResponse> call(const ShipRequest& request);
+
+    // Function shipping
+    Result<ByteBuffer> link(StringView program, ConstByteSpan commarea);
+    Result<ByteBuffer> read_file(StringView file, ConstByteSpan key);
+    Result<void> write_file(StringView file, ConstByteSpan key, ConstByteSpan record);
+    Result<void> rewrite_file(StringView file, ConstByteSpan key, ConstByteSpan record);
+    Result<void> delete_file(StringView file, ConstByteSpan key);
+    Result<UInt32> writeq_ts(StringView queue, ConstByteSpan data);
+    Result<ByteBuffer> readq_ts(StringView queue, UInt32 item);
+    Result<void> deleteq_ts(StringView queue);
+
+    // Send what is queued and wait up to the call timeout for the answers.
+    // Requests still unanswered then fail with TIMEDOUT, not SYSIDERR: they
+    // reached the owning region, which may have run them.
+    void close();
+    [[nodiscard]] bool is_open() const;
+
+    [[nodiscard]] const MroStatistics& statistics() const { return stats_; }
+
+private:
+    MroConnection(int fd, MroConnectionConfig config);
+
+    // ship(), also giving call() the id to forget if it times out
+    std::future<ShipResponse> enqueue(const ShipRequest& request, UInt32& id);
+    void send_loop();
+    void receive_loop();
+    void fail_pending(ErrorCode code, StringView reason);
+
+    int fd_;
+    MroConnectionConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable outbound_ready_;
+    std::condition_variable drained_;  // pending_ emptied, or the connection broke
+    std::deque<ByteBuffer> outbound_;  // Encoded messages not yet sent
+    Size outbound_bytes_ = 0;
+    std::unordered_map<UInt32, std::promise<ShipResponse>> pending_;
+    UInt32 next_id_ = 0;
+    bool closing_ = false;
+    bool broken_ = false;
+
+    std::thread sender_;
+    std::thread receiver_;
+    MroStatistics stats_;
+};
+
+// =============================================================================
+// Server (owning region)
+// =============================================================================
+
+class MroServer {
+public:
+    explicit MroServer(String sysid = "");
+    ~MroServer();
+    MroServer(const MroServer&) = delete;
+    MroServer& operator=(const MroServer&) = delete;
+
+    void register_handler(FunctionCode function, MirrorHandler handler);
+
+    // Bind the socket and start accepting connections in the background
+    Result<void> listen(const Path& socket_path);
+    void stop();
+
+    [[nodiscard]] bool is_running() const { return running_.load(); }
+    [[nodiscard]] const String& sysid() const { return sysid_; }
+    [[nodiscard]] Size connection_count() const;
+    [[nodiscard]] const MroStatistics& statistics() const { return stats_; }
+
+private:
+    struct Session {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void accept_loop();
+    void serve(Session& session);
+    [[nodiscard]] ShipResponse dispatch(const ShipRequest& request) const;
+
+    String sysid_;
+    std::array<MirrorHandler, FUNCTION_CODE_COUNT> handlers_;
+    mutable std::shared_mutex handlers_mutex_;
+
+    int listen_fd_ = -1;
+    Path socket_path_;
+    std::atomic<bool> running_{false};
+    std::thread acceptor_;
+    std::vector<UniquePtr<Session>> sessions_;
+    mutable std::mutex sessions_mutex_;
+    MroStatistics stats_;
+};
+
+} // namespace cics::mro
@@ -0,0 +1,745 @@
+// =============================================================================
+// CICS Emulation - Multi-Region Operation Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include "cics/mro/mro.hpp"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace cics::mro {
+
+using serialization::BinaryReader;
+using serialization::BinaryWriter;
+
+namespace {
+
+constexpr UInt8 PROTOCOL_VERSION = 2;
+constexpr UInt8 FRAME_REQUESTS = 1;
+constexpr UInt8 FRAME_RESPONSES = 2;
+constexpr Size FRAME_HEADER_BYTES = 8;
+constexpr UInt32 MAX_FRAME_BYTES = 64 * 1024 * 1024;
+constexpr Size MAX_FRAME_MESSAGES = 65535;  // message_count is a u16
+
+// message = u32 id, u32 body_length, body. The length lets a reader step
+// over a body it cannot decode and still find the messages after it.
+constexpr Size MESSAGE_HEADER_BYTES = 8;
+
+void write_blob(BinaryWriter& writer, ConstByteSpan data) {
+    writer.write_uint32(static_cast<UInt32>(data.size()));
+    writer.write_bytes(data);
+}
+
+Result<ByteBuffer> read_blob(BinaryReader& reader) {
+    auto length = reader.read_uint32();
+    if (!length) return make_error<ByteBuffer>(length.error());
+    return reader.read_bytes(length.value());
+}
+
+void store_uint32(ByteBuffer& buffer, Size offset, UInt32 value) {
+    for (Size i = 0; i < sizeof(value); ++i) buffer[offset + i] = static_cast<Byte>(value >> (8 * i));
+}
+
+// Message ids are patched into already-encoded messages under the
+// connection lock, so encoding itself happens outside it
+void store_id(ByteBuffer& message, UInt32 id) {
+    store_uint32(message, 0, id);
+}
+
+template <typename Body>
+ByteBuffer encode_message(UInt32 id, const Body& body, Size size_hint) {
+    BinaryWriter writer(size_hint);
+    body.serialize(writer);
+    const ByteBuffer& encoded = writer.buffer();
+
+    ByteBuffer message(MESSAGE_HEADER_BYTES + encoded.size());
+    store_id(message, id);
+    store_uint32(message, sizeof(UInt32), static_cast<UInt32>(encoded.size()));
+    std::copy(encoded.begin(), encoded.end(), message.begin() + MESSAGE_HEADER_BYTES);
+    return message;
+}
+
+struct Message {
+    UInt32 id = 0;
+    ConstByteSpan body;
+};
+
+// false if the frame body ends inside the message
+bool next_message(BinaryReader& reader, ConstByteSpan frame_body, Message& out) {
+    auto id = reader.read_uint32();
+    auto length = reader.read_uint32();
+    if (!id || !length || reader.remaining() < length.value()) return false;
+    out.id = id.value();
+    out.body = frame_body.subspan(reader.position(), length.value());
+    reader.skip(length.value());
+    return true;
+}
+
+ByteBuffer frame(UInt8 kind, std::span<const ByteBuffer> messages) {
+    Size body = 0;
+    for (const auto& message : messages) body += message.size();
+
+    BinaryWriter writer(FRAME_HEADER_BYTES + body);
+    writer.write_uint32(static_cast<UInt32>(body));
+    writer.write_uint16(static_cast<UInt16>(messages.size()));
+    writer.write_uint8(kind);
+    writer.write_uint8(PROTOCOL_VERSION);
+    for (const auto& message : messages) writer.write_bytes(message);
+    return writer.take_buffer();
+}
+
+} // namespace
+
+// =============================================================================
+// Messages
+// =============================================================================
+
+void ShipRequest::serialize(BinaryWriter& writer) const {
+    writer.write_uint8(static_cast<UInt8>(function));
+    writer.write_string(resource);
+    write_blob(writer, key);
+    write_blob(writer, data);
+    writer.write_uint32(item);
+}
+
+Result<void> ShipRequest::deserialize(BinaryReader& reader) {
+    auto fn = reader.read_uint8();
+    if (!fn) return make_error<void>(fn.error());
+    if (fn.value() == 0 || fn.value() >= FUNCTION_CODE_COUNT) {
+        return make_error<void>(ErrorCode::INVREQ, std::format("Unknown shipped function {}", fn.value()));
+    }
+    function = static_cast<FunctionCode>(fn.value());
+
+    auto name = reader.read_string();
+    if (!name) return make_error<void>(name.error());
+    resource = std::move(name.value());
+
+    auto k = read_blob(reader);
+    if (!k) return make_error<void>(k.error());
+    key = std::move(k.value());
+
+    auto d = read_blob(reader);
+    if (!d) return make_error<void>(d.error());
+    data = std::move(d.value());
+
+    auto i = reader.read_uint32();
+    if (!i) return make_error<void>(i.error());
+    item = i.value();
+    return {};
+}
+
+void ShipResponse::serialize(BinaryWriter& writer) const {
+    writer.write_int32(static_cast<Int32>(code));
+    writer.write_string(message);
+    write_blob(writer, data);
+    writer.write_uint32(item);
+}
+
+Result<void> ShipResponse::deserialize(BinaryReader& reader) {
+    auto c = reader.read_int32();
+    if (!c) return make_error<void>(c.error());
+    code = static_cast<ErrorCode>(c.value());
+
+    auto text = reader.read_string();
+    if (!text) return make_error<void>(text.error());
+    message = std::move(text.value());
+
+    auto d = read_blob(reader);
+    if (!d) return make_error<void>(d.error());
+    data = std::move(d.value());
+
+    auto i = reader.read_uint32();
+    if (!i) return make_error<void>(i.error());
+    item = i.value();
+    return {};
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+double MroStatistics::requests_per_frame() const {
+    const UInt64 frames = frames_sent.get();
+    return frames == 0 ? 0.0 : static_cast<double>(requests.get()) / static_cast<double>(frames);
+}
+
+String MroStatistics::to_string() const {
+    std::ostringstream oss;
+    oss << "MRO Statistics:\n"
+        << "  Requests: " << requests.get() << "\n"
+        << "  Responses: " << responses.get() << "\n"
+        << "  Frames Sent: " << frames_sent.get() << " (" << std::format("{:.1f}", requests_per_frame())
+        << " requests/frame)\n"
+        << "  Frames Received: " << frames_received.get() << "\n"
+        << "  Bytes Sent: " << bytes_sent.get() << "\n"
+        << "  Bytes Received: " << bytes_received.get();
+    return oss.str();
+}
+
+#ifdef _WIN32
+
+Result<UniquePtr<MroConnection>> MroConnection::connect(const Path&, MroConnectionConfig) {
+    return make_error<UniquePtr<MroConnection>>(ErrorCode::NOT_SUPPORTED, "MRO needs Unix-domain sockets");
+}
+MroConnection::MroConnection(int fd, MroConnectionConfig config) : fd_(fd), config_(config) {}
+MroConnection::~MroConnection() = default;
+std::future<ShipResponse> MroConnection::enqueue(const ShipRequest&, UInt32&) {
+    std::promise<ShipResponse> promise;
+    promise.set_value(ShipResponse{ErrorCode::NOT_SUPPORTED, "MRO needs Unix-domain sockets", {}, 0});
+    return promise.get_future();
+}
+void MroConnection::close() {}
+bool MroConnection::is_open() const { return false; }
+void MroConnection::send_loop() {}
+void MroConnection::receive_loop() {}
+void MroConnection::fail_pending(ErrorCode, StringView) {}
+
+MroServer::MroServer(String sysid) : sysid_(std::move(sysid)) {}
+MroServer::~MroServer() = default;
+Result<void> MroServer::listen(const Path&) {
+    return make_error<void>(ErrorCode::NOT_SUPPORTED, "MRO needs Unix-domain sockets");
+}
+void MroServer::stop() {}
+Size MroServer::connection_count() const { return 0; }
+void MroServer::accept_loop() {}
+void MroServer::serve(Session&) {}
+
+#else
+
+namespace {
+
+// Linux says "no SIGPIPE" per send() and "close on exec" when the socket is
+// made; elsewhere (macOS) both are options set on the descriptor afterwards
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+#ifdef SOCK_CLOEXEC
+constexpr int SOCKET_FLAGS = SOCK_CLOEXEC;
+#else
+constexpr int SOCKET_FLAGS = 0;
+#endif
+
+bool prepare_socket(int fd) {
+    if (fd < 0) return false;
+#ifndef SOCK_CLOEXEC
+    if (::fcntl(fd, F_SETFD, FD_CLOEXEC) != 0) return false;
+#endif
+#ifdef SO_NOSIGPIPE
+    const int on = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on)) != 0) return false;
+#endif
+    return true;
+}
+
+bool write_all(int fd, ConstByteSpan data) {
+    Size done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + done, data.size() - done, SEND_FLAGS);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<Size>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, ByteSpan data) {
+    Size done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::recv(fd, data.data() + done, data.size() - done, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<Size>(n);
+    }
+    return true;
+}
+
+struct Frame {
+    UInt8 kind = 0;
+    UInt16 count = 0;
+    ByteBuffer body;
+};
+
+// false on EOF, a broken socket or a malformed header
+bool read_frame(int fd, Frame& out) {
+    Byte header[FRAME_HEADER_BYTES];
+    if (!read_all(fd, header)) return false;
+
+    BinaryReader reader(ConstByteSpan(header, sizeof(header)));
+    const UInt32 body = reader.read_uint32().value_or(0);
+    out.count = reader.read_uint16().value_or(0);
+    out.kind = reader.read_uint8().value_or(0);
+    const UInt8 version = reader.read_uint8().value_or(0);
+    if (version != PROTOCOL_VERSION || body > MAX_FRAME_BYTES) return false;
+
+    out.body.resize(body);
+    return read_all(fd, out.body);
+}
+
+Result<int> open_socket(const Path& socket_path, sockaddr_un& addr) {
+    const String path = socket_path.string();
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return make_error<int>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Socket path must be 1-{} bytes: {}", sizeof(addr.sun_path) - 1, path));
+    }
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.data(), path.size());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCKET_FLAGS, 0);
+    if (!prepare_socket(fd)) {
+        const int err = errno;
+        if (fd >= 0) ::close(fd);
+        return make_error<int>(ErrorCode::IO_ERROR, std::format("socket: {}", std::strerror(err)));
+    }
+    return fd;
+}
+
+} // namespace
+
+// =============================================================================
+// MroConnection
+// =============================================================================
+
+Result<UniquePtr<MroConnection>> MroConnection::connect(const Path& socket_path, MroConnectionConfig config) {
+    sockaddr_un addr{};
+    auto fd = open_socket(socket_path, addr);
+    if (!fd) return make_error<UniquePtr<MroConnection>>(fd.error());
+
+    if (::connect(fd.value(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const int err = errno;
+        ::close(fd.value());
+        return make_error<UniquePtr<MroConnection>>(ErrorCode::SYSIDERR,
+            std::format("Cannot connect to {}: {}", socket_path.string(), std::strerror(err)));
+    }
+    return UniquePtr<MroConnection>(new MroConnection(fd.value(), config));
+}
+
+MroConnection::MroConnection(int fd, MroConnectionConfig config)
+    : fd_(fd), config_(config) {
+    config_.max_batch_requests = std::clamp<Size>(config_.max_batch_requests, 1, MAX_FRAME_MESSAGES);
+    sender_ = std::thread([this] { send_loop(); });
+    receiver_ = std::thread([this] { receive_loop(); });
+}
+
+MroConnection::~MroConnection() {
+    close();
+}
+
+std::future<ShipResponse> MroConnection::enqueue(const ShipRequest& request, UInt32& id) {
+    ByteBuffer message = encode_message(0, request,  // Id patched below
+        64 + request.resource.size() + request.key.size() + request.data.size());
+
+    std::promise<ShipResponse> promise;
+    auto future = promise.get_future();
+    {
+        std::lock_guard lock(mutex_);
+        if (closing_ || broken_) {
+            promise.set_value(ShipResponse{ErrorCode::SYSIDERR, "MRO connection closed", {}, 0});
+            return future;
+        }
+        id = ++next_id_;
+        store_id(message, id);
+        pending_.emplace(id, std::move(promise));
+        outbound_bytes_ += message.size();
+        outbound_.push_back(std::move(message));
+    }
+    ++stats_.requests;
+    outbound_ready_.notify_one();
+    return future;
+}
+
+void MroConnection::send_loop() {
+    std::vector<ByteBuffer> batch;
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        outbound_ready_.wait(lock, [&] { return closing_ || broken_ || !outbound_.empty(); });
+        if (broken_ || (closing_ && outbound_.empty())) return;
+
+        // Give a short batch a moment to fill up, if configured to
+        if (config_.batch_window.count() > 0 && !closing_ &&
+            outbound_.size() < config_.max_batch_requests && outbound_bytes_ < config_.max_batch_bytes) {
+            outbound_ready_.wait_for(lock, config_.batch_window, [&] {
+                return closing_ || outbound_.size() >= config_.max_batch_requests ||
+                       outbound_bytes_ >= config_.max_batch_bytes;
+            });
+        }
+
+        // Everything queued while the last frame was on the wire goes in this one
+        Size bytes = 0;
+        while (!outbound_.empty() && batch.size() < config_.max_batch_requests &&
+               (batch.empty() || bytes + outbound_.front().size() <= config_.max_batch_bytes)) {
+            bytes += outbound_.front().size();
+            outbound_bytes_ -= outbound_.front().size();
+            batch.push_back(std::move(outbound_.front()));
+            outbound_.pop_front();
+        }
+        lock.unlock();
+
+        const ByteBuffer out = frame(FRAME_REQUESTS, batch);
+        const bool sent = write_all(fd_, out);
+        batch.clear();
+
+        lock.lock();
+        if (!sent) {
+            broken_ = true;
+            lock.unlock();
+            fail_pending(ErrorCode::SYSIDERR, "MRO connection lost while sending");
+            return;
+        }
+        ++stats_.frames_sent;
+        stats_.bytes_sent += out.size();
+    }
+}
+
+void MroConnection::receive_loop() {
+    Frame in;
+    while (read_frame(fd_, in)) {
+        ++stats_.frames_received;
+        stats_.bytes_received += FRAME_HEADER_BYTES + in.body.size();
+        if (in.kind != FRAME_RESPONSES) break;
+
+        BinaryReader reader(in.body);
+        Message message;
+        for (UInt16 i = 0; i < in.count && next_message(reader, in.body, message); ++i) {
+            ShipResponse response;
+            BinaryReader body(message.body);
+            if (auto parsed = response.deserialize(body); !parsed) {
+                response = ShipResponse{parsed.error().code,
+                    "Undecodable response: " + parsed.error().message, {}, 0};
+            }
+
+            std::promise<ShipResponse> promise;
+            {
+                std::lock_guard lock(mutex_);
+                auto it = pending_.find(message.id);
+                if (it == pending_.end()) continue;
+                promise = std::move(it->second);
+                pending_.erase(it);
+                if (pending_.empty()) drained_.notify_all();
+            }
+            ++stats_.responses;
+            promise.set_value(std::move(response));
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        broken_ = true;
+    }
+    outbound_ready_.notify_all();
+    drained_.notify_all();
+    fail_pending(ErrorCode::SYSIDERR, "MRO connection lost");
+}
+
+void MroConnection::fail_pending(ErrorCode code, StringView reason) {
+    std::unordered_map<UInt32, std::promise<ShipResponse>> failed;
+    {
+        std::lock_guard lock(mutex_);
+        failed.swap(pending_);
+        outbound_.clear();
+        outbound_bytes_ = 0;
+    }
+    for (auto& [id, promise] : failed) {
+        promise.set_value(ShipResponse{code, String(reason), {}, 0});
+    }
+}
+
+void MroConnection::close() {
+    {
+        std::lock_guard lock(mutex_);
+        if (closing_) return;
+        closing_ = true;
+    }
+    outbound_ready_.notify_all();
+    if (sender_.joinable()) sender_.join();  // Flushes what was already shipped
+
+    // Everything still pending is on the wire and the owning region may run
+    // it, so give it the usual time to answer rather than failing it
+    {
+        std::unique_lock lock(mutex_);
+        drained_.wait_for(lock, config_.timeout, [this] { return pending_.empty() || broken_; });
+    }
+
+    ::shutdown(fd_, SHUT_RDWR);
+    if (receiver_.joinable()) receiver_.join();
+    fail_pending(ErrorCode::TIMEDOUT, "MRO connection closed with no response; the request may have run");
+    ::close(fd_);
+}
+
+bool MroConnection::is_open() const {
+    std::lock_guard lock(mutex_);
+    return !closing_ && !broken_;
+}
+
+// =============================================================================
+// MroServer
+// =============================================================================
+
+MroServer::MroServer(String sysid) : sysid_(std::move(sysid)) {}
+
+MroServer::~MroServer() {
+    stop();
+}
+
+Result<void> MroServer::listen(const Path& socket_path) {
+    if (running_) return make_error<void>(ErrorCode::INVALID_STATE, "MRO server already listening");
+
+    sockaddr_un addr{};
+    auto fd = open_socket(socket_path, addr);
+    if (!fd) return make_error<void>(fd.error());
+
+    ::unlink(socket_path.c_str());  // A stale socket from a region that did not stop cleanly
+    if (::bind(fd.value(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd.value(), SOMAXCONN) != 0) {
+        const int err = errno;
+        ::close(fd.value());
+        return make_error<void>(ErrorCode::IO_ERROR,
+            std::format("Cannot listen on {}: {}", socket_path.string(), std::strerror(err)));
+    }
+
+    listen_fd_ = fd.value();
+    socket_path_ = socket_path;
+    running_ = true;
+    acceptor_ = std::thread([this] { accept_loop(); });
+    return {};
+}
+
+void MroServer::stop() {
+    if (!running_.exchange(false)) return;
+
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    if (acceptor_.joinable()) acceptor_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(socket_path_.c_str());
+
+    std::vector<UniquePtr<Session>> sessions;
+    {
+        std::lock_guard lock(sessions_mutex_);
+        sessions.swap(sessions_);
+    }
+    for (auto& session : sessions) ::shutdown(session->fd, SHUT_RDWR);
+    for (auto& session : sessions) {
+        if (session->thread.joinable()) session->thread.join();
+        ::close(session->fd);
+    }
+}
+
+Size MroServer::connection_count() const {
+    std::lock_guard lock(sessions_mutex_);
+    Size live = 0;
+    for (const auto& session : sessions_) {
+        if (!session->done) ++live;
+    }
+    return live;
+}
+
+void MroServer::accept_loop() {
+    while (running_) {
+#ifdef SOCK_CLOEXEC
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+#endif
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;  // Listening socket shut down
+        }
+        if (!prepare_socket(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        std::lock_guard lock(sessions_mutex_);
+        // Reap sessions whose client has gone
+        std::erase_if(sessions_, [](UniquePtr<Session>& session) {
+            if (!session->done) return false;
+            session->thread.join();
+            ::close(session->fd);
+            return true;
+        });
+
+        auto session = make_unique<Session>();
+        session->fd = fd;
+        Session& ref = *session;
+        session->thread = std::thread([this, &ref] { serve(ref); });
+        sessions_.push_back(std::move(session));
+    }
+}
+
+void MroServer::serve(Session& session) {
+    Frame in;
+    std::vector<ByteBuffer> responses;
+    while (read_frame(session.fd, in)) {
+        ++stats_.frames_received;
+        stats_.bytes_received += FRAME_HEADER_BYTES + in.body.size();
+        if (in.kind != FRAME_REQUESTS) break;
+
+        // Run the frame's requests in order and answer them in one frame. A
+        // request that does not decode is answered with the error; only a
+        // frame cut short inside a message ends the session, which fails
+        // whatever the client still has outstanding.
+        BinaryReader reader(in.body);
+        responses.clear();
+        Message message;
+        bool intact = true;
+        for (UInt16 i = 0; i < in.count; ++i) {
+            if (!next_message(reader, in.body, message)) {
+                intact = false;
+                break;
+            }
+
+            ShipRequest request;
+            ShipResponse response;
+            BinaryReader body(message.body);
+            if (auto parsed = request.deserialize(body); !parsed) {
+                response.code = parsed.error().code;
+                response.message = parsed.error().message;
+            } else {
+                response = dispatch(request);
+            }
+            ++stats_.requests;
+            responses.push_back(encode_message(message.id, response,
+                32 + response.message.size() + response.data.size()));
+        }
+
+        const ByteBuffer out = frame(FRAME_RESPONSES, responses);
+        if (!write_all(session.fd, out)) break;
+        ++stats_.frames_sent;
+        stats_.responses += responses.size();
+        stats_.bytes_sent += out.size();
+        if (!intact) break;
+    }
+    session.done = true;
+}
+
+#endif // _WIN32
+
+// =============================================================================
+// Shipping and dispatch
+// =============================================================================
+
+std::future<ShipResponse> MroConnection::ship(const ShipRequest& request) {
+    UInt32 id = 0;
+    return enqueue(request, id);
+}
+
+Result<ShipResponse> MroConnection::call(const ShipRequest& request) {
+    UInt32 id = 0;
+    auto future = enqueue(request, id);
+    if (future.wait_for(config_.timeout) != std::future_status::ready) {
+        // Forget the request; a late response is then dropped unmatched
+        std::lock_guard lock(mutex_);
+        pending_.erase(id);
+        if (pending_.empty()) drained_.notify_all();
+        return make_error<ShipResponse>(ErrorCode::TIMEDOUT,
+            std::format("No response to {} {}", to_string(request.function), request.resource));
+    }
+    ShipResponse response = future.get();
+    if (!response.ok()) return make_error<ShipResponse>(response.code, response.message);
+    return response;
+}
+
+void MroServer::register_handler(FunctionCode function, MirrorHandler handler) {
+    std::unique_lock lock(handlers_mutex_);
+    handlers_[static_cast<Size>(function)] = std::move(handler);
+}
+
+ShipResponse MroServer::dispatch(const ShipRequest& request) const {
+    MirrorHandler handler;
+    {
+        std::shared_lock lock(handlers_mutex_);
+        handler = handlers_[static_cast<Size>(request.function)];
+    }
+    if (!handler) {
+        return ShipResponse{ErrorCode::NOT_SUPPORTED,
+            std::format("{} has no mirror for {}", sysid_, to_string(request.function)), {}, 0};
+    }
+    try {
+        return handler(request);
+    } catch (const std::exception& e) {
+        return ShipResponse{ErrorCode::CICS_ABEND, e.what(), {}, 0};
+    }
+}
+
+// =============================================================================
+// Function shipping
+// =============================================================================
+
+namespace {
+
+ShipRequest make_request(FunctionCode function, StringView resource,
+                         ConstByteSpan key = {}, ConstByteSpan data = {}, UInt32 item = 0) {
+    ShipRequest request;
+    request.function = function;
+    request.resource = String(resource);
+    request.key.assign(key.begin(), key.end());
+    request.data.assign(data.begin(), data.end());
+    request.item = item;
+    return request;
+}
+
+} // namespace
+
+Result<ByteBuffer> MroConnection::link(StringView program, ConstByteSpan commarea) {
+    auto response = call(make_request(FunctionCode::LINK, program, {}, commarea));
+    if (!response) return make_error<ByteBuffer>(response.error());
+    return std::move(response.value().data);
+}
+
+Result<ByteBuffer> MroConnection::read_file(StringView file, ConstByteSpan key) {
+    auto response = call(make_request(FunctionCode::FILE_READ, file, key));
+    if (!response) return make_error<ByteBuffer>(response.error());
+    return std::move(response.value().data);
+}
+
+Result<void> MroConnection::write_file(StringView file, ConstByteSpan key, ConstByteSpan record) {
+    auto response = call(make_request(FunctionCode::FILE_WRITE, file, key, record));
+    if (!response) return make_error<void>(response.error());
+    return {};
+}
+
+Result<void> MroConnection::rewrite_file(StringView file, ConstByteSpan key, ConstByteSpan record) {
+    auto response = call(make_request(FunctionCode::FILE_REWRITE, file, key, record));
+    if (!response) return make_error<void>(response.error());
+    return {};
+}
+
+Result<void> MroConnection::delete_file(StringView file, ConstByteSpan key) {
+    auto response = call(make_request(FunctionCode::FILE_DELETE, file, key));
+    if (!response) return make_error<void>(response.error());
+    return {};
+}
+
+Result<UInt32> MroConnection::writeq_ts(StringView queue, ConstByteSpan data) {
+    auto response = call(make_request(FunctionCode::TS_WRITEQ, queue, {}, data));
+    if (!response) return make_error<UInt32>(response.error());
+    return response.value().item;
+}
+
+Result<ByteBuffer> MroConnection::readq_ts(StringView queue, UInt32 item) {
+    auto response = call(make_request(FunctionCode::TS_READQ, queue, {}, {}, item));
+    if (!response) return make_error<ByteBuffer>(response.error());
+    return std::move(response.value().data);
+}
+
+Result<void> MroConnection::deleteq_ts(StringView queue) {
+    auto response = call(make_request(FunctionCode::TS_DELETEQ, queue));
+    if (!response) return make_error<void>(response.error());
+    return {};
+}
+
+} // namespace cics::mro
@@ -12,6 +12,7 @@
 
 #include <cics/common/types.hpp>
 #include <cics/common/error.hpp>
+#include <cics/common/name_table.hpp>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
@@ -116,6 +117,7 @@ public:
     Result<NamedCounter*> define(StringView counter_name, Int64 initial, 
                                   const CounterOptions& opts = {});
     Result<NamedCounter*> get_counter(StringView name);
+    Result<NamedCounter*> get_counter(NameId name);
     Result<void> delete_counter(StringView name);
     [[nodiscard]] bool exists(StringView name) const;
     
@@ -132,6 +134,7 @@ public:
 private:
     String name_;
     std::unordered_map<String, std::unique_ptr<NamedCounter>> counters_;
+    NameIndex<NamedCounter> counters_by_id_;
     mutable std::mutex mutex_;
 };
 
@@ -176,6 +179,10 @@ public:
     Result<Int64> update(StringView name, Int64 expected, Int64 new_value);
     Result<void> delete_counter(StringView name);
     
+    // By interned name: an array index into the default pool
+    Result<Int64> get(NameId name);
+    Result<Int64> get(NameId name, Int64 increment);
+    
     // Counter operations (with pool)
     Result<Int64> get(StringView pool, StringView name);
     Result<void> put(StringView pool, StringView name, Int64 value);
@@ -161,6 +161,7 @@ Result<NamedCounter*> CounterPool::define(StringView counter_name, Int64 initial
     
     auto counter = std::make_unique<NamedCounter>(counter_name, initial, opts);
     NamedCounter* ptr = counter.get();
+    counters_by_id_.set(NameTable::instance().intern(key), ptr);
     counters_[key] = std::move(counter);
     
     return make_success(ptr);
@@ -178,6 +179,14 @@ Result<NamedCounter*> CounterPool::get_counter(StringView name) {
     return make_success(it->second.get());
 }
 
+Result<NamedCounter*> CounterPool::get_counter(NameId name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (NamedCounter* counter = counters_by_id_.find(name)) return make_success(counter);
+    }
+    return get_counter(NameTable::instance().name(name));
+}
+
 Result<void> CounterPool::delete_counter(StringView name) {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -187,6 +196,7 @@ Result<void> CounterPool::delete_counter(StringView name) {
             "Counter not found: " + String(name));
     }
     
+    counters_by_id_.erase(NameTable::instance().find(it->first));
     counters_.erase(it);
     return make_success();
 }
@@ -366,6 +376,36 @@ Result<Int64> CounterManager::get(StringView name, Int64 increment) {
     return result;
 }
 
+Result<Int64> CounterManager::get(NameId name) {
+    CounterPool* pool = default_pool();
+    if (!pool) {
+        return make_error<Int64>(ErrorCode::NOT_INITIALIZED, "Counter manager not initialized");
+    }
+    
+    auto counter = pool->get_counter(name);
+    if (counter.is_error()) return make_error<Int64>(counter.error());
+    auto result = counter.value()->get();
+    if (result.is_success()) {
+        ++stats_.gets_executed;
+    }
+    return result;
+}
+
+Result<Int64> CounterManager::get(NameId name, Int64 increment) {
+    CounterPool* pool = default_pool();
+    if (!pool) {
+        return make_error<Int64>(ErrorCode::NOT_INITIALIZED, "Counter manager not initialized");
+    }
+    
+    auto counter = pool->get_counter(name);
+    if (counter.is_error()) return make_error<Int64>(counter.error());
+    auto result = counter.value()->get(increment);
+    if (result.is_success()) {
+        ++stats_.gets_executed;
+    }
+    return result;
+}
+
 Result<void> CounterManager::put(StringView name, Int64 value) {
     CounterPool* pool = default_pool();
     if (!pool) {
@@ -8,6 +8,12 @@
 // - RETURN: Return to calling program
 // - LOAD: Load a program into storage
 // - RELEASE: Release a loaded program
+// - NEWCOPY / PHASEIN: Load a new copy of a program from the library
+//
+// Programs are either registered in-process as functions or loaded from the
+// program library (see program_library.hpp) on first use, or at startup for
+// RESIDENT programs. Each LINK and XCTL runs the copy that was current when
+// it started, so a PHASEIN never disturbs a task already in the program.
 // =============================================================================
 
 #ifndef CICS_PROGRAM_CONTROL_HPP
@@ -15,6 +21,9 @@
 
 #include <cics/common/types.hpp>
 #include <cics/common/error.hpp>
+#include <cics/common/name_table.hpp>
+#include <cics/program/program_library.hpp>
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <unordered_map>
@@ -54,6 +63,16 @@ enum class ProgramStatus : UInt8 {
 // Function signature for program entry point
 using ProgramFunction = std::function<Int32(void* commarea, UInt32 commarea_length)>;
 
+// One loaded version of a program; tasks running it hold a reference, so a
+// replaced copy stays in storage until the last of them leaves it
+struct ProgramCopy {
+    ProgramFunction entry_point;
+    void* load_address = nullptr;
+    UInt32 program_size = 0;
+    UInt32 version = 0;
+    SharedPtr<LoadModule> module;   // Null for in-process programs
+};
+
 struct ProgramDefinition {
     FixedString<8> program_name;
     ProgramType type = ProgramType::NATIVE;
@@ -68,6 +87,14 @@ struct ProgramDefinition {
     String language;
     bool resident = false;  // Keep in storage
     
+    // Loadable programs: library member and entry point, defaulting to the
+    // program name; unused when entry_point is set
+    String module_name;
+    String entry_symbol;
+    SharedPtr<const ProgramCopy> current_copy;  // Null until first loaded
+    
+    [[nodiscard]] bool is_loadable() const { return !entry_point; }
+    
     [[nodiscard]] bool is_loaded() const { 
         return status == ProgramStatus::LOADED || status == ProgramStatus::ENABLED; 
     }
@@ -81,7 +108,8 @@ struct ProgramDefinition {
 struct LinkLevel {
     FixedString<8> program_name;
     void* commarea = nullptr;
-    UInt32 commarea_length = 0;
+    UInt32 commarea_length = 0;     // The program may change it within capacity
+    UInt32 commarea_capacity = 0;
     void* return_address = nullptr;
     Int32 response_code = 0;
     std::chrono::steady_clock::time_point entry_time;
@@ -97,6 +125,7 @@ private:
     
     // Program definitions (PPT - Processing Program Table)
     std::unordered_map<String, ProgramDefinition> programs_;
+    NameIndex<ProgramDefinition> programs_by_id_;
     
     // Current program stack per thread
     thread_local static std::stack<LinkLevel> link_stack_;
@@ -110,11 +139,27 @@ private:
         UInt64 load_count = 0;
         UInt64 release_count = 0;
         UInt64 program_not_found = 0;
+        UInt64 module_loads = 0;
+        UInt64 load_failures = 0;
+        UInt64 newcopy_count = 0;
+        UInt64 phasein_count = 0;
         UInt32 max_link_depth = 0;
     } stats_;
     
+    // DFHRPL analogue, initialised from PROGRAM_LIBRARY_ENV
+    ProgramLibrary library_;
+    std::atomic<UInt32> next_version_{0};
+    
+    Result<SharedPtr<const ProgramCopy>> load_copy(const ProgramDefinition& program);
+    Result<SharedPtr<const ProgramCopy>> ensure_copy(std::unique_lock<std::mutex>& lock, const String& key);
+    Result<SharedPtr<const ProgramCopy>> enter(StringView program_name, ProgramDefinition*& program);
+    Result<SharedPtr<const ProgramCopy>> enter(NameId program_id, ProgramDefinition*& program);
+    Result<Int32> run_linked(ProgramDefinition& program, const ProgramCopy& copy,
+                             ByteSpan commarea, UInt32& length);
+    Result<void> replace_copy(StringView name, bool phasein);
+    
 public:
-    ProgramControlManager() = default;
+    ProgramControlManager();
     ~ProgramControlManager() = default;
     
     // Singleton access
@@ -133,6 +178,15 @@ public:
     Result<Int32> link(StringView program_name, void* commarea, UInt32 commarea_length);
     Result<Int32> link(StringView program_name, ByteBuffer& commarea);
     
+    // The COMMAREA is passed in place, never copied: the program works in
+    // the caller's storage and may set the returned length up to the
+    // storage's size, which `length` then holds
+    Result<Int32> link(StringView program_name, ByteSpan commarea, UInt32& length);
+    
+    // By interned name: an array index once the program is loaded
+    Result<Int32> link(NameId program_id, void* commarea, UInt32 commarea_length);
+    Result<Int32> link(NameId program_id, ByteSpan commarea, UInt32& length);
+    
     // XCTL - Transfer control (does not return)
     Result<void> xctl(StringView program_name);
     Result<void> xctl(StringView program_name, void* commarea, UInt32 commarea_length);
@@ -152,6 +206,12 @@ public:
     Result<void> release(StringView program_name);
     Result<void> release_all();
     
+    // The running program's COMMAREA: all the storage the caller passed, so
+    // a further LINK can hand it down whole, and the length in use there
+    [[nodiscard]] ByteSpan current_commarea() const;
+    [[nodiscard]] UInt32 current_commarea_length() const;
+    Result<void> set_commarea_length(UInt32 length);
+    
     // Query operations
     [[nodiscard]] FixedString<8> get_current_program() const;
     [[nodiscard]] UInt32 get_link_depth() const;
@@ -160,7 +220,16 @@ public:
     // Enable/Disable programs
     Result<void> enable_program(StringView name);
     Result<void> disable_program(StringView name);
+    
+    // NEWCOPY refuses a program in use; PHASEIN lets current users finish
+    // on the old copy while new LINKs get the new one
     Result<void> newcopy_program(StringView name);
+    Result<void> phasein_program(StringView name);
+    
+    // Program library, and the startup preload of RESIDENT programs that
+    // takes the load out of their first LINK; returns the number loaded
+    [[nodiscard]] ProgramLibrary& library() { return library_; }
+    Result<UInt32> preload_resident();
     
     // Statistics
     [[nodiscard]] String get_statistics() const;
@@ -173,6 +242,7 @@ public:
 
 Result<Int32> exec_cics_link(StringView program);
 Result<Int32> exec_cics_link(StringView program, void* commarea, UInt32 length);
+Result<Int32> exec_cics_link(NameId program, void* commarea, UInt32 length);
 Result<void> exec_cics_xctl(StringView program);
 Result<void> exec_cics_xctl(StringView program, void* commarea, UInt32 length);
 Result<void> exec_cics_return();
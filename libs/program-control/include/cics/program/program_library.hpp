@@ -0,0 +1,98 @@
+// =============================================================================
+// CICS Emulation - Program Library
+// Version: 3.4.6
+// =============================================================================
+// Loadable programs and the library they are loaded from:
+// - ProgramLibrary: ordered search path of directories, the DFHRPL analogue
+// - LoadModule: one dlopen()ed copy of a program's shared object
+//
+// A loadable program is a shared object exporting a C entry point with the
+// ProgramEntry signature, named after the program (CUSTINQ) as a COBOL
+// compile names its PROGRAM-ID, or cics_program_entry. Every load maps a
+// private copy of the file, so a new copy of a program can be loaded while
+// tasks still run the old one, and each copy is unmapped when its last user
+// lets go of it. The copy is an in-memory file (memfd) where the system has
+// them, else a file in a new directory only this user can enter.
+// =============================================================================
+
+#ifndef CICS_PROGRAM_LIBRARY_HPP
+#define CICS_PROGRAM_LIBRARY_HPP
+
+#include <cics/common/types.hpp>
+#include <cics/common/error.hpp>
+#include <mutex>
+#include <vector>
+
+namespace cics {
+namespace program {
+
+// C entry point of a loadable program
+using ProgramEntry = Int32 (*)(void* commarea, UInt32 commarea_length);
+
+// Exported by programs whose entry point is not named after the program
+inline constexpr const char* DEFAULT_ENTRY_SYMBOL = "cics_program_entry";
+
+// Environment variable holding the library search path, ':'-separated
+inline constexpr const char* PROGRAM_LIBRARY_ENV = "CICS_RPL";
+
+// =============================================================================
+// Load Module
+// =============================================================================
+
+class LoadModule {
+public:
+    // Load a private copy of the shared object at `path` and resolve its
+    // entry point: `entry_symbol` if given, else the program name as
+    // written, in lower case, then DEFAULT_ENTRY_SYMBOL
+    static Result<SharedPtr<LoadModule>> open(const Path& path, StringView program_name,
+                                              StringView entry_symbol = {});
+
+    ~LoadModule();
+    LoadModule(const LoadModule&) = delete;
+    LoadModule& operator=(const LoadModule&) = delete;
+
+    [[nodiscard]] ProgramEntry entry() const { return entry_; }
+    [[nodiscard]] const Path& path() const { return path_; }
+    [[nodiscard]] const String& entry_symbol() const { return symbol_; }
+    [[nodiscard]] UInt32 size() const { return size_; }
+
+private:
+    LoadModule() = default;
+
+    void* handle_ = nullptr;
+    int copy_fd_ = -1;              // The in-memory copy, while it is loaded
+    ProgramEntry entry_ = nullptr;
+    Path path_;
+    String symbol_;
+    UInt32 size_ = 0;
+};
+
+// =============================================================================
+// Program Library
+// =============================================================================
+
+class ProgramLibrary {
+public:
+    ProgramLibrary() = default;
+
+    // Directories are searched in order; the first match wins
+    void set_search_path(std::vector<Path> directories);
+    void add_directory(const Path& directory);
+    [[nodiscard]] std::vector<Path> search_path() const;
+
+    // Parse a ':'-separated list, as held in PROGRAM_LIBRARY_ENV
+    [[nodiscard]] static std::vector<Path> parse_search_path(StringView spec);
+
+    // First of lib<member>.so, <member>.so and <member> in each directory,
+    // trying the member name as written and in lower case
+    [[nodiscard]] Result<Path> locate(StringView member) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Path> directories_;
+};
+
+} // namespace program
+} // namespace cics
+
+#endif // CICS_PROGRAM_LIBRARY_HPP
@@ -6,6 +6,7 @@
 #include <cics/program/program_control.hpp>
 #include <sstream>
 #include <algorithm>
+#include <cstdlib>
 
 namespace cics {
 namespace program {
@@ -32,6 +33,12 @@ String ProgramDefinition::to_string() const {
 // ProgramControlManager Implementation
 // =============================================================================
 
+ProgramControlManager::ProgramControlManager() {
+    if (const char* rpl = std::getenv(PROGRAM_LIBRARY_ENV)) {
+        library_.set_search_path(ProgramLibrary::parse_search_path(rpl));
+    }
+}
+
 ProgramControlManager& ProgramControlManager::instance() {
     static ProgramControlManager instance;
     return instance;
@@ -45,8 +52,11 @@ Result<void> ProgramControlManager::define_program(const ProgramDefinition& def)
     name.erase(std::find_if(name.rbegin(), name.rend(), 
         [](unsigned char ch) { return !std::isspace(ch); }).base(), name.end());
     
-    programs_[name] = def;
-    programs_[name].status = ProgramStatus::ENABLED;
+    ProgramDefinition& program = programs_[name];
+    program = def;
+    program.status = ProgramStatus::ENABLED;
+    programs_by_id_.set(NameTable::instance().intern(name), &program);
+    note_resource_change();
     
     return make_success();
 }
@@ -76,7 +86,9 @@ Result<void> ProgramControlManager::undefine_program(StringView name) {
             "Program is in use: " + key);
     }
     
+    programs_by_id_.erase(NameTable::instance().find(key));
     programs_.erase(it);
+    note_resource_change();
     return make_success();
 }
 
@@ -111,41 +123,153 @@ Result<Int32> ProgramControlManager::link(StringView program_name) {
     return link(program_name, nullptr, 0);
 }
 
+Result<SharedPtr<const ProgramCopy>> ProgramControlManager::load_copy(const ProgramDefinition& program) {
+    using ResultType = SharedPtr<const ProgramCopy>;
+    auto copy = std::make_shared<ProgramCopy>();
+    copy->version = ++next_version_;
+    
+    if (!program.is_loadable()) {
+        copy->entry_point = program.entry_point;
+        copy->load_address = program.load_address;
+        copy->program_size = program.program_size;
+        return make_success<ResultType>(std::move(copy));
+    }
+    
+    const String name = program.program_name.trimmed();
+    auto path = library_.locate(program.module_name.empty() ? name : program.module_name);
+    if (!path) return make_error<ResultType>(path.error());
+    auto module = LoadModule::open(path.value(), name, program.entry_symbol);
+    if (!module) return make_error<ResultType>(module.error());
+    
+    // The copy owns the module, so the entry point outlives every call through it
+    const ProgramEntry entry = module.value()->entry();
+    copy->entry_point = entry;
+    copy->load_address = reinterpret_cast<void*>(entry);
+    copy->program_size = module.value()->size();
+    copy->module = std::move(module.value());
+    return make_success<ResultType>(std::move(copy));
+}
+
+Result<SharedPtr<const ProgramCopy>> ProgramControlManager::ensure_copy(std::unique_lock<std::mutex>& lock,
+                                                                        const String& key) {
+    using ResultType = SharedPtr<const ProgramCopy>;
+    auto it = programs_.find(key);
+    if (it == programs_.end()) {
+        return make_error<ResultType>(ErrorCode::RECORD_NOT_FOUND, "Program not found: " + key);
+    }
+    if (it->second.current_copy) return make_success(it->second.current_copy);
+    
+    // Load without the lock; LINKs to other programs carry on meanwhile
+    const ProgramDefinition wanted = it->second;
+    lock.unlock();
+    auto copy = load_copy(wanted);
+    lock.lock();
+    
+    if (!copy) {
+        ++stats_.load_failures;
+        return make_error<ResultType>(copy.error());
+    }
+    it = programs_.find(key);
+    if (it == programs_.end()) {
+        return make_error<ResultType>(ErrorCode::RECORD_NOT_FOUND, "Program not found: " + key);
+    }
+    ProgramDefinition& program = it->second;
+    if (!program.current_copy) {
+        // Another task may have loaded it first; theirs is kept
+        if (copy.value()->module) ++stats_.module_loads;
+        program.current_copy = std::move(copy.value());
+        program.program_size = program.current_copy->program_size;
+        program.load_time = std::chrono::steady_clock::now();
+        if (program.is_loadable()) program.load_address = program.current_copy->load_address;
+    }
+    return make_success(program.current_copy);
+}
+
+Result<SharedPtr<const ProgramCopy>> ProgramControlManager::enter(StringView program_name,
+                                                                  ProgramDefinition*& program) {
+    using ResultType = SharedPtr<const ProgramCopy>;
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    String key(program_name);
+    auto it = programs_.find(key);
+    if (it == programs_.end()) {
+        ++stats_.program_not_found;
+        return make_error<ResultType>(ErrorCode::RECORD_NOT_FOUND,
+            "Program not found: " + key);
+    }
+    
+    if (it->second.status == ProgramStatus::DISABLED) {
+        return make_error<ResultType>(ErrorCode::INVALID_STATE,
+            "Program is disabled: " + key);
+    }
+    
+    auto copy = ensure_copy(lock, key);
+    if (!copy) return copy;
+    
+    program = &programs_.find(key)->second;
+    ++program->use_count;
+    return copy;
+}
+
+Result<SharedPtr<const ProgramCopy>> ProgramControlManager::enter(NameId program_id,
+                                                                  ProgramDefinition*& program) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ProgramDefinition* indexed = programs_by_id_.find(program_id);
+        if (indexed != nullptr && indexed->current_copy &&
+            indexed->status != ProgramStatus::DISABLED) {
+            program = indexed;
+            ++program->use_count;
+            return make_success(program->current_copy);
+        }
+    }
+    // Not yet loaded, disabled or unknown: as by name, which reports why
+    return enter(NameTable::instance().name(program_id), program);
+}
+
 Result<Int32> ProgramControlManager::link(StringView program_name, void* commarea, 
                                            UInt32 commarea_length) {
+    return link(program_name, ByteSpan(static_cast<Byte*>(commarea), commarea_length), commarea_length);
+}
+
+Result<Int32> ProgramControlManager::link(StringView program_name, ByteSpan commarea, UInt32& length) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.link_count;
+    }
     ProgramDefinition* program = nullptr;
+    auto copy = enter(program_name, program);
+    if (!copy) return make_error<Int32>(copy.error());
+    return run_linked(*program, *copy.value(), commarea, length);
+}
+
+Result<Int32> ProgramControlManager::link(NameId program_id, void* commarea, UInt32 commarea_length) {
+    return link(program_id, ByteSpan(static_cast<Byte*>(commarea), commarea_length), commarea_length);
+}
+
+Result<Int32> ProgramControlManager::link(NameId program_id, ByteSpan commarea, UInt32& length) {
     {
         std::lock_guard<std::mutex> lock(mutex_);
         ++stats_.link_count;
-        
-        String key(program_name);
-        auto it = programs_.find(key);
-        if (it == programs_.end()) {
-            ++stats_.program_not_found;
-            return make_error<Int32>(ErrorCode::RECORD_NOT_FOUND,
-                "Program not found: " + key);
-        }
-        
-        program = &it->second;
-        
-        if (program->status == ProgramStatus::DISABLED) {
-            return make_error<Int32>(ErrorCode::INVALID_STATE,
-                "Program is disabled: " + key);
-        }
-        
-        if (!program->entry_point) {
-            return make_error<Int32>(ErrorCode::INVALID_STATE,
-                "Program has no entry point: " + key);
-        }
-        
-        ++program->use_count;
     }
+    ProgramDefinition* program = nullptr;
+    auto copy = enter(program_id, program);
+    if (!copy) return make_error<Int32>(copy.error());
+    return run_linked(*program, *copy.value(), commarea, length);
+}
+
+Result<Int32> ProgramControlManager::run_linked(ProgramDefinition& program, const ProgramCopy& copy,
+                                                ByteSpan commarea, UInt32& length) {
+    const UInt32 capacity = static_cast<UInt32>(std::min<Size>(commarea.size(), UINT32_MAX));
+    length = std::min(length, capacity);
+    void* const area = commarea.empty() ? nullptr : commarea.data();
     
     // Push current level
     LinkLevel level;
     level.program_name = current_program_;
-    level.commarea = commarea;
-    level.commarea_length = commarea_length;
+    level.commarea = area;
+    level.commarea_length = length;
+    level.commarea_capacity = capacity;
     level.entry_time = std::chrono::steady_clock::now();
     link_stack_.push(level);
     
@@ -158,12 +282,12 @@ Result<Int32> ProgramControlManager::link(StringView program_name, void* commare
     
     // Save current and switch
     FixedString<8> saved_program = current_program_;
-    current_program_ = program->program_name;
+    current_program_ = program.program_name;
     
     // Execute the program
     Int32 result = 0;
     try {
-        result = program->entry_point(commarea, commarea_length);
+        result = copy.entry_point(area, length);
     } catch (...) {
         // Restore state on exception
         current_program_ = saved_program;
@@ -171,25 +295,29 @@ Result<Int32> ProgramControlManager::link(StringView program_name, void* commare
         
         {
             std::lock_guard<std::mutex> lock(mutex_);
-            --program->use_count;
+            --program.use_count;
         }
         throw;
     }
     
-    // Restore state
+    // Restore state; the area comes back in place with the length it was left at
+    length = link_stack_.top().commarea_length;
     current_program_ = saved_program;
     link_stack_.pop();
     
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        --program->use_count;
+        --program.use_count;
     }
     
     return make_success(result);
 }
 
 Result<Int32> ProgramControlManager::link(StringView program_name, ByteBuffer& commarea) {
-    return link(program_name, commarea.data(), static_cast<UInt32>(commarea.size()));
+    UInt32 length = static_cast<UInt32>(commarea.size());
+    auto result = link(program_name, ByteSpan(commarea), length);
+    if (result) commarea.resize(length);  // Shrinks only; never reallocates
+    return result;
 }
 
 Result<void> ProgramControlManager::xctl(StringView program_name) {
@@ -198,40 +326,20 @@ Result<void> ProgramControlManager::xctl(StringView program_name) {
 
 Result<void> ProgramControlManager::xctl(StringView program_name, void* commarea,
                                           UInt32 commarea_length) {
-    ProgramDefinition* program = nullptr;
     {
         std::lock_guard<std::mutex> lock(mutex_);
         ++stats_.xctl_count;
-        
-        String key(program_name);
-        auto it = programs_.find(key);
-        if (it == programs_.end()) {
-            ++stats_.program_not_found;
-            return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
-                "Program not found: " + key);
-        }
-        
-        program = &it->second;
-        
-        if (program->status == ProgramStatus::DISABLED) {
-            return make_error<void>(ErrorCode::INVALID_STATE,
-                "Program is disabled: " + key);
-        }
-        
-        if (!program->entry_point) {
-            return make_error<void>(ErrorCode::INVALID_STATE,
-                "Program has no entry point: " + key);
-        }
-        
-        ++program->use_count;
     }
+    ProgramDefinition* program = nullptr;
+    auto copy = enter(program_name, program);
+    if (!copy) return make_error<void>(copy.error());
     
     // Replace current link level (don't push)
     current_program_ = program->program_name;
     
     // Execute the program
     try {
-        program->entry_point(commarea, commarea_length);
+        copy.value()->entry_point(commarea, commarea_length);
     } catch (...) {
         {
             std::lock_guard<std::mutex> lock(mutex_);
@@ -291,21 +399,22 @@ Result<void*> ProgramControlManager::load(StringView program_name) {
 }
 
 Result<void*> ProgramControlManager::load(StringView program_name, bool hold) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
     ++stats_.load_count;
     
     String key(program_name);
-    auto it = programs_.find(key);
-    if (it == programs_.end()) {
+    if (programs_.find(key) == programs_.end()) {
         ++stats_.program_not_found;
         return make_error<void*>(ErrorCode::RECORD_NOT_FOUND,
             "Program not found: " + key);
     }
     
-    ProgramDefinition& program = it->second;
+    auto copy = ensure_copy(lock, key);
+    if (!copy) return make_error<void*>(copy.error());
+    
+    ProgramDefinition& program = programs_.find(key)->second;
     program.status = ProgramStatus::LOADED;
     ++program.load_count;
-    program.load_time = std::chrono::steady_clock::now();
     
     if (hold) {
         program.resident = true;
@@ -356,6 +465,29 @@ Result<void> ProgramControlManager::release_all() {
     return make_success();
 }
 
+ByteSpan ProgramControlManager::current_commarea() const {
+    if (link_stack_.empty()) return {};
+    const LinkLevel& level = link_stack_.top();
+    return ByteSpan(static_cast<Byte*>(level.commarea), level.commarea_capacity);
+}
+
+UInt32 ProgramControlManager::current_commarea_length() const {
+    return link_stack_.empty() ? 0 : link_stack_.top().commarea_length;
+}
+
+Result<void> ProgramControlManager::set_commarea_length(UInt32 length) {
+    if (link_stack_.empty()) {
+        return make_error<void>(ErrorCode::INVALID_STATE, "No program is linked to");
+    }
+    LinkLevel& level = link_stack_.top();
+    if (length > level.commarea_capacity) {
+        return make_error<void>(ErrorCode::BUFFER_OVERFLOW,
+            "COMMAREA length exceeds the caller's storage");
+    }
+    level.commarea_length = length;
+    return make_success();
+}
+
 FixedString<8> ProgramControlManager::get_current_program() const {
     return current_program_;
 }
@@ -386,6 +518,7 @@ Result<void> ProgramControlManager::enable_program(StringView name) {
     }
     
     it->second.status = ProgramStatus::ENABLED;
+    note_resource_change();
     return make_success();
 }
 
@@ -405,23 +538,86 @@ Result<void> ProgramControlManager::disable_program(StringView name) {
     }
     
     it->second.status = ProgramStatus::DISABLED;
+    note_resource_change();
     return make_success();
 }
 
 Result<void> ProgramControlManager::newcopy_program(StringView name) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+    return replace_copy(name, false);
+}
+
+Result<void> ProgramControlManager::phasein_program(StringView name) {
+    return replace_copy(name, true);
+}
+
+Result<void> ProgramControlManager::replace_copy(StringView name, bool phasein) {
     String key(name);
+    auto in_use = [&key]() {
+        return make_error<void>(ErrorCode::RESOURCE_EXHAUSTED,
+            "Program is in use, PHASEIN is needed: " + key);
+    };
+    
+    ProgramDefinition wanted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = programs_.find(key);
+        if (it == programs_.end()) {
+            return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
+                "Program not found: " + key);
+        }
+        if (!phasein && it->second.use_count > 0) return in_use();
+        wanted = it->second;
+    }
+    
+    auto copy = load_copy(wanted);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!copy) {
+        ++stats_.load_failures;
+        return make_error<void>(copy.error());
+    }
     auto it = programs_.find(key);
     if (it == programs_.end()) {
         return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
             "Program not found: " + key);
     }
+    ProgramDefinition& program = it->second;
+    if (!phasein && program.use_count > 0) return in_use();
     
-    it->second.status = ProgramStatus::NEW_COPY;
+    // Tasks already in the program keep the copy they entered
+    if (copy.value()->module) ++stats_.module_loads;
+    ++(phasein ? stats_.phasein_count : stats_.newcopy_count);
+    program.current_copy = std::move(copy.value());
+    program.program_size = program.current_copy->program_size;
+    program.load_time = std::chrono::steady_clock::now();
+    if (program.is_loadable()) program.load_address = program.current_copy->load_address;
+    note_resource_change();
     return make_success();
 }
 
+Result<UInt32> ProgramControlManager::preload_resident() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<String> resident;
+    for (const auto& [name, program] : programs_) {
+        if (program.resident && !program.current_copy) resident.push_back(name);
+    }
+    
+    UInt32 loaded = 0;
+    String failed;
+    for (const auto& name : resident) {
+        if (ensure_copy(lock, name)) {
+            ++loaded;
+        } else {
+            failed += (failed.empty() ? "" : ", ") + name;
+        }
+    }
+    if (!failed.empty()) {
+        return make_error<UInt32>(ErrorCode::CICS_PROGRAM_NOT_FOUND,
+            "Resident programs not loaded: " + failed);
+    }
+    return make_success(loaded);
+}
+
 String ProgramControlManager::get_statistics() const {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -433,6 +629,9 @@ String ProgramControlManager::get_statistics() const {
         << "  LOAD calls:           " << stats_.load_count << "\n"
         << "  RELEASE calls:        " << stats_.release_count << "\n"
         << "  Program not found:    " << stats_.program_not_found << "\n"
+        << "  Modules loaded:       " << stats_.module_loads << "\n"
+        << "  Load failures:        " << stats_.load_failures << "\n"
+        << "  NEWCOPY / PHASEIN:    " << stats_.newcopy_count << " / " << stats_.phasein_count << "\n"
         << "  Max link depth:       " << stats_.max_link_depth << "\n"
         << "  Defined programs:     " << programs_.size() << "\n";
     
@@ -456,6 +655,10 @@ Result<Int32> exec_cics_link(StringView program, void* commarea, UInt32 length)
     return ProgramControlManager::instance().link(program, commarea, length);
 }
 
+Result<Int32> exec_cics_link(NameId program, void* commarea, UInt32 length) {
+    return ProgramControlManager::instance().link(program, commarea, length);
+}
+
 Result<void> exec_cics_xctl(StringView program) {
     return ProgramControlManager::instance().xctl(program);
 }
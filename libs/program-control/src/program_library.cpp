@@ -0,0 +1,262 @@
+// =============================================================================
+// CICS Emulation - Program Library Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include <cics/program/program_library.hpp>
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <system_error>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace cics {
+namespace program {
+
+namespace {
+
+String to_lower(StringView text) {
+    String lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+        [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    return lower;
+}
+
+} // namespace
+
+// =============================================================================
+// LoadModule Implementation
+// =============================================================================
+
+#ifdef _WIN32
+
+Result<SharedPtr<LoadModule>> LoadModule::open(const Path&, StringView, StringView) {
+    return make_error<SharedPtr<LoadModule>>(ErrorCode::NOT_SUPPORTED, "Loadable programs need dlopen");
+}
+
+LoadModule::~LoadModule() = default;
+
+#else
+
+namespace {
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd = -1) : fd_(fd) {}
+    ~FileDescriptor() { if (fd_ >= 0) ::close(fd_); }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    [[nodiscard]] int get() const { return fd_; }
+    [[nodiscard]] int release() { return std::exchange(fd_, -1); }
+    explicit operator bool() const { return fd_ >= 0; }
+
+private:
+    int fd_;
+};
+
+bool copy_contents(int source, int target) {
+    char buffer[64 * 1024];
+    for (;;) {
+        const ssize_t got = ::read(source, buffer, sizeof buffer);
+        if (got == 0) return true;
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (ssize_t done = 0; done < got;) {
+            const ssize_t put = ::write(target, buffer + done, static_cast<Size>(got - done));
+            if (put < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += put;
+        }
+    }
+}
+
+String errno_text() {
+    return std::system_category().message(errno);
+}
+
+// dlopen() of a copy of the open file `source`. The loader hands back the
+// mapping it already has for a file name, so each load needs a name of its
+// own; the copy is never reachable under a name anyone else can write or
+// swap. `kept` is a descriptor to hold until the module is closed.
+void* load_private_copy(int source, int& kept, String& failure) {
+#ifdef MFD_CLOEXEC
+    // An anonymous in-memory file, loaded through its descriptor. The
+    // descriptor stays open while loaded, so no later load reuses its name.
+    FileDescriptor memory(static_cast<int>(::memfd_create("cics-load-module", MFD_CLOEXEC)));
+    if (memory) {
+        if (!copy_contents(source, memory.get())) {
+            failure = "cannot copy: " + errno_text();
+            return nullptr;
+        }
+        const String fd_path = std::format("/proc/self/fd/{}", memory.get());
+        void* handle = ::dlopen(fd_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            const char* reason = ::dlerror();
+            failure = reason ? reason : "unknown error";
+        } else {
+            kept = memory.release();
+        }
+        return handle;
+    }
+    if (errno != ENOSYS) {
+        failure = "cannot create an in-memory copy: " + errno_text();
+        return nullptr;
+    }
+#endif
+
+    // A new directory only this user can enter, removed once loaded
+    std::error_code ec;
+    String dir_template = (std::filesystem::temp_directory_path(ec) / "cics-load-XXXXXX").string();
+    if (ec || ::mkdtemp(dir_template.data()) == nullptr) {
+        failure = "cannot create a staging directory: " + (ec ? ec.message() : errno_text());
+        return nullptr;
+    }
+    const Path directory(dir_template);
+    const Path staged = directory / "module.so";
+    void* handle = nullptr;
+    {
+        FileDescriptor copy(::open(staged.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0700));
+        if (!copy || !copy_contents(source, copy.get())) {
+            failure = "cannot copy: " + errno_text();
+        }
+    }
+    if (failure.empty()) {
+        handle = ::dlopen(staged.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr) {
+            const char* reason = ::dlerror();
+            failure = reason ? reason : "unknown error";
+        }
+    }
+    std::filesystem::remove_all(directory, ec);
+    return handle;
+}
+
+} // namespace
+
+Result<SharedPtr<LoadModule>> LoadModule::open(const Path& path, StringView program_name,
+                                               StringView entry_symbol) {
+    using ResultType = SharedPtr<LoadModule>;
+
+    // Size and contents both come from this one open of the file
+    FileDescriptor source(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat status {};
+    if (!source || ::fstat(source.get(), &status) != 0) {
+        return make_error<ResultType>(ErrorCode::FILE_NOT_FOUND,
+            std::format("Cannot read load module {}: {}", path.string(), errno_text()));
+    }
+    if (!S_ISREG(status.st_mode)) {
+        return make_error<ResultType>(ErrorCode::FILE_NOT_FOUND,
+            std::format("Cannot read load module {}: not a regular file", path.string()));
+    }
+
+    String failure;
+    int kept = -1;
+    void* handle = load_private_copy(source.get(), kept, failure);
+    if (handle == nullptr) {
+        return make_error<ResultType>(ErrorCode::IO_ERROR,
+            std::format("Cannot load {}: {}", path.string(), failure));
+    }
+
+    auto module = ResultType(new LoadModule());
+    module->handle_ = handle;
+    module->copy_fd_ = kept;
+    module->path_ = path;
+    module->size_ = static_cast<UInt32>(std::min<std::uintmax_t>(static_cast<std::uintmax_t>(status.st_size), UINT32_MAX));
+
+    std::vector<String> candidates;
+    if (!entry_symbol.empty()) {
+        candidates.emplace_back(entry_symbol);
+    } else {
+        candidates.emplace_back(program_name);
+        candidates.push_back(to_lower(program_name));
+        candidates.emplace_back(DEFAULT_ENTRY_SYMBOL);
+    }
+    for (const auto& symbol : candidates) {
+        if (void* address = ::dlsym(handle, symbol.c_str())) {
+            module->entry_ = reinterpret_cast<ProgramEntry>(address);
+            module->symbol_ = symbol;
+            return make_success(std::move(module));
+        }
+    }
+    return make_error<ResultType>(ErrorCode::CICS_PROGRAM_NOT_FOUND,
+        std::format("{} exports no entry point for {}", path.string(), program_name));
+}
+
+LoadModule::~LoadModule() {
+    if (handle_ != nullptr) ::dlclose(handle_);
+    if (copy_fd_ >= 0) ::close(copy_fd_);
+}
+
+#endif // _WIN32
+
+// =============================================================================
+// ProgramLibrary Implementation
+// =============================================================================
+
+void ProgramLibrary::set_search_path(std::vector<Path> directories) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directories_ = std::move(directories);
+}
+
+void ProgramLibrary::add_directory(const Path& directory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directories_.push_back(directory);
+}
+
+std::vector<Path> ProgramLibrary::search_path() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return directories_;
+}
+
+std::vector<Path> ProgramLibrary::parse_search_path(StringView spec) {
+    std::vector<Path> directories;
+    while (!spec.empty()) {
+        const Size colon = spec.find(':');
+        const StringView entry = spec.substr(0, colon);
+        if (!entry.empty()) directories.emplace_back(entry);
+        if (colon == StringView::npos) break;
+        spec.remove_prefix(colon + 1);
+    }
+    return directories;
+}
+
+Result<Path> ProgramLibrary::locate(StringView member) const {
+    const std::vector<Path> directories = search_path();
+    if (directories.empty()) {
+        return make_error<Path>(ErrorCode::CICS_PROGRAM_NOT_FOUND,
+            std::format("Program {} is not loadable: the program library is empty", member));
+    }
+
+    String names[2] = {String(member), to_lower(member)};
+    const Size variants = names[0] == names[1] ? 1 : 2;
+    std::error_code ec;
+    for (const auto& directory : directories) {
+        for (Size i = 0; i < variants; ++i) {
+            for (const String& file : {"lib" + names[i] + ".so", names[i] + ".so", names[i]}) {
+                Path candidate = directory / file;
+                if (std::filesystem::is_regular_file(candidate, ec)) return make_success(std::move(candidate));
+            }
+        }
+    }
+    return make_error<Path>(ErrorCode::CICS_PROGRAM_NOT_FOUND,
+        std::format("Program {} not found in the program library", member));
+}
+
+} // namespace program
+} // namespace cics
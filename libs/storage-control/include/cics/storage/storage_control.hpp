@@ -6,6 +6,7 @@
 // - GETMAIN: Acquire storage
 // - FREEMAIN: Release storage
 // - Storage pools and tracking
+// - Dynamic storage areas with cushions and short-on-storage detection
 // =============================================================================
 
 #ifndef CICS_STORAGE_CONTROL_HPP
@@ -17,6 +18,9 @@
 #include <unordered_map>
 #include <memory>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <cstring>
 
 namespace cics {
@@ -36,6 +40,8 @@ enum class StorageClass : UInt8 {
     SHARED      // Shared storage (cross-transaction)
 };
 
+constexpr Size STORAGE_CLASS_COUNT = 7;
+
 enum class StorageInit : UInt8 {
     DEFAULT,    // No initialization
     ZERO,       // Initialize to zeros
@@ -56,6 +62,7 @@ struct StorageBlock {
     bool shared = false;
     std::chrono::steady_clock::time_point allocation_time;
     String tag;  // Optional identification tag
+    bool pooled = false;  // Taken from its DSA's free lists
     
     [[nodiscard]] bool is_valid() const { return address != nullptr && size > 0; }
 };
@@ -63,27 +70,83 @@ struct StorageBlock {
 // =============================================================================
 // Storage Pool
 // =============================================================================
+//
+// One pool per storage class, acting as that class's DSA. A DSA may have a
+// limit of its own on top of the manager's overall maximum, and a cushion:
+// the last bytes below the limit. A GETMAIN that has to dip into the cushion
+// still succeeds, so tasks already running can finish, but it puts the DSA
+// short on storage. That state is cleared once twice the cushion is free
+// again. Freed blocks of up to MAX_POOLED_SIZE bytes are kept on per-size-class
+// free lists, so reuse needs neither malloc nor the manager's lock.
+
+enum class StorageAdmit : UInt8 {
+    OK,         // Within the limit
+    CUSHION,    // Granted from the cushion
+    FULL        // Refused
+};
 
 class StoragePool {
+public:
+    static constexpr UInt32 MAX_POOLED_SIZE = 4096;
+    static constexpr Size SIZE_CLASS_COUNT = 28;
+    static constexpr Size MAX_CACHED_PER_CLASS = 256;       // In the pool's shared lists
+    static constexpr Size THREAD_CACHED_PER_CLASS = 32;     // In each thread's own cache
+
 private:
     StorageClass class_;
-    UInt64 total_size_ = 0;
-    UInt64 used_size_ = 0;
-    UInt64 peak_size_ = 0;
-    UInt32 allocation_count_ = 0;
+    std::atomic<UInt64> total_size_{0};
+    std::atomic<UInt64> used_size_{0};
+    std::atomic<UInt64> peak_size_{0};
+    std::atomic<UInt32> allocation_count_{0};
+
+    std::atomic<UInt64> limit_{0};      // 0 = bounded only by the manager's maximum
+    std::atomic<UInt64> cushion_{0};
+    std::atomic<bool> short_on_storage_{false};
+    std::atomic<UInt32> sos_count_{0};
+    std::atomic<UInt64> cushion_allocations_{0};
+    std::atomic<UInt64> refused_{0};
+
+    // Free lists shared between threads. A GETMAIN or FREEMAIN uses
+    // its thread's cache and only takes the mutex to move a batch between
+    // that cache and these lists.
     mutable std::mutex mutex_;
+    std::array<std::vector<void*>, SIZE_CLASS_COUNT> free_lists_;
+    std::atomic<UInt64> shared_blocks_{0};  // Across free_lists_, to skip the lock when empty
+    std::atomic<UInt64> cache_hits_{0};
     
 public:
     explicit StoragePool(StorageClass cls) : class_(cls) {}
+    ~StoragePool();
     
     void record_allocation(UInt32 size);
     void record_free(UInt32 size);
+
+    // Charge size bytes against the DSA limit; FULL charges nothing
+    [[nodiscard]] StorageAdmit reserve(UInt32 size);
+
+    // Pooled block of at least size bytes, from a cache when one is held
+    [[nodiscard]] void* allocate_block(UInt32 size);
+    void free_block(void* address, UInt32 size);
+    void drain_cache();     // The shared lists; thread caches empty as their threads end
+
+    void set_limits(UInt64 limit, UInt64 cushion);
+
+    // Re-evaluate short-on-storage after a GETMAIN or FREEMAIN (refused_size:
+    // the bytes of one just turned away); the new state if this call changed it
+    Optional<bool> refresh_short_on_storage(UInt64 refused_size = 0);
     
     [[nodiscard]] StorageClass storage_class() const { return class_; }
-    [[nodiscard]] UInt64 total_allocated() const { return total_size_; }
-    [[nodiscard]] UInt64 current_used() const { return used_size_; }
-    [[nodiscard]] UInt64 peak_used() const { return peak_size_; }
-    [[nodiscard]] UInt32 allocation_count() const { return allocation_count_; }
+    [[nodiscard]] UInt64 total_allocated() const { return total_size_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 current_used() const { return used_size_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 peak_used() const { return peak_size_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt32 allocation_count() const { return allocation_count_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 limit() const { return limit_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 cushion() const { return cushion_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool is_short_on_storage() const { return short_on_storage_.load(std::memory_order_acquire); }
+    [[nodiscard]] UInt32 sos_count() const { return sos_count_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 cushion_allocations() const { return cushion_allocations_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 refused() const { return refused_.load(std::memory_order_relaxed); }
+    [[nodiscard]] UInt64 cache_hits() const { return cache_hits_.load(std::memory_order_relaxed); }
 };
 
 // =============================================================================
@@ -91,30 +154,52 @@ public:
 // =============================================================================
 
 class StorageControlManager {
+public:
+    // Called when the region as a whole enters or leaves short-on-storage
+    using SosListener = std::function<void(bool short_on_storage)>;
+
 private:
-    mutable std::mutex mutex_;
+    mutable std::mutex mutex_;          // Configuration and the listener
     
-    // Storage tracking
-    std::unordered_map<void*, StorageBlock> allocations_;
-    std::unordered_map<StorageClass, std::unique_ptr<StoragePool>> pools_;
+    // Storage tracking, striped by address so GETMAIN/FREEMAIN on different
+    // blocks rarely meet on a lock
+    static constexpr Size ALLOCATION_STRIPES = 16;
+    struct AllocationStripe {
+        mutable std::mutex mutex;
+        std::unordered_map<void*, StorageBlock> blocks;
+    };
+    mutable std::array<AllocationStripe, ALLOCATION_STRIPES> allocations_;
+    std::array<std::unique_ptr<StoragePool>, STORAGE_CLASS_COUNT> pools_;
     
     // Configuration
-    UInt64 max_storage_ = 64 * 1024 * 1024;  // 64MB default
-    UInt32 default_alignment_ = 8;
+    std::atomic<UInt64> max_storage_{64 * 1024 * 1024};  // 64MB default
+    std::atomic<UInt64> storage_cushion_{1024 * 1024};
+    std::atomic<UInt32> default_alignment_{8};
+
+    // Region-wide short-on-storage: the overall maximum's cushion, or any DSA
+    std::atomic<bool> global_sos_{false};
+    std::atomic<UInt32> sos_areas_{0};
+    SosListener sos_listener_;
     
     // Statistics
     struct Statistics {
-        UInt64 getmain_count = 0;
-        UInt64 freemain_count = 0;
-        UInt64 total_allocated = 0;
-        UInt64 total_freed = 0;
-        UInt64 peak_allocated = 0;
-        UInt64 current_allocated = 0;
-        UInt64 failed_allocations = 0;
+        AtomicCounter<> getmain_count;
+        AtomicCounter<> freemain_count;
+        AtomicCounter<> total_allocated;
+        AtomicCounter<> total_freed;
+        AtomicCounter<> failed_allocations;
+        AtomicCounter<> sos_events;
     } stats_;
+    std::atomic<UInt64> current_allocated_{0};
+    std::atomic<UInt64> peak_allocated_{0};
     
     void update_peak();
     StoragePool& get_pool(StorageClass cls);
+    AllocationStripe& stripe_for(void* address) const;
+    void release_block(const StorageBlock& block);
+    StorageAdmit reserve_global(UInt32 size);
+    void refresh_global_sos(UInt64 refused_size = 0);
+    void area_sos_changed(bool entered);
     
 public:
     StorageControlManager();
@@ -148,6 +233,15 @@ public:
     // Configuration
     void set_max_storage(UInt64 max_bytes);
     void set_default_alignment(UInt32 alignment);
+
+    // DSA limits; a limit of 0 leaves the class bounded only by max storage
+    void set_dsa_limit(StorageClass cls, UInt64 limit, UInt64 cushion = 0);
+    void set_storage_cushion(UInt64 bytes);     // Cushion below max storage
+
+    // Short-on-storage: the attach path should hold back new tasks while set
+    [[nodiscard]] bool is_short_on_storage() const;
+    [[nodiscard]] bool is_short_on_storage(StorageClass cls) const;
+    void set_sos_listener(SosListener listener);
     
     // Statistics
     [[nodiscard]] String get_statistics() const;
@@ -168,6 +262,14 @@ Result<void*> exec_cics_getmain_shared(UInt32 length);
 Result<void> exec_cics_freemain(void* data);
 Result<void> exec_cics_freemain(void* data, UInt32 length);
 
+// =============================================================================
+// Admission Control
+// =============================================================================
+
+// Make task attach (TaskControlManager::create_task) queue while the region
+// is short on storage, for up to max_wait, and resume when it recovers
+void enable_sos_admission_control(std::chrono::milliseconds max_wait = std::chrono::milliseconds(30000));
+
 // =============================================================================
 // RAII Storage Guard
 // =============================================================================
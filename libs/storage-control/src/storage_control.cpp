@@ -4,28 +4,186 @@
 // =============================================================================
 
 #include <cics/storage/storage_control.hpp>
+#include <cics/task/task_control.hpp>
+#include <cics/common/task_context.hpp>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <format>
 
 namespace cics {
 namespace storage {
 
+namespace {
+
+// Pooled block sizes: 16-byte steps to 128, then four steps per doubling
+constexpr UInt32 SIZE_CLASSES[StoragePool::SIZE_CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096
+};
+static_assert(SIZE_CLASSES[StoragePool::SIZE_CLASS_COUNT - 1] == StoragePool::MAX_POOLED_SIZE);
+
+Size size_class(UInt32 size) {
+    return static_cast<Size>(std::lower_bound(std::begin(SIZE_CLASSES), std::end(SIZE_CLASSES), size) -
+                             std::begin(SIZE_CLASSES));
+}
+
+// A cushion larger than a quarter of the limit would leave the area short
+// on storage almost permanently
+UInt64 effective_cushion(UInt64 limit, UInt64 cushion) {
+    return std::min(cushion, limit / 4);
+}
+
+StorageAdmit reserve_bytes(std::atomic<UInt64>& used, UInt64 limit, UInt64 cushion, UInt64 size) {
+    const UInt64 now_used = used.fetch_add(size, std::memory_order_relaxed) + size;
+    if (limit == 0) return StorageAdmit::OK;
+    if (now_used > limit) {
+        used.fetch_sub(size, std::memory_order_relaxed);
+        return StorageAdmit::FULL;
+    }
+    return now_used > limit - effective_cushion(limit, cushion) ? StorageAdmit::CUSHION : StorageAdmit::OK;
+}
+
+// Entered on touching the cushion, left once twice the cushion is free, so
+// the state does not flap at the boundary. A refused GETMAIN (refused_size
+// bytes) counts as being short already, so it holds the state only while
+// the exit rule would: a refusal in a nearly empty area, or of more than
+// the whole limit, which no FREEMAIN could satisfy, leaves nothing behind
+// that only a later GETMAIN or FREEMAIN would clear.
+bool wants_sos(UInt64 used, UInt64 limit, UInt64 cushion, bool currently, UInt64 refused_size) {
+    if (limit == 0) return false;
+    if (refused_size != 0 && refused_size <= limit) currently = true;
+    const UInt64 c = effective_cushion(limit, cushion);
+    return currently ? used + 2 * c > limit : used > limit - c;
+}
+
+Optional<bool> flip_sos(std::atomic<bool>& flag, bool wanted) {
+    bool current = flag.load(std::memory_order_acquire);
+    if (current == wanted || !flag.compare_exchange_strong(current, wanted, std::memory_order_acq_rel)) {
+        return std::nullopt;
+    }
+    return wanted;
+}
+
+// Blocks this thread freed, handed back to its next GETMAINs of the same
+// size without taking a lock. Pooled blocks are plain aligned_alloc memory,
+// so one cache serves every pool; it trades blocks with a pool's shared
+// lists only a batch at a time, and frees what it holds when the thread ends.
+struct ThreadBlockCache {
+    std::array<std::vector<void*>, StoragePool::SIZE_CLASS_COUNT> lists;
+
+    ~ThreadBlockCache() {
+        for (auto& list : lists) {
+            for (void* address : list) std::free(address);
+        }
+    }
+};
+
+thread_local ThreadBlockCache thread_blocks;
+
+constexpr Size TRANSFER_BATCH = StoragePool::THREAD_CACHED_PER_CLASS / 2;
+
+StringView storage_class_name(StorageClass cls) {
+    switch (cls) {
+        case StorageClass::USER: return "USER";
+        case StorageClass::CICSDSA: return "CICSDSA";
+        case StorageClass::CDSA: return "CDSA";
+        case StorageClass::UDSA: return "UDSA";
+        case StorageClass::SDSA: return "SDSA";
+        case StorageClass::RDSA: return "RDSA";
+        case StorageClass::SHARED: return "SHARED";
+    }
+    return "UNKNOWN";
+}
+
+} // namespace
+
 // =============================================================================
 // StoragePool Implementation
 // =============================================================================
 
+StoragePool::~StoragePool() {
+    drain_cache();
+}
+
 void StoragePool::record_allocation(UInt32 size) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    total_size_ += size;
-    used_size_ += size;
-    ++allocation_count_;
-    peak_size_ = std::max(peak_size_, used_size_);
+    total_size_.fetch_add(size, std::memory_order_relaxed);
+    allocation_count_.fetch_add(1, std::memory_order_relaxed);
+    const UInt64 used = used_size_.load(std::memory_order_relaxed);
+    UInt64 peak = peak_size_.load(std::memory_order_relaxed);
+    while (used > peak && !peak_size_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
 }
 
 void StoragePool::record_free(UInt32 size) {
+    used_size_.fetch_sub(size, std::memory_order_relaxed);
+}
+
+StorageAdmit StoragePool::reserve(UInt32 size) {
+    const StorageAdmit admit = reserve_bytes(used_size_, limit(), cushion(), size);
+    if (admit == StorageAdmit::CUSHION) cushion_allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (admit == StorageAdmit::FULL) refused_.fetch_add(1, std::memory_order_relaxed);
+    return admit;
+}
+
+void* StoragePool::allocate_block(UInt32 size) {
+    const Size cls = size_class(size);
+    auto& local = thread_blocks.lists[cls];
+    if (local.empty() && shared_blocks_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& shared = free_lists_[cls];
+        const Size take = std::min(shared.size(), TRANSFER_BATCH);
+        local.insert(local.end(), shared.end() - static_cast<std::ptrdiff_t>(take), shared.end());
+        shared.resize(shared.size() - take);
+        shared_blocks_.fetch_sub(take, std::memory_order_relaxed);
+    }
+    if (!local.empty()) {
+        void* address = local.back();
+        local.pop_back();
+        cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        return address;
+    }
+    return std::aligned_alloc(16, SIZE_CLASSES[cls]);
+}
+
+void StoragePool::free_block(void* address, UInt32 size) {
+    auto& local = thread_blocks.lists[size_class(size)];
+    if (local.size() >= THREAD_CACHED_PER_CLASS) {
+        // Pass a batch on so other threads can reuse it
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& shared = free_lists_[size_class(size)];
+        const Size give = std::min(TRANSFER_BATCH, MAX_CACHED_PER_CLASS - std::min(shared.size(), MAX_CACHED_PER_CLASS));
+        shared.insert(shared.end(), local.end() - static_cast<std::ptrdiff_t>(give), local.end());
+        local.resize(local.size() - give);
+        shared_blocks_.fetch_add(give, std::memory_order_relaxed);
+    }
+    if (local.size() < THREAD_CACHED_PER_CLASS) {
+        local.push_back(address);
+    } else {
+        std::free(address);
+    }
+}
+
+void StoragePool::drain_cache() {
     std::lock_guard<std::mutex> lock(mutex_);
-    used_size_ -= std::min(used_size_, static_cast<UInt64>(size));
+    for (auto& list : free_lists_) {
+        for (void* address : list) std::free(address);
+        list.clear();
+    }
+    shared_blocks_.store(0, std::memory_order_relaxed);
+}
+
+void StoragePool::set_limits(UInt64 limit, UInt64 cushion) {
+    limit_.store(limit, std::memory_order_relaxed);
+    cushion_.store(cushion, std::memory_order_relaxed);
+}
+
+Optional<bool> StoragePool::refresh_short_on_storage(UInt64 refused_size) {
+    auto changed = flip_sos(short_on_storage_,
+        wants_sos(current_used(), limit(), cushion(), is_short_on_storage(), refused_size));
+    if (changed && *changed) sos_count_.fetch_add(1, std::memory_order_relaxed);
+    return changed;
 }
 
 // =============================================================================
@@ -33,25 +191,23 @@ void StoragePool::record_free(UInt32 size) {
 // =============================================================================
 
 StorageControlManager::StorageControlManager() {
-    // Initialize default pools
-    pools_[StorageClass::USER] = std::make_unique<StoragePool>(StorageClass::USER);
-    pools_[StorageClass::CICSDSA] = std::make_unique<StoragePool>(StorageClass::CICSDSA);
-    pools_[StorageClass::CDSA] = std::make_unique<StoragePool>(StorageClass::CDSA);
-    pools_[StorageClass::UDSA] = std::make_unique<StoragePool>(StorageClass::UDSA);
-    pools_[StorageClass::SDSA] = std::make_unique<StoragePool>(StorageClass::SDSA);
-    pools_[StorageClass::RDSA] = std::make_unique<StoragePool>(StorageClass::RDSA);
-    pools_[StorageClass::SHARED] = std::make_unique<StoragePool>(StorageClass::SHARED);
+    // One pool (DSA) per storage class
+    for (Size i = 0; i < STORAGE_CLASS_COUNT; ++i) {
+        pools_[i] = std::make_unique<StoragePool>(static_cast<StorageClass>(i));
+    }
 }
 
 StorageControlManager::~StorageControlManager() {
     // Free all remaining allocations
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& [addr, block] : allocations_) {
-        if (block.address) {
-            std::free(block.address);
+    for (auto& stripe : allocations_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (auto& [addr, block] : stripe.blocks) {
+            if (block.address) {
+                std::free(block.address);
+            }
         }
+        stripe.blocks.clear();
     }
-    allocations_.clear();
 }
 
 StorageControlManager& StorageControlManager::instance() {
@@ -60,16 +216,49 @@ StorageControlManager& StorageControlManager::instance() {
 }
 
 StoragePool& StorageControlManager::get_pool(StorageClass cls) {
-    auto it = pools_.find(cls);
-    if (it == pools_.end()) {
-        pools_[cls] = std::make_unique<StoragePool>(cls);
-        return *pools_[cls];
-    }
-    return *it->second;
+    return *pools_[static_cast<Size>(cls)];
+}
+
+StorageControlManager::AllocationStripe& StorageControlManager::stripe_for(void* address) const {
+    auto bits = reinterpret_cast<std::uintptr_t>(address) >> 4;
+    return allocations_[(bits ^ (bits >> 7)) % ALLOCATION_STRIPES];
 }
 
 void StorageControlManager::update_peak() {
-    stats_.peak_allocated = std::max(stats_.peak_allocated, stats_.current_allocated);
+    const UInt64 current = current_allocated_.load(std::memory_order_relaxed);
+    UInt64 peak = peak_allocated_.load(std::memory_order_relaxed);
+    while (current > peak && !peak_allocated_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+}
+
+StorageAdmit StorageControlManager::reserve_global(UInt32 size) {
+    return reserve_bytes(current_allocated_, max_storage_.load(std::memory_order_relaxed),
+                         storage_cushion_.load(std::memory_order_relaxed), size);
+}
+
+void StorageControlManager::refresh_global_sos(UInt64 refused_size) {
+    const bool wanted = wants_sos(current_allocated_.load(std::memory_order_relaxed),
+        max_storage_.load(std::memory_order_relaxed), storage_cushion_.load(std::memory_order_relaxed),
+        global_sos_.load(std::memory_order_acquire), refused_size);
+    if (auto changed = flip_sos(global_sos_, wanted)) area_sos_changed(*changed);
+}
+
+void StorageControlManager::area_sos_changed(bool entered) {
+    // The region is short on storage while any area is
+    bool region_changed;
+    if (entered) {
+        ++stats_.sos_events;
+        region_changed = sos_areas_.fetch_add(1, std::memory_order_acq_rel) == 0;
+    } else {
+        region_changed = sos_areas_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    if (!region_changed) return;
+
+    SosListener listener;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        listener = sos_listener_;
+    }
+    if (listener) listener(entered);
 }
 
 Result<void*> StorageControlManager::getmain(UInt32 size) {
@@ -86,26 +275,38 @@ Result<void*> StorageControlManager::getmain(UInt32 size, StorageClass cls, Stor
 
 Result<void*> StorageControlManager::getmain(UInt32 size, StorageClass cls, StorageInit init,
                                               bool shared, StringView tag) {
-    std::lock_guard<std::mutex> lock(mutex_);
     ++stats_.getmain_count;
     
     if (size == 0) {
         return make_error<void*>(ErrorCode::INVALID_ARGUMENT, "Size cannot be zero");
     }
     
-    // Check available storage
-    if (stats_.current_allocated + size > max_storage_) {
+    // Align size
+    const UInt32 alignment = default_alignment_.load(std::memory_order_relaxed);
+    UInt32 aligned_size = (size + alignment - 1) & ~(alignment - 1);
+    
+    // Charge the DSA, then the region; a refusal may put that area short on storage
+    StoragePool& pool = get_pool(cls);
+    if (pool.reserve(aligned_size) == StorageAdmit::FULL) {
+        ++stats_.failed_allocations;
+        if (auto changed = pool.refresh_short_on_storage(aligned_size)) area_sos_changed(*changed);
+        return make_error<void*>(ErrorCode::OUT_OF_MEMORY,
+            std::format("Insufficient storage available in {}", storage_class_name(cls)));
+    }
+    if (reserve_global(aligned_size) == StorageAdmit::FULL) {
+        pool.record_free(aligned_size);
         ++stats_.failed_allocations;
+        refresh_global_sos(aligned_size);
         return make_error<void*>(ErrorCode::OUT_OF_MEMORY,
             "Insufficient storage available");
     }
     
-    // Align size
-    UInt32 aligned_size = (size + default_alignment_ - 1) & ~(default_alignment_ - 1);
-    
     // Allocate memory
-    void* address = std::aligned_alloc(default_alignment_, aligned_size);
+    const bool pooled = aligned_size <= StoragePool::MAX_POOLED_SIZE && alignment <= 16;
+    void* address = pooled ? pool.allocate_block(aligned_size) : std::aligned_alloc(alignment, aligned_size);
     if (!address) {
+        pool.record_free(aligned_size);
+        current_allocated_.fetch_sub(aligned_size, std::memory_order_relaxed);
         ++stats_.failed_allocations;
         return make_error<void*>(ErrorCode::OUT_OF_MEMORY,
             "Memory allocation failed");
@@ -134,47 +335,67 @@ Result<void*> StorageControlManager::getmain(UInt32 size, StorageClass cls, Stor
     block.shared = shared;
     block.allocation_time = std::chrono::steady_clock::now();
     block.tag = String(tag);
+    block.pooled = pooled;
     
-    allocations_[address] = block;
+    {
+        auto& stripe = stripe_for(address);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.blocks[address] = std::move(block);
+    }
     
     // Update statistics
     stats_.total_allocated += aligned_size;
-    stats_.current_allocated += aligned_size;
     update_peak();
     
     // Update pool
-    get_pool(cls).record_allocation(aligned_size);
+    pool.record_allocation(aligned_size);
+    if (auto changed = pool.refresh_short_on_storage()) area_sos_changed(*changed);
+    refresh_global_sos();
+    note_getmain(aligned_size);
     
     return make_success(address);
 }
 
+void StorageControlManager::release_block(const StorageBlock& block) {
+    StoragePool& pool = get_pool(block.storage_class);
+    if (block.pooled) {
+        pool.free_block(block.address, block.size);
+    } else {
+        std::free(block.address);
+    }
+    
+    // Update statistics
+    stats_.total_freed += block.size;
+    current_allocated_.fetch_sub(block.size, std::memory_order_relaxed);
+    
+    // Update pool
+    pool.record_free(block.size);
+    if (auto changed = pool.refresh_short_on_storage()) area_sos_changed(*changed);
+    refresh_global_sos();
+}
+
 Result<void> StorageControlManager::freemain(void* address) {
-    std::lock_guard<std::mutex> lock(mutex_);
     ++stats_.freemain_count;
     
     if (!address) {
         return make_error<void>(ErrorCode::INVALID_ARGUMENT, "Null address");
     }
     
-    auto it = allocations_.find(address);
-    if (it == allocations_.end()) {
-        return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
-            "Address not found in allocations");
+    StorageBlock block;
+    {
+        auto& stripe = stripe_for(address);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.blocks.find(address);
+        if (it == stripe.blocks.end()) {
+            return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
+                "Address not found in allocations");
+        }
+        block = std::move(it->second);
+        stripe.blocks.erase(it);
     }
     
-    UInt32 size = it->second.size;
-    StorageClass cls = it->second.storage_class;
-    
-    std::free(address);
-    allocations_.erase(it);
-    
-    // Update statistics
-    stats_.total_freed += size;
-    stats_.current_allocated -= size;
-    
-    // Update pool
-    get_pool(cls).record_free(size);
-    
+    release_block(block);
+    note_freemain(block.size);
     return make_success();
 }
 
@@ -193,39 +414,32 @@ Result<void> StorageControlManager::freemain(void* address, UInt32 size) {
 }
 
 Result<void> StorageControlManager::freemain_task(UInt32 task_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::vector<void*> to_free;
-    for (const auto& [addr, block] : allocations_) {
-        if (block.task_id == task_id && !block.shared) {
-            to_free.push_back(addr);
+    std::vector<StorageBlock> to_free;
+    for (auto& stripe : allocations_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (auto it = stripe.blocks.begin(); it != stripe.blocks.end();) {
+            if (it->second.task_id == task_id && !it->second.shared) {
+                to_free.push_back(std::move(it->second));
+                it = stripe.blocks.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
     
-    for (void* addr : to_free) {
-        auto it = allocations_.find(addr);
-        if (it != allocations_.end()) {
-            UInt32 size = it->second.size;
-            StorageClass cls = it->second.storage_class;
-            
-            std::free(addr);
-            
-            stats_.total_freed += size;
-            stats_.current_allocated -= size;
-            get_pool(cls).record_free(size);
-            
-            allocations_.erase(it);
-        }
+    for (const auto& block : to_free) {
+        release_block(block);
     }
     
     return make_success();
 }
 
 Result<StorageBlock> StorageControlManager::get_block_info(void* address) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stripe = stripe_for(address);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
     
-    auto it = allocations_.find(address);
-    if (it == allocations_.end()) {
+    auto it = stripe.blocks.find(address);
+    if (it == stripe.blocks.end()) {
         return make_error<StorageBlock>(ErrorCode::RECORD_NOT_FOUND,
             "Address not found");
     }
@@ -234,73 +448,115 @@ Result<StorageBlock> StorageControlManager::get_block_info(void* address) const
 }
 
 bool StorageControlManager::is_valid_address(void* address) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return allocations_.find(address) != allocations_.end();
+    auto& stripe = stripe_for(address);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    return stripe.blocks.find(address) != stripe.blocks.end();
 }
 
 UInt32 StorageControlManager::get_block_size(void* address) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = allocations_.find(address);
-    return it != allocations_.end() ? it->second.size : 0;
+    auto& stripe = stripe_for(address);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.blocks.find(address);
+    return it != stripe.blocks.end() ? it->second.size : 0;
 }
 
 UInt64 StorageControlManager::available_storage() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return max_storage_ - stats_.current_allocated;
+    const UInt64 max_bytes = max_storage_.load(std::memory_order_relaxed);
+    return max_bytes - std::min(max_bytes, current_allocated_.load(std::memory_order_relaxed));
 }
 
 UInt64 StorageControlManager::current_allocated() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stats_.current_allocated;
+    return current_allocated_.load(std::memory_order_relaxed);
 }
 
 const StoragePool* StorageControlManager::get_pool(StorageClass cls) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = pools_.find(cls);
-    return it != pools_.end() ? it->second.get() : nullptr;
+    const auto index = static_cast<Size>(cls);
+    return index < pools_.size() ? pools_[index].get() : nullptr;
 }
 
 void StorageControlManager::set_max_storage(UInt64 max_bytes) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    max_storage_ = max_bytes;
+    max_storage_.store(max_bytes, std::memory_order_relaxed);
+    refresh_global_sos();
 }
 
 void StorageControlManager::set_default_alignment(UInt32 alignment) {
+    default_alignment_.store(alignment, std::memory_order_relaxed);
+}
+
+void StorageControlManager::set_dsa_limit(StorageClass cls, UInt64 limit, UInt64 cushion) {
+    StoragePool& pool = get_pool(cls);
+    pool.set_limits(limit, cushion);
+    if (auto changed = pool.refresh_short_on_storage()) area_sos_changed(*changed);
+}
+
+void StorageControlManager::set_storage_cushion(UInt64 bytes) {
+    storage_cushion_.store(bytes, std::memory_order_relaxed);
+    refresh_global_sos();
+}
+
+bool StorageControlManager::is_short_on_storage() const {
+    return sos_areas_.load(std::memory_order_acquire) > 0;
+}
+
+bool StorageControlManager::is_short_on_storage(StorageClass cls) const {
+    const StoragePool* pool = get_pool(cls);
+    return pool != nullptr && pool->is_short_on_storage();
+}
+
+void StorageControlManager::set_sos_listener(SosListener listener) {
     std::lock_guard<std::mutex> lock(mutex_);
-    default_alignment_ = alignment;
+    sos_listener_ = std::move(listener);
 }
 
 String StorageControlManager::get_statistics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    Size active_blocks = 0;
+    for (const auto& stripe : allocations_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        active_blocks += stripe.blocks.size();
+    }
+    const UInt64 current = current_allocated();
+    const UInt64 max_bytes = max_storage_.load(std::memory_order_relaxed);
     
     std::ostringstream oss;
     oss << "Storage Control Statistics:\n"
-        << "  GETMAIN calls:     " << stats_.getmain_count << "\n"
-        << "  FREEMAIN calls:    " << stats_.freemain_count << "\n"
-        << "  Total allocated:   " << stats_.total_allocated << " bytes\n"
-        << "  Total freed:       " << stats_.total_freed << " bytes\n"
-        << "  Current allocated: " << stats_.current_allocated << " bytes\n"
-        << "  Peak allocated:    " << stats_.peak_allocated << " bytes\n"
-        << "  Failed allocs:     " << stats_.failed_allocations << "\n"
-        << "  Active blocks:     " << allocations_.size() << "\n"
-        << "  Max storage:       " << max_storage_ << " bytes\n"
-        << "  Available:         " << (max_storage_ - stats_.current_allocated) << " bytes\n";
+        << "  GETMAIN calls:     " << stats_.getmain_count.get() << "\n"
+        << "  FREEMAIN calls:    " << stats_.freemain_count.get() << "\n"
+        << "  Total allocated:   " << stats_.total_allocated.get() << " bytes\n"
+        << "  Total freed:       " << stats_.total_freed.get() << " bytes\n"
+        << "  Current allocated: " << current << " bytes\n"
+        << "  Peak allocated:    " << peak_allocated_.load(std::memory_order_relaxed) << " bytes\n"
+        << "  Failed allocs:     " << stats_.failed_allocations.get() << "\n"
+        << "  Active blocks:     " << active_blocks << "\n"
+        << "  Max storage:       " << max_bytes << " bytes\n"
+        << "  Available:         " << available_storage() << " bytes\n"
+        << "  Short on storage:  " << (is_short_on_storage() ? "YES" : "NO")
+        << " (" << stats_.sos_events.get() << " times)\n";
+    
+    for (const auto& pool : pools_) {
+        if (pool->allocation_count() == 0 && pool->limit() == 0) continue;
+        oss << "  DSA " << std::left << std::setw(8) << storage_class_name(pool->storage_class()) << std::right
+            << " used " << pool->current_used() << " peak " << pool->peak_used();
+        if (pool->limit() != 0) {
+            oss << " limit " << pool->limit() << " cushion " << pool->cushion();
+        }
+        oss << (pool->is_short_on_storage() ? " SOS" : "")
+            << ", free-list hits " << pool->cache_hits() << "\n";
+    }
     
     return oss.str();
 }
 
 void StorageControlManager::reset_statistics() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    stats_ = Statistics{};
-    stats_.current_allocated = 0;
-    for (const auto& [addr, block] : allocations_) {
-        stats_.current_allocated += block.size;
-    }
+    stats_.getmain_count.reset();
+    stats_.freemain_count.reset();
+    stats_.total_allocated.reset();
+    stats_.total_freed.reset();
+    stats_.failed_allocations.reset();
+    stats_.sos_events.reset();
+    peak_allocated_.store(current_allocated(), std::memory_order_relaxed);
 }
 
 String StorageControlManager::dump_allocations() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     std::ostringstream oss;
     oss << "Storage Allocations:\n";
     oss << std::setfill('-') << std::setw(80) << "" << "\n" << std::setfill(' ');
@@ -312,13 +568,16 @@ String StorageControlManager::dump_allocations() const {
         << "Tag\n";
     oss << std::setfill('-') << std::setw(80) << "" << "\n" << std::setfill(' ');
     
-    for (const auto& [addr, block] : allocations_) {
-        oss << std::left << std::setw(18) << addr
-            << std::setw(10) << block.size
-            << std::setw(10) << block.requested_size
-            << std::setw(10) << static_cast<int>(block.storage_class)
-            << std::setw(8) << block.task_id
-            << block.tag << "\n";
+    for (const auto& stripe : allocations_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (const auto& [addr, block] : stripe.blocks) {
+            oss << std::left << std::setw(18) << addr
+                << std::setw(10) << block.size
+                << std::setw(10) << block.requested_size
+                << std::setw(10) << static_cast<int>(block.storage_class)
+                << std::setw(8) << block.task_id
+                << block.tag << "\n";
+        }
     }
     
     return oss.str();
@@ -358,6 +617,19 @@ Result<void> exec_cics_freemain(void* data, UInt32 length) {
     return StorageControlManager::instance().freemain(data, length);
 }
 
+// =============================================================================
+// Admission Control Implementation
+// =============================================================================
+
+void enable_sos_admission_control(std::chrono::milliseconds max_wait) {
+    auto& storage = StorageControlManager::instance();
+    auto& tasks = task::TaskControlManager::instance();
+    tasks.set_admission_check([&storage] { return !storage.is_short_on_storage(); }, max_wait);
+    storage.set_sos_listener([&tasks](bool short_on_storage) {
+        if (!short_on_storage) tasks.notify_admission();
+    });
+}
+
 // =============================================================================
 // StorageGuard Implementation
 // =============================================================================
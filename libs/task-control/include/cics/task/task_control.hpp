@@ -22,6 +22,7 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <functional>
 #include <queue>
 
 namespace cics {
@@ -155,7 +156,21 @@ private:
         UInt64 deadlock_detections = 0;
         UInt64 max_waiters = 0;
         UInt64 suspend_count = 0;
+        UInt64 admission_waits = 0;
+        UInt64 admission_timeouts = 0;
     } stats_;
+
+public:
+    // Admission control: attaches wait while the check is false
+    using AdmissionCheck = std::function<bool()>;
+
+private:
+    AdmissionCheck admission_check_;
+    std::atomic<bool> admission_enabled_{false};    // Lets attaches skip the gate when no check is set
+    std::chrono::milliseconds admission_wait_{30000};
+    std::atomic<UInt32> admission_queued_{0};       // Attaches waiting at the gate now
+    std::mutex admission_mutex_;
+    std::condition_variable admission_cv_;
     
     // Deadlock detection
     bool detect_deadlock(UInt32 task_id, const ResourceId& resource);
@@ -175,6 +190,17 @@ public:
     [[nodiscard]] UInt32 get_current_task_id() const;
     void set_current_task_id(UInt32 task_id);
     Result<TaskInfo*> get_task(UInt32 task_id);
+
+    // Hold new tasks back while check() is false (the region is short on
+    // storage, say): create_task queues for up to max_wait and then fails
+    // with RESOURCE_EXHAUSTED. Call notify_admission() when the check may
+    // have turned true.
+    void set_admission_check(AdmissionCheck check,
+                             std::chrono::milliseconds max_wait = std::chrono::milliseconds(30000));
+    void notify_admission();
+    [[nodiscard]] UInt32 admission_queue_depth() const {
+        return admission_queued_.load(std::memory_order_relaxed);
+    }
     
     // ENQ - Enqueue resource
     Result<void> enq(const ResourceId& resource, LockType type = LockType::EXCLUSIVE,
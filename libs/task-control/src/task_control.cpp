@@ -4,6 +4,7 @@
 // =============================================================================
 
 #include <cics/task/task_control.hpp>
+#include <cics/common/task_context.hpp>
 #include <sstream>
 #include <algorithm>
 
@@ -78,7 +79,29 @@ TaskControlManager& TaskControlManager::instance() {
 }
 
 Result<UInt32> TaskControlManager::create_task(const FixedString<4>& transid) {
+    // Queue the attach rather than start a task that would fail mid-flight
+    bool waited = false;
+    if (admission_enabled_.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> gate(admission_mutex_);
+        if (admission_check_ && !admission_check_()) {
+            waited = true;
+            admission_queued_.fetch_add(1, std::memory_order_relaxed);
+            const bool admitted = admission_cv_.wait_for(gate, admission_wait_, [this] { return admission_check_(); });
+            admission_queued_.fetch_sub(1, std::memory_order_relaxed);
+            if (!admitted) {
+                gate.unlock();
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                ++stats_.admission_waits;
+                ++stats_.admission_timeouts;
+                return make_error<UInt32>(ErrorCode::RESOURCE_EXHAUSTED,
+                    "Task not attached: admission held back for " +
+                    std::to_string(admission_wait_.count()) + "ms");
+            }
+        }
+    }
+    
     std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (waited) ++stats_.admission_waits;
     
     UInt32 task_id = next_task_id_++;
     
@@ -95,6 +118,22 @@ Result<UInt32> TaskControlManager::create_task(const FixedString<4>& transid) {
     return make_success(task_id);
 }
 
+void TaskControlManager::set_admission_check(AdmissionCheck check, std::chrono::milliseconds max_wait) {
+    {
+        std::lock_guard<std::mutex> gate(admission_mutex_);
+        admission_check_ = std::move(check);
+        admission_wait_ = max_wait;
+        admission_enabled_.store(static_cast<bool>(admission_check_), std::memory_order_release);
+    }
+    admission_cv_.notify_all();
+}
+
+void TaskControlManager::notify_admission() {
+    // Taking the gate orders this after any waiter's last check
+    { std::lock_guard<std::mutex> gate(admission_mutex_); }
+    admission_cv_.notify_all();
+}
+
 Result<void> TaskControlManager::end_task(UInt32 task_id) {
     std::unique_lock<std::shared_mutex> lock(mutex_);
     
@@ -227,10 +266,13 @@ Result<void> TaskControlManager::enq(const ResourceId& resource, LockType type,
     }
     
     // Wait for the lock
-    cv_.wait(lock, [&]() {
-        return try_acquire() || 
-               (task_it != tasks_.end() && task_it->second.state == TaskState::TERMINATED);
-    });
+    {
+        WaitTimer waiting(WaitType::ENQ);
+        cv_.wait(lock, [&]() {
+            return try_acquire() || 
+                   (task_it != tasks_.end() && task_it->second.state == TaskState::TERMINATED);
+        });
+    }
     
     if (task_it != tasks_.end()) {
         task_it->second.state = TaskState::RUNNING;
@@ -518,6 +560,8 @@ String TaskControlManager::get_statistics() const {
         << "  Deadlocks detected:  " << stats_.deadlock_detections << "\n"
         << "  Max waiters:         " << stats_.max_waiters << "\n"
         << "  SUSPEND calls:       " << stats_.suspend_count << "\n"
+        << "  Admission waits:     " << stats_.admission_waits
+        << " (" << stats_.admission_timeouts << " timed out)\n"
         << "  Active tasks:        " << tasks_.size() << "\n"
         << "  Active locks:        " << locks_.size() << "\n";
     
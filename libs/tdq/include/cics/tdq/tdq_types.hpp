@@ -14,11 +14,16 @@
 
 #include "cics/common/types.hpp"
 #include "cics/common/error.hpp"
+#include "cics/common/name_table.hpp"
 #include <map>
 #include <shared_mutex>
 #include <queue>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <condition_variable>
+#include <thread>
+#include <unordered_set>
 
 namespace cics::tdq {
 
@@ -160,10 +165,12 @@ public:
 struct TriggerDefinition {
     String transaction_id;       // Transaction to start
     UInt32 trigger_level = 1;    // Number of records to trigger
-    String terminal_id;          // Optional terminal ID
+    String terminal_id;          // Optional terminal ID; the task's facility
     String user_id;              // Optional user ID
     bool enabled = true;
     
+    // Starts the transaction and returns when it ends. Called from a
+    // TriggerDispatcher thread, never from the writing task.
     using TriggerCallback = std::function<void(StringView transaction, StringView dest)>;
     TriggerCallback callback;
 };
@@ -235,6 +242,10 @@ struct TDQStatistics {
 // =============================================================================
 
 class IntrapartitionQueue {
+public:
+    // Told the destination when a write brings the queue to its trigger level
+    using TriggerSink = std::function<void(const String& dest)>;
+    
 private:
     TDQDefinition definition_;
     std::queue<TDQRecord> records_;
@@ -242,13 +253,30 @@ private:
     mutable std::shared_mutex mutex_;
     UInt64 sequence_counter_ = 0;
     bool enabled_ = true;
-    
-    void check_trigger();
+    bool trigger_rearmed_ = false;
+    TriggerSink trigger_sink_;
+    
+    // What a write that reached the trigger level starts, copied under the
+    // queue lock; the definition is only taken when there is no sink
+    struct PendingTrigger {
+        String dest;
+        Optional<TriggerDefinition> trigger;
+    };
+    [[nodiscard]] Optional<PendingTrigger> take_trigger();
+    void fire_trigger(const PendingTrigger& pending);
     
 public:
     explicit IntrapartitionQueue(TDQDefinition def);
     ~IntrapartitionQueue() = default;
     
+    // Without a sink the trigger callback runs on the writer, after the
+    // queue lock is released
+    void set_trigger_sink(TriggerSink sink) { trigger_sink_ = std::move(sink); }
+    
+    // The next write triggers again at any depth at or above the level,
+    // not only on reaching it
+    void rearm_trigger();
+    
     // Write record
     Result<void> write(ConstByteSpan data);
     Result<void> write(StringView str);
@@ -307,6 +335,87 @@ public:
     [[nodiscard]] const TDQStatistics& statistics() const { return statistics_; }
 };
 
+// =============================================================================
+// Trigger Dispatcher (ATI)
+// =============================================================================
+//
+// Starts trigger transactions off the write path. A write that brings a
+// queue to its trigger level only posts the destination name; dispatcher
+// threads run the trigger transaction with at most one consumer per
+// destination, and one per terminal when the trigger names a terminal
+// facility. A consumer that ends with records still queued is started
+// again if it read any or more were written meanwhile; one that threw or
+// got nowhere would only spin, so its queue instead triggers on the next
+// write. Posts for a destination already waiting are merged, so writer
+// cost stays flat however often the level is crossed.
+
+struct TriggerCheck {
+    TriggerDefinition trigger;
+    Size depth = 0;
+    UInt64 written = 0;     // Records ever written and read, to tell
+    UInt64 read = 0;        // whether a consumer got anywhere
+};
+
+// Current trigger and depth of an enabled intrapartition destination
+using TriggerLookup = std::function<Optional<TriggerCheck>(const String& dest)>;
+
+// Asks the destination to trigger on its next write (rearm_trigger)
+using TriggerRearm = std::function<void(const String& dest)>;
+
+struct TriggerDispatcherStatistics {
+    AtomicCounter<UInt64> posted;
+    AtomicCounter<UInt64> merged;        // Destination already waiting
+    AtomicCounter<UInt64> started;
+    AtomicCounter<UInt64> suppressed;    // A consumer was already running
+    AtomicCounter<UInt64> deferred;      // Waited for the terminal facility
+    AtomicCounter<UInt64> retriggered;   // Records left when a consumer ended
+    AtomicCounter<UInt64> failures;      // Trigger transaction threw
+    AtomicCounter<UInt64> stalled;       // Left for the next write to restart
+    
+    [[nodiscard]] String to_string() const;
+};
+
+class TriggerDispatcher {
+public:
+    TriggerDispatcher(TriggerLookup lookup, TriggerRearm rearm, UInt32 workers = 2);
+    ~TriggerDispatcher();
+    TriggerDispatcher(const TriggerDispatcher&) = delete;
+    TriggerDispatcher& operator=(const TriggerDispatcher&) = delete;
+    
+    // Cheap and non-blocking; workers start on first use
+    void post(const String& dest);
+    
+    // Wait until no trigger is queued or running
+    void wait_idle();
+    
+    // Finishes running consumers and drops queued triggers; a later post
+    // starts the workers again
+    void stop();
+    
+    [[nodiscard]] const TriggerDispatcherStatistics& statistics() const { return stats_; }
+    
+private:
+    void enqueue(const String& dest);   // mutex_ held
+    void worker_loop();
+    void run(const String& dest, std::unique_lock<std::mutex>& lock);
+    
+    TriggerLookup lookup_;
+    TriggerRearm rearm_;
+    UInt32 worker_count_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<String> events_;
+    std::unordered_set<String> waiting_;            // Destinations in events_
+    std::unordered_set<String> active_;             // Destinations with a consumer
+    std::unordered_set<String> busy_terminals_;
+    std::vector<std::pair<String, String>> deferred_;  // Terminal, destination
+    std::vector<std::thread> workers_;
+    UInt32 busy_workers_ = 0;
+    bool stopping_ = false;
+    TriggerDispatcherStatistics stats_;
+};
+
 // =============================================================================
 // TDQ Manager
 // =============================================================================
@@ -316,6 +425,9 @@ private:
     std::map<String, UniquePtr<IntrapartitionQueue>> intra_queues_;
     std::map<String, UniquePtr<ExtrapartitionQueue>> extra_queues_;
     std::map<String, String> indirect_map_;
+    // Defined queues by their name's id; indirect destinations go by name
+    NameIndex<IntrapartitionQueue> intra_by_id_;
+    NameIndex<ExtrapartitionQueue> extra_by_id_;
     mutable std::shared_mutex mutex_;
     bool initialized_ = false;
     
@@ -327,6 +439,11 @@ private:
     // Resolve indirect destination
     Result<String> resolve_destination(StringView dest) const;
     
+    // Automatic transaction initiation for trigger levels
+    TriggerDispatcher ati_;
+    [[nodiscard]] Optional<TriggerCheck> trigger_check(const String& dest) const;
+    void rearm_trigger(const String& dest) const;
+    
 public:
     TDQManager();
     ~TDQManager();
@@ -352,6 +469,10 @@ public:
     // READQ TD
     Result<TDQRecord> readq(StringView dest);
     
+    // By interned name: an array index for defined queues, otherwise as by name
+    Result<void> writeq(NameId dest, ConstByteSpan data);
+    Result<TDQRecord> readq(NameId dest);
+    
     // DELETEQ TD
     Result<void> deleteq(StringView dest);
     
@@ -366,6 +487,9 @@ public:
     [[nodiscard]] Optional<TDQType> get_destination_type(StringView dest) const;
     [[nodiscard]] Result<Size> get_queue_depth(StringView dest) const;
     
+    // ATI
+    [[nodiscard]] TriggerDispatcher& trigger_dispatcher() { return ati_; }
+    
     // Statistics
     [[nodiscard]] String get_statistics() const;
 };
@@ -4,6 +4,7 @@
 // =============================================================================
 
 #include "cics/tdq/tdq_types.hpp"
+#include "cics/common/task_context.hpp"
 #include <algorithm>
 #include <format>
 #include <sstream>
@@ -115,19 +116,40 @@ IntrapartitionQueue::IntrapartitionQueue(TDQDefinition def)
     statistics_.created = SystemClock::now();
 }
 
-void IntrapartitionQueue::check_trigger() {
-    if (!definition_.trigger.has_value()) return;
+Optional<IntrapartitionQueue::PendingTrigger> IntrapartitionQueue::take_trigger() {
+    if (!definition_.trigger.has_value()) return nullopt;
     
     const auto& trigger = definition_.trigger.value();
-    if (!trigger.enabled) return;
+    if (!trigger.enabled) return nullopt;
     
-    UInt64 depth = records_.size();
-    if (depth >= trigger.trigger_level) {
-        statistics_.record_trigger();
-        if (trigger.callback) {
-            trigger.callback(trigger.transaction_id, definition_.dest_id.trimmed());
-        }
+    // Writes add one record at a time, so rising through the level always
+    // lands on it; deeper queues are already the consumer's to drain,
+    // unless it stopped short and the queue was rearmed
+    const Size level = std::max<UInt32>(trigger.trigger_level, 1);
+    if (records_.size() != level && !(trigger_rearmed_ && records_.size() > level)) return nullopt;
+    trigger_rearmed_ = false;
+    statistics_.record_trigger();
+    
+    PendingTrigger pending;
+    pending.dest = definition_.dest_id.trimmed();
+    if (!trigger_sink_) pending.trigger = trigger;
+    return pending;
+}
+
+void IntrapartitionQueue::fire_trigger(const PendingTrigger& pending) {
+    if (trigger_sink_) {
+        trigger_sink_(pending.dest);
+        return;
     }
+    const auto& trigger = pending.trigger.value();
+    if (trigger.callback) {
+        trigger.callback(trigger.transaction_id, pending.dest);
+    }
+}
+
+void IntrapartitionQueue::rearm_trigger() {
+    std::unique_lock lock(mutex_);
+    trigger_rearmed_ = true;
 }
 
 Result<void> IntrapartitionQueue::write(ConstByteSpan data) {
@@ -152,8 +174,12 @@ Result<void> IntrapartitionQueue::write(ConstByteSpan data) {
     
     statistics_.record_write(data.size());
     statistics_.update_peak_depth(records_.size());
+    note_request(RequestType::TD_PUT, data.size());
     
-    check_trigger();
+    // The trigger transaction is started with the queue unlocked
+    const auto pending = take_trigger();
+    lock.unlock();
+    if (pending) fire_trigger(*pending);
     
     return {};
 }
@@ -180,6 +206,7 @@ Result<TDQRecord> IntrapartitionQueue::read() {
     }
     
     statistics_.record_read(record.length());
+    note_request(RequestType::TD_GET, record.length());
     
     return record;
 }
@@ -296,6 +323,7 @@ Result<void> ExtrapartitionQueue::write(ConstByteSpan data) {
     
     file_.flush();
     statistics_.record_write(data.size());
+    note_request(RequestType::TD_PUT, data.size());
     
     return {};
 }
@@ -347,6 +375,7 @@ Result<TDQRecord> ExtrapartitionQueue::read() {
     }
     
     statistics_.record_read(record_len);
+    note_request(RequestType::TD_GET, record_len);
     
     return TDQRecord(ConstByteSpan(data.data(), static_cast<Size>(file_.gcount())));
 }
@@ -355,7 +384,10 @@ Result<TDQRecord> ExtrapartitionQueue::read() {
 // TDQManager Implementation
 // =============================================================================
 
-TDQManager::TDQManager() = default;
+TDQManager::TDQManager()
+    : ati_([this](const String& dest) { return trigger_check(dest); },
+           [this](const String& dest) { rearm_trigger(dest); }) {}
+
 TDQManager::~TDQManager() { shutdown(); }
 
 TDQManager& TDQManager::instance() {
@@ -373,8 +405,12 @@ Result<void> TDQManager::initialize() {
 }
 
 void TDQManager::shutdown() {
+    // Running trigger transactions may still read their queues
+    ati_.stop();
     std::unique_lock lock(mutex_);
     if (!initialized_) return;
+    intra_by_id_.clear();
+    extra_by_id_.clear();
     intra_queues_.clear();
     extra_queues_.clear();
     indirect_map_.clear();
@@ -405,8 +441,12 @@ Result<void> TDQManager::define_intrapartition(const TDQDefinition& def) {
         return make_error<void>(ErrorCode::FILE_EXISTS, std::format("Destination '{}' already defined", dest_name));
     }
     
-    intra_queues_[dest_name] = make_unique<IntrapartitionQueue>(def);
+    auto queue = make_unique<IntrapartitionQueue>(def);
+    queue->set_trigger_sink([this](const String& dest) { ati_.post(to_upper(dest)); });
+    intra_by_id_.set(NameTable::instance().intern(dest_name), queue.get());
+    intra_queues_[dest_name] = std::move(queue);
     ++total_dests_defined_;
+    note_resource_change();
     return {};
 }
 
@@ -425,8 +465,11 @@ Result<void> TDQManager::define_extrapartition(const TDQDefinition& def) {
         return make_error<void>(ErrorCode::FILE_EXISTS, std::format("Destination '{}' already defined", dest_name));
     }
     
-    extra_queues_[dest_name] = make_unique<ExtrapartitionQueue>(def);
+    auto queue = make_unique<ExtrapartitionQueue>(def);
+    extra_by_id_.set(NameTable::instance().intern(dest_name), queue.get());
+    extra_queues_[dest_name] = std::move(queue);
     ++total_dests_defined_;
+    note_resource_change();
     return {};
 }
 
@@ -441,6 +484,7 @@ Result<void> TDQManager::define_indirect(StringView dest, StringView target) {
     
     indirect_map_[dest_name] = target_name;
     ++total_dests_defined_;
+    note_resource_change();
     return {};
 }
 
@@ -448,9 +492,14 @@ Result<void> TDQManager::delete_destination(StringView dest) {
     std::unique_lock lock(mutex_);
     String dest_name = to_upper(String(dest));
     
-    if (intra_queues_.erase(dest_name) > 0) return {};
-    if (extra_queues_.erase(dest_name) > 0) return {};
-    if (indirect_map_.erase(dest_name) > 0) return {};
+    const NameId id = NameTable::instance().find(dest_name);
+    intra_by_id_.erase(id);
+    extra_by_id_.erase(id);
+    if (intra_queues_.erase(dest_name) > 0 || extra_queues_.erase(dest_name) > 0 ||
+        indirect_map_.erase(dest_name) > 0) {
+        note_resource_change();
+        return {};
+    }
     
     return make_error<void>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Destination '{}' not found", dest));
 }
@@ -503,6 +552,36 @@ Result<TDQRecord> TDQManager::readq(StringView dest) {
     return make_error<TDQRecord>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Destination '{}' not found", dest));
 }
 
+Result<void> TDQManager::writeq(NameId dest, ConstByteSpan data) {
+    {
+        std::shared_lock lock(mutex_);
+        if (auto* intra = intra_by_id_.find(dest)) {
+            ++total_writes_;
+            return intra->write(data);
+        }
+        if (auto* extra = extra_by_id_.find(dest)) {
+            ++total_writes_;
+            return extra->write(data);
+        }
+    }
+    return writeq(NameTable::instance().name(dest), data);
+}
+
+Result<TDQRecord> TDQManager::readq(NameId dest) {
+    {
+        std::shared_lock lock(mutex_);
+        if (auto* intra = intra_by_id_.find(dest)) {
+            ++total_reads_;
+            return intra->read();
+        }
+        if (auto* extra = extra_by_id_.find(dest)) {
+            ++total_reads_;
+            return extra->read();
+        }
+    }
+    return readq(NameTable::instance().name(dest));
+}
+
 Result<void> TDQManager::deleteq(StringView dest) { return delete_destination(dest); }
 
 Result<void> TDQManager::enable_destination(StringView dest) {
@@ -515,6 +594,7 @@ Result<void> TDQManager::enable_destination(StringView dest) {
     auto intra_it = intra_queues_.find(dest_name);
     if (intra_it != intra_queues_.end()) {
         intra_it->second->set_enabled(true);
+        note_resource_change();
         return {};
     }
     
@@ -531,6 +611,7 @@ Result<void> TDQManager::disable_destination(StringView dest) {
     auto intra_it = intra_queues_.find(dest_name);
     if (intra_it != intra_queues_.end()) {
         intra_it->second->set_enabled(false);
+        note_resource_change();
         return {};
     }
     
@@ -580,6 +661,23 @@ Result<Size> TDQManager::get_queue_depth(StringView dest) const {
     return make_error<Size>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Destination '{}' not found or not intrapartition", dest));
 }
 
+Optional<TriggerCheck> TDQManager::trigger_check(const String& dest) const {
+    std::shared_lock lock(mutex_);
+    auto it = intra_queues_.find(dest);
+    if (it == intra_queues_.end() || !it->second->is_enabled()) return nullopt;
+    const auto& trigger = it->second->definition().trigger;
+    if (!trigger.has_value()) return nullopt;
+    const auto& stats = it->second->statistics();
+    return TriggerCheck{trigger.value(), it->second->depth(),
+                        stats.total_records_written.get(), stats.total_records_read.get()};
+}
+
+void TDQManager::rearm_trigger(const String& dest) const {
+    std::shared_lock lock(mutex_);
+    auto it = intra_queues_.find(dest);
+    if (it != intra_queues_.end()) it->second->rearm_trigger();
+}
+
 String TDQManager::get_statistics() const {
     std::shared_lock lock(mutex_);
     std::ostringstream oss;
@@ -589,7 +687,8 @@ String TDQManager::get_statistics() const {
         << "  Indirect Destinations: " << indirect_map_.size() << "\n"
         << "  Total Destinations Defined: " << total_dests_defined_.get() << "\n"
         << "  Total Writes: " << total_writes_.get() << "\n"
-        << "  Total Reads: " << total_reads_.get();
+        << "  Total Reads: " << total_reads_.get() << "\n"
+        << "  " << ati_.statistics().to_string();
     return oss.str();
 }
 
@@ -0,0 +1,158 @@
+// =============================================================================
+// CICS Emulation - Trigger Dispatcher (ATI) Implementation
+// Version: 3.4.6
+// =============================================================================
+
+#include "cics/tdq/tdq_types.hpp"
+#include <algorithm>
+#include <format>
+
+namespace cics::tdq {
+
+String TriggerDispatcherStatistics::to_string() const {
+    return std::format("ATI: posted {}, merged {}, started {}, suppressed {}, deferred {}, "
+        "retriggered {}, failures {}, stalled {}",
+        posted.get(), merged.get(), started.get(), suppressed.get(), deferred.get(),
+        retriggered.get(), failures.get(), stalled.get());
+}
+
+TriggerDispatcher::TriggerDispatcher(TriggerLookup lookup, TriggerRearm rearm, UInt32 workers)
+    : lookup_(std::move(lookup)), rearm_(std::move(rearm)), worker_count_(std::max<UInt32>(workers, 1)) {}
+
+TriggerDispatcher::~TriggerDispatcher() {
+    stop();
+}
+
+void TriggerDispatcher::enqueue(const String& dest) {
+    if (!waiting_.insert(dest).second) {
+        ++stats_.merged;
+        return;
+    }
+    events_.push_back(dest);
+    work_cv_.notify_one();
+}
+
+void TriggerDispatcher::post(const String& dest) {
+    std::lock_guard lock(mutex_);
+    ++stats_.posted;
+    if (stopping_) return;
+    if (workers_.empty()) {
+        workers_.reserve(worker_count_);
+        for (UInt32 i = 0; i < worker_count_; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+    enqueue(dest);
+}
+
+void TriggerDispatcher::wait_idle() {
+    std::unique_lock lock(mutex_);
+    idle_cv_.wait(lock, [this] { return events_.empty() && busy_workers_ == 0; });
+}
+
+void TriggerDispatcher::stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        events_.clear();
+        waiting_.clear();
+        deferred_.clear();
+        workers.swap(workers_);
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers) worker.join();
+
+    std::lock_guard lock(mutex_);
+    stopping_ = false;
+    idle_cv_.notify_all();
+}
+
+void TriggerDispatcher::worker_loop() {
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        work_cv_.wait(lock, [this] { return stopping_ || !events_.empty(); });
+        if (stopping_) return;
+
+        const String dest = std::move(events_.front());
+        events_.pop_front();
+        waiting_.erase(dest);
+        ++busy_workers_;
+        run(dest, lock);
+        --busy_workers_;
+        if (events_.empty() && busy_workers_ == 0) idle_cv_.notify_all();
+    }
+}
+
+void TriggerDispatcher::run(const String& dest, std::unique_lock<std::mutex>& lock) {
+    // The consumer's own end re-checks the queue, so nothing is lost
+    if (active_.contains(dest)) {
+        ++stats_.suppressed;
+        return;
+    }
+
+    lock.unlock();
+    auto check = lookup_(dest);
+    lock.lock();
+    if (!check || !check->trigger.enabled || !check->trigger.callback || check->depth == 0) return;
+    if (stopping_ || active_.contains(dest)) return;
+
+    // A terminal runs one task at a time; wait for it to be free
+    const String terminal = check->trigger.terminal_id;
+    if (!terminal.empty() && busy_terminals_.contains(terminal)) {
+        deferred_.emplace_back(terminal, dest);
+        ++stats_.deferred;
+        return;
+    }
+
+    active_.insert(dest);
+    if (!terminal.empty()) busy_terminals_.insert(terminal);
+    ++stats_.started;
+    lock.unlock();
+
+    bool failed = false;
+    try {
+        check->trigger.callback(check->trigger.transaction_id, dest);
+    } catch (...) {
+        ++stats_.failures;
+        failed = true;
+    }
+
+    lock.lock();
+    active_.erase(dest);
+    if (!terminal.empty()) {
+        busy_terminals_.erase(terminal);
+        for (auto it = deferred_.begin(); it != deferred_.end();) {
+            if (it->first == terminal) {
+                if (!stopping_) enqueue(it->second);
+                it = deferred_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (stopping_) return;
+    lock.unlock();
+
+    // Arm the queue before looking, so a write from here on triggers it
+    // again whatever its depth. Starting a consumer that threw, or that
+    // read nothing while nothing was written, would only repeat the same
+    // run; those wait for that write instead.
+    if (rearm_) rearm_(dest);
+    auto after = failed ? nullopt : lookup_(dest);
+    lock.lock();
+    if (stopping_) return;
+    if (failed) {
+        ++stats_.stalled;
+        return;
+    }
+    if (!after || !after->trigger.enabled || after->depth == 0) return;
+    if (after->read == check->read && after->written == check->written) {
+        ++stats_.stalled;
+        return;
+    }
+    ++stats_.retriggered;
+    enqueue(dest);
+}
+
+} // namespace cics::tdq
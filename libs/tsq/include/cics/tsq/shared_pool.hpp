@@ -0,0 +1,91 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - Shared Temporary Storage Pool
+// =============================================================================
+//
+// A TS pool in a POSIX shared-memory segment, standing in for CICS TS data
+// sharing on the coupling facility: every region process on the box that
+// opens the same pool name sees the same queues, with no server in between.
+//
+// Nothing in the segment is a pointer. Queues live in a fixed directory of
+// slots; each slot's header is a single atomic word (epoch, live flag, items
+// handed out) so WRITEQ reserves an item number with one CAS, and item
+// numbers index offset tables carved from the pool heap. Readers never lock:
+// they copy an item and then check that neither the item slot nor the
+// block's generation moved, retrying if they did.
+//
+// The heap allocator is a set of lock-free free lists per size class on top
+// of a bump pointer. No operation holds a lock another process could wait
+// on, so a region that dies mid-request leaks at most the block it was
+// writing and never wedges or corrupts the pool.
+// =============================================================================
+
+#include "cics/common/types.hpp"
+#include "cics/common/error.hpp"
+
+namespace cics::tsq {
+
+struct SharedTSPoolConfig {
+    Size segment_bytes = 64 * 1024 * 1024;
+    UInt32 max_queues = 4096;  // Distinct queue names over the pool's life
+};
+
+struct SharedTSPoolStatistics {
+    UInt64 segment_bytes = 0;
+    UInt64 heap_bytes = 0;
+    UInt64 heap_used = 0;       // High-water mark of the bump pointer
+    UInt64 blocks_in_use = 0;
+    UInt64 bytes_in_use = 0;    // Item and index bytes currently allocated
+    UInt64 queues = 0;          // Live queues
+    UInt64 writes = 0;
+    UInt64 reads = 0;
+    UInt64 rewrites = 0;
+    UInt64 deleteqs = 0;
+    UInt64 read_retries = 0;    // Reads repeated because the item changed underneath
+
+    [[nodiscard]] String to_string() const;
+};
+
+class SharedTSPool {
+public:
+    // Create the named segment or attach to it if another process has
+    // already; config only matters to the creator
+    static Result<SharedPtr<SharedTSPool>> open(StringView name, const SharedTSPoolConfig& config = {});
+
+    // Remove the segment name; processes already attached keep their mapping
+    static Result<void> remove(StringView name);
+
+    ~SharedTSPool();
+    SharedTSPool(const SharedTSPool&) = delete;
+    SharedTSPool& operator=(const SharedTSPool&) = delete;
+
+    // WRITEQ TS: item number written
+    Result<UInt32> writeq(StringView queue, ConstByteSpan data);
+    // WRITEQ TS REWRITE
+    Result<void> rewriteq(StringView queue, UInt32 item, ConstByteSpan data);
+    // READQ TS ITEM / NEXT
+    Result<ByteBuffer> readq(StringView queue, UInt32 item) const;
+    Result<ByteBuffer> readq_next(StringView queue, UInt32& current_item) const;
+    // DELETEQ TS
+    Result<void> deleteq(StringView queue);
+
+    [[nodiscard]] bool queue_exists(StringView queue) const;
+    [[nodiscard]] UInt32 item_count(StringView queue) const;
+    [[nodiscard]] std::vector<String> list_queues() const;
+
+    [[nodiscard]] const String& name() const { return name_; }
+    [[nodiscard]] bool created() const { return created_; }  // This process made the segment
+    [[nodiscard]] SharedTSPoolStatistics statistics() const;
+
+private:
+    SharedTSPool(String name, Byte* base, Size size, bool created)
+        : name_(std::move(name)), base_(base), size_(size), created_(created) {}
+
+    String name_;
+    Byte* base_;
+    Size size_;
+    bool created_;
+};
+
+} // namespace cics::tsq
@@ -14,6 +14,7 @@
 
 #include "cics/common/types.hpp"
 #include "cics/common/error.hpp"
+#include "cics/common/name_table.hpp"
 #include <map>
 #include <shared_mutex>
 #include <deque>
@@ -250,14 +251,22 @@ public:
 // TSQ Manager
 // =============================================================================
 
+class SharedTSPool;
+
 class TSQManager {
 private:
     std::map<String, UniquePtr<TemporaryStorageQueue>> queues_;
+    NameIndex<TemporaryStorageQueue> queues_by_id_;    // Main-storage queues, by their name's id
     mutable std::shared_mutex mutex_;
     Size auxiliary_threshold_;
     Path auxiliary_storage_path_;
     bool initialized_ = false;
     
+    // Queues whose names start with shared_prefix_ live in the shared pool
+    // (the TSMODEL POOLNAME mapping), every other queue in this process
+    SharedPtr<SharedTSPool> shared_pool_;
+    String shared_prefix_;
+    
     // Statistics
     AtomicCounter<UInt64> total_queues_created_;
     AtomicCounter<UInt64> total_queues_deleted_;
@@ -282,6 +291,14 @@ public:
     Result<void> delete_queue(StringView name);
     [[nodiscard]] bool queue_exists(StringView name) const;
     
+    // By interned name: an array index once the queue has been seen by id.
+    // Ids of names not in upper case still work, by way of the name.
+    Result<TemporaryStorageQueue*> get_queue(NameId queue);
+    Result<UInt32> writeq(NameId queue, ConstByteSpan data, TSQLocation location = TSQLocation::MAIN);
+    Result<TSQItem> readq(NameId queue, UInt32 item_number) const;
+    Result<TSQItem> readq_next(NameId queue, UInt32& current_item) const;
+    Result<void> deleteq(NameId queue);
+    
     // WRITEQ TS
     Result<UInt32> writeq(StringView queue_name, ConstByteSpan data,
                           TSQLocation location = TSQLocation::MAIN);
@@ -305,12 +322,21 @@ public:
     [[nodiscard]] std::vector<String> list_queues() const;
     [[nodiscard]] std::vector<String> list_queues_by_prefix(StringView prefix) const;
     
+    // Shared TS pool; an empty prefix routes every queue to the pool
+    void set_shared_pool(SharedPtr<SharedTSPool> pool, StringView prefix = "");
+    [[nodiscard]] SharedPtr<SharedTSPool> shared_pool() const;
+    
     // Configuration
     void set_auxiliary_threshold(Size threshold) { auxiliary_threshold_ = threshold; }
     [[nodiscard]] Size auxiliary_threshold() const { return auxiliary_threshold_; }
     
     // Statistics
     [[nodiscard]] String get_statistics() const;
+    
+private:
+    [[nodiscard]] SharedPtr<SharedTSPool> pool_for(StringView queue_name) const;
+    [[nodiscard]] TemporaryStorageQueue* indexed_queue(NameId queue) const;
+    void index_queue(NameId queue);
 };
 
 // =============================================================================
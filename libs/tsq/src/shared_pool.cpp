@@ -0,0 +1,654 @@
+// =============================================================================
+// CICS Emulation - Shared Temporary Storage Pool Implementation
+// =============================================================================
+
+#include "cics/tsq/shared_pool.hpp"
+#include "cics/tsq/tsq_types.hpp"
+#include "cics/common/task_context.hpp"
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cics::tsq {
+
+String SharedTSPoolStatistics::to_string() const {
+    std::ostringstream oss;
+    oss << "Shared TS Pool Statistics:\n"
+        << "  Queues: " << queues << "\n"
+        << "  Heap: " << heap_used << " of " << heap_bytes << " bytes carved\n"
+        << "  In Use: " << blocks_in_use << " blocks, " << bytes_in_use << " bytes\n"
+        << "  Writes: " << writes << "\n"
+        << "  Reads: " << reads << " (retried: " << read_retries << ")\n"
+        << "  Rewrites: " << rewrites << "\n"
+        << "  DeleteQs: " << deleteqs;
+    return oss.str();
+}
+
+#ifdef _WIN32
+
+Result<SharedPtr<SharedTSPool>> SharedTSPool::open(StringView, const SharedTSPoolConfig&) {
+    return make_error<SharedPtr<SharedTSPool>>(ErrorCode::NOT_SUPPORTED, "Shared TS pools need POSIX shared memory");
+}
+Result<void> SharedTSPool::remove(StringView) {
+    return make_error<void>(ErrorCode::NOT_SUPPORTED, "Shared TS pools need POSIX shared memory");
+}
+SharedTSPool::~SharedTSPool() = default;
+Result<UInt32> SharedTSPool::writeq(StringView, ConstByteSpan) { return make_error<UInt32>(ErrorCode::NOT_SUPPORTED, "No pool"); }
+Result<void> SharedTSPool::rewriteq(StringView, UInt32, ConstByteSpan) { return make_error<void>(ErrorCode::NOT_SUPPORTED, "No pool"); }
+Result<ByteBuffer> SharedTSPool::readq(StringView, UInt32) const { return make_error<ByteBuffer>(ErrorCode::NOT_SUPPORTED, "No pool"); }
+Result<ByteBuffer> SharedTSPool::readq_next(StringView, UInt32&) const { return make_error<ByteBuffer>(ErrorCode::NOT_SUPPORTED, "No pool"); }
+Result<void> SharedTSPool::deleteq(StringView) { return make_error<void>(ErrorCode::NOT_SUPPORTED, "No pool"); }
+bool SharedTSPool::queue_exists(StringView) const { return false; }
+UInt32 SharedTSPool::item_count(StringView) const { return 0; }
+std::vector<String> SharedTSPool::list_queues() const { return {}; }
+SharedTSPoolStatistics SharedTSPool::statistics() const { return {}; }
+
+#else
+
+namespace {
+
+// =============================================================================
+// Segment Layout
+// =============================================================================
+// [PoolHeader][QueueSlot x max_queues][heap ...]. Every reference inside the
+// segment is a byte offset from its base, so each process may map it at a
+// different address. Offset 0 is the header, never a block, and means null.
+
+constexpr UInt64 POOL_MAGIC = 0x4C4F4F5053544349ULL;  // "ICTSPOOL"
+constexpr UInt32 POOL_VERSION = 1;
+
+constexpr Size ITEMS_PER_CHUNK = 256;
+constexpr Size CHUNKS_PER_QUEUE = (MAX_QUEUE_ITEMS + ITEMS_PER_CHUNK - 1) / ITEMS_PER_CHUNK;
+
+// Payload size classes 64 bytes .. 32 KiB; the largest holds MAX_ITEM_LENGTH
+constexpr Size MIN_CLASS_SHIFT = 6;
+constexpr Size SIZE_CLASSES = 10;
+static_assert((Size{1} << (MIN_CLASS_SHIFT + SIZE_CLASSES - 1)) >= MAX_ITEM_LENGTH);
+static_assert((Size{1} << (MIN_CLASS_SHIFT + SIZE_CLASSES - 1)) >= ITEMS_PER_CHUNK * sizeof(UInt64));
+
+// Offsets fit in 40 bits; the top 24 carry an ABA tag in free-list heads and
+// the queue epoch in item slots
+constexpr UInt64 OFFSET_MASK = (UInt64{1} << 40) - 1;
+constexpr UInt64 TAG_MASK = (UInt64{1} << 24) - 1;
+
+constexpr UInt64 offset_of(UInt64 word) { return word & OFFSET_MASK; }
+constexpr UInt64 tag_of(UInt64 word) { return word >> 40; }
+constexpr UInt64 tagged(UInt64 offset, UInt64 tag) { return offset | ((tag & TAG_MASK) << 40); }
+
+// Queue state word: items handed out (32) | live (1) | epoch (31). Bumping
+// the epoch is what DELETEQ does; items published under an older epoch are
+// dead even before anyone frees them.
+constexpr UInt64 LIVE_BIT = UInt64{1} << 32;
+constexpr UInt32 reserved_of(UInt64 state) { return static_cast<UInt32>(state); }
+constexpr bool live_of(UInt64 state) { return (state & LIVE_BIT) != 0; }
+constexpr UInt64 epoch_of(UInt64 state) { return state >> 33; }
+constexpr UInt64 make_state(UInt64 epoch, bool live, UInt32 reserved) {
+    return (epoch << 33) | (live ? LIVE_BIT : 0) | reserved;
+}
+
+// Directory slot claim word
+constexpr UInt64 SLOT_EMPTY = 0;
+constexpr UInt64 SLOT_ACTIVE = 1;
+constexpr UInt64 SLOT_CLAIMING = UInt64{1} << 63;  // | claiming pid
+
+struct BlockHeader {
+    std::atomic<UInt32> generation;  // Bumped on every free
+    UInt32 size_class;               // Fixed for the block's life
+    std::atomic<UInt32> length;
+    UInt32 reserved;
+    std::atomic<UInt64> next;        // Free-list link
+    UInt64 pad;
+};
+static_assert(sizeof(BlockHeader) == 32);
+
+struct QueueSlot {
+    std::atomic<UInt64> claim;
+    char name[MAX_QUEUE_NAME_LENGTH];
+    std::atomic<UInt64> state;
+    std::atomic<UInt64> chunks[CHUNKS_PER_QUEUE];  // Item offset tables, never freed
+};
+
+struct PoolHeader {
+    UInt64 magic;
+    std::atomic<UInt32> ready;
+    UInt32 version;
+    UInt64 segment_bytes;
+    UInt64 slots_offset;
+    UInt64 heap_offset;
+    UInt32 max_queues;
+    UInt32 pad;
+    std::atomic<UInt64> heap_top;
+    std::atomic<UInt64> free_heads[SIZE_CLASSES];
+
+    std::atomic<UInt64> blocks_in_use;
+    std::atomic<UInt64> bytes_in_use;
+    std::atomic<UInt64> writes;
+    std::atomic<UInt64> reads;
+    std::atomic<UInt64> rewrites;
+    std::atomic<UInt64> deleteqs;
+    std::atomic<UInt64> read_retries;
+};
+
+static_assert(std::atomic<UInt64>::is_always_lock_free, "shared pool needs address-free 64-bit atomics");
+
+constexpr Size align_up(Size n, Size a) { return (n + a - 1) & ~(a - 1); }
+
+// Reads of an item being published wait this many yields before ITEMERR
+constexpr int PUBLISH_SPINS = 1000;
+
+class Segment {
+public:
+    explicit Segment(Byte* base) : base_(base) {}
+
+    PoolHeader& header() const { return *reinterpret_cast<PoolHeader*>(base_); }
+    QueueSlot& slot(UInt32 i) const {
+        return reinterpret_cast<QueueSlot*>(base_ + header().slots_offset)[i];
+    }
+    BlockHeader& block(UInt64 offset) const { return *reinterpret_cast<BlockHeader*>(base_ + offset); }
+    Byte* payload(UInt64 offset) const { return base_ + offset + sizeof(BlockHeader); }
+    std::atomic<UInt64>* item_table(UInt64 offset) const {
+        return reinterpret_cast<std::atomic<UInt64>*>(payload(offset));
+    }
+
+    static Size capacity(UInt32 size_class) { return Size{1} << (MIN_CLASS_SHIFT + size_class); }
+
+    // -------------------------------------------------------------------------
+    // Allocator
+    // -------------------------------------------------------------------------
+
+    UInt64 allocate(Size length) {
+        UInt32 cls = 0;
+        while (capacity(cls) < length) ++cls;
+
+        auto& head = header().free_heads[cls];
+        UInt64 top = head.load(std::memory_order_acquire);
+        while (offset_of(top) != 0) {
+            // A racing pop may hand this block out and reuse its link; the
+            // tag makes our CAS fail in that case
+            const UInt64 next = block(offset_of(top)).next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(top, tagged(next, tag_of(top) + 1),
+                                           std::memory_order_acquire, std::memory_order_acquire)) {
+                return claimed(offset_of(top), cls);
+            }
+        }
+
+        const Size bytes = sizeof(BlockHeader) + capacity(cls);
+        UInt64 end = header().heap_top.load(std::memory_order_relaxed);
+        do {
+            if (end + bytes > header().segment_bytes) return 0;
+        } while (!header().heap_top.compare_exchange_weak(end, end + bytes, std::memory_order_relaxed));
+
+        block(end).size_class = cls;
+        return claimed(end, cls);
+    }
+
+    void release(UInt64 offset) {
+        BlockHeader& blk = block(offset);
+        // Readers that copied from this block see the generation move and retry
+        blk.generation.fetch_add(1, std::memory_order_release);
+        header().blocks_in_use.fetch_sub(1, std::memory_order_relaxed);
+        header().bytes_in_use.fetch_sub(capacity(blk.size_class), std::memory_order_relaxed);
+
+        auto& head = header().free_heads[blk.size_class];
+        UInt64 top = head.load(std::memory_order_relaxed);
+        do {
+            blk.next.store(offset_of(top), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(top, tagged(offset, tag_of(top) + 1),
+                                             std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // -------------------------------------------------------------------------
+    // Queue directory
+    // -------------------------------------------------------------------------
+
+    QueueSlot* find(StringView name, bool create) const {
+        const UInt32 count = header().max_queues;
+        const UInt32 start = static_cast<UInt32>(
+            fnv1a_hash(ConstByteSpan(reinterpret_cast<const Byte*>(name.data()), name.size())) % count);
+
+        for (UInt32 probe = 0; probe < count; ++probe) {
+            QueueSlot& s = slot((start + probe) % count);
+            for (;;) {
+                UInt64 claim = s.claim.load(std::memory_order_acquire);
+                if (claim == SLOT_ACTIVE) {
+                    if (same_name(s, name)) return &s;
+                    break;
+                }
+                if (claim == SLOT_EMPTY) {
+                    if (!create) return nullptr;  // Names are never removed, so the probe ends here
+                    const UInt64 mine = SLOT_CLAIMING | static_cast<UInt64>(::getpid());
+                    if (!s.claim.compare_exchange_strong(claim, mine, std::memory_order_acquire)) continue;
+                    std::memset(s.name, 0, sizeof(s.name));
+                    std::memcpy(s.name, name.data(), name.size());
+                    s.claim.store(SLOT_ACTIVE, std::memory_order_release);
+                    return &s;
+                }
+                // Another process is naming this slot; if it died doing so,
+                // put the slot back
+                const pid_t owner = static_cast<pid_t>(claim & ~SLOT_CLAIMING);
+                if (::kill(owner, 0) != 0 && errno == ESRCH) {
+                    s.claim.compare_exchange_strong(claim, SLOT_EMPTY, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    static bool same_name(const QueueSlot& s, StringView name) {
+        return std::strncmp(s.name, name.data(), name.size()) == 0 &&
+               (name.size() == sizeof(s.name) || s.name[name.size()] == '\0');
+    }
+
+    // Item offset word for item index i, creating its table if asked
+    std::atomic<UInt64>* item(QueueSlot& s, UInt32 index, bool create) {
+        auto& chunk = s.chunks[index / ITEMS_PER_CHUNK];
+        UInt64 table = chunk.load(std::memory_order_acquire);
+        if (table == 0) {
+            if (!create) return nullptr;
+            const UInt64 fresh = allocate(ITEMS_PER_CHUNK * sizeof(UInt64));
+            if (fresh == 0) return nullptr;
+            std::memset(payload(fresh), 0, ITEMS_PER_CHUNK * sizeof(UInt64));
+            if (chunk.compare_exchange_strong(table, fresh, std::memory_order_acq_rel)) {
+                table = fresh;
+            } else {
+                release(fresh);
+            }
+        }
+        return &item_table(table)[index % ITEMS_PER_CHUNK];
+    }
+
+    std::atomic<UInt64>* item(const QueueSlot& s, UInt32 index) const {
+        const UInt64 table = s.chunks[index / ITEMS_PER_CHUNK].load(std::memory_order_acquire);
+        return table == 0 ? nullptr : &item_table(table)[index % ITEMS_PER_CHUNK];
+    }
+
+    // Copy one item, retrying while writers replace or free it underneath
+    Optional<ByteBuffer> copy_item(const std::atomic<UInt64>& word, UInt64 epoch) const {
+        for (int spins = 0;;) {
+            const UInt64 value = word.load(std::memory_order_acquire);
+            if (value == 0 || tag_of(value) != (epoch & TAG_MASK)) {
+                // Reserved but not yet published (or its writer died)
+                if (++spins > PUBLISH_SPINS) return std::nullopt;
+                std::this_thread::yield();
+                continue;
+            }
+
+            const BlockHeader& blk = block(offset_of(value));
+            const UInt32 generation = blk.generation.load(std::memory_order_acquire);
+            const Size length = std::min<Size>(blk.length.load(std::memory_order_relaxed), capacity(blk.size_class));
+            const Byte* data = payload(offset_of(value));
+            ByteBuffer copy(data, data + length);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (blk.generation.load(std::memory_order_relaxed) == generation &&
+                word.load(std::memory_order_relaxed) == value) {
+                return copy;
+            }
+            header().read_retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    UInt64 store_block(ConstByteSpan data) {
+        const UInt64 offset = allocate(data.size());
+        if (offset == 0) return 0;
+        if (!data.empty()) std::memcpy(payload(offset), data.data(), data.size());
+        block(offset).length.store(static_cast<UInt32>(data.size()), std::memory_order_relaxed);
+        return offset;
+    }
+
+private:
+    UInt64 claimed(UInt64 offset, UInt32 cls) {
+        header().blocks_in_use.fetch_add(1, std::memory_order_relaxed);
+        header().bytes_in_use.fetch_add(capacity(cls), std::memory_order_relaxed);
+        return offset;
+    }
+
+    Byte* base_;
+};
+
+String segment_name(StringView name) {
+    String shm(name);
+    if (!name.starts_with('/')) shm.insert(shm.begin(), '/');
+    return shm;
+}
+
+String queue_key(StringView queue) {
+    return to_upper(queue);
+}
+
+Result<void> check_queue_name(StringView queue) {
+    if (queue.empty() || queue.size() > MAX_QUEUE_NAME_LENGTH) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Queue name must be 1-{} characters", MAX_QUEUE_NAME_LENGTH));
+    }
+    return {};
+}
+
+} // namespace
+
+// =============================================================================
+// Segment lifetime
+// =============================================================================
+
+Result<SharedPtr<SharedTSPool>> SharedTSPool::open(StringView name, const SharedTSPoolConfig& config) {
+    using PoolResult = Result<SharedPtr<SharedTSPool>>;
+    const String shm = segment_name(name);
+
+    const Size slots_offset = align_up(sizeof(PoolHeader), 64);
+    const Size heap_offset = align_up(slots_offset + Size{config.max_queues} * sizeof(QueueSlot), 64);
+    if (config.max_queues == 0 || config.segment_bytes <= heap_offset ||
+        config.segment_bytes > OFFSET_MASK) {
+        return make_error<SharedPtr<SharedTSPool>>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Segment of {} bytes cannot hold {} queues", config.segment_bytes, config.max_queues));
+    }
+
+    bool created = true;
+    int fd = ::shm_open(shm.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (fd < 0 && errno == EEXIST) {
+        created = false;
+        fd = ::shm_open(shm.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0) {
+        return make_error<SharedPtr<SharedTSPool>>(ErrorCode::IO_ERROR,
+            std::format("shm_open {}: {}", shm, std::strerror(errno)));
+    }
+
+    auto fail = [&](const String& what) -> PoolResult {
+        const int err = errno;
+        ::close(fd);
+        if (created) ::shm_unlink(shm.c_str());
+        return make_error<SharedPtr<SharedTSPool>>(ErrorCode::IO_ERROR,
+            std::format("{} {}: {}", what, shm, std::strerror(err)));
+    };
+
+    Size size = config.segment_bytes;
+    if (created) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) return fail("ftruncate");
+    } else {
+        // The creator may not have sized the segment yet
+        struct stat st{};
+        for (int i = 0; i < 5000; ++i) {
+            if (::fstat(fd, &st) != 0) return fail("fstat");
+            if (st.st_size > 0) break;
+            std::this_thread::sleep_for(Milliseconds(1));
+        }
+        if (static_cast<Size>(st.st_size) < sizeof(PoolHeader)) {
+            ::close(fd);
+            return make_error<SharedPtr<SharedTSPool>>(ErrorCode::INVALID_STATE,
+                std::format("Shared TS pool {} was never initialised", shm));
+        }
+        size = static_cast<Size>(st.st_size);
+    }
+
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return fail("mmap");
+    ::close(fd);
+
+    auto* base = static_cast<Byte*>(mapped);
+    auto& header = *reinterpret_cast<PoolHeader*>(base);
+    if (created) {
+        // ftruncate zero-filled the segment, which is every slot's and
+        // free list's empty state
+        header.magic = POOL_MAGIC;
+        header.version = POOL_VERSION;
+        header.segment_bytes = size;
+        header.slots_offset = slots_offset;
+        header.heap_offset = heap_offset;
+        header.max_queues = config.max_queues;
+        header.heap_top.store(heap_offset, std::memory_order_relaxed);
+        header.ready.store(1, std::memory_order_release);
+    } else {
+        for (int i = 0; i < 5000 && header.ready.load(std::memory_order_acquire) == 0; ++i) {
+            std::this_thread::sleep_for(Milliseconds(1));
+        }
+        if (header.ready.load(std::memory_order_acquire) == 0 || header.magic != POOL_MAGIC ||
+            header.version != POOL_VERSION || header.segment_bytes != size) {
+            ::munmap(mapped, size);
+            return make_error<SharedPtr<SharedTSPool>>(ErrorCode::INVALID_STATE,
+                std::format("{} is not a usable shared TS pool", shm));
+        }
+    }
+
+    return SharedPtr<SharedTSPool>(new SharedTSPool(String(name), base, size, created));
+}
+
+Result<void> SharedTSPool::remove(StringView name) {
+    const String shm = segment_name(name);
+    if (::shm_unlink(shm.c_str()) != 0 && errno != ENOENT) {
+        return make_error<void>(ErrorCode::IO_ERROR, std::format("shm_unlink {}: {}", shm, std::strerror(errno)));
+    }
+    return {};
+}
+
+SharedTSPool::~SharedTSPool() {
+    ::munmap(base_, size_);
+}
+
+// =============================================================================
+// Queue operations
+// =============================================================================
+
+Result<UInt32> SharedTSPool::writeq(StringView queue, ConstByteSpan data) {
+    if (auto valid = check_queue_name(queue); !valid) return make_error<UInt32>(valid.error());
+    if (data.size() > MAX_ITEM_LENGTH) {
+        return make_error<UInt32>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Item length {} exceeds maximum {}", data.size(), MAX_ITEM_LENGTH));
+    }
+
+    Segment seg(base_);
+    QueueSlot* slot = seg.find(queue_key(queue), true);
+    if (!slot) return make_error<UInt32>(ErrorCode::RESOURCE_EXHAUSTED, "Shared TS pool directory full");
+
+    // Reserve the item number; the first WRITEQ after DELETEQ revives the queue
+    UInt64 state = slot->state.load(std::memory_order_acquire);
+    UInt64 next;
+    do {
+        const UInt32 number = live_of(state) ? reserved_of(state) + 1 : 1;
+        if (number > MAX_QUEUE_ITEMS) {
+            return make_error<UInt32>(ErrorCode::RESOURCE_EXHAUSTED,
+                std::format("Queue full: {} items", MAX_QUEUE_ITEMS));
+        }
+        next = make_state(epoch_of(state), true, number);
+    } while (!slot->state.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+
+    const UInt32 number = reserved_of(next);
+    const UInt64 epoch = epoch_of(next);
+    auto* word = seg.item(*slot, number - 1, true);
+    const UInt64 offset = word ? seg.store_block(data) : 0;
+    if (offset == 0) return make_error<UInt32>(ErrorCode::RESOURCE_EXHAUSTED, "Shared TS pool heap full");
+
+    // Whoever takes a value out of an item word frees it; here that may only
+    // be a leftover from an epoch DELETEQ has not finished sweeping. A value
+    // of our epoch or of the queue's live one is an item someone was told
+    // was written: if we stalled across a DELETEQ, a revived queue has
+    // reused our number and that item is not ours to displace.
+    const UInt64 mine = tagged(offset, epoch);
+    UInt64 current = word->load(std::memory_order_acquire);
+    do {
+        if (offset_of(current) == 0) continue;
+        const UInt64 live = epoch_of(slot->state.load(std::memory_order_acquire));
+        if (tag_of(current) == (epoch & TAG_MASK) || tag_of(current) == (live & TAG_MASK)) {
+            seg.release(offset);
+            if (live != epoch) {
+                return make_error<UInt32>(ErrorCode::CICS_QUEUE_NOT_FOUND,
+                    std::format("Queue '{}' was deleted during WRITEQ", queue));
+            }
+            return make_error<UInt32>(ErrorCode::INVALID_STATE,
+                std::format("Item {} of queue '{}' is already written", number, queue));
+        }
+    } while (!word->compare_exchange_weak(current, mine, std::memory_order_acq_rel, std::memory_order_acquire));
+    if (offset_of(current) != 0) seg.release(offset_of(current));
+
+    // A DELETEQ that raced us owns the queue now; take our item back out
+    if (epoch_of(slot->state.load(std::memory_order_acquire)) != epoch) {
+        UInt64 expected = mine;
+        if (word->compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) seg.release(offset);
+        return make_error<UInt32>(ErrorCode::CICS_QUEUE_NOT_FOUND,
+            std::format("Queue '{}' was deleted during WRITEQ", queue));
+    }
+
+    seg.header().writes.fetch_add(1, std::memory_order_relaxed);
+    note_request(RequestType::TS_PUT, data.size());
+    return number;
+}
+
+Result<void> SharedTSPool::rewriteq(StringView queue, UInt32 item, ConstByteSpan data) {
+    if (data.size() > MAX_ITEM_LENGTH) {
+        return make_error<void>(ErrorCode::INVALID_ARGUMENT,
+            std::format("Item length {} exceeds maximum {}", data.size(), MAX_ITEM_LENGTH));
+    }
+
+    Segment seg(base_);
+    QueueSlot* slot = seg.find(queue_key(queue), false);
+    const UInt64 state = slot ? slot->state.load(std::memory_order_acquire) : 0;
+    if (!slot || !live_of(state)) {
+        return make_error<void>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Queue '{}' not found", queue));
+    }
+    auto* word = item == 0 || item > reserved_of(state) ? nullptr : seg.item(*slot, item - 1);
+    if (!word) {
+        return make_error<void>(ErrorCode::RECORD_NOT_FOUND,
+            std::format("Item {} not found (queue has {} items)", item, reserved_of(state)));
+    }
+
+    const UInt64 offset = seg.store_block(data);
+    if (offset == 0) return make_error<void>(ErrorCode::RESOURCE_EXHAUSTED, "Shared TS pool heap full");
+
+    const UInt64 epoch = epoch_of(state);
+    const UInt64 mine = tagged(offset, epoch);
+    UInt64 current = word->load(std::memory_order_acquire);
+    do {
+        if (offset_of(current) == 0 || tag_of(current) != (epoch & TAG_MASK)) {
+            seg.release(offset);
+            return make_error<void>(ErrorCode::RECORD_NOT_FOUND, std::format("Item {} not found", item));
+        }
+    } while (!word->compare_exchange_weak(current, mine, std::memory_order_acq_rel, std::memory_order_acquire));
+    seg.release(offset_of(current));
+
+    seg.header().rewrites.fetch_add(1, std::memory_order_relaxed);
+    note_request(RequestType::TS_PUT, data.size());
+    return {};
+}
+
+Result<ByteBuffer> SharedTSPool::readq(StringView queue, UInt32 item) const {
+    Segment seg(base_);
+    QueueSlot* slot = seg.find(queue_key(queue), false);
+    const UInt64 state = slot ? slot->state.load(std::memory_order_acquire) : 0;
+    if (!slot || !live_of(state)) {
+        return make_error<ByteBuffer>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Queue '{}' not found", queue));
+    }
+
+    const auto* word = item == 0 || item > reserved_of(state) ? nullptr : seg.item(*slot, item - 1);
+    auto data = word ? seg.copy_item(*word, epoch_of(state)) : std::nullopt;
+    if (!data) {
+        return make_error<ByteBuffer>(ErrorCode::RECORD_NOT_FOUND,
+            std::format("Item {} not found (queue has {} items)", item, reserved_of(state)));
+    }
+
+    seg.header().reads.fetch_add(1, std::memory_order_relaxed);
+    note_request(RequestType::TS_GET, data->size());
+    return std::move(*data);
+}
+
+Result<ByteBuffer> SharedTSPool::readq_next(StringView queue, UInt32& current_item) const {
+    if (current_item >= item_count(queue)) {
+        if (!queue_exists(queue)) {
+            return make_error<ByteBuffer>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Queue '{}' not found", queue));
+        }
+        return make_error<ByteBuffer>(ErrorCode::VSAM_END_OF_FILE, "No more items in queue");
+    }
+    auto result = readq(queue, current_item + 1);
+    if (result) ++current_item;
+    return result;
+}
+
+Result<void> SharedTSPool::deleteq(StringView queue) {
+    Segment seg(base_);
+    QueueSlot* slot = seg.find(queue_key(queue), false);
+    UInt64 state = slot ? slot->state.load(std::memory_order_acquire) : 0;
+    do {
+        if (!slot || !live_of(state)) {
+            return make_error<void>(ErrorCode::CICS_QUEUE_NOT_FOUND, std::format("Queue '{}' not found", queue));
+        }
+    } while (!slot->state.compare_exchange_weak(state, make_state(epoch_of(state) + 1, false, 0),
+                                                std::memory_order_acq_rel));
+
+    // Sweep the dead epoch's items. Words already carrying the new epoch
+    // belong to WRITEQs that revived the queue and are left alone.
+    const UInt64 live_tag = (epoch_of(state) + 1) & TAG_MASK;
+    for (UInt32 i = 0; i < reserved_of(state); ++i) {
+        auto* word = seg.item(*slot, i);
+        if (!word) continue;
+        UInt64 value = word->load(std::memory_order_acquire);
+        while (value != 0 && tag_of(value) != live_tag) {
+            if (word->compare_exchange_weak(value, 0, std::memory_order_acq_rel)) {
+                seg.release(offset_of(value));
+                break;
+            }
+        }
+    }
+
+    seg.header().deleteqs.fetch_add(1, std::memory_order_relaxed);
+    return {};
+}
+
+bool SharedTSPool::queue_exists(StringView queue) const {
+    Segment seg(base_);
+    const QueueSlot* slot = seg.find(queue_key(queue), false);
+    return slot && live_of(slot->state.load(std::memory_order_acquire));
+}
+
+UInt32 SharedTSPool::item_count(StringView queue) const {
+    Segment seg(base_);
+    const QueueSlot* slot = seg.find(queue_key(queue), false);
+    if (!slot) return 0;
+    const UInt64 state = slot->state.load(std::memory_order_acquire);
+    return live_of(state) ? reserved_of(state) : 0;
+}
+
+std::vector<String> SharedTSPool::list_queues() const {
+    Segment seg(base_);
+    std::vector<String> names;
+    for (UInt32 i = 0; i < seg.header().max_queues; ++i) {
+        const QueueSlot& slot = seg.slot(i);
+        if (slot.claim.load(std::memory_order_acquire) == SLOT_ACTIVE &&
+            live_of(slot.state.load(std::memory_order_acquire))) {
+            names.emplace_back(slot.name, ::strnlen(slot.name, sizeof(slot.name)));
+        }
+    }
+    return names;
+}
+
+SharedTSPoolStatistics SharedTSPool::statistics() const {
+    Segment seg(base_);
+    const PoolHeader& h = seg.header();
+    SharedTSPoolStatistics stats;
+    stats.segment_bytes = h.segment_bytes;
+    stats.heap_bytes = h.segment_bytes - h.heap_offset;
+    stats.heap_used = h.heap_top.load(std::memory_order_relaxed) - h.heap_offset;
+    stats.blocks_in_use = h.blocks_in_use.load(std::memory_order_relaxed);
+    stats.bytes_in_use = h.bytes_in_use.load(std::memory_order_relaxed);
+    stats.queues = list_queues().size();
+    stats.writes = h.writes.load(std::memory_order_relaxed);
+    stats.reads = h.reads.load(std::memory_order_relaxed);
+    stats.rewrites = h.rewrites.load(std::memory_order_relaxed);
+    stats.deleteqs = h.deleteqs.load(std::memory_order_relaxed);
+    stats.read_retries = h.read_retries.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#endif // _WIN32
+
+} // namespace cics::tsq
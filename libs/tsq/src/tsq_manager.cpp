@@ -4,6 +4,8 @@
 // =============================================================================
 
 #include "cics/tsq/tsq_types.hpp"
+#include "cics/tsq/shared_pool.hpp"
+#include "cics/common/task_context.hpp"
 #include <algorithm>
 #include <format>
 #include <sstream>
@@ -139,6 +141,7 @@ Result<UInt32> TemporaryStorageQueue::write(ConstByteSpan data) {
     
     statistics_.record_write(data.size());
     statistics_.update_peaks(items_.size(), statistics_.total_bytes.get());
+    note_request(RequestType::TS_PUT, data.size());
     
     return item_number;
 }
@@ -170,6 +173,7 @@ Result<void> TemporaryStorageQueue::rewrite(UInt32 item_number, ConstByteSpan da
     
     statistics_.record_rewrite(old_size, data.size());
     statistics_.update_peaks(items_.size(), statistics_.total_bytes.get());
+    note_request(RequestType::TS_PUT, data.size());
     
     return {};
 }
@@ -191,6 +195,7 @@ Result<TSQItem> TemporaryStorageQueue::read(UInt32 item_number) const {
     }
     
     const_cast<TSQStatistics&>(statistics_).record_read();
+    note_request(RequestType::TS_GET, items_[item_number - 1].length());
     return items_[item_number - 1];
 }
 
@@ -207,6 +212,7 @@ Result<TSQItem> TemporaryStorageQueue::read_next(UInt32& current_item) const {
     
     ++current_item;
     const_cast<TSQStatistics&>(statistics_).record_read();
+    note_request(RequestType::TS_GET, items_[current_item - 1].length());
     return items_[current_item - 1];
 }
 
@@ -304,6 +310,7 @@ void TSQManager::shutdown() {
     
     if (!initialized_) return;
     
+    queues_by_id_.clear();
     queues_.clear();
     initialized_ = false;
 }
@@ -377,6 +384,7 @@ Result<void> TSQManager::delete_queue(StringView name) {
     auto result = it->second->delete_all();
     if (!result) return result;
     
+    queues_by_id_.erase(NameTable::instance().find(queue_name));
     queues_.erase(it);
     ++total_queues_deleted_;
     --active_queues_;
@@ -385,6 +393,8 @@ Result<void> TSQManager::delete_queue(StringView name) {
 }
 
 bool TSQManager::queue_exists(StringView name) const {
+    if (auto pool = pool_for(name)) return pool->queue_exists(name);
+    
     std::shared_lock lock(mutex_);
     String queue_name = to_upper(String(name));
     auto it = queues_.find(queue_name);
@@ -392,6 +402,8 @@ bool TSQManager::queue_exists(StringView name) const {
 }
 
 Result<UInt32> TSQManager::writeq(StringView queue_name, ConstByteSpan data, TSQLocation location) {
+    if (auto pool = pool_for(queue_name)) return pool->writeq(queue_name, data);
+    
     auto queue_result = get_or_create_queue(queue_name, location);
     if (!queue_result) {
         return make_error<UInt32>(queue_result.error().code, queue_result.error().message);
@@ -405,6 +417,8 @@ Result<UInt32> TSQManager::writeq(StringView queue_name, StringView str, TSQLoca
 }
 
 Result<void> TSQManager::rewriteq(StringView queue_name, UInt32 item_number, ConstByteSpan data) {
+    if (auto pool = pool_for(queue_name)) return pool->rewriteq(queue_name, item_number, data);
+    
     auto queue_result = get_queue(queue_name);
     if (!queue_result) {
         return make_error<void>(queue_result.error().code, queue_result.error().message);
@@ -419,6 +433,12 @@ Result<void> TSQManager::rewriteq(StringView queue_name, UInt32 item_number, Str
 }
 
 Result<TSQItem> TSQManager::readq(StringView queue_name, UInt32 item_number) const {
+    if (auto pool = pool_for(queue_name)) {
+        auto data = pool->readq(queue_name, item_number);
+        if (!data) return make_error<TSQItem>(data.error());
+        return TSQItem(ConstByteSpan(data.value()), item_number);
+    }
+    
     std::shared_lock lock(mutex_);
     
     String name = to_upper(String(queue_name));
@@ -433,6 +453,12 @@ Result<TSQItem> TSQManager::readq(StringView queue_name, UInt32 item_number) con
 }
 
 Result<TSQItem> TSQManager::readq_next(StringView queue_name, UInt32& current_item) const {
+    if (auto pool = pool_for(queue_name)) {
+        auto data = pool->readq_next(queue_name, current_item);
+        if (!data) return make_error<TSQItem>(data.error());
+        return TSQItem(ConstByteSpan(data.value()), current_item);
+    }
+    
     std::shared_lock lock(mutex_);
     
     String name = to_upper(String(queue_name));
@@ -447,6 +473,10 @@ Result<TSQItem> TSQManager::readq_next(StringView queue_name, UInt32& current_it
 }
 
 Result<void> TSQManager::deleteq_item(StringView queue_name, UInt32 item_number) {
+    if (pool_for(queue_name)) {
+        return make_error<void>(ErrorCode::NOT_SUPPORTED, "Items of a shared TS queue cannot be deleted singly");
+    }
+    
     auto queue_result = get_queue(queue_name);
     if (!queue_result) {
         return make_error<void>(queue_result.error().code, queue_result.error().message);
@@ -456,9 +486,75 @@ Result<void> TSQManager::deleteq_item(StringView queue_name, UInt32 item_number)
 }
 
 Result<void> TSQManager::deleteq(StringView queue_name) {
+    if (auto pool = pool_for(queue_name)) return pool->deleteq(queue_name);
     return delete_queue(queue_name);
 }
 
+Result<TemporaryStorageQueue*> TSQManager::get_queue(NameId queue) {
+    if (auto* indexed = indexed_queue(queue)) return indexed;
+    
+    auto result = get_queue(NameTable::instance().name(queue));
+    if (result) index_queue(queue);
+    return result;
+}
+
+Result<UInt32> TSQManager::writeq(NameId queue, ConstByteSpan data, TSQLocation location) {
+    if (auto* indexed = indexed_queue(queue)) return indexed->write(data);
+    
+    const StringView queue_name = NameTable::instance().name(queue);
+    if (queue_name.empty()) {
+        return make_error<UInt32>(ErrorCode::INVALID_ARGUMENT, "Queue name id is not interned");
+    }
+    if (auto pool = pool_for(queue_name)) return pool->writeq(queue_name, data);
+    
+    auto queue_result = get_or_create_queue(queue_name, location);
+    if (!queue_result) return make_error<UInt32>(queue_result.error());
+    index_queue(queue);
+    return queue_result.value()->write(data);
+}
+
+Result<TSQItem> TSQManager::readq(NameId queue, UInt32 item_number) const {
+    {
+        std::shared_lock lock(mutex_);
+        if (auto* indexed = queues_by_id_.find(queue); indexed && !indexed->is_deleted()) {
+            return indexed->read(item_number);
+        }
+    }
+    return readq(NameTable::instance().name(queue), item_number);
+}
+
+Result<TSQItem> TSQManager::readq_next(NameId queue, UInt32& current_item) const {
+    {
+        std::shared_lock lock(mutex_);
+        if (auto* indexed = queues_by_id_.find(queue); indexed && !indexed->is_deleted()) {
+            return indexed->read_next(current_item);
+        }
+    }
+    return readq_next(NameTable::instance().name(queue), current_item);
+}
+
+Result<void> TSQManager::deleteq(NameId queue) {
+    return deleteq(NameTable::instance().name(queue));
+}
+
+TemporaryStorageQueue* TSQManager::indexed_queue(NameId queue) const {
+    std::shared_lock lock(mutex_);
+    auto* indexed = queues_by_id_.find(queue);
+    return indexed && !indexed->is_deleted() ? indexed : nullptr;
+}
+
+void TSQManager::index_queue(NameId queue) {
+    // Only the id of the queue's own name is indexed, so that delete_queue
+    // can find the slot to clear from the name alone
+    const StringView queue_name = NameTable::instance().name(queue);
+    const String key = to_upper(String(queue_name));
+    if (key != queue_name) return;
+    
+    std::unique_lock lock(mutex_);
+    auto it = queues_.find(key);
+    if (it != queues_.end() && !it->second->is_deleted()) queues_by_id_.set(queue, it->second.get());
+}
+
 Size TSQManager::queue_count() const {
     std::shared_lock lock(mutex_);
     return queues_.size();
@@ -473,22 +569,44 @@ std::vector<String> TSQManager::list_queues() const {
             names.push_back(name);
         }
     }
+    if (shared_pool_) {
+        for (auto& name : shared_pool_->list_queues()) {
+            if (starts_with(name, shared_prefix_)) names.push_back(std::move(name));
+        }
+    }
     return names;
 }
 
 std::vector<String> TSQManager::list_queues_by_prefix(StringView prefix) const {
-    std::shared_lock lock(mutex_);
     String upper_prefix = to_upper(String(prefix));
     std::vector<String> names;
     
-    for (const auto& [name, queue] : queues_) {
-        if (!queue->is_deleted() && starts_with(name, upper_prefix)) {
-            names.push_back(name);
+    for (auto& name : list_queues()) {
+        if (starts_with(name, upper_prefix)) {
+            names.push_back(std::move(name));
         }
     }
     return names;
 }
 
+void TSQManager::set_shared_pool(SharedPtr<SharedTSPool> pool, StringView prefix) {
+    std::unique_lock lock(mutex_);
+    queues_by_id_.clear();
+    shared_pool_ = std::move(pool);
+    shared_prefix_ = to_upper(String(prefix));
+}
+
+SharedPtr<SharedTSPool> TSQManager::shared_pool() const {
+    std::shared_lock lock(mutex_);
+    return shared_pool_;
+}
+
+SharedPtr<SharedTSPool> TSQManager::pool_for(StringView queue_name) const {
+    std::shared_lock lock(mutex_);
+    if (!shared_pool_ || !starts_with(to_upper(String(queue_name)), shared_prefix_)) return nullptr;
+    return shared_pool_;
+}
+
 String TSQManager::get_statistics() const {
     std::shared_lock lock(mutex_);
     
@@ -511,6 +629,10 @@ String TSQManager::get_statistics() const {
     oss << "  Total Items: " << total_items << "\n"
         << "  Total Bytes: " << total_bytes;
     
+    if (shared_pool_) {
+        oss << "\n" << shared_pool_->statistics().to_string();
+    }
+    
     return oss.str();
 }
 
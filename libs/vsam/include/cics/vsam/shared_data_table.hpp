@@ -0,0 +1,185 @@
+#pragma once
+
+// =============================================================================
+// CICS Emulation - VSAM Shared Data Tables
+// =============================================================================
+
+#include "cics/vsam/vsam_types.hpp"
+#include <atomic>
+
+namespace cics::vsam {
+
+// =============================================================================
+// Shared Data Table
+// =============================================================================
+// A read-mostly KSDS held in memory in front of its source file. The whole
+// file is loaded at open into an immutable Table and published through an
+// atomic shared_ptr. Reads probe whichever Table is current without taking a
+// lock; a reader holding a Table keeps a consistent view until it lets go.
+// Browses, READ UPDATE and RBA access are passed to the source.
+//
+// A Table is a base (rows in key order, open-addressed hash slots) shared
+// by every Table until the next merge, plus the few records written since,
+// sorted by key. A write goes through to the source and publishes a Table
+// whose change list differs by that one record, so it copies only the list.
+// Once the list passes about the square root of the base's size it is
+// merged into a new base, which keeps a run of n writes near O(n * sqrt(n)).
+// Record bytes are appended to shared chunks; a merge repacks them once
+// dead bytes outweigh live ones.
+
+class SharedDataTable : public IVsamFile {
+public:
+    // Zero-copy view of one record; valid while its Table is held
+    struct Row {
+        ConstByteSpan key;
+        ConstByteSpan data;
+        RBA rba = 0;
+    };
+
+    class Table {
+    public:
+        [[nodiscard]] const Row* find(ConstByteSpan key) const;
+        [[nodiscard]] std::vector<Row> rows() const;  // Key order
+        [[nodiscard]] Size size() const { return size_; }
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+        [[nodiscard]] Size arena_bytes() const { return arena_bytes_; }
+        [[nodiscard]] Size pending_changes() const { return changes_.size(); }
+
+    private:
+        friend class SharedDataTable;
+
+        using Chunk = SharedPtr<const ByteBuffer>;
+
+        struct Slot {
+            UInt32 tag = 0;  // High hash bits, 0 = empty
+            UInt32 row = 0;
+        };
+
+        struct Base {
+            std::vector<Chunk> chunks;
+            std::vector<Row> rows;
+            std::vector<Slot> slots;
+
+            [[nodiscard]] const Row* find(ConstByteSpan key) const;
+            void build_slots();
+        };
+
+        // A record written since the base was built; erased hides a base row
+        struct Change {
+            Row row;
+            bool erased = false;
+        };
+
+        static UInt32 tag_of(UInt64 hash) { return static_cast<UInt32>(hash >> 32) | 1; }
+        [[nodiscard]] std::vector<Change>::const_iterator find_change(ConstByteSpan key) const;
+        void merge();   // Fold the changes into a new base
+        void pack(Base& base);  // Copy live rows into one chunk, dropping dead bytes
+
+        SharedPtr<const Base> base_ = make_shared<const Base>();
+        std::vector<Change> changes_;       // Key order
+        std::vector<Chunk> change_chunks_;  // Hold the bytes of changes_
+        Size size_ = 0;
+        Size arena_bytes_ = 0;  // Including bytes no row references any more
+        Size live_bytes_ = 0;
+    };
+    using TablePtr = SharedPtr<const Table>;
+
+    struct Statistics {
+        AtomicCounter<UInt64> hits;
+        AtomicCounter<UInt64> misses;
+        AtomicCounter<UInt64> loads;
+        AtomicCounter<UInt64> publishes;  // Tables swapped in by writes
+        AtomicCounter<UInt64> merges;     // Change lists folded into a new base
+        std::atomic<Int64> load_time_ns{0};
+
+        [[nodiscard]] double hit_ratio() const;
+        [[nodiscard]] String to_string() const;
+    };
+
+    explicit SharedDataTable(UniquePtr<IVsamFile> source);
+
+    // The current Table; lookups against it need no further synchronisation
+    [[nodiscard]] TablePtr table() const { return table_.load(std::memory_order_acquire); }
+
+    // Copy-free READ: calls fn(row) and returns true if the key is present
+    template<typename Fn>
+    bool lookup(ConstByteSpan key, Fn&& fn) const {
+        auto current = table();
+        const Row* row = current->find(key);
+        if (!row) { ++sdt_stats_.misses; return false; }
+        ++sdt_stats_.hits;
+        fn(*row);
+        return true;
+    }
+
+    // Rebuild the Table from the source, e.g. after the source changed
+    // behind the table's back
+    Result<void> reload();
+
+    [[nodiscard]] const Statistics& table_statistics() const { return sdt_stats_; }
+    [[nodiscard]] IVsamFile& source() { return *source_; }
+
+    // IVsamFile
+    Result<void> open(AccessMode mode, ProcessingMode proc = ProcessingMode::DYNAMIC) override;
+    Result<void> close() override;
+    [[nodiscard]] bool is_open() const override { return source_->is_open(); }
+
+    Result<VsamRecord> read(const VsamKey& key) override;
+    Result<VsamRecord> read_by_rba(RBA rba) override { return source_->read_by_rba(rba); }
+    Result<VsamRecord> read_by_rrn(RRN rrn) override { return source_->read_by_rrn(rrn); }
+    Result<void> write(const VsamRecord& record) override;
+    Result<void> update(const VsamRecord& record) override;
+    Result<void> erase(const VsamKey& key) override;
+
+    Result<LockedRecord> read_for_update(const VsamKey& key, const RecordLockOptions& options = {}) override;
+    Result<void> rewrite(UpdateToken token, const VsamRecord& record) override;
+    Result<void> erase(UpdateToken token) override;
+    Result<void> unlock(UpdateToken token) override;
+
+    Result<String> start_browse(const VsamKey& key, bool gteq = false, bool backward = false) override {
+        return source_->start_browse(key, gteq, backward);
+    }
+    Result<VsamRecord> read_next(const String& browse_id) override { return source_->read_next(browse_id); }
+    Result<VsamRecord> read_prev(const String& browse_id) override { return source_->read_prev(browse_id); }
+    Result<void> end_browse(const String& browse_id) override { return source_->end_browse(browse_id); }
+    Result<void> reset_browse(const String& browse_id, const VsamKey& key) override {
+        return source_->reset_browse(browse_id, key);
+    }
+    Result<BrowseBatchResult> read_next_batch(const String& browse_id, ByteSpan buffer,
+                                              std::span<BrowseBatchItem> items) override {
+        return source_->read_next_batch(browse_id, buffer, items);
+    }
+
+    [[nodiscard]] Result<KsdsIndex::Snapshot> snapshot() const override { return source_->snapshot(); }
+
+    [[nodiscard]] const VsamDefinition& definition() const override { return source_->definition(); }
+    [[nodiscard]] const VsamStatistics& statistics() const override { return source_->statistics(); }
+    [[nodiscard]] VsamType type() const override { return source_->type(); }
+    [[nodiscard]] UInt64 record_count() const override { return table()->size(); }
+
+private:
+    Result<void> load();
+
+    // Publish a copy of the current Table with key patched to whatever the
+    // source now holds. Re-reading the source under write_mutex_ means the
+    // last writer to publish always leaves the table matching the file.
+    void refresh(const VsamKey& key);
+    void forget_token(UpdateToken token);
+
+    // Copies a record's key and data to the end of the tail chunk
+    Row append(ConstByteSpan key, ConstByteSpan data, RBA rba);
+
+    UniquePtr<IVsamFile> source_;
+    std::atomic<TablePtr> table_;
+    std::mutex write_mutex_;  // Serialises loads and publishes; never held across a source write
+    SharedPtr<ByteBuffer> tail_chunk_;  // Filled by append(); bytes before tail_used_ are never touched again
+    Size tail_used_ = 0;
+    std::unordered_map<UpdateToken, VsamKey> tokens_;  // READ UPDATE keys, for DELETE by token
+    std::mutex token_mutex_;
+    mutable Statistics sdt_stats_;
+};
+
+// Open-ready shared data table over a new KSDS built from def
+[[nodiscard]] UniquePtr<SharedDataTable> create_shared_data_table(const VsamDefinition& def, const Path& path);
+
+} // namespace cics::vsam
@@ -9,6 +9,8 @@
 #include "cics/common/error.hpp"
 #include <map>
 #include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
 #include <compare>
 #include <cstring>
 
@@ -21,11 +23,14 @@ namespace cics::vsam {
 constexpr Size MIN_CI_SIZE = 512;
 constexpr Size MAX_CI_SIZE = 32768;
 constexpr Size DEFAULT_CI_SIZE = 4096;
+constexpr Size DEFAULT_INDEX_CI_SIZE = 2048;
 constexpr Size MAX_KEY_LENGTH = 255;
 constexpr Size MAX_RECORD_LENGTH = 32760;
 constexpr Size DEFAULT_BUFFERS = 4;
 constexpr UInt8 DEFAULT_FREE_CI_PERCENT = 10;
 constexpr UInt8 DEFAULT_FREE_CA_PERCENT = 10;
+constexpr Size CIDF_LENGTH = 4;     // CI definition field: free-space offset and length
+constexpr Size RDF_LENGTH = 3;      // Record definition field: one per record
 
 // =============================================================================
 // VSAM File Types
@@ -330,6 +335,7 @@ struct VsamDefinition {
     
     // Space parameters
     UInt16 ci_size = DEFAULT_CI_SIZE;
+    UInt16 index_ci_size = DEFAULT_INDEX_CI_SIZE;
     UInt16 ca_size = 1;  // Number of CIs per CA
     UInt8 free_ci_percent = DEFAULT_FREE_CI_PERCENT;
     UInt8 free_ca_percent = DEFAULT_FREE_CA_PERCENT;
@@ -376,12 +382,22 @@ struct VsamStatistics {
     UInt32 ca_count = 0;
     AtomicCounter<> ci_splits;
     AtomicCounter<> ca_splits;
+    AtomicCounter<> snapshot_ci_copies;  // CIs copied because a browse still shared them
+    AtomicCounter<> ci_reclaims;         // Data CIs freed by deletes or reorganisation
+    AtomicCounter<> reorg_passes;
+    UInt32 spanned_records = 0;
     
     // Index statistics (KSDS)
     UInt32 index_levels = 0;
     UInt32 index_records = 0;
     UInt64 index_bytes = 0;
     
+    // Front-key compression (KSDS): full key bytes vs bytes actually stored
+    UInt64 data_key_bytes_raw = 0;
+    UInt64 data_key_bytes_stored = 0;
+    UInt64 index_key_bytes_raw = 0;
+    UInt64 index_key_bytes_stored = 0;
+    
     // I/O statistics
     AtomicCounter<UInt64> reads;
     AtomicCounter<UInt64> writes;
@@ -403,17 +419,332 @@ struct VsamStatistics {
     VsamStatistics();
     
     void record_read(Duration time);
+    void record_reads(UInt64 count, Duration time);  // A batch, timed as a whole
     void record_write(Duration time, Size bytes);
     void record_delete();
     void record_update(Duration time);
     
     [[nodiscard]] double space_utilization() const;
+    [[nodiscard]] double key_compression_ratio() const;  // stored / raw, 0 if empty
     [[nodiscard]] double average_io_time_us() const;
     [[nodiscard]] double io_per_second() const;
     [[nodiscard]] String to_string() const;
     [[nodiscard]] String to_json() const;
 };
 
+// =============================================================================
+// Key-Compressed Block
+// =============================================================================
+// Sorted run of (key, value) entries with front-key compression: each key is
+// stored as the length of the prefix it shares with the previous key plus
+// the remaining suffix. Restart points store the key in full so seek() can
+// binary-search them and then scan a short run. Entries are inserted and
+// removed in place, shifting the rest of the CI as VSAM does, so only the
+// neighbouring entry is ever re-encoded. Used for KSDS data and index CIs.
+//
+// Entry layout: [shared:1][unshared:1][value_len:varint][suffix][value]
+
+[[nodiscard]] int compare_keys(ConstByteSpan a, ConstByteSpan b) noexcept;
+
+class KeyBlock {
+public:
+    static constexpr UInt32 RESTART_INTERVAL = 16;
+    
+    class Builder;
+    
+    class Iterator {
+    public:
+        Iterator() = default;
+        explicit Iterator(const KeyBlock* block) : block_(block) {}
+        
+        [[nodiscard]] bool valid() const { return block_ && index_ < block_->count_; }
+        [[nodiscard]] UInt32 index() const { return index_; }
+        [[nodiscard]] ConstByteSpan key() const { return {key_.data(), key_length_}; }
+        [[nodiscard]] ConstByteSpan value() const {
+            return {block_->bytes_.data() + value_offset_, value_length_};
+        }
+        
+        void seek_to_first();
+        void seek_to_last();
+        void seek(ConstByteSpan target);  // first entry with key >= target
+        void next();
+        void prev();
+        
+    private:
+        friend class KeyBlock;
+        
+        void seek_to_restart(UInt32 restart);
+        void decode_next();
+        
+        const KeyBlock* block_ = nullptr;
+        UInt32 index_ = UINT32_MAX;
+        UInt32 offset_ = 0;       // start of the current entry
+        UInt32 next_offset_ = 0;
+        UInt32 value_offset_ = 0;
+        UInt32 value_length_ = 0;
+        UInt32 key_length_ = 0;
+        std::array<Byte, MAX_KEY_LENGTH> key_;
+    };
+    
+    // In-place edits. insert() returns the new entry's index, or nullopt on a
+    // duplicate; erase()/replace() return false when the key is absent.
+    Optional<UInt32> insert(ConstByteSpan key, ConstByteSpan value);
+    bool erase(ConstByteSpan key);
+    bool replace(ConstByteSpan key, ConstByteSpan value);
+    
+    // Moves entries [at, count) into the returned block
+    [[nodiscard]] KeyBlock split(UInt32 at);
+    
+    [[nodiscard]] UInt32 count() const { return count_; }
+    [[nodiscard]] bool empty() const { return count_ == 0; }
+    [[nodiscard]] Size size_bytes() const { return bytes_.size() + restarts_.size() * sizeof(UInt32); }
+    [[nodiscard]] Size encoded_bytes() const { return bytes_.size(); }  // Entries only, as held in the CI
+    [[nodiscard]] UInt64 raw_key_bytes() const { return raw_key_bytes_; }
+    [[nodiscard]] UInt64 stored_key_bytes() const { return stored_key_bytes_; }
+    [[nodiscard]] Size value_bytes() const { return value_bytes_; }
+    [[nodiscard]] ConstByteSpan first_key() const;
+    [[nodiscard]] ByteBuffer key_at(UInt32 index) const;
+    [[nodiscard]] ByteBuffer last_key() const;
+    
+private:
+    struct Restart {
+        UInt32 offset;
+        UInt32 index;
+    };
+    
+    // First entry with key >= the searched key, in restart run `restart`;
+    // locate() leaves that entry's key in `current` and its predecessor's in
+    // `previous` (meaningful only when the entry is not a restart point)
+    struct Position {
+        UInt32 restart;
+        UInt32 offset;
+        UInt32 index;
+        UInt32 length;  // 0 past the last entry
+        bool found;
+    };
+    
+    [[nodiscard]] Position locate(ConstByteSpan key, ByteBuffer& previous, ByteBuffer& current) const;
+    [[nodiscard]] UInt32 run_length(UInt32 restart) const;
+    void splice(UInt32 offset, UInt32 length, const ByteBuffer& replacement);
+    void shift_restarts(UInt32 from, Int64 delta, int index_delta);
+    
+    ByteBuffer bytes_;
+    std::vector<Restart> restarts_;
+    UInt32 count_ = 0;
+    UInt64 raw_key_bytes_ = 0;
+    UInt64 stored_key_bytes_ = 0;
+    Size value_bytes_ = 0;
+};
+
+class KeyBlock::Builder {
+public:
+    // Keys must be added in strictly ascending order
+    void add(ConstByteSpan key, ConstByteSpan value);
+    [[nodiscard]] Size size_bytes() const { return block_.size_bytes(); }
+    [[nodiscard]] Size encoded_bytes() const { return block_.encoded_bytes(); }
+    [[nodiscard]] UInt32 count() const { return block_.count_; }
+    [[nodiscard]] KeyBlock finish();
+    
+private:
+    KeyBlock block_;
+    ByteBuffer last_key_;
+};
+
+// =============================================================================
+// KSDS Index
+// =============================================================================
+// B+ tree over key-compressed CIs. Leaves are data CIs holding the records
+// (the key lives only in the compressed entry, never duplicated in a separate
+// map key); index CIs hold the low key of each child, so appending past the
+// current high key touches only the last data CI. The root is always an
+// index CI, so a populated cluster has at least one index level (the
+// sequence set).
+//
+// Data CI occupancy is counted as VSAM lays a CI out: the entries, one RDF
+// per record and the CIDF. Inserts split a CI that overflows; an append past
+// a CI's high key (a sequential load) splits once the CI reaches its
+// FREESPACE load, so later inserts find room. A record too long for one CI
+// is spanned: it has a data CI to itself and occupies as many CI segments as
+// its length needs. Data CIs that empty out are freed, and an underfull CI
+// left by a delete is merged into a sibling under the same index CI when the
+// two fit together. reorganize() repacks a range of data CIs to the load
+// target in bounded steps so an online reorganiser can interleave with
+// requests.
+//
+// CIs are shared between the live tree and any Snapshot taken from it. A
+// writer changes a CI in place only while it is reachable from the live tree
+// alone; a CI a snapshot still holds is copied first, so snapshot readers
+// never need the writer's lock. Old versions are reclaimed by reference count
+// when the last snapshot or cursor holding them is dropped.
+
+class KsdsIndex {
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<Node>;
+    using ConstNodePtr = std::shared_ptr<const Node>;
+    
+public:
+    struct Layout {
+        UInt32 index_levels = 0;
+        UInt32 index_cis = 0;
+        UInt64 index_bytes = 0;
+        UInt32 data_cis = 0;            // CI segments, counting each spanned record's run
+        UInt64 data_bytes = 0;          // Occupied, including RDFs and CIDFs
+        UInt32 spanned_records = 0;
+        UInt64 data_key_bytes_raw = 0;
+        UInt64 data_key_bytes_stored = 0;
+        UInt64 index_key_bytes_raw = 0;
+        UInt64 index_key_bytes_stored = 0;
+    };
+    
+    class Cursor {
+    public:
+        [[nodiscard]] bool valid() const { return leaf_ != nullptr && it_.valid(); }
+        void next();
+        void prev();
+        
+        [[nodiscard]] ConstByteSpan key() const { return it_.key(); }
+        [[nodiscard]] RBA rba() const;
+        [[nodiscard]] ConstByteSpan data() const;
+        [[nodiscard]] VsamRecord record() const;
+        
+    private:
+        friend class KsdsIndex;
+        struct Level {
+            ConstNodePtr node;
+            UInt32 index;
+        };
+        
+        void descend(bool leftmost);
+        bool step_leaf(bool forward);
+        
+        std::vector<Level> path_;  // index CIs, root first
+        ConstNodePtr leaf_;
+        KeyBlock::Iterator it_;
+    };
+    
+    // Point-in-time view; safe to read concurrently with writers
+    class Snapshot {
+    public:
+        Snapshot() = default;
+        
+        [[nodiscard]] bool valid() const { return root_ != nullptr; }
+        [[nodiscard]] UInt64 size() const { return size_; }
+        [[nodiscard]] Cursor first() const { return KsdsIndex::first(root_); }
+        [[nodiscard]] Cursor last() const { return KsdsIndex::last(root_); }
+        [[nodiscard]] Cursor lower_bound(ConstByteSpan key) const { return KsdsIndex::seek(root_, key); }
+        [[nodiscard]] Cursor upper_bound(ConstByteSpan key) const { return KsdsIndex::upper_bound(root_, key); }
+        
+    private:
+        friend class KsdsIndex;
+        Snapshot(ConstNodePtr root, UInt64 size) : root_(std::move(root)), size_(size) {}
+        
+        ConstNodePtr root_;
+        UInt64 size_ = 0;
+    };
+    
+    // Point lookups presented in ascending key order. Each probe searches
+    // the data CI the previous one ended in first and descends from the root
+    // only once the key lies past that CI's high key, so a sorted batch costs
+    // about one descent per data CI touched rather than one per key.
+    class SortedProbe {
+    public:
+        explicit SortedProbe(const Snapshot& snapshot) : root_(snapshot.root_) {}
+        
+        // True if the key is present; rba() and data() then describe it
+        [[nodiscard]] bool find(ConstByteSpan key);
+        [[nodiscard]] RBA rba() const;
+        [[nodiscard]] ConstByteSpan data() const;
+        [[nodiscard]] UInt64 descents() const { return descents_; }
+        
+    private:
+        ConstNodePtr root_;
+        const Node* leaf_ = nullptr;
+        KeyBlock::Iterator it_;
+        UInt64 descents_ = 0;
+    };
+    
+    KsdsIndex(UInt32 data_ci_size, UInt32 index_ci_size, UInt8 free_ci_percent = 0);
+    
+    // Record operations; return false on duplicate / not found
+    bool insert(ConstByteSpan key, ConstByteSpan data, RBA rba);
+    bool replace(ConstByteSpan key, ConstByteSpan data);
+    bool erase(ConstByteSpan key);
+    void clear();
+    
+    [[nodiscard]] Optional<VsamRecord> find(ConstByteSpan key) const;
+    [[nodiscard]] bool contains(ConstByteSpan key) const;
+    
+    // True if a record this long cannot share a data CI and must be spanned
+    [[nodiscard]] bool needs_spanning(Size key_length, Size data_length) const;
+    
+    // One step of an online reorganisation: repacks at most max_cis data CIs,
+    // starting at the one holding `resume`, toward the FREESPACE load.
+    // `resume` is advanced to where the next step starts and left empty once
+    // the pass reaches the end. Returns the number of data CIs freed.
+    UInt32 reorganize(ByteBuffer& resume, UInt32 max_cis);
+    
+    [[nodiscard]] Cursor first() const;
+    [[nodiscard]] Cursor last() const;
+    [[nodiscard]] Cursor lower_bound(ConstByteSpan key) const;  // first >= key
+    [[nodiscard]] Cursor upper_bound(ConstByteSpan key) const;  // first > key
+    
+    // Caller must exclude writers while taking the snapshot, not while using it
+    [[nodiscard]] Snapshot snapshot() const { return Snapshot(root_, size_); }
+    
+    [[nodiscard]] UInt64 size() const { return size_; }
+    [[nodiscard]] const Layout& layout() const { return layout_; }
+    [[nodiscard]] UInt64 ci_splits() const { return ci_splits_; }
+    [[nodiscard]] UInt64 ca_splits() const { return ca_splits_; }
+    [[nodiscard]] UInt64 snapshot_copies() const { return snapshot_copies_; }
+    [[nodiscard]] UInt64 ci_reclaims() const { return ci_reclaims_; }
+    
+private:
+    struct Node {
+        bool leaf = true;
+        KeyBlock block;
+        std::vector<NodePtr> children;  // index CIs only, one per entry
+    };
+    
+    struct Step {
+        Node* node;
+        UInt32 slot;
+    };
+    using Path = std::vector<Step>;
+    
+    [[nodiscard]] static UInt32 route(const Node& node, ConstByteSpan key);
+    [[nodiscard]] static ByteBuffer encode_value(RBA rba, ConstByteSpan data);
+    [[nodiscard]] static Cursor first(const ConstNodePtr& root);
+    [[nodiscard]] static Cursor last(const ConstNodePtr& root);
+    [[nodiscard]] static Cursor seek(const ConstNodePtr& root, ConstByteSpan key);
+    [[nodiscard]] static Cursor upper_bound(const ConstNodePtr& root, ConstByteSpan key);
+    [[nodiscard]] const Node* find_leaf(ConstByteSpan key) const;
+    [[nodiscard]] Node* writable(NodePtr& node);
+    [[nodiscard]] Node* descend(ConstByteSpan key, Path& path, bool lower_low_keys);
+    [[nodiscard]] static Size occupancy(const KeyBlock& block);
+    [[nodiscard]] static Size occupancy(const KeyBlock::Builder& builder);
+    [[nodiscard]] bool spanned(const Node& node) const;
+    [[nodiscard]] UInt32 segments(const Node& node) const;
+    void split(Path& path, Node* node, UInt32 at);
+    void isolate(ConstByteSpan key);
+    bool pack(Node& parent, UInt32 slot, Size target);
+    void reclaim(Path& path, Node* leaf);
+    void unlink(Path& path);
+    void collapse_root();
+    void account(const Node& node, int sign);
+    
+    UInt32 data_ci_size_;
+    UInt32 index_ci_size_;
+    UInt32 load_limit_;             // Data CI occupancy a sequential load stops at
+    NodePtr root_;
+    UInt64 size_ = 0;
+    UInt64 ci_splits_ = 0;
+    UInt64 ca_splits_ = 0;
+    UInt64 snapshot_copies_ = 0;
+    UInt64 ci_reclaims_ = 0;
+    Layout layout_;
+};
+
 // =============================================================================
 // Browse Context
 // =============================================================================
@@ -447,7 +778,7 @@ public:
     void set_backward(bool backward) { backward_ = backward; }
     void set_at_start(bool at_start) { at_start_ = at_start; }
     void set_at_end(bool at_end) { at_end_ = at_end; }
-    void increment_records() { ++records_read_; }
+    void increment_records(UInt64 count = 1) { records_read_ += count; }
     void reset();
 };
 
@@ -498,10 +829,155 @@ struct VsamResponse {
     [[nodiscard]] bool not_found() const { return return_code == VsamRC::RECORD_NOT_FOUND; }
 };
 
+// =============================================================================
+// Record Locking
+// =============================================================================
+// Record locks for READ UPDATE, keyed by (file, key) and spread over striped
+// tables so updaters of different records rarely touch the same mutex. An
+// owner is a task: each thread is its own owner unless the dispatcher sets
+// one, so locks follow the task rather than the thread. Waits honour a
+// timeout (DTIMOUT) and a wait-for check that fails the request that would
+// close a cycle. Locks still held at SYNCPOINT or ROLLBACK are released by a
+// recovery resource registered with the owner's unit of work.
+//
+// The wait-for graph holds record locks only. A cycle that runs through an
+// ENQ (one task holds the ENQ and waits on a record, the other the reverse)
+// is not seen here; it ends when the record lock wait times out, which is
+// why the default timeout is finite.
+
+using LockOwner = UInt64;
+using UpdateToken = UInt64;
+constexpr UpdateToken INVALID_UPDATE_TOKEN = 0;
+
+struct RecordLockOptions {
+    bool wait = true;             // false = NOSUSPEND
+    Milliseconds timeout{0};      // 0 = the table's default
+};
+
+class RecordLockTable {
+public:
+    static constexpr Size STRIPES = 64;
+    static constexpr Milliseconds DEFAULT_TIMEOUT{30000};
+    
+    struct Statistics {
+        AtomicCounter<UInt64> acquires;
+        AtomicCounter<UInt64> waits;
+        AtomicCounter<UInt64> busy;
+        AtomicCounter<UInt64> timeouts;
+        AtomicCounter<UInt64> deadlocks;
+    };
+    
+    static RecordLockTable& instance();
+    
+    static void set_current_owner(LockOwner owner);  // 0 = back to the thread's own
+    [[nodiscard]] static LockOwner current_owner();
+    
+    // true if newly locked, false if the owner already held it
+    Result<bool> acquire(StringView file, ConstByteSpan key, LockOwner owner,
+                         const RecordLockOptions& options = {});
+    bool release(StringView file, ConstByteSpan key, LockOwner owner);
+    UInt32 release_all(LockOwner owner);
+    
+    // Release the owner's locks when its current unit of work ends; false
+    // if there is no unit of work to hand them to
+    bool release_at_syncpoint(LockOwner owner);
+    
+    [[nodiscard]] bool is_locked(StringView file, ConstByteSpan key) const;
+    [[nodiscard]] UInt32 held_count(LockOwner owner) const;
+    
+    // A wait that runs out fails with VSAM_RECORD_BUSY; 0 waits forever
+    void set_default_timeout(Milliseconds timeout) { default_timeout_ms_.store(timeout.count()); }
+    [[nodiscard]] const Statistics& statistics() const { return stats_; }
+    
+private:
+    RecordLockTable() = default;
+    
+    struct Entry {
+        LockOwner owner = 0;
+        UInt32 waiters = 0;
+    };
+    
+    struct Stripe {
+        std::mutex mutex;
+        std::condition_variable released;
+        std::unordered_map<String, Entry> locks;
+    };
+    
+    struct OwnerStripe {
+        std::mutex mutex;
+        std::unordered_map<LockOwner, std::vector<String>> held;
+    };
+    
+    [[nodiscard]] static String lock_name(StringView file, ConstByteSpan key);
+    [[nodiscard]] Stripe& stripe_for(const String& name) const;
+    [[nodiscard]] OwnerStripe& owner_stripe(LockOwner owner) const;
+    [[nodiscard]] bool closes_cycle(LockOwner waiter, LockOwner holder) const;
+    bool unlock(const String& name, LockOwner owner);
+    void forget(LockOwner owner, const String& name);
+    
+    mutable std::array<Stripe, STRIPES> stripes_;
+    mutable std::array<OwnerStripe, STRIPES> owners_;
+    std::mutex wait_mutex_;
+    std::unordered_map<LockOwner, LockOwner> waits_for_;  // waiter -> holder
+    std::atomic<Int64> default_timeout_ms_{DEFAULT_TIMEOUT.count()};
+    Statistics stats_;
+};
+
 // =============================================================================
 // VSAM File Interface
 // =============================================================================
 
+struct ReorgOptions {
+    UInt32 cis_per_step = 16;               // Data CIs repacked per hold of the file lock
+    Milliseconds step_pause{1};             // Between steps, so requests get the lock
+    double trigger_utilization = 70.0;      // Background: run when data CIs are less full (%)
+    Milliseconds check_interval{5000};      // Background: how often to look
+};
+
+struct ReorgResult {
+    UInt32 steps = 0;
+    UInt32 cis_freed = 0;
+    double utilization_before = 0.0;        // Data CI occupancy, percent
+    double utilization_after = 0.0;
+};
+
+// One key of a READ multiple. The record is copied into the caller's
+// buffer; one longer than the buffer is truncated and reports its length.
+struct BatchReadItem {
+    ByteSpan into;
+    UInt32 length = 0;
+    RBA rba = INVALID_RBA;
+    ErrorCode status = ErrorCode::SUCCESS;  // VSAM_RECORD_NOT_FOUND, BUFFER_OVERFLOW
+};
+
+struct BatchReadOptions {
+    Size keys_per_thread = 8192;            // Smaller batches run on the caller's thread
+    UInt32 max_threads = 0;                 // 0: hardware concurrency
+};
+
+struct BatchReadResult {
+    UInt64 found = 0;
+    UInt64 not_found = 0;
+    UInt64 truncated = 0;
+    UInt64 descents = 0;                    // Index descents; clustered keys share one
+    UInt32 threads = 1;
+};
+
+// One record of a READNEXT batch: its key then its data, packed into the
+// caller's buffer at `offset`
+struct BrowseBatchItem {
+    UInt32 offset = 0;
+    UInt32 key_length = 0;
+    UInt32 length = 0;                      // Data, after the key
+    RBA rba = INVALID_RBA;
+};
+
+struct BrowseBatchResult {
+    UInt32 records = 0;
+    Size bytes = 0;                         // Of the buffer used
+    bool end_of_file = false;               // The browse reached the end
+};
+
 class IVsamFile {
 public:
     virtual ~IVsamFile() = default;
@@ -519,6 +995,22 @@ public:
     virtual Result<void> update(const VsamRecord& record) = 0;
     virtual Result<void> erase(const VsamKey& key) = 0;
     
+    // READ multiple: keys[i] fills items[i]. The default reads key by key;
+    // KSDS sorts the keys and probes one snapshot, taking the file lock once
+    virtual Result<BatchReadResult> read_batch(std::span<const VsamKey> keys, std::span<BatchReadItem> items,
+                                               const BatchReadOptions& options = {});
+    
+    // READ UPDATE locks the record for RecordLockTable::current_owner() and
+    // returns the token that REWRITE, DELETE or UNLOCK must present
+    struct LockedRecord {
+        VsamRecord record;
+        UpdateToken token = INVALID_UPDATE_TOKEN;
+    };
+    virtual Result<LockedRecord> read_for_update(const VsamKey& key, const RecordLockOptions& options = {}) = 0;
+    virtual Result<void> rewrite(UpdateToken token, const VsamRecord& record) = 0;
+    virtual Result<void> erase(UpdateToken token) = 0;
+    virtual Result<void> unlock(UpdateToken token) = 0;
+    
     // Browse operations
     virtual Result<String> start_browse(const VsamKey& key, bool gteq = false, bool backward = false) = 0;
     virtual Result<VsamRecord> read_next(const String& browse_id) = 0;
@@ -526,6 +1018,23 @@ public:
     virtual Result<void> end_browse(const String& browse_id) = 0;
     virtual Result<void> reset_browse(const String& browse_id, const VsamKey& key) = 0;
     
+    // READNEXT until `items` or `buffer` is full, from where read_next would
+    // continue. A record that does not fit is left for the next call; one
+    // larger than the whole buffer fails with BUFFER_OVERFLOW. The default
+    // calls read_next per record; KSDS copies straight from its cursor
+    virtual Result<BrowseBatchResult> read_next_batch(const String& browse_id, ByteSpan buffer,
+                                                      std::span<BrowseBatchItem> items);
+    
+    // Point-in-time view of every record for bulk readers (table loads,
+    // unloads); it never blocks writers
+    [[nodiscard]] virtual Result<KsdsIndex::Snapshot> snapshot() const = 0;
+    
+    // Online reorganisation: repack underfull data CIs while the file stays
+    // open, a few CIs per step with requests running in between
+    virtual Result<ReorgResult> reorganize(const ReorgOptions& options = {});
+    virtual Result<void> start_background_reorg(const ReorgOptions& options = {});
+    virtual void stop_background_reorg() {}
+    
     // Information
     [[nodiscard]] virtual const VsamDefinition& definition() const = 0;
     [[nodiscard]] virtual const VsamStatistics& statistics() const = 0;
@@ -1,23 +1,102 @@
 #include "cics/vsam/vsam_types.hpp"
+#include <cics/syncpoint/syncpoint.hpp>
+#include <cics/common/task_context.hpp>
+#include <algorithm>
+#include <condition_variable>
 #include <map>
+#include <numeric>
+#include <thread>
 
 namespace cics::vsam {
 
+namespace {
+
+void fill_item(BatchReadItem& item, ConstByteSpan data, RBA rba, BatchReadResult& result) {
+    const Size copied = std::min(data.size(), item.into.size());
+    if (copied > 0) std::memcpy(item.into.data(), data.data(), copied);
+    item.length = static_cast<UInt32>(data.size());
+    item.rba = rba;
+    item.status = copied < data.size() ? ErrorCode::BUFFER_OVERFLOW : ErrorCode::SUCCESS;
+    if (copied < data.size()) ++result.truncated;
+    ++result.found;
+}
+
+void miss_item(BatchReadItem& item, BatchReadResult& result) {
+    item.length = 0;
+    item.rba = INVALID_RBA;
+    item.status = ErrorCode::VSAM_RECORD_NOT_FOUND;
+    ++result.not_found;
+}
+
+// False, leaving the item alone, if the record does not fit after `used`
+bool pack_record(ByteSpan buffer, Size& used, ConstByteSpan key, ConstByteSpan data, RBA rba,
+                 BrowseBatchItem& item) {
+    if (key.size() + data.size() > buffer.size() - used) return false;
+    item.offset = static_cast<UInt32>(used);
+    item.key_length = static_cast<UInt32>(key.size());
+    item.length = static_cast<UInt32>(data.size());
+    item.rba = rba;
+    if (!key.empty()) std::memcpy(buffer.data() + used, key.data(), key.size());
+    used += key.size();
+    if (!data.empty()) std::memcpy(buffer.data() + used, data.data(), data.size());
+    used += data.size();
+    return true;
+}
+
+} // namespace
+
 class KsdsFile : public IVsamFile {
 private:
     VsamDefinition def_;
     VsamStatistics stats_;
-    std::map<VsamKey, VsamRecord> records_;  // Sorted by key
-    std::unordered_map<String, BrowseContext> browse_contexts_;
+    KsdsIndex index_;  // Key-compressed data and index CIs
     mutable std::shared_mutex mutex_;
+    
+    // A browse reads the snapshot taken at STARTBR/RESETBR, never the live
+    // index, so it holds no file lock and writers never wait on it
+    struct Browse {
+        BrowseContext ctx;
+        KsdsIndex::Snapshot snapshot;
+        KsdsIndex::Cursor cursor;  // On ctx.current_key() within snapshot
+        std::mutex mutex;
+    };
+    std::unordered_map<String, SharedPtr<Browse>> browses_;
+    mutable std::mutex browse_mutex_;  // Guards browses_ only
+    
+    // Records held by READ UPDATE, by the token handed back to the caller.
+    // Shared with the unit-of-work resource that drops a task's tokens when
+    // SYNCPOINT releases its locks, which can outlive the file.
+    struct HeldRecord {
+        VsamKey key;
+        LockOwner owner = 0;
+        bool until_syncpoint = false;  // Unit of work releases the lock
+    };
+    struct HeldRecords {
+        std::mutex mutex;
+        std::unordered_map<UpdateToken, HeldRecord> records;
+    };
+    SharedPtr<HeldRecords> held_ = make_shared<HeldRecords>();
+    static constexpr Milliseconds TRANSIENT_LOCK_TIMEOUT{500};  // Unkeyed UPDATE/DELETE
+    std::atomic<UpdateToken> next_token_{INVALID_UPDATE_TOKEN};
     AccessMode access_mode_ = AccessMode::INPUT;
     ProcessingMode proc_mode_ = ProcessingMode::DYNAMIC;
     bool open_ = false;
     RBA next_rba_ = 0;
     
+    // Background reorganiser
+    std::thread reorg_thread_;
+    std::mutex reorg_mutex_;
+    std::condition_variable reorg_cv_;
+    std::atomic<bool> reorg_stop_{false};
+    
 public:
-    explicit KsdsFile(VsamDefinition def) : def_(std::move(def)) {
-        stats_.allocated_bytes = def_.ci_size * def_.ca_size * 100;
+    explicit KsdsFile(VsamDefinition def)
+        : def_(std::move(def)), index_(def_.ci_size, def_.index_ci_size, def_.free_ci_percent) {
+        sync_layout();
+    }
+    
+    ~KsdsFile() override {
+        stop_background_reorg();
     }
     
     Result<void> open(AccessMode mode, ProcessingMode proc) override {
@@ -30,8 +109,13 @@ public:
     }
     
     Result<void> close() override {
+        stop_background_reorg();
         std::unique_lock lock(mutex_);
-        browse_contexts_.clear();
+        {
+            std::lock_guard browse_lock(browse_mutex_);
+            browses_.clear();
+        }
+        release_held();
         open_ = false;
         return make_success();
     }
@@ -44,19 +128,78 @@ public:
         
         if (!open_) return make_error<VsamRecord>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
         
-        auto it = records_.find(key);
-        if (it == records_.end()) {
+        auto rec = index_.find(key.span());
+        if (!rec) {
             return make_error<VsamRecord>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
         }
         
         stats_.record_read(Clock::now() - start);
-        return make_success(it->second);
+        note_request(RequestType::FILE_READ, rec->length());
+        return make_success(std::move(*rec));
+    }
+    
+    Result<BatchReadResult> read_batch(std::span<const VsamKey> keys, std::span<BatchReadItem> items,
+                                       const BatchReadOptions& options) override {
+        auto start = Clock::now();
+        if (keys.size() != items.size()) {
+            return make_error<BatchReadResult>(ErrorCode::INVALID_ARGUMENT, "One item is needed per key");
+        }
+        
+        // The whole batch reads one point in time and holds no lock while it runs
+        KsdsIndex::Snapshot snapshot;
+        {
+            std::shared_lock lock(mutex_);
+            if (!open_) return make_error<BatchReadResult>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+            snapshot = index_.snapshot();
+        }
+        
+        std::vector<UInt32> order(keys.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [keys](UInt32 a, UInt32 b) {
+            return compare_keys(keys[a].span(), keys[b].span()) < 0;
+        });
+        
+        // Each thread takes a contiguous run of the sorted keys, so runs
+        // rarely share data CIs and each keeps its own CI hot
+        const Size per_thread = std::max<Size>(options.keys_per_thread, 1);
+        const Size hardware = options.max_threads > 0 ? options.max_threads
+                                                      : std::max(std::thread::hardware_concurrency(), 1u);
+        const Size threads = std::clamp<Size>((order.size() + per_thread - 1) / per_thread, 1, hardware);
+        const Size chunk = (order.size() + threads - 1) / threads;
+        
+        std::vector<BatchReadResult> partial(threads);
+        auto run = [&](Size t) {
+            const Size begin = std::min(t * chunk, order.size());
+            const Size end = std::min(begin + chunk, order.size());
+            probe_sorted(snapshot, keys, items, std::span<const UInt32>(order).subspan(begin, end - begin), partial[t]);
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (Size t = 1; t < threads; ++t) workers.emplace_back(run, t);
+        run(0);
+        for (auto& worker : workers) worker.join();
+        
+        BatchReadResult result;
+        result.threads = static_cast<UInt32>(threads);
+        for (const auto& part : partial) {
+            result.found += part.found;
+            result.not_found += part.not_found;
+            result.truncated += part.truncated;
+            result.descents += part.descents;
+        }
+        stats_.record_reads(result.found, Clock::now() - start);
+        UInt64 bytes = 0;
+        for (const auto& item : items) {
+            if (item.status != ErrorCode::VSAM_RECORD_NOT_FOUND) bytes += item.length;
+        }
+        note_request(RequestType::FILE_READ, bytes, static_cast<UInt32>(result.found));
+        return make_success(result);
     }
     
     Result<VsamRecord> read_by_rba(RBA rba) override {
         std::shared_lock lock(mutex_);
-        for (const auto& [k, rec] : records_) {
-            if (rec.rba() == rba) return make_success(rec);
+        for (auto cursor = index_.first(); cursor.valid(); cursor.next()) {
+            if (cursor.rba() == rba) return make_success(cursor.record());
         }
         return make_error<VsamRecord>(ErrorCode::VSAM_RBA_NOT_FOUND, "RBA not found");
     }
@@ -74,154 +217,606 @@ public:
             return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST, "File open for input");
         }
         
-        if (records_.contains(record.key())) {
-            return make_error<void>(ErrorCode::VSAM_DUPLICATE_KEY, "Duplicate key");
+        if (record.key().length() > MAX_KEY_LENGTH) {
+            return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST, "Key too long");
         }
+        if (auto fits = check_length(record); !fits) return fits;
         
-        VsamRecord new_rec = record;
-        VsamAddress addr;
-        addr.rba = next_rba_;
+        if (!index_.insert(record.key().span(), record.span(), next_rba_)) {
+            return make_error<void>(ErrorCode::VSAM_DUPLICATE_KEY, "Duplicate key");
+        }
         next_rba_ += record.length() + def_.key_length;
-        new_rec.set_address(addr);
         
-        records_[record.key()] = std::move(new_rec);
         stats_.record_count++;
         stats_.record_write(Clock::now() - start, record.length());
+        sync_layout();
+        note_request(RequestType::FILE_WRITE, record.length());
         
         return make_success();
     }
     
     Result<void> update(const VsamRecord& record) override {
+        // An unkeyed update still waits out another task's READ UPDATE,
+        // briefly; one on a record this task holds goes straight through
+        auto guard = lock_transient(record.key());
+        if (!guard) return make_error<void>(guard.error());
+        auto result = replace_record(record);
+        release_transient(record.key(), guard.value());
+        return result;
+    }
+    
+    Result<void> erase(const VsamKey& key) override {
+        auto guard = lock_transient(key);
+        if (!guard) return make_error<void>(guard.error());
+        auto result = erase_record(key);
+        release_transient(key, guard.value());
+        return result;
+    }
+    
+    Result<LockedRecord> read_for_update(const VsamKey& key, const RecordLockOptions& options) override {
         auto start = Clock::now();
-        std::unique_lock lock(mutex_);
-        
-        if (!open_) return make_error<void>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+        {
+            std::shared_lock lock(mutex_);
+            if (!open_) return make_error<LockedRecord>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+            if (access_mode_ == AccessMode::INPUT) {
+                return make_error<LockedRecord>(ErrorCode::VSAM_INVALID_REQUEST, "File open for input");
+            }
+        }
         
-        auto it = records_.find(record.key());
-        if (it == records_.end()) {
-            return make_error<void>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
+        // The record lock can wait, so is taken outside the file lock
+        auto& locks = RecordLockTable::instance();
+        const LockOwner owner = RecordLockTable::current_owner();
+        auto acquired = locks.acquire(def_.cluster_name, key.span(), owner, options);
+        if (!acquired) return make_error<LockedRecord>(acquired.error());
+        
+        std::optional<VsamRecord> rec;
+        bool still_open;
+        {
+            std::shared_lock lock(mutex_);
+            still_open = open_;
+            if (still_open) rec = index_.find(key.span());
+        }
+        if (!rec) {
+            if (acquired.value()) locks.release(def_.cluster_name, key.span(), owner);
+            if (!still_open) return make_error<LockedRecord>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+            return make_error<LockedRecord>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
         }
+        const bool until_syncpoint = def_.recovery && locks.release_at_syncpoint(owner) &&
+                                     forget_at_syncpoint(owner);
         
-        it->second.set_data(record.span());
-        stats_.record_update(Clock::now() - start);
+        LockedRecord locked{std::move(*rec), ++next_token_};
+        {
+            std::lock_guard held_lock(held_->mutex);
+            held_->records[locked.token] = HeldRecord{key, owner, until_syncpoint};
+        }
         
-        return make_success();
+        stats_.record_read(Clock::now() - start);
+        note_request(RequestType::FILE_READ, locked.record.length());
+        return make_success(std::move(locked));
     }
     
-    Result<void> erase(const VsamKey& key) override {
-        std::unique_lock lock(mutex_);
-        
-        if (!open_) return make_error<void>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
-        
-        auto it = records_.find(key);
-        if (it == records_.end()) {
-            return make_error<void>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
+    Result<void> rewrite(UpdateToken token, const VsamRecord& record) override {
+        auto held = take_held(token);
+        if (!held) return make_error<void>(held.error());
+        if (compare_keys(held.value().key.span(), record.key().span()) != 0) {
+            put_back(token, held.value());
+            return make_error<void>(ErrorCode::VSAM_KEY_CHANGE, "REWRITE may not change the key");
         }
         
-        records_.erase(it);
-        stats_.record_count--;
-        stats_.record_delete();
+        auto result = replace_record(record);
+        finish_update(held.value());
+        return result;
+    }
+    
+    Result<void> erase(UpdateToken token) override {
+        auto held = take_held(token);
+        if (!held) return make_error<void>(held.error());
         
+        auto result = erase_record(held.value().key);
+        finish_update(held.value());
+        return result;
+    }
+    
+    Result<void> unlock(UpdateToken token) override {
+        auto held = take_held(token);
+        if (!held) return make_error<void>(held.error());
+        finish_update(held.value());
         return make_success();
     }
     
     Result<String> start_browse(const VsamKey& key, bool gteq, bool backward) override {
-        std::unique_lock lock(mutex_);
-        
-        BrowseContext ctx;
-        ctx.set_mode(proc_mode_);
-        ctx.set_backward(backward);
+        auto browse = make_shared<Browse>();
+        browse->ctx.set_mode(proc_mode_);
+        browse->ctx.set_backward(backward);
+        {
+            std::shared_lock lock(mutex_);
+            browse->snapshot = index_.snapshot();
+        }
         
-        auto it = gteq ? records_.lower_bound(key) : records_.find(key);
-        if (it != records_.end()) {
-            ctx.set_current(it->second.key(), it->second.address());
+        browse->cursor = browse->snapshot.lower_bound(key.span());
+        const auto& cursor = browse->cursor;
+        if (cursor.valid() && (gteq || compare_keys(cursor.key(), key.span()) == 0)) {
+            browse->ctx.set_current(VsamKey(cursor.key()), address_of(cursor));
         } else {
-            ctx.set_at_end(true);
+            browse->ctx.set_at_end(true);
         }
         
-        String id = ctx.id();
-        browse_contexts_[id] = std::move(ctx);
+        String id = browse->ctx.id();
+        std::lock_guard browse_lock(browse_mutex_);
+        browses_[id] = std::move(browse);
         
         return make_success(id);
     }
     
     Result<VsamRecord> read_next(const String& browse_id) override {
-        std::shared_lock lock(mutex_);
-        
-        auto ctx_it = browse_contexts_.find(browse_id);
-        if (ctx_it == browse_contexts_.end()) {
+        auto browse = find_browse(browse_id);
+        if (!browse) {
             return make_error<VsamRecord>(ErrorCode::VSAM_ERROR, "Invalid browse ID");
         }
         
-        auto& ctx = ctx_it->second;
+        std::lock_guard lock(browse->mutex);
+        auto& ctx = browse->ctx;
         if (ctx.at_end()) {
             return make_error<VsamRecord>(ErrorCode::VSAM_END_OF_FILE, "End of file");
         }
         
-        auto it = records_.upper_bound(ctx.current_key());
-        if (it == records_.end()) {
+        auto& cursor = browse->cursor;
+        cursor.next();
+        if (!cursor.valid()) {
+            cursor = browse->snapshot.last();  // Stay on the last record for READPREV
             ctx.set_at_end(true);
             return make_error<VsamRecord>(ErrorCode::VSAM_END_OF_FILE, "End of file");
         }
         
-        ctx.set_current(it->second.key(), it->second.address());
+        VsamRecord rec = cursor.record();
+        ctx.set_current(rec.key(), rec.address());
         ctx.increment_records();
         stats_.browses++;
+        note_request(RequestType::FILE_BROWSE, rec.length());
         
-        return make_success(it->second);
+        return make_success(std::move(rec));
     }
     
     Result<VsamRecord> read_prev(const String& browse_id) override {
-        std::shared_lock lock(mutex_);
-        
-        auto ctx_it = browse_contexts_.find(browse_id);
-        if (ctx_it == browse_contexts_.end()) {
+        auto browse = find_browse(browse_id);
+        if (!browse) {
             return make_error<VsamRecord>(ErrorCode::VSAM_ERROR, "Invalid browse ID");
         }
         
-        auto& ctx = ctx_it->second;
-        auto it = records_.find(ctx.current_key());
-        if (it == records_.begin()) {
+        std::lock_guard lock(browse->mutex);
+        auto& ctx = browse->ctx;
+        KsdsIndex::Cursor cursor = browse->cursor;
+        if (cursor.valid()) {
+            cursor.prev();
+        } else {
+            cursor = browse->snapshot.last();
+        }
+        if (!cursor.valid()) {
             ctx.set_at_start(true);
             return make_error<VsamRecord>(ErrorCode::VSAM_END_OF_FILE, "Beginning of file");
         }
         
-        --it;
-        ctx.set_current(it->second.key(), it->second.address());
+        VsamRecord rec = cursor.record();
+        browse->cursor = std::move(cursor);
+        ctx.set_current(rec.key(), rec.address());
+        ctx.set_at_end(false);
         ctx.increment_records();
+        note_request(RequestType::FILE_BROWSE, rec.length());
+        
+        return make_success(std::move(rec));
+    }
+    
+    Result<BrowseBatchResult> read_next_batch(const String& browse_id, ByteSpan buffer,
+                                              std::span<BrowseBatchItem> items) override {
+        auto browse = find_browse(browse_id);
+        if (!browse) {
+            return make_error<BrowseBatchResult>(ErrorCode::VSAM_ERROR, "Invalid browse ID");
+        }
+        
+        // One lookup and one lock for the batch; the cursor walks the
+        // snapshot's CIs in order and each record is copied once
+        std::lock_guard lock(browse->mutex);
+        auto& ctx = browse->ctx;
+        if (ctx.at_end()) {
+            return make_error<BrowseBatchResult>(ErrorCode::VSAM_END_OF_FILE, "End of file");
+        }
         
-        return make_success(it->second);
+        BrowseBatchResult result;
+        auto& cursor = browse->cursor;
+        while (result.records < items.size()) {
+            cursor.next();
+            if (!cursor.valid()) {
+                cursor = browse->snapshot.last();  // Stay on the last record for READPREV
+                ctx.set_at_end(true);
+                result.end_of_file = true;
+                break;
+            }
+            if (!pack_record(buffer, result.bytes, cursor.key(), cursor.data(), cursor.rba(),
+                             items[result.records])) {
+                const Size needed = cursor.key().size() + cursor.data().size();
+                cursor.prev();  // Left for the next call
+                if (result.records == 0) {
+                    return make_error<BrowseBatchResult>(ErrorCode::BUFFER_OVERFLOW,
+                        std::format("Record of {} bytes does not fit a {} byte buffer", needed, buffer.size()));
+                }
+                break;
+            }
+            ++result.records;
+        }
+        
+        if (result.records > 0) {
+            const BrowseBatchItem& last = items[result.records - 1];
+            VsamAddress addr;
+            addr.rba = last.rba;
+            ctx.set_current(VsamKey(ConstByteSpan(buffer.data() + last.offset, last.key_length)), addr);
+            ctx.increment_records(result.records);
+            stats_.browses += result.records;
+            note_request(RequestType::FILE_BROWSE, result.bytes, result.records);
+        } else if (result.end_of_file) {
+            return make_error<BrowseBatchResult>(ErrorCode::VSAM_END_OF_FILE, "End of file");
+        }
+        return make_success(result);
     }
     
     Result<void> end_browse(const String& browse_id) override {
-        std::unique_lock lock(mutex_);
-        browse_contexts_.erase(browse_id);
+        std::lock_guard browse_lock(browse_mutex_);
+        browses_.erase(browse_id);
         return make_success();
     }
     
     Result<void> reset_browse(const String& browse_id, const VsamKey& key) override {
-        std::unique_lock lock(mutex_);
-        
-        auto ctx_it = browse_contexts_.find(browse_id);
-        if (ctx_it == browse_contexts_.end()) {
+        auto browse = find_browse(browse_id);
+        if (!browse) {
             return make_error<void>(ErrorCode::VSAM_ERROR, "Invalid browse ID");
         }
         
-        auto it = records_.lower_bound(key);
-        if (it != records_.end()) {
-            ctx_it->second.set_current(it->second.key(), it->second.address());
-            ctx_it->second.set_at_end(false);
+        // RESETBR repositions against the file as it is now
+        KsdsIndex::Snapshot snapshot;
+        {
+            std::shared_lock lock(mutex_);
+            snapshot = index_.snapshot();
+        }
+        
+        std::lock_guard lock(browse->mutex);
+        auto cursor = snapshot.lower_bound(key.span());
+        if (cursor.valid()) {
+            browse->ctx.set_current(VsamKey(cursor.key()), address_of(cursor));
+            browse->ctx.set_at_end(false);
+            browse->snapshot = std::move(snapshot);
+            browse->cursor = std::move(cursor);
         }
         
         return make_success();
     }
     
+    Result<KsdsIndex::Snapshot> snapshot() const override {
+        std::shared_lock lock(mutex_);
+        if (!open_) return make_error<KsdsIndex::Snapshot>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+        return make_success(index_.snapshot());
+    }
+    
+    Result<ReorgResult> reorganize(const ReorgOptions& options) override {
+        ReorgResult result;
+        {
+            std::shared_lock lock(mutex_);
+            if (!open_) return make_error<ReorgResult>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+            result.utilization_before = data_utilization();
+        }
+        
+        // Each step holds the file lock for a few CIs only; browses read
+        // their snapshots and are never disturbed
+        ByteBuffer resume;
+        do {
+            {
+                std::unique_lock lock(mutex_);
+                if (!open_) break;
+                result.cis_freed += index_.reorganize(resume, std::max<UInt32>(options.cis_per_step, 1));
+                sync_layout();
+            }
+            ++result.steps;
+            if (!resume.empty() && options.step_pause.count() > 0) std::this_thread::sleep_for(options.step_pause);
+        } while (!resume.empty() && !reorg_stop_.load(std::memory_order_relaxed));
+        
+        stats_.reorg_passes++;
+        std::shared_lock lock(mutex_);
+        result.utilization_after = data_utilization();
+        return make_success(result);
+    }
+    
+    Result<void> start_background_reorg(const ReorgOptions& options) override {
+        std::lock_guard lock(reorg_mutex_);
+        if (reorg_thread_.joinable()) {
+            return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST, "Background reorganisation already running");
+        }
+        reorg_stop_.store(false);
+        reorg_thread_ = std::thread([this, options] { reorg_loop(options); });
+        return make_success();
+    }
+    
+    void stop_background_reorg() override {
+        std::unique_lock lock(reorg_mutex_);
+        if (!reorg_thread_.joinable()) return;
+        reorg_stop_.store(true);
+        reorg_cv_.notify_all();
+        std::thread worker = std::move(reorg_thread_);
+        lock.unlock();
+        worker.join();
+        reorg_stop_.store(false);
+    }
+    
     const VsamDefinition& definition() const override { return def_; }
     const VsamStatistics& statistics() const override { return stats_; }
     VsamType type() const override { return VsamType::KSDS; }
     UInt64 record_count() const override { return stats_.record_count.get(); }
+    
+private:
+    Result<void> replace_record(const VsamRecord& record) {
+        auto start = Clock::now();
+        std::unique_lock lock(mutex_);
+        
+        if (!open_) return make_error<void>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+        if (auto fits = check_length(record); !fits) return fits;
+        
+        if (!index_.replace(record.key().span(), record.span())) {
+            return make_error<void>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
+        }
+        
+        sync_layout();
+        stats_.record_update(Clock::now() - start);
+        note_request(RequestType::FILE_WRITE, record.length());
+        
+        return make_success();
+    }
+    
+    Result<void> erase_record(const VsamKey& key) {
+        std::unique_lock lock(mutex_);
+        
+        if (!open_) return make_error<void>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+        
+        if (!index_.erase(key.span())) {
+            return make_error<void>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
+        }
+        
+        stats_.record_count--;
+        sync_layout();
+        stats_.record_delete();
+        note_request(RequestType::FILE_DELETE);
+        
+        return make_success();
+    }
+    
+    // Records beyond one CI are only accepted by a SPANNED cluster
+    Result<void> check_length(const VsamRecord& record) const {
+        if (record.length() > def_.maximum_record_length) {
+            return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST,
+                std::format("Record length {} exceeds the maximum of {}", record.length(), def_.maximum_record_length));
+        }
+        if (!def_.spanned_records && index_.needs_spanning(record.key().length(), record.length())) {
+            return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST,
+                std::format("Record length {} does not fit a {}-byte CI and the cluster is not SPANNED",
+                            record.length(), def_.ci_size));
+        }
+        return make_success();
+    }
+    
+    void reorg_loop(const ReorgOptions& options) {
+        std::unique_lock lock(reorg_mutex_);
+        while (!reorg_stop_.load()) {
+            reorg_cv_.wait_for(lock, options.check_interval, [this] { return reorg_stop_.load(); });
+            if (reorg_stop_.load()) break;
+            lock.unlock();
+            bool wanted;
+            {
+                std::shared_lock file_lock(mutex_);
+                wanted = open_ && index_.layout().data_cis > 1 && data_utilization() < options.trigger_utilization;
+            }
+            if (wanted) (void)reorganize(options);
+            lock.lock();
+        }
+    }
+    
+    // Percentage of the data CIs' bytes holding records, RDFs and CIDFs
+    double data_utilization() const {
+        const auto& layout = index_.layout();
+        const UInt64 capacity = static_cast<UInt64>(layout.data_cis) * def_.ci_size;
+        return capacity > 0 ? static_cast<double>(layout.data_bytes) * 100.0 / static_cast<double>(capacity) : 0.0;
+    }
+    
+    // Lock for the length of one keyed request; true if this request took it.
+    // Skipped when the task already holds the record from READ UPDATE, and
+    // bounded well short of the table default otherwise.
+    Result<bool> lock_transient(const VsamKey& key) {
+        const LockOwner owner = RecordLockTable::current_owner();
+        if (holds_for_update(key, owner)) return make_success(false);
+        RecordLockOptions options;
+        options.timeout = TRANSIENT_LOCK_TIMEOUT;
+        return RecordLockTable::instance().acquire(def_.cluster_name, key.span(), owner, options);
+    }
+    
+    bool holds_for_update(const VsamKey& key, LockOwner owner) const {
+        std::lock_guard held_lock(held_->mutex);
+        for (const auto& [token, held] : held_->records) {
+            if (held.owner == owner && compare_keys(held.key.span(), key.span()) == 0) return true;
+        }
+        return false;
+    }
+    
+    void release_transient(const VsamKey& key, bool acquired) {
+        if (acquired) {
+            RecordLockTable::instance().release(def_.cluster_name, key.span(),
+                                                RecordLockTable::current_owner());
+        }
+    }
+    
+    Result<HeldRecord> take_held(UpdateToken token) {
+        std::lock_guard held_lock(held_->mutex);
+        auto it = held_->records.find(token);
+        if (it == held_->records.end()) {
+            return make_error<HeldRecord>(ErrorCode::VSAM_INVALID_REQUEST, "No READ UPDATE for token");
+        }
+        if (it->second.owner != RecordLockTable::current_owner()) {
+            return make_error<HeldRecord>(ErrorCode::VSAM_INVALID_REQUEST, "Token held by another task");
+        }
+        HeldRecord held = std::move(it->second);
+        held_->records.erase(it);
+        return make_success(std::move(held));
+    }
+    
+    void put_back(UpdateToken token, const HeldRecord& held) {
+        std::lock_guard held_lock(held_->mutex);
+        held_->records[token] = held;
+    }
+    
+    // When the owner's unit of work ends and its locks go, so do the tokens
+    // it never presented; false if there is no unit of work
+    bool forget_at_syncpoint(LockOwner owner) {
+        auto* uow = syncpoint::SyncpointManager::instance().current_uow();
+        if (!uow) return false;
+        
+        const String name = std::format("VSAM.HELD.{}.{}", static_cast<const void*>(held_.get()), owner);
+        if (uow->has_resource(name)) return true;
+        
+        auto forget = [held = std::weak_ptr<HeldRecords>(held_), owner]() -> Result<void> {
+            if (auto records = held.lock()) {
+                std::lock_guard held_lock(records->mutex);
+                std::erase_if(records->records, [owner](const auto& entry) {
+                    return entry.second.owner == owner && entry.second.until_syncpoint;
+                });
+            }
+            return make_success();
+        };
+        return uow->register_resource(std::make_shared<syncpoint::SimpleRecoveryResource>(
+            name, syncpoint::ResourceType::VSAM_FILE,
+            []() -> Result<void> { return make_success(); }, forget, forget)).is_success();
+    }
+    
+    // Recoverable files keep the lock until the unit of work ends
+    void finish_update(const HeldRecord& held) {
+        if (held.until_syncpoint) return;
+        RecordLockTable::instance().release(def_.cluster_name, held.key.span(), held.owner);
+    }
+    
+    static void probe_sorted(const KsdsIndex::Snapshot& snapshot, std::span<const VsamKey> keys,
+                             std::span<BatchReadItem> items, std::span<const UInt32> order,
+                             BatchReadResult& result) {
+        KsdsIndex::SortedProbe probe(snapshot);
+        for (const UInt32 i : order) {
+            BatchReadItem& item = items[i];
+            if (!probe.find(keys[i].span())) {
+                miss_item(item, result);
+                continue;
+            }
+            fill_item(item, probe.data(), probe.rba(), result);
+        }
+        result.descents = probe.descents();
+    }
+    
+    void release_held() {
+        std::lock_guard held_lock(held_->mutex);
+        for (const auto& [token, held] : held_->records) {
+            if (held.until_syncpoint) continue;
+            RecordLockTable::instance().release(def_.cluster_name, held.key.span(), held.owner);
+        }
+        held_->records.clear();
+    }
+    
+    SharedPtr<Browse> find_browse(const String& browse_id) const {
+        std::lock_guard browse_lock(browse_mutex_);
+        auto it = browses_.find(browse_id);
+        return it == browses_.end() ? nullptr : it->second;
+    }
+    
+    static VsamAddress address_of(const KsdsIndex::Cursor& cursor) {
+        VsamAddress addr;
+        addr.rba = cursor.rba();
+        return addr;
+    }
+    
+    // Publish the index shape into the statistics block (writer lock held)
+    void sync_layout() {
+        const auto& layout = index_.layout();
+        stats_.ci_count = layout.data_cis;
+        stats_.index_levels = layout.index_levels;
+        stats_.index_records = layout.index_cis;
+        stats_.index_bytes = layout.index_bytes;
+        stats_.data_key_bytes_raw = layout.data_key_bytes_raw;
+        stats_.data_key_bytes_stored = layout.data_key_bytes_stored;
+        stats_.index_key_bytes_raw = layout.index_key_bytes_raw;
+        stats_.index_key_bytes_stored = layout.index_key_bytes_stored;
+        stats_.ci_splits.set(index_.ci_splits());
+        stats_.ca_splits.set(index_.ca_splits());
+        stats_.snapshot_ci_copies.set(index_.snapshot_copies());
+        stats_.ci_reclaims.set(index_.ci_reclaims());
+        stats_.spanned_records = layout.spanned_records;
+        
+        // Space as DEFINE CLUSTER would hold it: whole CAs of data CIs, each
+        // CA keeping its FREESPACE share of CIs empty, plus the index CIs
+        const UInt64 ca_cis = std::max<UInt64>(def_.ca_size, 1);
+        const UInt64 usable = std::max<UInt64>(ca_cis - ca_cis * def_.free_ca_percent / 100, 1);
+        const UInt64 cas = std::max<UInt64>((layout.data_cis + usable - 1) / usable, 1);
+        stats_.ca_count = static_cast<UInt32>(cas);
+        stats_.allocated_bytes = cas * ca_cis * def_.ci_size +
+                                 static_cast<UInt64>(layout.index_cis) * def_.index_ci_size;
+        stats_.used_bytes.set(layout.data_bytes + layout.index_bytes);
+    }
 };
 
+Result<BatchReadResult> IVsamFile::read_batch(std::span<const VsamKey> keys, std::span<BatchReadItem> items,
+                                              const BatchReadOptions&) {
+    if (keys.size() != items.size()) {
+        return make_error<BatchReadResult>(ErrorCode::INVALID_ARGUMENT, "One item is needed per key");
+    }
+    BatchReadResult result;
+    for (Size i = 0; i < keys.size(); ++i) {
+        BatchReadItem& item = items[i];
+        auto rec = read(keys[i]);
+        ++result.descents;
+        if (!rec) {
+            if (rec.error().code != ErrorCode::VSAM_RECORD_NOT_FOUND) return make_error<BatchReadResult>(rec.error());
+            miss_item(item, result);
+            continue;
+        }
+        fill_item(item, rec.value().span(), rec.value().rba(), result);
+    }
+    return make_success(result);
+}
+
+Result<BrowseBatchResult> IVsamFile::read_next_batch(const String& browse_id, ByteSpan buffer,
+                                                     std::span<BrowseBatchItem> items) {
+    BrowseBatchResult result;
+    while (result.records < items.size()) {
+        auto rec = read_next(browse_id);
+        if (!rec) {
+            if (rec.error().code != ErrorCode::VSAM_END_OF_FILE || result.records == 0) {
+                return make_error<BrowseBatchResult>(rec.error());
+            }
+            result.end_of_file = true;
+            break;
+        }
+        const VsamRecord& record = rec.value();
+        if (!pack_record(buffer, result.bytes, record.key().span(), record.span(), record.rba(),
+                         items[result.records])) {
+            (void)read_prev(browse_id);  // Left for the next call
+            if (result.records == 0) {
+                return make_error<BrowseBatchResult>(ErrorCode::BUFFER_OVERFLOW,
+                    std::format("Record of {} bytes does not fit a {} byte buffer",
+                                record.key().length() + record.length(), buffer.size()));
+            }
+            break;
+        }
+        ++result.records;
+    }
+    return make_success(result);
+}
+
+Result<ReorgResult> IVsamFile::reorganize(const ReorgOptions&) {
+    return make_error<ReorgResult>(ErrorCode::VSAM_INVALID_REQUEST, "Reorganisation not supported for this file");
+}
+
+Result<void> IVsamFile::start_background_reorg(const ReorgOptions&) {
+    return make_error<void>(ErrorCode::VSAM_INVALID_REQUEST, "Reorganisation not supported for this file");
+}
+
 UniquePtr<IVsamFile> create_vsam_file(const VsamDefinition& def, const Path&) {
     switch (def.type) {
         case VsamType::KSDS:
@@ -0,0 +1,214 @@
+#include "cics/vsam/vsam_types.hpp"
+#include <cics/syncpoint/syncpoint.hpp>
+#include <cics/common/task_context.hpp>
+#include <algorithm>
+
+namespace cics::vsam {
+// Record-level locking for READ UPDATE / REWRITE
+
+namespace {
+
+thread_local LockOwner thread_owner = 0;
+
+// Owners handed out to threads that never set one; the top bit keeps them
+// clear of task numbers a dispatcher would use
+std::atomic<LockOwner> next_thread_owner{0};
+constexpr LockOwner THREAD_OWNER_BIT = LockOwner{1} << 63;
+
+} // namespace
+
+RecordLockTable& RecordLockTable::instance() {
+    static RecordLockTable table;
+    return table;
+}
+
+void RecordLockTable::set_current_owner(LockOwner owner) {
+    thread_owner = owner;
+}
+
+LockOwner RecordLockTable::current_owner() {
+    if (thread_owner == 0) {
+        thread_owner = THREAD_OWNER_BIT | (next_thread_owner.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+    return thread_owner;
+}
+
+String RecordLockTable::lock_name(StringView file, ConstByteSpan key) {
+    String name;
+    name.reserve(file.size() + 1 + key.size());
+    name.append(file);
+    name.push_back('\0');
+    name.append(reinterpret_cast<const char*>(key.data()), key.size());
+    return name;
+}
+
+RecordLockTable::Stripe& RecordLockTable::stripe_for(const String& name) const {
+    return stripes_[std::hash<String>{}(name) % STRIPES];
+}
+
+RecordLockTable::OwnerStripe& RecordLockTable::owner_stripe(LockOwner owner) const {
+    return owners_[std::hash<LockOwner>{}(owner) % STRIPES];
+}
+
+bool RecordLockTable::closes_cycle(LockOwner waiter, LockOwner holder) const {
+    // Each owner waits on at most one lock, so the wait-for graph is a chain
+    for (LockOwner current = holder; current != 0;) {
+        if (current == waiter) return true;
+        auto it = waits_for_.find(current);
+        current = it == waits_for_.end() ? 0 : it->second;
+    }
+    return false;
+}
+
+Result<bool> RecordLockTable::acquire(StringView file, ConstByteSpan key, LockOwner owner,
+                                      const RecordLockOptions& options) {
+    String name = lock_name(file, key);
+    Stripe& stripe = stripe_for(name);
+    std::unique_lock lock(stripe.mutex);
+
+    // Entries are node-based, so this reference survives other inserts
+    Entry& entry = stripe.locks[name];
+    if (entry.owner == owner) return make_success(false);
+
+    if (entry.owner != 0) {
+        if (!options.wait) {
+            ++stats_.busy;
+            return make_error<bool>(ErrorCode::VSAM_RECORD_BUSY, "Record locked by another task");
+        }
+
+        const Int64 timeout_ms = options.timeout.count() > 0 ? options.timeout.count()
+                                                             : default_timeout_ms_.load();
+        const auto deadline = Clock::now() + Milliseconds(timeout_ms);
+        ++entry.waiters;
+        WaitTimer waiting(WaitType::ENQ);
+
+        auto stop_waiting = [&] {
+            --entry.waiters;
+            std::lock_guard wait_lock(wait_mutex_);
+            waits_for_.erase(owner);
+        };
+
+        while (entry.owner != 0) {
+            const LockOwner holder = entry.owner;
+            {
+                std::lock_guard wait_lock(wait_mutex_);
+                if (closes_cycle(owner, holder)) {
+                    waits_for_.erase(owner);
+                    --entry.waiters;
+                    ++stats_.deadlocks;
+                    return make_error<bool>(ErrorCode::VSAM_DEADLOCK, "Deadlock on record lock");
+                }
+                // Counted once the edge is visible to the deadlock check
+                if (waits_for_.insert_or_assign(owner, holder).second) ++stats_.waits;
+            }
+
+            // Wake on release, or when the lock changes hands so the wait-for
+            // edge is re-checked against the new holder
+            auto changed = [&] { return entry.owner != holder; };
+            if (timeout_ms > 0) {
+                if (!stripe.released.wait_until(lock, deadline, changed)) {
+                    stop_waiting();
+                    ++stats_.timeouts;
+                    return make_error<bool>(ErrorCode::VSAM_RECORD_BUSY, "Record lock wait timed out");
+                }
+            } else {
+                stripe.released.wait(lock, changed);
+            }
+        }
+        stop_waiting();
+    }
+
+    entry.owner = owner;
+    lock.unlock();
+    ++stats_.acquires;
+
+    OwnerStripe& owners = owner_stripe(owner);
+    std::lock_guard owner_lock(owners.mutex);
+    owners.held[owner].push_back(std::move(name));
+    return make_success(true);
+}
+
+bool RecordLockTable::unlock(const String& name, LockOwner owner) {
+    Stripe& stripe = stripe_for(name);
+    std::lock_guard lock(stripe.mutex);
+    auto it = stripe.locks.find(name);
+    if (it == stripe.locks.end() || it->second.owner != owner) return false;
+
+    if (it->second.waiters == 0) {
+        stripe.locks.erase(it);
+    } else {
+        it->second.owner = 0;
+        stripe.released.notify_all();
+    }
+    return true;
+}
+
+void RecordLockTable::forget(LockOwner owner, const String& name) {
+    OwnerStripe& owners = owner_stripe(owner);
+    std::lock_guard lock(owners.mutex);
+    auto it = owners.held.find(owner);
+    if (it == owners.held.end()) return;
+    auto& names = it->second;
+    auto pos = std::find(names.begin(), names.end(), name);
+    if (pos != names.end()) names.erase(pos);
+    if (names.empty()) owners.held.erase(it);
+}
+
+bool RecordLockTable::release(StringView file, ConstByteSpan key, LockOwner owner) {
+    const String name = lock_name(file, key);
+    if (!unlock(name, owner)) return false;
+    forget(owner, name);
+    return true;
+}
+
+UInt32 RecordLockTable::release_all(LockOwner owner) {
+    std::vector<String> names;
+    {
+        OwnerStripe& owners = owner_stripe(owner);
+        std::lock_guard lock(owners.mutex);
+        auto it = owners.held.find(owner);
+        if (it == owners.held.end()) return 0;
+        names = std::move(it->second);
+        owners.held.erase(it);
+    }
+
+    UInt32 released = 0;
+    for (const auto& name : names) {
+        if (unlock(name, owner)) ++released;
+    }
+    return released;
+}
+
+bool RecordLockTable::release_at_syncpoint(LockOwner owner) {
+    auto& syncpoint = syncpoint::SyncpointManager::instance();
+    auto* uow = syncpoint.current_uow();
+    if (!uow) return false;  // No unit of work: the caller releases explicitly
+
+    const String name = std::format("VSAM.RECORD.LOCKS.{}", owner);
+    if (uow->has_resource(name)) return true;
+
+    auto release = [this, owner]() -> Result<void> {
+        release_all(owner);
+        return make_success();
+    };
+    return uow->register_resource(std::make_shared<syncpoint::SimpleRecoveryResource>(
+        name, syncpoint::ResourceType::VSAM_FILE,
+        []() -> Result<void> { return make_success(); }, release, release)).is_success();
+}
+
+bool RecordLockTable::is_locked(StringView file, ConstByteSpan key) const {
+    const String name = lock_name(file, key);
+    Stripe& stripe = stripe_for(name);
+    std::lock_guard lock(stripe.mutex);
+    auto it = stripe.locks.find(name);
+    return it != stripe.locks.end() && it->second.owner != 0;
+}
+
+UInt32 RecordLockTable::held_count(LockOwner owner) const {
+    OwnerStripe& owners = owner_stripe(owner);
+    std::lock_guard lock(owners.mutex);
+    auto it = owners.held.find(owner);
+    return it == owners.held.end() ? 0 : static_cast<UInt32>(it->second.size());
+}
+
+} // namespace cics::vsam
@@ -0,0 +1,375 @@
+#include "cics/vsam/shared_data_table.hpp"
+#include "cics/common/task_context.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace cics::vsam {
+
+namespace {
+
+// Dead chunk bytes tolerated before a merge repacks the table
+constexpr Size PACK_SLACK_BYTES = 64 * 1024;
+
+// Record bytes are appended to chunks of this size, or one record's size
+constexpr Size CHUNK_BYTES = 64 * 1024;
+
+// Changes held before a merge: about sqrt(base rows), so copying the list
+// on each write and rebuilding the base cost about the same
+constexpr Size MIN_CHANGES = 64;
+
+Size change_limit(Size base_rows) {
+    return std::max(MIN_CHANGES, static_cast<Size>(std::sqrt(static_cast<double>(base_rows))));
+}
+
+bool same_key(ConstByteSpan a, ConstByteSpan b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool row_before(const SharedDataTable::Row& row, ConstByteSpan key) {
+    return compare_keys(row.key, key) < 0;
+}
+
+Size row_bytes(const SharedDataTable::Row& row) {
+    return row.key.size() + row.data.size();
+}
+
+} // namespace
+
+// =============================================================================
+// Table
+// =============================================================================
+
+const SharedDataTable::Row* SharedDataTable::Table::Base::find(ConstByteSpan key) const {
+    if (slots.empty()) return nullptr;
+    const UInt64 hash = fnv1a_hash(key);
+    const UInt32 tag = tag_of(hash);
+    const Size mask = slots.size() - 1;
+    for (Size i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.tag == 0) return nullptr;
+        if (slot.tag == tag && same_key(rows[slot.row].key, key)) return &rows[slot.row];
+    }
+}
+
+void SharedDataTable::Table::Base::build_slots() {
+    // Power-of-two capacity at most half full keeps probe runs short
+    Size capacity = 16;
+    while (capacity < rows.size() * 2) capacity <<= 1;
+    slots.assign(capacity, Slot{});
+
+    const Size mask = capacity - 1;
+    for (UInt32 r = 0; r < rows.size(); ++r) {
+        const UInt64 hash = fnv1a_hash(rows[r].key);
+        Size i = hash & mask;
+        while (slots[i].tag != 0) i = (i + 1) & mask;
+        slots[i] = Slot{tag_of(hash), r};
+    }
+}
+
+std::vector<SharedDataTable::Table::Change>::const_iterator
+SharedDataTable::Table::find_change(ConstByteSpan key) const {
+    auto it = std::lower_bound(changes_.begin(), changes_.end(), key,
+        [](const Change& change, ConstByteSpan wanted) { return compare_keys(change.row.key, wanted) < 0; });
+    return it != changes_.end() && same_key(it->row.key, key) ? it : changes_.end();
+}
+
+const SharedDataTable::Row* SharedDataTable::Table::find(ConstByteSpan key) const {
+    if (!changes_.empty()) {
+        if (auto it = find_change(key); it != changes_.end()) return it->erased ? nullptr : &it->row;
+    }
+    return base_->find(key);
+}
+
+std::vector<SharedDataTable::Row> SharedDataTable::Table::rows() const {
+    std::vector<Row> merged;
+    merged.reserve(size_);
+    auto change = changes_.begin();
+    for (const Row& row : base_->rows) {
+        for (; change != changes_.end() && compare_keys(change->row.key, row.key) < 0; ++change) {
+            if (!change->erased) merged.push_back(change->row);
+        }
+        if (change != changes_.end() && same_key(change->row.key, row.key)) {
+            if (!change->erased) merged.push_back(change->row);
+            ++change;
+        } else {
+            merged.push_back(row);
+        }
+    }
+    for (; change != changes_.end(); ++change) {
+        if (!change->erased) merged.push_back(change->row);
+    }
+    return merged;
+}
+
+void SharedDataTable::Table::merge() {
+    auto base = make_shared<Base>();
+    base->rows = rows();
+    base->chunks = base_->chunks;
+    for (auto& chunk : change_chunks_) {
+        if (std::find(base->chunks.begin(), base->chunks.end(), chunk) == base->chunks.end()) {
+            base->chunks.push_back(std::move(chunk));
+        }
+    }
+    if (arena_bytes_ > live_bytes_ * 2 + PACK_SLACK_BYTES) pack(*base);
+    base->build_slots();
+
+    base_ = std::move(base);
+    changes_.clear();
+    change_chunks_.clear();
+}
+
+void SharedDataTable::Table::pack(Base& base) {
+    auto chunk = make_shared<ByteBuffer>(live_bytes_);
+    Byte* out = chunk->data();
+    for (auto& row : base.rows) {
+        std::memcpy(out, row.key.data(), row.key.size());
+        std::memcpy(out + row.key.size(), row.data.data(), row.data.size());
+        row.key = ConstByteSpan(out, row.key.size());
+        row.data = ConstByteSpan(out + row.key.size(), row.data.size());
+        out += row_bytes(row);
+    }
+    base.chunks.assign(1, std::move(chunk));
+    arena_bytes_ = live_bytes_;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+double SharedDataTable::Statistics::hit_ratio() const {
+    const UInt64 total = hits.get() + misses.get();
+    return total == 0 ? 0.0 : static_cast<double>(hits.get()) / static_cast<double>(total);
+}
+
+String SharedDataTable::Statistics::to_string() const {
+    return std::format("Hits: {}, Misses: {}, Hit ratio: {:.1f}%, Loads: {}, Load time: {:.3f}ms, Publishes: {}",
+        hits.get(), misses.get(), hit_ratio() * 100.0, loads.get(),
+        static_cast<double>(load_time_ns.load()) / 1e6, publishes.get());
+}
+
+// =============================================================================
+// SharedDataTable
+// =============================================================================
+
+SharedDataTable::SharedDataTable(UniquePtr<IVsamFile> source)
+    : source_(std::move(source)), table_(make_shared<const Table>()) {}
+
+Result<void> SharedDataTable::open(AccessMode mode, ProcessingMode proc) {
+    if (auto result = source_->open(mode, proc); !result) return result;
+    if (auto result = load(); !result) {
+        (void)source_->close();
+        return result;
+    }
+    return make_success();
+}
+
+Result<void> SharedDataTable::close() {
+    {
+        std::lock_guard lock(token_mutex_);
+        tokens_.clear();
+    }
+    {
+        std::lock_guard lock(write_mutex_);
+        table_.store(make_shared<const Table>(), std::memory_order_release);
+        tail_chunk_.reset();
+    }
+    return source_->close();
+}
+
+Result<void> SharedDataTable::reload() {
+    return load();
+}
+
+Result<void> SharedDataTable::load() {
+    auto start = Clock::now();
+
+    // A refresh that ran between the snapshot and the publish would be lost
+    std::lock_guard lock(write_mutex_);
+    auto snapshot = source_->snapshot();
+    if (!snapshot) return make_error<void>(snapshot.error());
+
+    // Size the chunk first so every row can point straight into it
+    Size bytes = 0;
+    for (auto cursor = snapshot.value().first(); cursor.valid(); cursor.next()) {
+        bytes += cursor.key().size() + cursor.data().size();
+    }
+
+    auto table = make_shared<Table>();
+    auto base = make_shared<Table::Base>();
+    auto chunk = make_shared<ByteBuffer>(bytes);
+    base->rows.reserve(snapshot.value().size());
+    Byte* out = chunk->data();
+    for (auto cursor = snapshot.value().first(); cursor.valid(); cursor.next()) {
+        const ConstByteSpan key = cursor.key();
+        const ConstByteSpan data = cursor.data();
+        std::memcpy(out, key.data(), key.size());
+        std::memcpy(out + key.size(), data.data(), data.size());
+        base->rows.push_back(Row{ConstByteSpan(out, key.size()),
+                                 ConstByteSpan(out + key.size(), data.size()), cursor.rba()});
+        out += key.size() + data.size();
+    }
+    base->chunks.push_back(std::move(chunk));
+    base->build_slots();
+    table->size_ = base->rows.size();
+    table->arena_bytes_ = table->live_bytes_ = bytes;
+    table->base_ = std::move(base);
+
+    table_.store(std::move(table), std::memory_order_release);
+    tail_chunk_.reset();
+    ++sdt_stats_.loads;
+    sdt_stats_.load_time_ns.store(std::chrono::duration_cast<Nanoseconds>(Clock::now() - start).count());
+    return make_success();
+}
+
+Result<VsamRecord> SharedDataTable::read(const VsamKey& key) {
+    if (!source_->is_open()) return make_error<VsamRecord>(ErrorCode::VSAM_FILE_NOT_OPEN, "File not open");
+
+    Optional<VsamRecord> rec;
+    lookup(key.span(), [&](const Row& row) {
+        rec.emplace(VsamKey(row.key), row.data);
+        VsamAddress addr;
+        addr.rba = row.rba;
+        rec->set_address(addr);
+    });
+    // The table holds the whole file, so a miss needs no trip to the source
+    if (!rec) return make_error<VsamRecord>(ErrorCode::VSAM_RECORD_NOT_FOUND, "Record not found");
+    note_request(RequestType::FILE_READ, rec->length());
+    return make_success(std::move(*rec));
+}
+
+Result<void> SharedDataTable::write(const VsamRecord& record) {
+    auto result = source_->write(record);
+    if (result) refresh(record.key());
+    return result;
+}
+
+Result<void> SharedDataTable::update(const VsamRecord& record) {
+    auto result = source_->update(record);
+    if (result) refresh(record.key());
+    return result;
+}
+
+Result<void> SharedDataTable::erase(const VsamKey& key) {
+    auto result = source_->erase(key);
+    if (result) refresh(key);
+    return result;
+}
+
+Result<IVsamFile::LockedRecord> SharedDataTable::read_for_update(const VsamKey& key,
+                                                                 const RecordLockOptions& options) {
+    auto result = source_->read_for_update(key, options);
+    if (result) {
+        std::lock_guard lock(token_mutex_);
+        tokens_[result.value().token] = key;
+    }
+    return result;
+}
+
+Result<void> SharedDataTable::rewrite(UpdateToken token, const VsamRecord& record) {
+    auto result = source_->rewrite(token, record);
+    if (result) {
+        forget_token(token);
+        refresh(record.key());
+    }
+    return result;
+}
+
+Result<void> SharedDataTable::erase(UpdateToken token) {
+    Optional<VsamKey> key;
+    {
+        std::lock_guard lock(token_mutex_);
+        if (auto it = tokens_.find(token); it != tokens_.end()) key = it->second;
+    }
+    auto result = source_->erase(token);
+    if (result) {
+        forget_token(token);
+        if (key) refresh(*key);
+    }
+    return result;
+}
+
+Result<void> SharedDataTable::unlock(UpdateToken token) {
+    auto result = source_->unlock(token);
+    if (result) forget_token(token);
+    return result;
+}
+
+void SharedDataTable::forget_token(UpdateToken token) {
+    std::lock_guard lock(token_mutex_);
+    tokens_.erase(token);
+}
+
+SharedDataTable::Row SharedDataTable::append(ConstByteSpan key, ConstByteSpan data, RBA rba) {
+    const Size bytes = key.size() + data.size();
+    if (!tail_chunk_ || tail_chunk_->size() - tail_used_ < bytes) {
+        tail_chunk_ = make_shared<ByteBuffer>(std::max(CHUNK_BYTES, bytes));
+        tail_used_ = 0;
+    }
+    Byte* out = tail_chunk_->data() + tail_used_;
+    std::memcpy(out, key.data(), key.size());
+    std::memcpy(out + key.size(), data.data(), data.size());
+    tail_used_ += bytes;
+    return Row{ConstByteSpan(out, key.size()), ConstByteSpan(out + key.size(), data.size()), rba};
+}
+
+void SharedDataTable::refresh(const VsamKey& key) {
+    std::lock_guard lock(write_mutex_);
+    auto stored = source_->read(key);
+    auto current = table_.load(std::memory_order_acquire);
+
+    const Row* old = current->find(key.span());
+    if (!stored && !old) return;  // Neither in the table nor in the file
+
+    // Shares the base; only the change list is copied
+    auto next = make_shared<Table>(*current);
+    auto& changes = next->changes_;
+    auto pos = std::lower_bound(changes.begin(), changes.end(), key.span(),
+        [](const Table::Change& change, ConstByteSpan wanted) { return row_before(change.row, wanted); });
+    const bool changed_before = pos != changes.end() && compare_keys(pos->row.key, key.span()) == 0;
+    if (old) {
+        next->live_bytes_ -= row_bytes(*old);
+        --next->size_;
+    }
+
+    if (stored) {
+        const VsamRecord& rec = stored.value();
+        Table::Change change{append(key.span(), rec.span(), rec.rba())};
+        const Size bytes = row_bytes(change.row);
+        next->arena_bytes_ += bytes;
+        next->live_bytes_ += bytes;
+        ++next->size_;
+        if (next->change_chunks_.empty() || next->change_chunks_.back() != tail_chunk_) {
+            next->change_chunks_.push_back(tail_chunk_);
+        }
+        if (changed_before) {
+            *pos = change;
+        } else {
+            changes.insert(pos, change);
+        }
+    } else if (next->base_->find(key.span())) {
+        // A tombstone hides the base row until the next merge
+        const Table::Change tombstone{*old, true};
+        if (changed_before) {
+            *pos = tombstone;
+        } else {
+            changes.insert(pos, tombstone);
+        }
+    } else {
+        changes.erase(pos);  // Only ever written since the merge
+    }
+
+    if (changes.size() > change_limit(next->base_->rows.size())) {
+        next->merge();
+        ++sdt_stats_.merges;
+    }
+    table_.store(std::move(next), std::memory_order_release);
+    ++sdt_stats_.publishes;
+}
+
+UniquePtr<SharedDataTable> create_shared_data_table(const VsamDefinition& def, const Path& path) {
+    auto source = create_vsam_file(def, path);
+    if (!source) return nullptr;
+    return std::make_unique<SharedDataTable>(std::move(source));
+}
+
+} // namespace cics::vsam
@@ -12,6 +12,12 @@ void VsamStatistics::record_read(Duration time) {
     last_accessed = SystemClock::now();
 }
 
+void VsamStatistics::record_reads(UInt64 count, Duration time) {
+    reads += count;
+    total_io_time_ns += std::chrono::duration_cast<Nanoseconds>(time).count();
+    last_accessed = SystemClock::now();
+}
+
 void VsamStatistics::record_write(Duration time, Size bytes) {
     writes++; inserts++;
     used_bytes += bytes;
@@ -38,19 +44,29 @@ double VsamStatistics::space_utilization() const {
     return allocated_bytes > 0 ? static_cast<double>(used_bytes) * 100.0 / static_cast<double>(allocated_bytes) : 0.0;
 }
 
+double VsamStatistics::key_compression_ratio() const {
+    const UInt64 raw = data_key_bytes_raw + index_key_bytes_raw;
+    const UInt64 stored = data_key_bytes_stored + index_key_bytes_stored;
+    return raw > 0 ? static_cast<double>(stored) / static_cast<double>(raw) : 0.0;
+}
+
 double VsamStatistics::average_io_time_us() const {
     UInt64 total_ops = reads + writes + updates + deletes;
     return total_ops > 0 ? static_cast<double>(total_io_time_ns) / (static_cast<double>(total_ops) * 1000.0) : 0.0;
 }
 
 String VsamStatistics::to_string() const {
-    return std::format("Records: {}, Reads: {}, Writes: {}, Utilization: {:.1f}%",
-        record_count.get(), reads.get(), writes.get(), space_utilization());
+    return std::format("Records: {}, Reads: {}, Writes: {}, Utilization: {:.1f}%, "
+        "Index levels: {}, Key compression: {:.1f}%",
+        record_count.get(), reads.get(), writes.get(), space_utilization(),
+        index_levels, key_compression_ratio() * 100.0);
 }
 
 String VsamStatistics::to_json() const {
-    return std::format(R"({{"records":{},"reads":{},"writes":{},"utilization":{:.1f}}})",
-        record_count.get(), reads.get(), writes.get(), space_utilization());
+    return std::format(R"({{"records":{},"reads":{},"writes":{},"utilization":{:.1f},)"
+        R"("index_levels":{},"ci_count":{},"key_compression":{:.3f}}})",
+        record_count.get(), reads.get(), writes.get(), space_utilization(),
+        index_levels, ci_count, key_compression_ratio());
 }
 
 VsamRecord::VsamRecord(VsamKey key, ConstByteSpan data)
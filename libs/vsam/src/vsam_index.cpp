@@ -1,4 +1,994 @@
 #include "cics/vsam/vsam_types.hpp"
+#include <algorithm>
+#include <utility>
 namespace cics::vsam {
 // B-tree index implementation for KSDS
+
+namespace {
+
+void put_varint(ByteBuffer& out, UInt32 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<Byte>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<Byte>(value));
+}
+
+const Byte* get_varint(const Byte* p, UInt32& value) {
+    value = 0;
+    UInt32 shift = 0;
+    while (*p & 0x80) {
+        value |= static_cast<UInt32>(*p++ & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<UInt32>(*p++) << shift;
+    return p;
+}
+
+struct EntryHeader {
+    UInt32 shared;
+    UInt32 unshared;
+    UInt32 value_length;
+    UInt32 header_length;
+
+    [[nodiscard]] UInt32 length() const { return header_length + unshared + value_length; }
+};
+
+EntryHeader read_header(const ByteBuffer& bytes, UInt32 offset) {
+    const Byte* start = bytes.data() + offset;
+    EntryHeader header{start[0], start[1], 0, 0};
+    const Byte* p = get_varint(start + 2, header.value_length);
+    header.header_length = static_cast<UInt32>(p - start);
+    return header;
+}
+
+// Full key stored at a restart point (shared length is always zero there)
+ConstByteSpan restart_key(const ByteBuffer& bytes, UInt32 offset) {
+    const EntryHeader header = read_header(bytes, offset);
+    return {bytes.data() + offset + header.header_length, header.unshared};
+}
+
+// Appends one entry, compressed against `previous` (empty at a restart);
+// returns the number of key bytes actually stored
+UInt32 encode_entry(ByteBuffer& out, ConstByteSpan previous, ConstByteSpan key, ConstByteSpan value) {
+    UInt32 shared = 0;
+    const Size limit = std::min(previous.size(), key.size());
+    while (shared < limit && previous[shared] == key[shared]) ++shared;
+    const UInt32 unshared = static_cast<UInt32>(key.size()) - shared;
+
+    out.push_back(static_cast<Byte>(shared));
+    out.push_back(static_cast<Byte>(unshared));
+    put_varint(out, static_cast<UInt32>(value.size()));
+    out.insert(out.end(), key.begin() + shared, key.end());
+    out.insert(out.end(), value.begin(), value.end());
+    return 2 + unshared;
+}
+
+// Restart slot holding the entry with the given index
+template<typename Restarts>
+UInt32 restart_covering(const Restarts& restarts, UInt32 index) {
+    auto it = std::upper_bound(restarts.begin(), restarts.end(), index,
+                               [](UInt32 value, const auto& restart) { return value < restart.index; });
+    return static_cast<UInt32>(it - restarts.begin()) - 1;
+}
+
+constexpr Size RBA_BYTES = sizeof(RBA);
+
+// Where an overflowing CI splits: an insert past the high key (sequential
+// load) moves only the new entry, leaving the old CI at its load; anything
+// else splits in half
+UInt32 split_point(UInt32 count, UInt32 inserted) {
+    return inserted == count - 1 ? count - 1 : count / 2;
+}
+
+Size varint_length(Size value) {
+    Size length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++length;
+    }
+    return length;
+}
+
+// Most a single entry can add to a CI, before front-key compression
+Size entry_bound(ConstByteSpan key, ConstByteSpan value) {
+    return 2 + varint_length(value.size()) + key.size() + value.size() + RDF_LENGTH;
+}
+
+} // namespace
+
+int compare_keys(ConstByteSpan a, ConstByteSpan b) noexcept {
+    const Size min_len = std::min(a.size(), b.size());
+    if (min_len > 0) {
+        const int cmp = std::memcmp(a.data(), b.data(), min_len);
+        if (cmp != 0) return cmp;
+    }
+    if (a.size() < b.size()) return -1;
+    if (a.size() > b.size()) return 1;
+    return 0;
+}
+
+// =============================================================================
+// KeyBlock
+// =============================================================================
+
+void KeyBlock::Builder::add(ConstByteSpan key, ConstByteSpan value) {
+    auto& bytes = block_.bytes_;
+    const bool restart = block_.count_ % RESTART_INTERVAL == 0;
+    if (restart) {
+        block_.restarts_.push_back({static_cast<UInt32>(bytes.size()), block_.count_});
+    }
+    block_.stored_key_bytes_ += encode_entry(bytes, restart ? ConstByteSpan{} : ConstByteSpan(last_key_), key, value);
+    ++block_.count_;
+    block_.raw_key_bytes_ += key.size();
+    block_.value_bytes_ += value.size();
+    last_key_.assign(key.begin(), key.end());
+}
+
+KeyBlock KeyBlock::Builder::finish() {
+    last_key_.clear();
+    return std::exchange(block_, KeyBlock{});
+}
+
+KeyBlock::Position KeyBlock::locate(ConstByteSpan key, ByteBuffer& previous, ByteBuffer& current) const {
+    // Last restart point whose key is < key (or the first one)
+    UInt32 lo = 0;
+    UInt32 hi = static_cast<UInt32>(restarts_.size() - 1);
+    while (lo < hi) {
+        const UInt32 mid = (lo + hi + 1) / 2;
+        if (compare_keys(restart_key(bytes_, restarts_[mid].offset), key) < 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    Position pos{lo, restarts_[lo].offset, restarts_[lo].index, 0, false};
+    previous.clear();
+    current.clear();
+    while (pos.offset < bytes_.size()) {
+        if (pos.restart + 1 < restarts_.size() && restarts_[pos.restart + 1].offset == pos.offset) {
+            ++pos.restart;
+        }
+        const EntryHeader header = read_header(bytes_, pos.offset);
+        const Byte* suffix = bytes_.data() + pos.offset + header.header_length;
+        std::swap(previous, current);
+        current.assign(previous.begin(), previous.begin() + header.shared);
+        current.insert(current.end(), suffix, suffix + header.unshared);
+
+        const int cmp = compare_keys(current, key);
+        if (cmp >= 0) {
+            pos.length = header.length();
+            pos.found = cmp == 0;
+            return pos;
+        }
+        pos.offset += header.length();
+        ++pos.index;
+    }
+    std::swap(previous, current);
+    return pos;
+}
+
+UInt32 KeyBlock::run_length(UInt32 restart) const {
+    const UInt32 end = restart + 1 < restarts_.size() ? restarts_[restart + 1].index : count_;
+    return end - restarts_[restart].index;
+}
+
+void KeyBlock::splice(UInt32 offset, UInt32 length, const ByteBuffer& replacement) {
+    if (replacement.size() > length) {
+        bytes_.insert(bytes_.begin() + offset + length, replacement.size() - length, Byte{0});
+    } else if (replacement.size() < length) {
+        bytes_.erase(bytes_.begin() + offset + replacement.size(), bytes_.begin() + offset + length);
+    }
+    if (!replacement.empty()) {
+        std::memcpy(bytes_.data() + offset, replacement.data(), replacement.size());
+    }
+}
+
+void KeyBlock::shift_restarts(UInt32 from, Int64 delta, int index_delta) {
+    for (UInt32 i = from; i < restarts_.size(); ++i) {
+        restarts_[i].offset = static_cast<UInt32>(restarts_[i].offset + delta);
+        restarts_[i].index = static_cast<UInt32>(static_cast<Int64>(restarts_[i].index) + index_delta);
+    }
+}
+
+Optional<UInt32> KeyBlock::insert(ConstByteSpan key, ConstByteSpan value) {
+    ByteBuffer entry;
+    if (count_ == 0) {
+        stored_key_bytes_ += encode_entry(entry, {}, key, value);
+        bytes_ = std::move(entry);
+        restarts_.push_back({0, 0});
+        count_ = 1;
+        raw_key_bytes_ += key.size();
+        value_bytes_ += value.size();
+        return 0;
+    }
+
+    ByteBuffer previous;
+    ByteBuffer successor;
+    const Position pos = locate(key, previous, successor);
+    if (pos.found) return nullopt;
+
+    // Inserting in front of a restart point takes it over; otherwise runs
+    // grow in place and are cut once they reach twice the restart interval
+    // (or the interval itself when appending, as a sequential load does)
+    UInt32 shift_from = pos.restart + 1;
+    bool restart = pos.length > 0 && restarts_[pos.restart].offset == pos.offset;
+    const UInt32 run_limit = pos.length == 0 ? RESTART_INTERVAL : 2 * RESTART_INTERVAL;
+    if (!restart && run_length(pos.restart) >= run_limit) {
+        restarts_.insert(restarts_.begin() + pos.restart + 1, {pos.offset, pos.index});
+        restart = true;
+        ++shift_from;
+    }
+    stored_key_bytes_ += encode_entry(entry, restart ? ConstByteSpan{} : ConstByteSpan(previous), key, value);
+
+    if (pos.length > 0) {
+        // The displaced entry is now compressed against the new key
+        const EntryHeader header = read_header(bytes_, pos.offset);
+        const UInt32 value_offset = pos.offset + header.header_length + header.unshared;
+        const ByteBuffer old_value(bytes_.begin() + value_offset, bytes_.begin() + value_offset + header.value_length);
+        stored_key_bytes_ -= 2 + header.unshared;
+        stored_key_bytes_ += encode_entry(entry, key, successor, old_value);
+    }
+
+    splice(pos.offset, pos.length, entry);
+    shift_restarts(shift_from, static_cast<Int64>(entry.size()) - pos.length, 1);
+    ++count_;
+    raw_key_bytes_ += key.size();
+    value_bytes_ += value.size();
+    return pos.index;
+}
+
+bool KeyBlock::erase(ConstByteSpan key) {
+    if (count_ == 0) return false;
+    ByteBuffer previous;
+    ByteBuffer current;
+    const Position pos = locate(key, previous, current);
+    if (!pos.found) return false;
+
+    const EntryHeader header = read_header(bytes_, pos.offset);
+    const bool restart = restarts_[pos.restart].offset == pos.offset;
+    const UInt32 next_offset = pos.offset + pos.length;
+    const bool next_is_restart = pos.restart + 1 < restarts_.size() &&
+                                 restarts_[pos.restart + 1].offset == next_offset;
+
+    ByteBuffer entry;
+    UInt32 length = pos.length;
+    UInt32 shift_from = pos.restart + 1;
+    if (next_offset < bytes_.size() && !next_is_restart) {
+        // Re-encode the following entry against the erased entry's predecessor;
+        // at a restart point it becomes the new full key
+        const EntryHeader next = read_header(bytes_, next_offset);
+        const Byte* suffix = bytes_.data() + next_offset + next.header_length;
+        ByteBuffer next_key(current.begin(), current.begin() + next.shared);
+        next_key.insert(next_key.end(), suffix, suffix + next.unshared);
+        const ConstByteSpan next_value(suffix + next.unshared, next.value_length);
+        stored_key_bytes_ -= 2 + next.unshared;
+        stored_key_bytes_ += encode_entry(entry, restart ? ConstByteSpan{} : ConstByteSpan(previous),
+                                          next_key, next_value);
+        length += next.length();
+    } else if (restart) {
+        restarts_.erase(restarts_.begin() + pos.restart);
+        --shift_from;
+    }
+
+    splice(pos.offset, length, entry);
+    shift_restarts(shift_from, static_cast<Int64>(entry.size()) - length, -1);
+    --count_;
+    raw_key_bytes_ -= key.size();
+    stored_key_bytes_ -= 2 + header.unshared;
+    value_bytes_ -= header.value_length;
+    return true;
+}
+
+bool KeyBlock::replace(ConstByteSpan key, ConstByteSpan value) {
+    if (count_ == 0) return false;
+    ByteBuffer previous;
+    ByteBuffer current;
+    const Position pos = locate(key, previous, current);
+    if (!pos.found) return false;
+
+    const EntryHeader header = read_header(bytes_, pos.offset);
+    const Byte* suffix = bytes_.data() + pos.offset + header.header_length;
+    ByteBuffer entry;
+    entry.push_back(static_cast<Byte>(header.shared));
+    entry.push_back(static_cast<Byte>(header.unshared));
+    put_varint(entry, static_cast<UInt32>(value.size()));
+    entry.insert(entry.end(), suffix, suffix + header.unshared);
+    entry.insert(entry.end(), value.begin(), value.end());
+
+    splice(pos.offset, pos.length, entry);
+    shift_restarts(pos.restart + 1, static_cast<Int64>(entry.size()) - pos.length, 0);
+    value_bytes_ = value_bytes_ - header.value_length + value.size();
+    return true;
+}
+
+KeyBlock KeyBlock::split(UInt32 at) {
+    KeyBlock right;
+    if (at >= count_) return right;
+
+    Iterator it(this);
+    it.seek_to_restart(restart_covering(restarts_, at));
+    while (it.index_ < at) it.next();
+    const UInt32 cut = it.offset_;
+
+    Builder builder;
+    for (; it.valid(); it.next()) {
+        builder.add(it.key(), it.value());
+        stored_key_bytes_ -= 2 + bytes_[it.offset_ + 1];
+    }
+    right = builder.finish();
+
+    bytes_.resize(cut);
+    while (!restarts_.empty() && restarts_.back().index >= at) restarts_.pop_back();
+    count_ = at;
+    raw_key_bytes_ -= right.raw_key_bytes_;
+    value_bytes_ -= right.value_bytes_;
+    return right;
+}
+
+ConstByteSpan KeyBlock::first_key() const {
+    if (count_ == 0) return {};
+    return restart_key(bytes_, 0);
+}
+
+ByteBuffer KeyBlock::key_at(UInt32 index) const {
+    if (index >= count_) return {};
+    Iterator it(this);
+    it.seek_to_restart(restart_covering(restarts_, index));
+    while (it.index_ < index) it.next();
+    return ByteBuffer(it.key().begin(), it.key().end());
+}
+
+ByteBuffer KeyBlock::last_key() const {
+    Iterator it(this);
+    it.seek_to_last();
+    if (!it.valid()) return {};
+    return ByteBuffer(it.key().begin(), it.key().end());
+}
+
+void KeyBlock::Iterator::decode_next() {
+    offset_ = next_offset_;
+    const EntryHeader header = read_header(block_->bytes_, offset_);
+    const Byte* suffix = block_->bytes_.data() + offset_ + header.header_length;
+    std::memcpy(key_.data() + header.shared, suffix, header.unshared);
+    key_length_ = header.shared + header.unshared;
+    value_offset_ = offset_ + header.header_length + header.unshared;
+    value_length_ = header.value_length;
+    next_offset_ = value_offset_ + value_length_;
+}
+
+void KeyBlock::Iterator::seek_to_restart(UInt32 restart) {
+    index_ = block_->restarts_[restart].index;
+    next_offset_ = block_->restarts_[restart].offset;
+    decode_next();
+}
+
+void KeyBlock::Iterator::seek_to_first() {
+    if (!block_ || block_->count_ == 0) {
+        index_ = UINT32_MAX;
+        return;
+    }
+    seek_to_restart(0);
+}
+
+void KeyBlock::Iterator::seek_to_last() {
+    if (!block_ || block_->count_ == 0) {
+        index_ = UINT32_MAX;
+        return;
+    }
+    seek_to_restart(static_cast<UInt32>(block_->restarts_.size() - 1));
+    while (index_ + 1 < block_->count_) {
+        ++index_;
+        decode_next();
+    }
+}
+
+void KeyBlock::Iterator::seek(ConstByteSpan target) {
+    if (!block_ || block_->count_ == 0) {
+        index_ = UINT32_MAX;
+        return;
+    }
+
+    const auto& restarts = block_->restarts_;
+    UInt32 lo = 0;
+    UInt32 hi = static_cast<UInt32>(restarts.size() - 1);
+    while (lo < hi) {
+        const UInt32 mid = (lo + hi + 1) / 2;
+        if (compare_keys(restart_key(block_->bytes_, restarts[mid].offset), target) < 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    seek_to_restart(lo);
+    while (valid() && compare_keys(key(), target) < 0) {
+        next();
+    }
+}
+
+void KeyBlock::Iterator::next() {
+    if (!valid()) return;
+    if (++index_ >= block_->count_) {
+        index_ = UINT32_MAX;
+        return;
+    }
+    decode_next();
+}
+
+void KeyBlock::Iterator::prev() {
+    if (!valid() || index_ == 0) {
+        index_ = UINT32_MAX;
+        return;
+    }
+    const UInt32 target = index_ - 1;
+    seek_to_restart(restart_covering(block_->restarts_, target));
+    while (index_ < target) {
+        ++index_;
+        decode_next();
+    }
+}
+
+// =============================================================================
+// KsdsIndex::Cursor
+// =============================================================================
+
+void KsdsIndex::Cursor::descend(bool leftmost) {
+    ConstNodePtr child = path_.back().node->children[path_.back().index];
+    while (!child->leaf) {
+        const UInt32 index = leftmost ? 0 : static_cast<UInt32>(child->children.size() - 1);
+        path_.push_back({child, index});
+        child = child->children[index];
+    }
+    leaf_ = std::move(child);
+    it_ = KeyBlock::Iterator(&leaf_->block);
+    if (leftmost) {
+        it_.seek_to_first();
+    } else {
+        it_.seek_to_last();
+    }
+}
+
+bool KsdsIndex::Cursor::step_leaf(bool forward) {
+    // Move to the adjacent data CI via the nearest ancestor that has one
+    while (!path_.empty()) {
+        Level& level = path_.back();
+        if (forward ? level.index + 1 < level.node->children.size() : level.index > 0) {
+            level.index = forward ? level.index + 1 : level.index - 1;
+            descend(forward);
+            return true;
+        }
+        path_.pop_back();
+    }
+    leaf_.reset();
+    return false;
+}
+
+void KsdsIndex::Cursor::next() {
+    if (!valid()) return;
+    it_.next();
+    if (!it_.valid()) step_leaf(true);
+}
+
+void KsdsIndex::Cursor::prev() {
+    if (!valid()) return;
+    it_.prev();
+    if (!it_.valid()) step_leaf(false);
+}
+
+RBA KsdsIndex::Cursor::rba() const {
+    RBA rba = INVALID_RBA;
+    std::memcpy(&rba, it_.value().data(), RBA_BYTES);
+    return rba;
+}
+
+ConstByteSpan KsdsIndex::Cursor::data() const {
+    return it_.value().subspan(RBA_BYTES);
+}
+
+VsamRecord KsdsIndex::Cursor::record() const {
+    VsamRecord rec(VsamKey(key()), data());
+    VsamAddress addr;
+    addr.rba = rba();
+    rec.set_address(addr);
+    return rec;
+}
+
+// =============================================================================
+// KsdsIndex::SortedProbe
+// =============================================================================
+
+bool KsdsIndex::SortedProbe::find(ConstByteSpan key) {
+    if (leaf_ != nullptr) {
+        // The previous key reached this CI, so this one is at or past its low
+        // key: an entry >= key here settles the probe without a descent
+        it_.seek(key);
+        if (it_.valid()) return compare_keys(it_.key(), key) == 0;
+    }
+    if (!root_ || root_->children.empty()) return false;
+    const Node* node = root_.get();
+    while (!node->leaf) {
+        node = node->children[route(*node, key)].get();
+    }
+    ++descents_;
+    leaf_ = node;
+    it_ = KeyBlock::Iterator(&leaf_->block);
+    it_.seek(key);
+    return it_.valid() && compare_keys(it_.key(), key) == 0;
+}
+
+RBA KsdsIndex::SortedProbe::rba() const {
+    RBA rba = INVALID_RBA;
+    std::memcpy(&rba, it_.value().data(), RBA_BYTES);
+    return rba;
+}
+
+ConstByteSpan KsdsIndex::SortedProbe::data() const {
+    return it_.value().subspan(RBA_BYTES);
+}
+
+// =============================================================================
+// KsdsIndex
+// =============================================================================
+
+KsdsIndex::KsdsIndex(UInt32 data_ci_size, UInt32 index_ci_size, UInt8 free_ci_percent)
+    : data_ci_size_(data_ci_size), index_ci_size_(index_ci_size)
+    , load_limit_(data_ci_size * (100 - std::min<UInt32>(free_ci_percent, 90)) / 100) {
+    clear();
+}
+
+Size KsdsIndex::occupancy(const KeyBlock& block) {
+    return block.encoded_bytes() + CIDF_LENGTH + RDF_LENGTH * block.count();
+}
+
+Size KsdsIndex::occupancy(const KeyBlock::Builder& builder) {
+    return builder.encoded_bytes() + CIDF_LENGTH + RDF_LENGTH * builder.count();
+}
+
+bool KsdsIndex::spanned(const Node& node) const {
+    return node.leaf && node.block.count() == 1 && occupancy(node.block) > data_ci_size_;
+}
+
+UInt32 KsdsIndex::segments(const Node& node) const {
+    if (!spanned(node)) return 1;
+    // Each segment has its CIDF and a segment-control RDF beside the length RDF
+    const Size payload = data_ci_size_ - CIDF_LENGTH - 2 * RDF_LENGTH;
+    return static_cast<UInt32>((node.block.encoded_bytes() + payload - 1) / payload);
+}
+
+bool KsdsIndex::needs_spanning(Size key_length, Size data_length) const {
+    const Size value = RBA_BYTES + data_length;
+    return 2 + varint_length(value) + key_length + value + RDF_LENGTH + CIDF_LENGTH > data_ci_size_;
+}
+
+void KsdsIndex::clear() {
+    layout_ = Layout{};
+    root_ = std::make_shared<Node>();
+    root_->leaf = false;
+    account(*root_, 1);
+    layout_.index_levels = 1;
+    size_ = 0;
+}
+
+void KsdsIndex::account(const Node& node, int sign) {
+    auto adjust = [sign](auto& field, auto amount) {
+        using Field = std::remove_reference_t<decltype(field)>;
+        if (sign > 0) field += static_cast<Field>(amount);
+        else field -= static_cast<Field>(amount);
+    };
+    if (node.leaf) {
+        adjust(layout_.data_cis, segments(node));
+        adjust(layout_.data_bytes, occupancy(node.block));
+        if (spanned(node)) adjust(layout_.spanned_records, 1);
+        adjust(layout_.data_key_bytes_raw, node.block.raw_key_bytes());
+        adjust(layout_.data_key_bytes_stored, node.block.stored_key_bytes());
+    } else {
+        adjust(layout_.index_cis, 1);
+        adjust(layout_.index_bytes, node.block.size_bytes());
+        adjust(layout_.index_key_bytes_raw, node.block.raw_key_bytes());
+        adjust(layout_.index_key_bytes_stored, node.block.stored_key_bytes());
+    }
+}
+
+ByteBuffer KsdsIndex::encode_value(RBA rba, ConstByteSpan data) {
+    ByteBuffer value(RBA_BYTES + data.size());
+    std::memcpy(value.data(), &rba, RBA_BYTES);
+    if (!data.empty()) std::memcpy(value.data() + RBA_BYTES, data.data(), data.size());
+    return value;
+}
+
+UInt32 KsdsIndex::route(const Node& node, ConstByteSpan key) {
+    // Child whose low key is the last one <= key; keys below the first low
+    // key can only be new and belong to the first child
+    KeyBlock::Iterator it(&node.block);
+    it.seek(key);
+    if (!it.valid()) return node.block.count() - 1;
+    if (it.index() == 0 || compare_keys(it.key(), key) == 0) return it.index();
+    return it.index() - 1;
+}
+
+const KsdsIndex::Node* KsdsIndex::find_leaf(ConstByteSpan key) const {
+    const Node* node = root_.get();
+    if (node->children.empty()) return nullptr;
+    while (!node->leaf) {
+        node = node->children[route(*node, key)].get();
+    }
+    return node;
+}
+
+KsdsIndex::Node* KsdsIndex::writable(NodePtr& node) {
+    // Anything beyond the live tree's reference is a snapshot or one of its
+    // cursors, which only ever drop references without the lock. New ones
+    // are only taken under the lock, so a count of two (the tree's and the
+    // probe) stays two. use_count() is a relaxed load, though: the fence
+    // pairs it with the releasing decrement each holder made as it let go,
+    // so every read that holder made happens before the in-place change.
+    const NodePtr probe = node;
+    if (probe.use_count() > 2) {
+        node = std::make_shared<Node>(*node);
+        ++snapshot_copies_;
+    } else {
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return node.get();
+}
+
+KsdsIndex::Node* KsdsIndex::descend(ConstByteSpan key, Path& path, bool lower_low_keys) {
+    path.clear();
+    Node* node = writable(root_);
+    while (!node->leaf) {
+        const UInt32 slot = route(*node, key);
+        if (lower_low_keys && slot == 0 && compare_keys(key, node->block.first_key()) < 0) {
+            // New lowest key under this CI: keep every low key <= its child's keys
+            account(*node, -1);
+            node->block.erase(ByteBuffer(node->block.first_key().begin(), node->block.first_key().end()));
+            node->block.insert(key, {});
+            account(*node, 1);
+        }
+        path.push_back({node, slot});
+        node = writable(node->children[slot]);
+    }
+    return node;
+}
+
+KsdsIndex::Cursor KsdsIndex::seek(const ConstNodePtr& root, ConstByteSpan key) {
+    Cursor cursor;
+    if (!root || root->children.empty()) return cursor;
+    ConstNodePtr node = root;
+    while (!node->leaf) {
+        const UInt32 slot = route(*node, key);
+        cursor.path_.push_back({node, slot});
+        node = node->children[slot];
+    }
+    cursor.leaf_ = std::move(node);
+    cursor.it_ = KeyBlock::Iterator(&cursor.leaf_->block);
+    cursor.it_.seek(key);
+    if (!cursor.it_.valid()) cursor.step_leaf(true);  // Past this CI's high key
+    return cursor;
+}
+
+KsdsIndex::Cursor KsdsIndex::first(const ConstNodePtr& root) {
+    Cursor cursor;
+    if (!root || root->children.empty()) return cursor;
+    cursor.path_.push_back({root, 0});
+    cursor.descend(true);
+    return cursor;
+}
+
+KsdsIndex::Cursor KsdsIndex::last(const ConstNodePtr& root) {
+    Cursor cursor;
+    if (!root || root->children.empty()) return cursor;
+    cursor.path_.push_back({root, static_cast<UInt32>(root->children.size() - 1)});
+    cursor.descend(false);
+    return cursor;
+}
+
+KsdsIndex::Cursor KsdsIndex::upper_bound(const ConstNodePtr& root, ConstByteSpan key) {
+    Cursor cursor = seek(root, key);
+    if (cursor.valid() && compare_keys(cursor.key(), key) == 0) {
+        cursor.next();
+    }
+    return cursor;
+}
+
+Optional<VsamRecord> KsdsIndex::find(ConstByteSpan key) const {
+    // Plain descent; no cursor path is needed for a point read
+    const Node* leaf = find_leaf(key);
+    if (!leaf) return nullopt;
+    KeyBlock::Iterator it(&leaf->block);
+    it.seek(key);
+    if (!it.valid() || compare_keys(it.key(), key) != 0) return nullopt;
+
+    RBA rba = INVALID_RBA;
+    std::memcpy(&rba, it.value().data(), RBA_BYTES);
+    VsamRecord rec(VsamKey(key), it.value().subspan(RBA_BYTES));
+    VsamAddress addr;
+    addr.rba = rba;
+    rec.set_address(addr);
+    return rec;
+}
+
+bool KsdsIndex::contains(ConstByteSpan key) const {
+    const Node* leaf = find_leaf(key);
+    if (!leaf) return false;
+    KeyBlock::Iterator it(&leaf->block);
+    it.seek(key);
+    return it.valid() && compare_keys(it.key(), key) == 0;
+}
+
+KsdsIndex::Cursor KsdsIndex::first() const {
+    return first(root_);
+}
+
+KsdsIndex::Cursor KsdsIndex::last() const {
+    return last(root_);
+}
+
+KsdsIndex::Cursor KsdsIndex::lower_bound(ConstByteSpan key) const {
+    return seek(root_, key);
+}
+
+KsdsIndex::Cursor KsdsIndex::upper_bound(ConstByteSpan key) const {
+    return upper_bound(root_, key);
+}
+
+bool KsdsIndex::insert(ConstByteSpan key, ConstByteSpan data, RBA rba) {
+    const ByteBuffer value = encode_value(rba, data);
+    if (root_->children.empty()) {
+        // Empty cluster: the first insert creates the first data CI
+        auto leaf = std::make_shared<Node>();
+        leaf->block.insert(key, value);
+        account(*leaf, 1);
+        Node* root = writable(root_);
+        account(*root, -1);
+        root->block.insert(key, {});
+        root->children.push_back(std::move(leaf));
+        account(*root, 1);
+        ++size_;
+        return true;
+    }
+
+    Path path;
+    Node* leaf = descend(key, path, true);
+    account(*leaf, -1);
+    const Optional<UInt32> index = leaf->block.insert(key, value);
+    account(*leaf, 1);
+    if (!index) return false;
+
+    ++size_;
+    if (needs_spanning(key.size(), data.size())) {
+        isolate(key);
+        return true;
+    }
+    const UInt32 count = leaf->block.count();
+    const Size limit = *index == count - 1 ? load_limit_ : data_ci_size_;
+    if (count > 1 && occupancy(leaf->block) > limit) {
+        split(path, leaf, split_point(count, *index));
+    }
+    return true;
+}
+
+bool KsdsIndex::replace(ConstByteSpan key, ConstByteSpan data) {
+    if (root_->children.empty()) return false;
+    Path path;
+    Node* leaf = descend(key, path, false);
+    KeyBlock::Iterator it(&leaf->block);
+    it.seek(key);
+    if (!it.valid() || compare_keys(it.key(), key) != 0) return false;
+
+    RBA rba = INVALID_RBA;
+    std::memcpy(&rba, it.value().data(), RBA_BYTES);
+    account(*leaf, -1);
+    leaf->block.replace(key, encode_value(rba, data));
+    account(*leaf, 1);
+    if (needs_spanning(key.size(), data.size())) {
+        isolate(key);
+    } else if (leaf->block.count() > 1 && occupancy(leaf->block) > data_ci_size_) {
+        split(path, leaf, leaf->block.count() / 2);
+    }
+    return true;
+}
+
+bool KsdsIndex::erase(ConstByteSpan key) {
+    if (root_->children.empty()) return false;
+    Path path;
+    Node* leaf = descend(key, path, false);
+    account(*leaf, -1);
+    const bool erased = leaf->block.erase(key);
+    account(*leaf, 1);
+    if (!erased) return false;
+
+    --size_;
+    if (leaf->block.empty()) {
+        unlink(path);
+        ++ci_reclaims_;
+    } else if (occupancy(leaf->block) < data_ci_size_ / 4) {
+        reclaim(path, leaf);
+    }
+    return true;
+}
+
+void KsdsIndex::split(Path& path, Node* node, UInt32 at) {
+    for (;;) {
+        auto right = std::make_shared<Node>();
+        right->leaf = node->leaf;
+        account(*node, -1);
+        right->block = node->block.split(at);
+        if (!node->leaf) {
+            right->children.assign(node->children.begin() + at, node->children.end());
+            node->children.resize(at);
+        }
+        account(*node, 1);
+        account(*right, 1);
+        if (node->leaf) {
+            ++ci_splits_;
+        } else if (node->children.front()->leaf) {
+            ++ca_splits_;  // Sequence-set CI split: the control area is full
+        }
+
+        if (path.empty()) {
+            // Root split: grow the tree by one index level
+            auto root = std::make_shared<Node>();
+            root->leaf = false;
+            root->block.insert(node->block.first_key(), {});
+            root->block.insert(right->block.first_key(), {});
+            root->children = {root_, std::move(right)};
+            account(*root, 1);
+            root_ = std::move(root);
+            ++layout_.index_levels;
+            return;
+        }
+
+        const Step step = path.back();
+        path.pop_back();
+        Node* parent = step.node;
+        account(*parent, -1);
+        parent->block.insert(right->block.first_key(), {});
+        parent->children.insert(parent->children.begin() + step.slot + 1, std::move(right));
+        account(*parent, 1);
+
+        if (parent->block.size_bytes() <= index_ci_size_ || parent->block.count() <= 2) return;
+        node = parent;
+        at = split_point(parent->block.count(), step.slot + 1);
+    }
+}
+
+void KsdsIndex::isolate(ConstByteSpan key) {
+    // A spanned record's segments hold nothing else: split off whatever
+    // shares its data CI, first the records below it, then those above
+    for (;;) {
+        Path path;
+        Node* leaf = descend(key, path, false);
+        if (leaf->block.count() <= 1) return;
+        KeyBlock::Iterator it(&leaf->block);
+        it.seek(key);
+        split(path, leaf, it.index() > 0 ? it.index() : 1);
+    }
+}
+
+bool KsdsIndex::pack(Node& parent, UInt32 slot, Size target) {
+    // Moves records from the front of children[slot + 1] onto the end of
+    // children[slot] while it stays within target; both must be writable
+    Node& left = *parent.children[slot];
+    Node& right = *parent.children[slot + 1];
+
+    KeyBlock::Builder packed;
+    KeyBlock::Iterator source(&left.block);
+    for (source.seek_to_first(); source.valid(); source.next()) packed.add(source.key(), source.value());
+    const UInt32 kept = packed.count();
+    KeyBlock::Iterator it(&right.block);
+    it.seek_to_first();
+    while (it.valid() && occupancy(packed) + entry_bound(it.key(), it.value()) <= target) {
+        packed.add(it.key(), it.value());
+        it.next();
+    }
+    if (packed.count() == kept) return false;
+    KeyBlock::Builder rest;
+    for (; it.valid(); it.next()) rest.add(it.key(), it.value());
+
+    account(left, -1);
+    account(right, -1);
+    account(parent, -1);
+    parent.block.erase(parent.block.key_at(slot + 1));
+    left.block = packed.finish();
+    right.block = rest.finish();
+    const bool emptied = right.block.empty();
+    if (emptied) {
+        parent.children.erase(parent.children.begin() + slot + 1);
+        ++ci_reclaims_;
+    } else {
+        // The right CI's low key rises to its new first record
+        parent.block.insert(right.block.first_key(), {});
+        account(right, 1);
+    }
+    account(left, 1);
+    account(parent, 1);
+    return emptied;
+}
+
+void KsdsIndex::reclaim(Path& path, Node* leaf) {
+    // CI reclaim: fold an underfull data CI into a sibling under the same
+    // sequence-set CI when both fit within the load, freeing one CI
+    if (path.empty() || spanned(*leaf)) return;
+    Node* parent = path.back().node;
+    const UInt32 slot = path.back().slot;
+    if (parent->children.size() < 2) return;
+    const UInt32 left = slot + 1 < parent->children.size() ? slot : slot - 1;
+    Node* a = writable(parent->children[left]);
+    Node* b = writable(parent->children[left + 1]);
+    if (spanned(*a) || spanned(*b)) return;
+    if (occupancy(a->block) + occupancy(b->block) - CIDF_LENGTH > load_limit_) return;
+    if (pack(*parent, left, data_ci_size_)) collapse_root();
+}
+
+UInt32 KsdsIndex::reorganize(ByteBuffer& resume, UInt32 max_cis) {
+    if (root_->children.empty()) {
+        resume.clear();
+        return 0;
+    }
+    Path path;
+    (void)descend(resume, path, false);
+    Node* parent = path.back().node;
+    UInt32 slot = path.back().slot;
+
+    // Walk this sequence-set CI's data CIs, pulling records forward into
+    // each one below the load; CIs are only made writable when repacked
+    UInt32 freed = 0;
+    for (UInt32 examined = 0; examined < max_cis && slot + 1 < parent->children.size(); ++examined) {
+        const Node& left = *parent->children[slot];
+        const Node& right = *parent->children[slot + 1];
+        if (spanned(left) || spanned(right) || occupancy(left.block) >= load_limit_) {
+            ++slot;
+            continue;
+        }
+        (void)writable(parent->children[slot]);
+        (void)writable(parent->children[slot + 1]);
+        if (pack(*parent, slot, load_limit_)) {
+            ++freed;  // Stay on this CI; it may take records from the next one too
+        } else {
+            ++slot;
+        }
+    }
+
+    if (slot + 1 < parent->children.size()) {
+        const ConstByteSpan next = parent->children[slot]->block.first_key();
+        resume.assign(next.begin(), next.end());
+    } else {
+        // On to the first data CI under the next sequence-set CI, if any
+        const ByteBuffer high = parent->children.back()->block.last_key();
+        const Cursor cursor = upper_bound(root_, high);
+        if (cursor.valid()) resume.assign(cursor.key().begin(), cursor.key().end());
+        else resume.clear();
+    }
+    if (freed > 0) collapse_root();
+    return freed;
+}
+
+void KsdsIndex::unlink(Path& path) {
+    // Free the emptied data CI, and any index CI that empties with it
+    while (!path.empty()) {
+        const Step step = path.back();
+        path.pop_back();
+        Node* parent = step.node;
+        account(*parent->children[step.slot], -1);
+        account(*parent, -1);
+        parent->block.erase(parent->block.key_at(step.slot));
+        parent->children.erase(parent->children.begin() + step.slot);
+        account(*parent, 1);
+        if (!parent->block.empty()) break;
+    }
+    collapse_root();
+}
+
+void KsdsIndex::collapse_root() {
+    // Collapse index levels that have a single index CI child
+    while (root_->children.size() == 1 && !root_->children.front()->leaf) {
+        account(*root_, -1);
+        root_ = root_->children.front();
+        --layout_.index_levels;
+    }
+    if (root_->children.empty()) layout_.index_levels = 1;
+}
+
 } // namespace cics::vsam
@@ -2,6 +2,8 @@
 #include "cics/common/types.hpp"
 #include "cics/common/threading.hpp"
 #include "cics/vsam/vsam_types.hpp"
+#include "cics/datetime/datetime.hpp"
+#include "cics/channel/channel.hpp"
 
 using namespace cics;
 using namespace cics::benchmark;
@@ -95,6 +97,53 @@ int main() {
         Benchmark::print_result(b.run([&]() { counter++; }));
     }
     
+    // Date conversion: one value at a time against the array forms
+    {
+        std::vector<datetime::AbsTime> times(1000);
+        for (Size i = 0; i < times.size(); ++i) times[i] = datetime::asktime() - static_cast<datetime::AbsTime>(i) * 86400000;
+        std::vector<datetime::PackedDate> dates(times.size());
+
+        Benchmark single("from_abstime -> packed (1000 values)", 1000);
+        Benchmark::print_result(single.run([&]() {
+            for (Size i = 0; i < times.size(); ++i) dates[i] = datetime::from_abstime(times[i]).to_packed_date();
+        }));
+
+        Benchmark batch("abstimes_to_packed_dates (1000 values)", 1000);
+        Benchmark::print_result(batch.run([&]() { (void)datetime::abstimes_to_packed_dates(times, dates); }));
+
+        std::vector<datetime::DateTime> out(dates.size());
+        Benchmark convert("convert_packed_dates (1000 values)", 1000);
+        Benchmark::print_result(convert.run([&]() { (void)datetime::convert_packed_dates(dates, out); }));
+    }
+
+    // Date formatting: the pattern interpreted per call against compiled once
+    {
+        const datetime::DateTime dt = datetime::now();
+        Benchmark per_call("DateTime::format", 100000);
+        Benchmark::print_result(per_call.run([&]() { (void)dt.format("%Y-%m-%d %H:%M:%S"); }));
+
+        const datetime::CompiledFormat compiled("%Y-%m-%d %H:%M:%S");
+        char buffer[32];
+        Benchmark compiled_run("CompiledFormat::format_to", 100000);
+        Benchmark::print_result(compiled_run.run([&]() { (void)compiled.format_to(dt, buffer); }));
+    }
+
+    // Channels: a task PUTs three containers into a new channel and
+    // deletes it, as a LINK with a channel does
+    {
+        auto& channels = channel::ChannelManager::instance();
+        channels.initialize();
+        TaskBinding task(1);
+        const char data[] = "0123456789ABCDEF";
+        Benchmark b("Channel 3 PUTs + delete", 100000);
+        Benchmark::print_result(b.run([&]() {
+            (void)channels.put_container("FIRST", "BENCH", data, 16);
+            (void)channels.put_container("SECOND", "BENCH", data, 16);
+            (void)channels.put_container("THIRD", "BENCH", data, 16);
+            (void)channels.delete_channel("BENCH");
+        }));
+    }
+    
     // Thread pool (if available)
     {
         auto& pool = threading::global_thread_pool();
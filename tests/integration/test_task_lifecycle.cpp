@@ -0,0 +1,253 @@
+#include "../framework/test_framework.hpp"
+#include "cics/cics/cics_types.hpp"
+#include "cics/cics/monitoring.hpp"
+#include "cics/abend/abend.hpp"
+#include "cics/common/task_context.hpp"
+#include "cics/tsq/tsq_types.hpp"
+#include "cics/tdq/tdq_types.hpp"
+#include "cics/storage/storage_control.hpp"
+#include "cics/task/task_control.hpp"
+#include <thread>
+
+namespace cc = cics::cics;
+using namespace cics::test;
+using cics::Result;
+using cics::UInt32;
+using cics::UInt64;
+using cics::TaskBinding;
+using cics::add_task_end_hook;
+using cics::remove_task_end_hook;
+using cics::current_task_id;
+using cics::make_success;
+using cics::Byte;
+using cics::Size;
+using cics::ConstByteSpan;
+namespace abend = cics::abend;
+
+// =============================================================================
+// Task Binding
+// =============================================================================
+
+void test_task_binding() {
+    ASSERT_EQ(current_task_id(), 0u);
+    std::vector<UInt32> ended;
+    const UInt64 hook = add_task_end_hook([&ended](UInt32 task_id) { ended.push_back(task_id); });
+    {
+        TaskBinding outer(7);
+        ASSERT_EQ(current_task_id(), 7u);
+        {
+            TaskBinding inner(8);
+            ASSERT_EQ(current_task_id(), 8u);
+        }
+        ASSERT_EQ(current_task_id(), 7u);
+        outer.end();
+        outer.end();
+        ASSERT_EQ(current_task_id(), 0u);
+    }
+    remove_task_end_hook(hook);
+    { TaskBinding unobserved(9); }
+    ASSERT_EQ(ended.size(), 2u);
+    ASSERT_EQ(ended[0], 8u);
+    ASSERT_EQ(ended[1], 7u);
+}
+
+// =============================================================================
+// Abend Handler State
+// =============================================================================
+
+void test_thread_reused_for_two_tasks() {
+    auto& abends = abend::AbendManager::instance();
+    abends.initialize();
+
+    // One worker runs both tasks back to back, as a pooled thread would
+    bool first_ok = false;
+    bool first_completed = false;
+    bool second_saw_handler = true;
+    std::thread worker([&] {
+        cc::CicsTask first(1, "TSK1");
+        first_ok = first.run([&](cc::CicsTask&) -> Result<void> {
+            abends.set_current_program("PROGA");
+            return abends.handle_abend_program("RECOVER");
+        }).is_success();
+        first_completed = first.status() == cc::TransactionStatus::COMPLETED;
+
+        cc::CicsTask second(2, "TSK2");
+        (void)second.run([&](cc::CicsTask&) -> Result<void> {
+            const abend::HandlerDefinition* handler = abends.current_handler();
+            second_saw_handler = handler != nullptr && handler->program_name == "RECOVER";
+            return make_success();
+        });
+    });
+    worker.join();
+    ASSERT_TRUE(first_ok);
+    ASSERT_TRUE(first_completed);
+    ASSERT_FALSE(second_saw_handler);
+    abends.shutdown();
+}
+
+void test_abended_task_is_ended() {
+    auto& abends = abend::AbendManager::instance();
+    abends.initialize();
+
+    cc::CicsTask first(3, "TSK3");
+    ASSERT_THROW(first.run([&](cc::CicsTask&) -> Result<void> {
+        (void)abends.handle_abend_program("RECOVER");
+        throw std::runtime_error("program failed");
+    }), std::runtime_error);
+    ASSERT_TRUE(first.status() == cc::TransactionStatus::ABENDED);
+    ASSERT_EQ(current_task_id(), 0u);
+
+    cc::CicsTask second(4, "TSK4");
+    bool clean = false;
+    (void)second.run([&](cc::CicsTask&) -> Result<void> {
+        clean = abends.current_handler() == nullptr || abends.current_handler()->program_name != "RECOVER";
+        return make_success();
+    });
+    ASSERT_TRUE(clean);
+    abends.shutdown();
+}
+
+void test_nested_task_keeps_outer_handlers() {
+    auto& abends = abend::AbendManager::instance();
+    abends.initialize();
+
+    TaskBinding outer(11);
+    ASSERT_TRUE(abends.handle_abend_program("OUTERREC").is_success());
+    {
+        // A task bound inside another starts with no handlers of its own
+        TaskBinding inner(12);
+        ASSERT_TRUE(abends.current_handler() == nullptr);
+        ASSERT_TRUE(abends.handle_abend_program("INNERREC").is_success());
+        ASSERT_EQ(abends.current_handler()->program_name, cics::String("INNERREC"));
+    }
+    // Ending it leaves the outer task's handler in place
+    ASSERT_TRUE(abends.current_handler() != nullptr);
+    ASSERT_EQ(abends.current_handler()->program_name, cics::String("OUTERREC"));
+    outer.end();
+    ASSERT_TRUE(abends.current_handler() == nullptr);
+    abends.shutdown();
+}
+
+// =============================================================================
+// Monitoring Record
+// =============================================================================
+
+namespace {
+
+// Starts the facility with a sink that keeps every record it is handed
+std::vector<cc::PerformanceRecord> run_monitored(const std::function<void()>& tasks) {
+    std::vector<Byte> written;
+    cc::MonitoringConfig config;
+    config.sink = [&written](ConstByteSpan records, Size) -> Result<void> {
+        written.insert(written.end(), records.begin(), records.end());
+        return make_success();
+    };
+    auto& facility = cc::MonitoringFacility::instance();
+    if (!facility.start(std::move(config)).is_success()) return {};
+    tasks();
+    facility.flush();
+    facility.stop();
+
+    std::vector<cc::PerformanceRecord> records;
+    for (Size off = 0; off + cc::PerformanceRecord::ENCODED_SIZE <= written.size();
+         off += cc::PerformanceRecord::ENCODED_SIZE) {
+        records.push_back(cc::PerformanceRecord::decode(
+            ConstByteSpan(written.data() + off, cc::PerformanceRecord::ENCODED_SIZE)).value());
+    }
+    return records;
+}
+
+Size index_of(cc::RequestType type) { return static_cast<Size>(type); }
+
+} // namespace
+
+void test_task_writes_monitoring_record() {
+    auto& tsq = cics::tsq::TSQManager::instance();
+    ASSERT_TRUE(tsq.initialize().is_success());
+    auto& tdq = cics::tdq::TDQManager::instance();
+    ASSERT_TRUE(tdq.initialize().is_success());
+    cics::tdq::TDQDefinition dest;
+    dest.dest_id = cics::FixedString<4>("MONQ");
+    ASSERT_TRUE(tdq.define_intrapartition(dest).is_success());
+    auto& storage = cics::storage::StorageControlManager::instance();
+    auto& tasks = cics::task::TaskControlManager::instance();
+
+    const std::vector<Byte> item(120, Byte{0x40});
+    bool body_ok = false;
+    bool reached_end = false;
+    auto records = run_monitored([&] {
+        cc::CicsTask task(41, "MONT", "T001");
+        body_ok = task.run([&](cc::CicsTask&) -> Result<void> {
+            if (!tsq.writeq("MONTSQ", item).is_success()) return make_success();
+            if (!tsq.writeq("MONTSQ", item).is_success()) return make_success();
+            if (!tsq.readq("MONTSQ", 1).is_success()) return make_success();
+            if (!tdq.writeq("MONQ", ConstByteSpan(item.data(), 50)).is_success()) return make_success();
+            if (!tdq.readq("MONQ").is_success()) return make_success();
+            auto block = storage.getmain(1000);
+            if (!block.is_success()) return make_success();
+            if (!storage.freemain(block.value()).is_success()) return make_success();
+            tasks.set_current_task_id(41);
+            const bool enqueued = tasks.enq("MONRES").is_success() && tasks.deq("MONRES").is_success();
+            tasks.set_current_task_id(0);
+            if (!enqueued) return make_success();
+            reached_end = true;
+            return make_success();
+        }).is_success();
+
+        // Work outside a task is not charged to anyone
+        (void)tsq.writeq("MONTSQ", item);
+    });
+    ASSERT_TRUE(body_ok);
+    ASSERT_TRUE(reached_end);
+    ASSERT_EQ(records.size(), 1u);
+
+    const cc::PerformanceRecord& record = records[0];
+    ASSERT_EQ(record.transaction_id.str(), "MONT");
+    ASSERT_EQ(record.terminal_id.str(), "T001");
+    ASSERT_EQ(record.task_number, 41u);
+    ASSERT_FALSE(record.abended());
+    ASSERT_GE(record.stop_us, record.start_us);
+    ASSERT_GE(record.dispatch_us, 0);
+    ASSERT_EQ(record.request_count[index_of(cc::RequestType::TS_PUT)], 2u);
+    ASSERT_EQ(record.request_bytes[index_of(cc::RequestType::TS_PUT)], 240u);
+    ASSERT_EQ(record.request_count[index_of(cc::RequestType::TS_GET)], 1u);
+    ASSERT_EQ(record.request_bytes[index_of(cc::RequestType::TS_GET)], 120u);
+    ASSERT_EQ(record.request_count[index_of(cc::RequestType::TD_PUT)], 1u);
+    ASSERT_EQ(record.request_bytes[index_of(cc::RequestType::TD_PUT)], 50u);
+    ASSERT_EQ(record.request_count[index_of(cc::RequestType::TD_GET)], 1u);
+    ASSERT_EQ(record.getmain_count, 1u);
+    ASSERT_GE(record.getmain_bytes, 1000u);
+    ASSERT_GE(record.storage_peak, 1000u);
+
+    (void)tsq.deleteq("MONTSQ");
+    (void)tdq.delete_destination("MONQ");
+}
+
+void test_abended_task_record() {
+    auto records = run_monitored([] {
+        cc::CicsTask task(42, "ABND");
+        try {
+            (void)task.run([](cc::CicsTask&) -> Result<void> { throw std::runtime_error("program failed"); });
+        } catch (const std::runtime_error&) {
+        }
+    });
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].task_number, 42u);
+    ASSERT_EQ(records[0].abend_code.str(), "????");
+    ASSERT_EQ(records[0].total_requests(), 0u);
+}
+
+int main() {
+    TestSuite suite("Task Lifecycle Tests");
+
+    suite.add_test("Task Binding", test_task_binding);
+    suite.add_test("Thread Reused For Two Tasks", test_thread_reused_for_two_tasks);
+    suite.add_test("Nested Task Keeps Outer Handlers", test_nested_task_keeps_outer_handlers);
+    suite.add_test("Abended Task Is Ended", test_abended_task_is_ended);
+    suite.add_test("Task Writes Monitoring Record", test_task_writes_monitoring_record);
+    suite.add_test("Abended Task Record", test_abended_task_record);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
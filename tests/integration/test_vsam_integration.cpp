@@ -1,6 +1,9 @@
 #include "../framework/test_framework.hpp"
 #include "cics/vsam/vsam_types.hpp"
+#include "cics/vsam/shared_data_table.hpp"
 #include "cics/catalog/master_catalog.hpp"
+#include "cics/syncpoint/syncpoint.hpp"
+#include <thread>
 
 using namespace cics;
 using namespace cics::vsam;
@@ -118,12 +121,516 @@ void test_catalog_vsam_integration() {
     ASSERT_TRUE(del_result.is_success());
 }
 
+void test_vsam_record_locking() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.LOCK.FILE";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    
+    auto file = create_vsam_file(def, "");
+    file->open(AccessMode::IO, ProcessingMode::DYNAMIC);
+    for (int i = 1; i <= 3; i++) {
+        ByteBuffer data = {'O', 'L', 'D'};
+        file->write(VsamRecord(VsamKey(std::format("LCK{:03d}", i)), ConstByteSpan(data.data(), data.size())));
+    }
+    
+    VsamKey key("LCK002");
+    auto locked = file->read_for_update(key);
+    ASSERT_TRUE(locked.is_success());
+    ASSERT_NE(locked.value().token, INVALID_UPDATE_TOKEN);
+    ASSERT_TRUE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    
+    // Another task is refused while the record is held, even for a plain read-for-update
+    ErrorCode other_task = ErrorCode::SUCCESS;
+    std::thread([&] {
+        RecordLockOptions nosuspend;
+        nosuspend.wait = false;
+        auto result = file->read_for_update(key, nosuspend);
+        other_task = result.is_error() ? result.error().code : ErrorCode::SUCCESS;
+    }).join();
+    ASSERT_EQ(other_task, ErrorCode::VSAM_RECORD_BUSY);
+    
+    // The token belongs to this task only, and REWRITE may not change the key
+    ByteBuffer data = {'N', 'E', 'W'};
+    auto moved = file->rewrite(locked.value().token, VsamRecord(VsamKey("LCK003"), ConstByteSpan(data.data(), data.size())));
+    ASSERT_TRUE(moved.is_error());
+    ASSERT_EQ(moved.error().code, ErrorCode::VSAM_KEY_CHANGE);
+    
+    // A waiting task gets the record as soon as the REWRITE releases it
+    std::thread waiter([&] {
+        auto result = file->read_for_update(key);
+        if (result.is_success()) {
+            auto rec = result.value().record;
+            other_task = rec.span()[0] == 'N' ? ErrorCode::SUCCESS : ErrorCode::VSAM_ERROR;
+            file->unlock(result.value().token);
+        } else {
+            other_task = result.error().code;
+        }
+    });
+    auto rewritten = file->rewrite(locked.value().token, VsamRecord(key, ConstByteSpan(data.data(), data.size())));
+    ASSERT_TRUE(rewritten.is_success());
+    waiter.join();
+    ASSERT_EQ(other_task, ErrorCode::SUCCESS);
+    ASSERT_FALSE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    
+    // A spent token is rejected
+    ASSERT_TRUE(file->unlock(locked.value().token).is_error());
+    
+    // DELETE through a token removes the record and frees the lock
+    auto for_delete = file->read_for_update(VsamKey("LCK001"));
+    ASSERT_TRUE(for_delete.is_success());
+    ASSERT_TRUE(file->erase(for_delete.value().token).is_success());
+    ASSERT_EQ(file->record_count(), 2u);
+    ASSERT_FALSE(RecordLockTable::instance().is_locked(def.cluster_name, VsamKey("LCK001").span()));
+    
+    file->close();
+}
+
+void test_record_lock_deadlock() {
+    auto& locks = RecordLockTable::instance();
+    const String file = "TEST.DEADLOCK";
+    VsamKey first("KEYA"), second("KEYB");
+    const LockOwner task_a = 101, task_b = 102;
+    
+    ASSERT_TRUE(locks.acquire(file, first.span(), task_a).is_success());
+    ASSERT_TRUE(locks.acquire(file, second.span(), task_b).is_success());
+    
+    // Task A waits on B's record; B asking for A's record would close the cycle
+    const UInt64 waits_before = locks.statistics().waits.get();
+    std::thread waiter([&] { (void)locks.acquire(file, second.span(), task_a); });
+    while (locks.statistics().waits.get() == waits_before) std::this_thread::yield();
+    
+    auto deadlocked = locks.acquire(file, first.span(), task_b);
+    ASSERT_TRUE(deadlocked.is_error());
+    ASSERT_EQ(deadlocked.error().code, ErrorCode::VSAM_DEADLOCK);
+    
+    // Releasing B's locks lets A through
+    ASSERT_EQ(locks.release_all(task_b), 1u);
+    waiter.join();
+    ASSERT_EQ(locks.held_count(task_a), 2u);
+    ASSERT_EQ(locks.release_all(task_a), 2u);
+    ASSERT_FALSE(locks.is_locked(file, first.span()));
+    
+    // A bounded wait gives up with RECORD_BUSY
+    ASSERT_TRUE(locks.acquire(file, first.span(), task_a).is_success());
+    RecordLockOptions timed;
+    timed.timeout = Milliseconds(20);
+    auto timed_out = locks.acquire(file, first.span(), task_b, timed);
+    ASSERT_TRUE(timed_out.is_error());
+    ASSERT_EQ(timed_out.error().code, ErrorCode::VSAM_RECORD_BUSY);
+    locks.release_all(task_a);
+}
+
+void test_record_lock_syncpoint() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.LOCK.RECOVERABLE";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    def.recovery = true;
+    
+    auto file = create_vsam_file(def, "");
+    file->open(AccessMode::IO, ProcessingMode::DYNAMIC);
+    ByteBuffer data = {'O', 'L', 'D'};
+    file->write(VsamRecord(VsamKey("REC001"), ConstByteSpan(data.data(), data.size())));
+    
+    auto& syncpoint = syncpoint::SyncpointManager::instance();
+    syncpoint.initialize();
+    ASSERT_TRUE(syncpoint.begin_uow().is_success());
+    
+    // A recoverable file keeps the lock past REWRITE, until SYNCPOINT
+    VsamKey key("REC001");
+    auto rewritten = file->read_for_update(key);
+    ASSERT_TRUE(rewritten.is_success());
+    ASSERT_TRUE(file->rewrite(rewritten.value().token, rewritten.value().record).is_success());
+    ASSERT_TRUE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    
+    // A token never presented is dropped along with its lock
+    auto abandoned = file->read_for_update(key);
+    ASSERT_TRUE(abandoned.is_success());
+    ASSERT_TRUE(syncpoint.syncpoint().is_success());
+    ASSERT_FALSE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    auto stale = file->rewrite(abandoned.value().token, abandoned.value().record);
+    ASSERT_TRUE(stale.is_error());
+    ASSERT_EQ(stale.error().code, ErrorCode::VSAM_INVALID_REQUEST);
+    
+    file->close();
+    syncpoint.shutdown();
+}
+
+void test_record_lock_default_timeout() {
+    auto& locks = RecordLockTable::instance();
+    const String file = "TEST.LOCK.TIMEOUT";
+    const VsamKey key("KEY001");
+    const LockOwner holder = 301;
+    const LockOwner waiter = 302;
+    
+    // With no timeout of its own a wait is still bounded by the table's
+    locks.set_default_timeout(Milliseconds(20));
+    ASSERT_TRUE(locks.acquire(file, key.span(), holder).is_success());
+    auto timed_out = locks.acquire(file, key.span(), waiter);
+    ASSERT_TRUE(timed_out.is_error());
+    ASSERT_EQ(timed_out.error().code, ErrorCode::VSAM_RECORD_BUSY);
+    ASSERT_EQ(locks.release_all(holder), 1u);
+    ASSERT_EQ(locks.held_count(waiter), 0u);
+    locks.set_default_timeout(RecordLockTable::DEFAULT_TIMEOUT);
+}
+
+void test_unkeyed_update_lock() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.LOCK.UNKEYED";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    
+    auto file = create_vsam_file(def, "");
+    file->open(AccessMode::IO, ProcessingMode::DYNAMIC);
+    ByteBuffer data = {'O', 'L', 'D'};
+    file->write(VsamRecord(VsamKey("UNK001"), ConstByteSpan(data.data(), data.size())));
+    
+    // An update of a record this task holds does not touch the lock
+    VsamKey key("UNK001");
+    auto locked = file->read_for_update(key);
+    ASSERT_TRUE(locked.is_success());
+    ByteBuffer changed = {'N', 'E', 'W'};
+    ASSERT_TRUE(file->update(VsamRecord(key, ConstByteSpan(changed.data(), changed.size()))).is_success());
+    ASSERT_TRUE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    
+    // Another task's update gives up long before the table default
+    ErrorCode other_task = ErrorCode::SUCCESS;
+    auto waited = Milliseconds(0);
+    std::thread([&] {
+        const auto start = std::chrono::steady_clock::now();
+        auto result = file->update(VsamRecord(key, ConstByteSpan(data.data(), data.size())));
+        waited = std::chrono::duration_cast<Milliseconds>(std::chrono::steady_clock::now() - start);
+        other_task = result.is_error() ? result.error().code : ErrorCode::SUCCESS;
+    }).join();
+    ASSERT_EQ(other_task, ErrorCode::VSAM_RECORD_BUSY);
+    ASSERT_TRUE(waited < RecordLockTable::DEFAULT_TIMEOUT / 10);
+    
+    ASSERT_TRUE(file->unlock(locked.value().token).is_success());
+    ASSERT_FALSE(RecordLockTable::instance().is_locked(def.cluster_name, key.span()));
+    ASSERT_TRUE(file->erase(key).is_success());
+    ASSERT_EQ(file->record_count(), 0u);
+    file->close();
+}
+
+void test_shared_data_table() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.SDT.FILE";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    
+    // Records already in the source are loaded at open
+    auto source = create_vsam_file(def, "");
+    source->open(AccessMode::IO, ProcessingMode::DYNAMIC);
+    for (int i = 1; i <= 100; i++) {
+        String data_str = std::format("Reference {}", i);
+        ByteBuffer data(data_str.begin(), data_str.end());
+        source->write(VsamRecord(VsamKey(std::format("REF{:03d}", i)), ConstByteSpan(data.data(), data.size())));
+    }
+    source->close();
+    
+    SharedDataTable table(std::move(source));
+    ASSERT_TRUE(table.open(AccessMode::IO).is_success());
+    ASSERT_EQ(table.record_count(), 100u);
+    ASSERT_EQ(table.table_statistics().loads.get(), 1u);
+    
+    auto rec = table.read(VsamKey("REF042"));
+    ASSERT_TRUE(rec.is_success());
+    ASSERT_EQ(String(reinterpret_cast<const char*>(rec.value().data()), rec.value().length()), "Reference 42");
+    ASSERT_TRUE(table.read(VsamKey("REF999")).is_error());
+    ASSERT_EQ(table.table_statistics().hits.get(), 1u);
+    ASSERT_EQ(table.table_statistics().misses.get(), 1u);
+    
+    // A reader holding a Table keeps its view while writes publish new ones
+    auto before = table.table();
+    ByteBuffer changed = {'C', 'H', 'A', 'N', 'G', 'E', 'D'};
+    ASSERT_TRUE(table.update(VsamRecord(VsamKey("REF042"), ConstByteSpan(changed.data(), changed.size()))).is_success());
+    ASSERT_TRUE(table.write(VsamRecord(VsamKey("REF101"), ConstByteSpan(changed.data(), changed.size()))).is_success());
+    ASSERT_TRUE(table.erase(VsamKey("REF001")).is_success());
+    
+    ASSERT_EQ(before->size(), 100u);
+    ASSERT_EQ(before->find(VsamKey("REF042").span())->data.size(), 12u);
+    ASSERT_EQ(table.record_count(), 100u);
+    ASSERT_EQ(table.table()->find(VsamKey("REF042").span())->data.size(), changed.size());
+    ASSERT_TRUE(table.table()->find(VsamKey("REF101").span()) != nullptr);
+    ASSERT_TRUE(table.table()->find(VsamKey("REF001").span()) == nullptr);
+    ASSERT_EQ(table.source().record_count(), 100u);
+    
+    // Rows stay in key order for scans
+    auto rows = table.table()->rows();
+    for (Size i = 1; i < rows.size(); i++) {
+        ASSERT_LT(compare_keys(rows[i - 1].key, rows[i].key), 0);
+    }
+    
+    // READ UPDATE / DELETE by token go through to the source
+    auto locked = table.read_for_update(VsamKey("REF050"));
+    ASSERT_TRUE(locked.is_success());
+    ASSERT_TRUE(table.erase(locked.value().token).is_success());
+    ASSERT_FALSE(table.lookup(VsamKey("REF050").span(), [](const SharedDataTable::Row&) {}));
+    
+    table.close();
+}
+
+void test_shared_data_table_many_writes() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.SDT.WRITES";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    
+    auto table = create_shared_data_table(def, "");
+    ASSERT_TRUE(table->open(AccessMode::IO).is_success());
+    auto record = [](int i, StringView text) {
+        return VsamRecord(VsamKey(std::format("K{:05d}", i)),
+                          ConstByteSpan(reinterpret_cast<const Byte*>(text.data()), text.size()));
+    };
+    
+    // Enough writes to fold the change list into a new base several times
+    constexpr int RECORDS = 2000;
+    for (int i = 0; i < RECORDS; i++) ASSERT_TRUE(table->write(record(i, "FIRST")).is_success());
+    for (int i = 0; i < RECORDS; i += 2) ASSERT_TRUE(table->update(record(i, "SECOND!")).is_success());
+    for (int i = 0; i < RECORDS; i += 5) ASSERT_TRUE(table->erase(VsamKey(std::format("K{:05d}", i))).is_success());
+    ASSERT_TRUE(table->write(record(0, "BACK")).is_success());
+    
+    const auto& stats = table->table_statistics();
+    ASSERT_GT(stats.merges.get(), 3u);
+    ASSERT_LT(stats.merges.get(), stats.publishes.get() / 20);
+    
+    auto current = table->table();
+    ASSERT_EQ(current->size(), table->source().record_count());
+    ASSERT_LE(current->pending_changes(), 64u);
+    for (int i = 0; i < RECORDS; i++) {
+        const auto* row = current->find(VsamKey(std::format("K{:05d}", i)).span());
+        if (i == 0) {
+            ASSERT_TRUE(row != nullptr);
+            ASSERT_EQ(row->data.size(), 4u);
+        } else if (i % 5 == 0) {
+            ASSERT_TRUE(row == nullptr);
+        } else {
+            ASSERT_TRUE(row != nullptr);
+            ASSERT_EQ(row->data.size(), i % 2 == 0 ? 7u : 5u);
+        }
+    }
+    auto rows = current->rows();
+    ASSERT_EQ(rows.size(), current->size());
+    for (Size i = 1; i < rows.size(); i++) {
+        ASSERT_LT(compare_keys(rows[i - 1].key, rows[i].key), 0);
+    }
+    table->close();
+}
+
+void test_shared_data_table_reload_race() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.SDT.RELOAD";
+    def.type = VsamType::KSDS;
+    def.key_length = 6;
+    def.ci_size = 4096;
+    
+    auto table = create_shared_data_table(def, "");
+    ASSERT_TRUE(table->open(AccessMode::IO).is_success());
+    
+    // A reload that overlaps writes must not publish a table missing them
+    constexpr int RECORDS = 500;
+    std::atomic<bool> writing{true};
+    std::thread reloader([&] {
+        while (writing.load()) (void)table->reload();
+    });
+    ByteBuffer data = {'D', 'A', 'T', 'A'};
+    for (int i = 0; i < RECORDS; i++) {
+        table->write(VsamRecord(VsamKey(std::format("R{:05d}", i)), ConstByteSpan(data.data(), data.size())));
+    }
+    writing.store(false);
+    reloader.join();
+    
+    ASSERT_EQ(table->record_count(), static_cast<UInt64>(RECORDS));
+    for (int i = 0; i < RECORDS; i++) {
+        ASSERT_TRUE(table->table()->find(VsamKey(std::format("R{:05d}", i)).span()) != nullptr);
+    }
+    table->close();
+}
+
+void test_ksds_space_management() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.KSDS.SPACE";
+    def.type = VsamType::KSDS;
+    def.key_length = 8;
+    def.ci_size = 1024;
+    def.ca_size = 10;
+    
+    auto file = create_vsam_file(def, "");
+    ASSERT_TRUE(file->open(AccessMode::IO, ProcessingMode::DYNAMIC).is_success());
+    ByteBuffer data(100, 0x40);
+    for (int i = 0; i < 400; i++) {
+        VsamRecord rec(VsamKey(std::format("KEY{:05d}", i)), ConstByteSpan(data.data(), data.size()));
+        ASSERT_TRUE(file->write(rec).is_success());
+    }
+    const auto& stats = file->statistics();
+    ASSERT_GT(stats.allocated_bytes, 0u);
+    ASSERT_LE(stats.used_bytes.get(), stats.allocated_bytes);
+    ASSERT_GT(stats.space_utilization(), 50.0);
+    
+    // Longer than a CI: only a SPANNED cluster takes it
+    ByteBuffer big(3000, 0x5A);
+    VsamRecord big_rec(VsamKey("KEY00100X"), ConstByteSpan(big.data(), big.size()));
+    ASSERT_TRUE(file->write(big_rec).is_error());
+    
+    for (int i = 0; i < 400; i++) {
+        if (i % 4 != 0) ASSERT_TRUE(file->erase(VsamKey(std::format("KEY{:05d}", i))).is_success());
+    }
+    const UInt32 cis = stats.ci_count;
+    auto reorg = file->reorganize({.cis_per_step = 4, .step_pause = Milliseconds(0)});
+    ASSERT_TRUE(reorg.is_success());
+    ASSERT_GT(reorg.value().steps, 1u);
+    ASSERT_GE(reorg.value().utilization_after, reorg.value().utilization_before);
+    ASSERT_EQ(stats.ci_count, cis - reorg.value().cis_freed);
+    ASSERT_EQ(file->record_count(), 100u);
+    ASSERT_TRUE(file->read(VsamKey("KEY00200")).is_success());
+    file->close();
+    
+    def.cluster_name = "TEST.KSDS.SPANNED";
+    def.spanned_records = true;
+    auto spanned = create_vsam_file(def, "");
+    ASSERT_TRUE(spanned->open(AccessMode::IO, ProcessingMode::DYNAMIC).is_success());
+    ASSERT_TRUE(spanned->write(big_rec).is_success());
+    ASSERT_EQ(spanned->read(VsamKey("KEY00100X")).value().length(), big.size());
+    ASSERT_EQ(spanned->statistics().spanned_records, 1u);
+    ASSERT_TRUE(spanned->start_background_reorg({.check_interval = Milliseconds(1)}).is_success());
+    spanned->close();
+}
+
+void test_ksds_batch_read() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.KSDS.BATCH";
+    def.type = VsamType::KSDS;
+    def.key_length = 8;
+    
+    auto file = create_vsam_file(def, "");
+    ASSERT_TRUE(file->open(AccessMode::IO, ProcessingMode::DYNAMIC).is_success());
+    for (int i = 0; i < 5000; i++) {
+        String data = std::format("RECORD-{:05d}", i);
+        VsamRecord rec(VsamKey(std::format("KEY{:05d}", i)), ConstByteSpan(reinterpret_cast<const Byte*>(data.data()), data.size()));
+        ASSERT_TRUE(file->write(rec).is_success());
+    }
+    
+    // Unsorted probes, some missing, one into a short buffer
+    std::vector<VsamKey> keys;
+    for (int i = 0; i < 6000; i++) keys.emplace_back(std::format("KEY{:05d}", (i * 7919) % 6000));
+    std::vector<std::array<Byte, 16>> buffers(keys.size());
+    std::vector<BatchReadItem> items(keys.size());
+    for (Size i = 0; i < items.size(); i++) items[i].into = ByteSpan(buffers[i]);
+    items[0].into = ByteSpan(buffers[0]).first(4);
+    
+    auto result = file->read_batch(keys, items, {.keys_per_thread = 1000, .max_threads = 4});
+    ASSERT_TRUE(result.is_success());
+    ASSERT_EQ(result.value().threads, 4u);
+    ASSERT_EQ(result.value().found, 5000u);
+    ASSERT_EQ(result.value().not_found, 1000u);
+    ASSERT_EQ(result.value().truncated, 1u);
+    ASSERT_LT(result.value().descents, 5000u);
+    for (Size i = 1; i < keys.size(); i++) {
+        const int n = static_cast<int>((i * 7919) % 6000);
+        if (n >= 5000) {
+            ASSERT_TRUE(items[i].status == ErrorCode::VSAM_RECORD_NOT_FOUND);
+            continue;
+        }
+        ASSERT_TRUE(items[i].status == ErrorCode::SUCCESS);
+        ASSERT_EQ(String(reinterpret_cast<const char*>(buffers[i].data()), items[i].length),
+                  std::format("RECORD-{:05d}", n));
+    }
+    ASSERT_TRUE(items[0].status == ErrorCode::BUFFER_OVERFLOW);
+    ASSERT_EQ(items[0].length, 12u);
+    
+    ASSERT_TRUE(file->read_batch(std::span(keys).first(2), std::span(items).first(1)).is_error());
+    file->close();
+}
+
+void test_ksds_browse_batch() {
+    VsamDefinition def;
+    def.cluster_name = "TEST.KSDS.BRBATCH";
+    def.type = VsamType::KSDS;
+    def.key_length = 8;
+    
+    auto file = create_vsam_file(def, "");
+    ASSERT_TRUE(file->open(AccessMode::IO, ProcessingMode::DYNAMIC).is_success());
+    for (int i = 0; i < 3000; i++) {
+        String data = std::format("RECORD-{:05d}", i);
+        VsamRecord rec(VsamKey(std::format("KEY{:05d}", i)), ConstByteSpan(reinterpret_cast<const Byte*>(data.data()), data.size()));
+        ASSERT_TRUE(file->write(rec).is_success());
+    }
+    
+    // Batches return exactly what READNEXT would, interleaved with it
+    auto single = file->start_browse(VsamKey("KEY00000"), true, false);
+    auto batched = file->start_browse(VsamKey("KEY00000"), true, false);
+    ASSERT_TRUE(single.is_success() && batched.is_success());
+    std::array<Byte, 1000> buffer{};
+    std::vector<BrowseBatchItem> items(64);
+    Size total = 0;
+    bool end = false;
+    while (!end) {
+        auto batch = file->read_next_batch(batched.value(), buffer, items);
+        ASSERT_TRUE(batch.is_success());
+        ASSERT_LE(batch.value().bytes, buffer.size());
+        for (UInt32 i = 0; i < batch.value().records; i++) {
+            auto rec = file->read_next(single.value());
+            ASSERT_TRUE(rec.is_success());
+            const auto& item = items[i];
+            ASSERT_EQ(String(reinterpret_cast<const char*>(buffer.data() + item.offset), item.key_length),
+                      rec.value().key().to_string());
+            ASSERT_EQ(String(reinterpret_cast<const char*>(buffer.data() + item.offset + item.key_length), item.length),
+                      String(reinterpret_cast<const char*>(rec.value().data()), rec.value().length()));
+            ASSERT_EQ(item.rba, rec.value().rba());
+        }
+        total += batch.value().records;
+        end = batch.value().end_of_file;
+        if (total == 100) {
+            ASSERT_TRUE(file->read_next(batched.value()).is_success());
+            ASSERT_TRUE(file->read_next(single.value()).is_success());
+            total++;
+        }
+    }
+    ASSERT_TRUE(file->read_next(single.value()).is_error());
+    ASSERT_TRUE(file->read_next_batch(batched.value(), buffer, items).is_error());
+    ASSERT_GE(total, 2999u);
+    
+    // A record bigger than the buffer is reported and left in place
+    auto small = file->start_browse(VsamKey("KEY00010"), true, false);
+    std::array<Byte, 8> tiny{};
+    auto overflow = file->read_next_batch(small.value(), tiny, items);
+    ASSERT_TRUE(overflow.is_error());
+    ASSERT_TRUE(overflow.error().code == ErrorCode::BUFFER_OVERFLOW);
+    auto after = file->read_next_batch(small.value(), buffer, std::span(items).first(1));
+    ASSERT_TRUE(after.is_success());
+    ASSERT_EQ(after.value().records, 1u);
+    // READNEXT after STARTBR moves off the start record, as read_next does
+    ASSERT_EQ(String(reinterpret_cast<const char*>(buffer.data()), items[0].key_length), String("KEY00011"));
+    
+    file->end_browse(single.value());
+    file->end_browse(batched.value());
+    file->end_browse(small.value());
+    file->close();
+}
+
 int main() {
     TestSuite suite("VSAM Integration Tests");
     
     suite.add_test("KSDS File Operations", test_ksds_file_operations);
     suite.add_test("VSAM Browse", test_vsam_browse);
     suite.add_test("Catalog-VSAM Integration", test_catalog_vsam_integration);
+    suite.add_test("VSAM Record Locking", test_vsam_record_locking);
+    suite.add_test("Record Lock Deadlock", test_record_lock_deadlock);
+    suite.add_test("Record Lock Syncpoint", test_record_lock_syncpoint);
+    suite.add_test("Record Lock Default Timeout", test_record_lock_default_timeout);
+    suite.add_test("Unkeyed Update Lock", test_unkeyed_update_lock);
+    suite.add_test("Shared Data Table", test_shared_data_table);
+    suite.add_test("Shared Data Table Many Writes", test_shared_data_table_many_writes);
+    suite.add_test("Shared Data Table Reload Race", test_shared_data_table_reload_race);
+    suite.add_test("KSDS Space Management", test_ksds_space_management);
+    suite.add_test("KSDS Batch Read", test_ksds_batch_read);
+    suite.add_test("KSDS Browse Batch", test_ksds_browse_batch);
     
     TestRunner runner;
     runner.add_suite(&suite);
@@ -0,0 +1,10 @@
+// A loadable program for the program library tests; built once per
+// TEST_PROGRAM_VERSION so NEWCOPY has a second copy to pick up
+#include <cstdint>
+
+extern "C" std::int32_t testpgm(void* commarea, std::uint32_t commarea_length) {
+    if (commarea != nullptr && commarea_length > 0) {
+        static_cast<char*>(commarea)[0] = static_cast<char>('0' + TEST_PROGRAM_VERSION);
+    }
+    return TEST_PROGRAM_VERSION;
+}
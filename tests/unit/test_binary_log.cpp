@@ -0,0 +1,324 @@
+#include "../framework/test_framework.hpp"
+#include "cics/common/binary_log.hpp"
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace cics;
+using namespace cics::logging;
+using namespace cics::test;
+
+namespace {
+
+// A log file of its own, removed with the test
+struct LogFile {
+    Path path;
+
+    explicit LogFile(StringView test)
+        : path(std::filesystem::temp_directory_path() / std::format("cics-blog-{}-{}.blog", test, ::getpid())) {
+        std::filesystem::remove(path);
+    }
+    ~LogFile() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+BinaryLogConfig file_config(const Path& path, Size buffer_size = 64 * 1024) {
+    BinaryLogConfig config;
+    config.sink = binary_log_file_sink(path).value();
+    config.buffer_size = buffer_size;
+    config.flush_interval = Milliseconds(10000);
+    return config;
+}
+
+UInt32 register_format(StringView format) {
+    return FormatRegistry::instance().add(LogLevel::INFO, format, std::source_location::current());
+}
+
+std::vector<String> messages(const Path& path) {
+    std::vector<String> out;
+    auto lines = read_binary_log(path);
+    if (lines.is_error()) return out;
+    for (const auto& line : lines.value()) out.push_back(line.message);
+    return out;
+}
+
+// Frames written by hand, as the writer lays them out on this host
+struct FrameBuilder {
+    std::vector<Byte> bytes;
+
+    // Magic, format version 1, byte order, then padding to 16 bytes
+    FrameBuilder() : bytes(16, 0) {
+        std::memcpy(bytes.data(), "CBLG", 4);
+        const UInt16 version = 1;
+        std::memcpy(bytes.data() + 4, &version, sizeof(version));
+        bytes[6] = std::endian::native == std::endian::little ? 1 : 2;
+    }
+
+    template<typename T>
+    void put(const T& value) {
+        const auto* raw = reinterpret_cast<const Byte*>(&value);
+        bytes.insert(bytes.end(), raw, raw + sizeof(T));
+    }
+
+    void put(StringView text) { bytes.insert(bytes.end(), text.begin(), text.end()); }
+
+    void session() {
+        bytes.push_back(0);
+        put(UInt64{0});
+    }
+
+    void format(UInt32 id, StringView text) {
+        bytes.push_back(1);
+        put(id);
+        put(static_cast<UInt8>(LogLevel::WARN));
+        put(UInt32{7});
+        put(static_cast<UInt16>(5));
+        put(StringView("x.cpp"));
+        put(static_cast<UInt32>(text.size()));
+        put(text);
+    }
+
+    void record(UInt32 format_id, Int64 arg) {
+        bytes.push_back(2);
+        put(UInt32{1});
+        put(static_cast<UInt32>(BinaryLog::RECORD_HEADER_SIZE + 1 + 8));
+        put(format_id);
+        put(UInt64{0});
+        put(BinaryArgType::INT);
+        put(arg);
+    }
+
+    void save(const Path& path) const {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+};
+
+} // namespace
+
+// =============================================================================
+// Writing
+// =============================================================================
+
+void test_round_trip() {
+    LogFile file("round-trip");
+    auto& log = BinaryLog::instance();
+    ASSERT_TRUE(log.start(file_config(file.path)).is_success());
+
+    const String name = "ACCOUNTS";
+    const Int32 delta = -12;
+    CICS_BLOG(LogLevel::INFO, "READ {} key {} took {:.1f}us", name, 42u, 1.26);
+    CICS_BLOG(LogLevel::WARN, "delta {} found {} code {}", delta, true, 'Q');
+    CICS_BLOG(LogLevel::DBG, "no arguments");
+    log.set_level(LogLevel::INFO);
+    CICS_BLOG(LogLevel::DBG, "below the level {}", 1);
+    log.stop();
+    ASSERT_EQ(log.statistics().written.get(), 3u);
+
+    auto lines = read_binary_log(file.path);
+    ASSERT_TRUE(lines.is_success());
+    ASSERT_EQ(lines.value().size(), 3u);
+    const auto& first = lines.value()[0];
+    ASSERT_EQ(first.message, String("READ ACCOUNTS key 42 took 1.3us"));
+    ASSERT_TRUE(first.level == LogLevel::INFO);
+    ASSERT_TRUE(first.file.find("test_binary_log.cpp") != String::npos);
+    ASSERT_NE(first.line, 0u);
+    ASSERT_NE(first.thread, 0u);
+    ASSERT_EQ(lines.value()[1].message, String("delta -12 found true code Q"));
+    ASSERT_TRUE(lines.value()[1].level == LogLevel::WARN);
+    ASSERT_EQ(lines.value()[2].message, String("no arguments"));
+
+    // A second session appends to the same file
+    ASSERT_TRUE(log.start(file_config(file.path)).is_success());
+    CICS_BLOG(LogLevel::INFO, "again {}", 2);
+    log.stop();
+    auto all = messages(file.path);
+    ASSERT_EQ(all.size(), 4u);
+    ASSERT_EQ(all[3], String("again 2"));
+}
+
+void test_ring_wrap() {
+    LogFile file("wrap");
+    BinaryLog log;
+    ASSERT_TRUE(log.start(file_config(file.path, 4096)).is_success());
+    const UInt32 id = register_format("{} {}");
+
+    // 121-byte lines: the 34th would cross the end of the buffer, so the
+    // rest of it is skipped behind a zero size
+    const String body(91, 'w');
+    UInt32 n = 0;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 30; ++i) log.log(id, n++, body);
+        log.flush();
+    }
+
+    log.stop();
+    ASSERT_EQ(log.statistics().dropped.get(), 0u);
+
+    // A 4094-byte line leaves 2 bytes at the end: too few for the marker
+    BinaryLog tight;
+    ASSERT_TRUE(tight.start(file_config(file.path, 4096)).is_success());
+    const String filler(4094 - BinaryLog::RECORD_HEADER_SIZE - 9 - 5, 'f');
+    tight.log(id, n++, filler);
+    tight.flush();
+    tight.log(id, n++, String("after"));
+    tight.stop();
+    ASSERT_EQ(tight.statistics().written.get(), 2u);
+
+    auto lines = messages(file.path);
+    ASSERT_EQ(lines.size(), static_cast<Size>(n));
+    for (UInt32 i = 0; i < 150; ++i) {
+        ASSERT_EQ(lines[i], std::format("{} {}", i, body));
+    }
+    ASSERT_EQ(lines[150], std::format("150 {}", filler));
+    ASSERT_EQ(lines[151], String("151 after"));
+}
+
+void test_drops_when_full() {
+    // The writer is held in the sink, so nothing drains
+    std::atomic<bool> hold{true};
+    std::atomic<int> calls{0};
+    BinaryLogConfig config;
+    config.buffer_size = 4096;
+    config.sink = [&hold, &calls](ConstByteSpan) -> Result<void> {
+        ++calls;
+        while (hold.load()) std::this_thread::yield();
+        return make_success();
+    };
+    BinaryLog log;
+    ASSERT_TRUE(log.start(std::move(config)).is_success());
+    while (calls.load() == 0) std::this_thread::yield();
+
+    const UInt32 id = register_format("{} {}");
+    const String body(91, 'd');
+    for (UInt32 i = 0; i < 100; ++i) log.log(id, i, body);
+    ASSERT_EQ(log.statistics().dropped.get(), 67u);
+
+    hold = false;
+    log.stop();
+    ASSERT_EQ(log.statistics().written.get(), 33u);
+    ASSERT_EQ(log.statistics().sink_errors.get(), 0u);
+}
+
+void test_stop_while_logging() {
+    LogFile file("stop");
+    BinaryLog log;
+    ASSERT_TRUE(log.start(file_config(file.path)).is_success());
+    const UInt32 id = register_format("{} {}");
+
+    // Every line is either in the file or counted as dropped, however close
+    // to stop() it was logged; a thread's last call may find logging stopped
+    constexpr UInt32 threads = 4;
+    std::atomic<UInt64> logged{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (UInt32 t = 0; t < threads; ++t) {
+        workers.emplace_back([&log, &logged, &go, id, t] {
+            while (!go.load()) std::this_thread::yield();
+            for (UInt32 i = 0; log.active(); ++i) {
+                log.log(id, t, i);
+                ++logged;
+            }
+        });
+    }
+    go = true;
+    while (logged.load() < 20000) std::this_thread::yield();
+    log.stop();
+    for (auto& worker : workers) worker.join();
+
+    const Size in_file = messages(file.path).size();
+    ASSERT_EQ(static_cast<UInt64>(in_file), log.statistics().written.get());
+    const UInt64 counted = log.statistics().written.get() + log.statistics().dropped.get();
+    ASSERT_LE(counted, logged.load());
+    ASSERT_GE(counted + threads, logged.load());
+}
+
+// =============================================================================
+// Decoding
+// =============================================================================
+
+void test_render_format() {
+    const std::vector<BinaryArg> args{Int64{-7}, UInt64{255}, 3.14159, true, 'z', String("text")};
+    ASSERT_EQ(render_format("{} {} {} {} {} {}", args), String("-7 255 3.14159 true z text"));
+    ASSERT_EQ(render_format("[{:>4}|{:<6}|{:^8}]", {Int64{42}, String("ab"), String("mid")}),
+              String("[  42|ab    |  mid   ]"));
+    ASSERT_EQ(render_format("{:x} {:08.3f} {:+}", {UInt64{255}, 2.5, Int64{3}}), String("ff 0002.500 +3"));
+
+    // Positional indices, mixed with specs, and used more than once
+    ASSERT_EQ(render_format("{1} {0} {1}", {String("a"), String("b")}), String("b a b"));
+    ASSERT_EQ(render_format("{2:>3}{0:x}", {UInt64{10}, UInt64{0}, Int64{5}}), String("  5a"));
+
+    // Escapes, too few arguments, and a spec that does not fit the value
+    ASSERT_EQ(render_format("{{{}}}", {Int64{1}}), String("{1}"));
+    ASSERT_EQ(render_format("{} {}", {Int64{1}}), String("1 {?}"));
+    ASSERT_EQ(render_format("{:d}", {String("abc")}), String("abc"));
+    ASSERT_EQ(render_format("open {", {}), String("open {"));
+}
+
+void test_session_resets_formats() {
+    LogFile file("session");
+    FrameBuilder frames;
+    frames.session();
+    frames.format(1, "first {}");
+    frames.record(1, 10);
+
+    // A new session's ids start over: id 1 means nothing until redefined
+    frames.session();
+    frames.record(1, 20);
+    frames.format(1, "second {}");
+    frames.record(1, 30);
+    frames.save(file.path);
+
+    auto lines = read_binary_log(file.path);
+    ASSERT_TRUE(lines.is_success());
+    ASSERT_EQ(lines.value().size(), 3u);
+    ASSERT_EQ(lines.value()[0].message, String("first 10"));
+    ASSERT_TRUE(lines.value()[0].level == LogLevel::WARN);
+    ASSERT_EQ(lines.value()[1].message, String("<format 1 not in log>"));
+    ASSERT_EQ(lines.value()[2].message, String("second 30"));
+
+    // A frame cut short ends the log without failing it
+    frames.record(1, 40);
+    frames.bytes.resize(frames.bytes.size() - 3);
+    frames.save(file.path);
+    ASSERT_EQ(messages(file.path).size(), 3u);
+}
+
+void test_foreign_byte_order() {
+    LogFile file("order");
+    FrameBuilder frames;
+    frames.session();
+    frames.bytes[6] = static_cast<Byte>(frames.bytes[6] == 1 ? 2 : 1);
+    frames.save(file.path);
+
+    auto lines = read_binary_log(file.path);
+    ASSERT_TRUE(lines.is_error());
+    ASSERT_TRUE(lines.error().code == ErrorCode::NOT_SUPPORTED);
+
+    // Nor is one appended to
+    auto sink = binary_log_file_sink(file.path);
+    ASSERT_TRUE(sink.is_error());
+    ASSERT_TRUE(sink.error().code == ErrorCode::NOT_SUPPORTED);
+}
+
+int main() {
+    TestSuite suite("Binary Log Tests");
+
+    suite.add_test("Round Trip", test_round_trip);
+    suite.add_test("Ring Wrap", test_ring_wrap);
+    suite.add_test("Drops When Full", test_drops_when_full);
+    suite.add_test("Stop While Logging", test_stop_while_logging);
+    suite.add_test("Render Format", test_render_format);
+    suite.add_test("Session Resets Formats", test_session_resets_formats);
+    suite.add_test("Foreign Byte Order", test_foreign_byte_order);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
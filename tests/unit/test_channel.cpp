@@ -0,0 +1,136 @@
+#include "../framework/test_framework.hpp"
+#include "cics/channel/channel.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace cics;
+using namespace cics::channel;
+using namespace cics::test;
+
+namespace {
+
+ChannelManager& channels() {
+    auto& manager = ChannelManager::instance();
+    manager.initialize();
+    return manager;
+}
+
+String get_string(StringView container, StringView channel) {
+    auto data = channels().get_container(container, channel);
+    if (data.is_error()) return "<" + data.error().message + ">";
+    return String(reinterpret_cast<const char*>(data.value().data()), data.value().size());
+}
+
+} // namespace
+
+// =============================================================================
+// Task Scope
+// =============================================================================
+
+void test_task_isolation() {
+    auto& manager = channels();
+
+    // Two tasks run one after the other on the same (pooled) thread
+    {
+        TaskBinding task(101);
+        ASSERT_TRUE(exec_cics_put_container_channel("DATA", "ORDERS", ByteBuffer{'o', 'n', 'e'}).is_success());
+        ASSERT_EQ(get_string("DATA", "ORDERS"), String("one"));
+    }
+    {
+        TaskBinding task(102);
+        ASSERT_FALSE(manager.has_channel("ORDERS"));
+        ASSERT_TRUE(manager.get_channel("ORDERS").is_error());
+    }
+
+    // A task bound inside another sees only its own channels
+    {
+        TaskBinding outer(103);
+        ASSERT_TRUE(manager.create_channel("OUTER").is_success());
+        manager.set_current_channel("OUTER");
+        {
+            TaskBinding inner(104);
+            ASSERT_FALSE(manager.has_channel("OUTER"));
+            ASSERT_TRUE(manager.current_channel() == nullptr);
+        }
+        ASSERT_TRUE(manager.has_channel("OUTER"));
+        ASSERT_EQ(manager.current_channel_name(), String("OUTER"));
+    }
+
+    // Tasks on different threads using the same channel name
+    std::atomic<int> own_data{0};
+    auto run_task = [&own_data](UInt32 task_id, String value) {
+        TaskBinding task(task_id);
+        for (int i = 0; i < 1000; ++i) {
+            (void)exec_cics_put_container("ITEM", "WORK", value.data(), static_cast<UInt32>(value.size()));
+            if (get_string("ITEM", "WORK") != value) return;
+        }
+        ++own_data;
+    };
+    std::thread first(run_task, 105, String("first"));
+    std::thread second(run_task, 106, String("second"));
+    first.join();
+    second.join();
+    ASSERT_EQ(own_data.load(), 2);
+}
+
+void test_pooled_container_reuse() {
+    auto& manager = channels();
+    {
+        TaskBinding task(201);
+        ByteBuffer large(1000, 'x');
+        ASSERT_TRUE(exec_cics_put_container_channel("BIG", "POOL", large).is_success());
+        ASSERT_TRUE(exec_cics_delete_container("BIG", "POOL").is_success());
+        // Left behind for the end hook
+        ASSERT_TRUE(exec_cics_put_container_channel("LEFT", "POOL", ByteBuffer{'l'}).is_success());
+    }
+
+    // The next task on the thread takes the pooled channel and containers,
+    // with nothing of the last task's left in them
+    TaskBinding task(202);
+    auto channel = manager.create_channel("FRESH");
+    ASSERT_TRUE(channel.is_success());
+    ASSERT_EQ(channel.value()->container_count(), 0u);
+    ASSERT_TRUE(exec_cics_put_container("NEW", "FRESH", "abc", 3).is_success());
+    ASSERT_EQ(get_string("NEW", "FRESH"), String("abc"));
+    auto info = channel.value()->list_container_info();
+    ASSERT_EQ(info.size(), 1u);
+    ASSERT_EQ(info[0].name, String("NEW"));
+    ASSERT_EQ(info[0].size, 3u);
+    ASSERT_FALSE(manager.has_channel("POOL"));
+}
+
+void test_shutdown_ends_every_scope() {
+    auto& manager = channels();
+    ASSERT_TRUE(manager.create_channel("UNBOUND").is_success());
+
+    std::atomic<int> stage{0};
+    std::atomic<bool> kept_after_shutdown{true};
+    std::thread worker([&] {
+        TaskBinding task(301);
+        (void)manager.create_channel("RUNNING");
+        stage = 1;
+        while (stage != 2) std::this_thread::yield();
+        kept_after_shutdown = manager.has_channel("RUNNING");
+    });
+    while (stage != 1) std::this_thread::yield();
+
+    manager.shutdown();
+    manager.initialize();
+    stage = 2;
+    worker.join();
+
+    ASSERT_FALSE(kept_after_shutdown.load());
+    ASSERT_FALSE(manager.has_channel("UNBOUND"));
+}
+
+int main() {
+    TestSuite suite("Channel Tests");
+
+    suite.add_test("Task Isolation", test_task_isolation);
+    suite.add_test("Pooled Container Reuse", test_pooled_container_reuse);
+    suite.add_test("Shutdown Ends Every Scope", test_shutdown_ends_every_scope);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
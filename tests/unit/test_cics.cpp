@@ -1,5 +1,14 @@
 #include "../framework/test_framework.hpp"
 #include "cics/cics/cics_types.hpp"
+#include "cics/cics/transaction_router.hpp"
+#include "cics/cics/monitoring.hpp"
+#include "cics/cics/command_dispatch.hpp"
+#include "cics/cics/file_control.hpp"
+#include "cics/program/program_control.hpp"
+#include "cics/tdq/tdq_types.hpp"
+#include "cics/task/task_control.hpp"
+#include <atomic>
+#include <thread>
 
 namespace cc = cics::cics;
 using cics::String;
@@ -25,6 +34,33 @@ void test_commarea() {
     ASSERT_EQ(comm.length(), 50u);
 }
 
+void test_commarea_in_place() {
+    cc::Commarea comm;
+    comm.set_string(0, "REQUEST", 10);
+    const cics::Byte* storage = comm.data();
+    comm.set_value<uint32_t>(20000, 42);
+    comm.resize(30000);
+    ASSERT_TRUE(comm.data() == storage);  // Allocated once at full length
+    ASSERT_EQ(comm.get_value<uint32_t>(20000), 42u);
+    comm.set_value<uint32_t>(32766, 1);   // Past the capacity
+    ASSERT_EQ(comm.length(), 30000u);
+    
+    // A LINK passes the caller's storage down; the callee's changes land there
+    std::array<cics::Byte, 64> caller{};
+    cc::Commarea linked(cics::ByteSpan(caller), 8);
+    ASSERT_TRUE(linked.borrowed());
+    ASSERT_EQ(linked.capacity(), 64u);
+    linked.set_string(8, "REPLY", 8);
+    ASSERT_EQ(linked.length(), 16u);
+    ASSERT_EQ(std::string(reinterpret_cast<const char*>(caller.data()) + 8, 5), "REPLY");
+    linked.resize(100);
+    ASSERT_EQ(linked.length(), 64u);
+    
+    cc::Commarea copy = linked;
+    ASSERT_FALSE(copy.borrowed());
+    ASSERT_EQ(copy.get_string(8, 5), "REPLY");
+}
+
 void test_transaction_definition() {
     cc::TransactionDefinition txn("MENU", "MENUPGM");
     ASSERT_EQ(txn.priority, 100);  // Default priority is 100
@@ -62,17 +98,383 @@ void test_command_names() {
     ASSERT_FALSE(name.empty());
 }
 
+void test_router_load_balancing() {
+    cc::TransactionRouterConfig config;
+    config.sample_interval = Milliseconds(0);
+    cc::TransactionRouter router(config);
+
+    cc::RegionLoad busy{9, 0, 10, 0, 0, true};
+    cc::RegionLoad idle{2, 0, 10, 0, 0, true};
+    router.add_region("CICA", [&] { return busy; });
+    router.add_region("CICB", [&] { return idle; });
+    ASSERT_FALSE(router.add_region("CICA", [&] { return busy; }).is_success());
+
+    auto decision = router.route("PAY1");
+    ASSERT_TRUE(decision.is_success());
+    ASSERT_EQ(decision.value().sysid, String("CICB"));
+
+    // A region at MAXTASK loses to one with headroom, however slow
+    idle.active_tasks = 10;
+    busy.completed = 10;
+    busy.total_response_ms = 5000;
+    ASSERT_EQ(router.route("PAY1").value().sysid, String("CICA"));
+    ASSERT_EQ(router.statistics().at_maxtask.get(), 0u);
+
+    // Every region full still routes; none available does not
+    busy.active_tasks = 10;
+    ASSERT_TRUE(router.route("PAY1").is_success());
+    ASSERT_EQ(router.statistics().at_maxtask.get(), 1u);
+    busy.available = idle.available = false;
+    auto rejected = router.route("PAY1");
+    ASSERT_FALSE(rejected.is_success());
+    ASSERT_EQ(rejected.error().code, cics::ErrorCode::SYSIDERR);
+}
+
+void test_router_spreads_between_samples() {
+    cc::TransactionRouterConfig config;
+    config.sample_interval = Milliseconds(60000);
+    cc::TransactionRouter router(config);
+    router.add_region("CICA", [] { return cc::RegionLoad{0, 0, 100, 0, 0, true}; });
+    router.add_region("CICB", [] { return cc::RegionLoad{0, 0, 100, 0, 0, true}; });
+
+    // Routed-but-unfinished work counts until the next sample
+    std::vector<cc::RouteDecision> decisions;
+    for (int i = 0; i < 40; ++i) decisions.push_back(router.route("INQ1").value());
+    for (const auto& region : router.regions()) ASSERT_EQ(region.routed, 20u);
+
+    for (const auto& d : decisions) {
+        if (d.sysid == "CICA") router.complete(d);
+    }
+    ASSERT_EQ(router.route("INQ1").value().sysid, String("CICA"));
+}
+
+void test_router_affinity() {
+    cc::TransactionRouter router;
+    cc::RegionLoad a{0, 0, 10, 0, 0, true};
+    router.add_region("CICA", [&] { return a; });
+    router.add_region("CICB", [] { return cc::RegionLoad{5, 0, 10, 0, 0, true}; });
+
+    auto first = router.route("ORD1", "T001").value();
+    ASSERT_EQ(first.sysid, String("CICA"));
+    ASSERT_FALSE(first.affinity);
+    for (int i = 0; i < 10; ++i) router.route("ORD1");
+
+    auto next = router.route("ORD2", "T001").value();
+    ASSERT_EQ(next.sysid, String("CICA"));
+    ASSERT_TRUE(next.affinity);
+    ASSERT_EQ(router.affinity_count(), 1u);
+
+    // Losing the region breaks the pseudo-conversation rather than moving it
+    router.remove_region("CICA");
+    ASSERT_EQ(router.route("ORD2", "T001").error().code, cics::ErrorCode::SYSIDERR);
+    router.end_affinity("T001");
+    ASSERT_EQ(router.route("ORD1", "T001").value().sysid, String("CICB"));
+}
+
+void test_statistics_probe_queue() {
+    auto& tasks = cics::task::TaskControlManager::instance();
+    cc::CicsStatistics stats;
+    auto probe = cc::statistics_probe(stats, 10);
+    ASSERT_EQ(probe().queued_tasks, 0u);
+
+    // An attach held at the admission gate counts as queued until let in
+    std::atomic<bool> open{false};
+    tasks.set_admission_check([&open] { return open.load(); }, Milliseconds(5000));
+    std::atomic<bool> attached{false};
+    std::thread attach([&] {
+        auto task = tasks.create_task(FixedString<4>("QUE1"));
+        attached = task.is_success();
+        if (task.is_success()) (void)tasks.end_task(task.value());
+    });
+    while (probe().queued_tasks == 0) std::this_thread::yield();
+    ASSERT_EQ(probe().queued_tasks, 1u);
+
+    open = true;
+    tasks.notify_admission();
+    attach.join();
+    tasks.set_admission_check(nullptr);
+    ASSERT_TRUE(attached.load());
+    ASSERT_EQ(probe().queued_tasks, 0u);
+}
+
+void test_monitoring_record() {
+    cc::TaskMonitor monitor;
+    monitor.dispatch_begin();
+    monitor.add_request(cc::RequestType::FILE_READ, 200);
+    monitor.add_request(cc::RequestType::FILE_READ, 300);
+    monitor.add_request(cc::RequestType::TS_PUT, 80);
+    monitor.add_getmain(4096);
+    monitor.add_freemain(4096);
+    monitor.add_getmain(1024);
+    monitor.add_wait(cc::WaitType::ENQ, Milliseconds(3));
+    { auto wait = monitor.wait(cc::WaitType::FILE_IO); }
+    monitor.set_abend_code("ASRA");
+
+    cc::PerformanceRecord record = monitor.finish();
+    record.transaction_id = FixedString<4>("PAY1");
+    record.task_number = 42;
+    ASSERT_EQ(record.request_count[0], 2u);
+    ASSERT_EQ(record.request_bytes[0], 500u);
+    ASSERT_EQ(record.getmain_bytes, 5120u);
+    ASSERT_EQ(record.storage_peak, 4096u);
+    ASSERT_EQ(record.wait_us[0], 3000);
+    ASSERT_EQ(record.wait_count[1], 1u);
+    ASSERT_GE(record.response_us(), 0);
+
+    std::array<cics::Byte, cc::PerformanceRecord::ENCODED_SIZE> encoded{};
+    record.encode(encoded.data());
+    auto decoded = cc::PerformanceRecord::decode(encoded).value();
+    ASSERT_EQ(decoded.transaction_id, record.transaction_id);
+    ASSERT_EQ(decoded.task_number, 42u);
+    ASSERT_EQ(decoded.abend_code.trimmed(), String("ASRA"));
+    ASSERT_EQ(decoded.request_bytes, record.request_bytes);
+    ASSERT_EQ(decoded.wait_us, record.wait_us);
+    ASSERT_EQ(decoded.stop_us, record.stop_us);
+    ASSERT_FALSE(cc::PerformanceRecord::decode(cics::ConstByteSpan(encoded.data(), 10)).is_success());
+}
+
+void test_monitoring_facility() {
+    std::vector<cics::Byte> written;
+    cics::Size batches = 0;
+    cc::MonitoringConfig config;
+    config.sink = [&](cics::ConstByteSpan records, cics::Size) -> cics::Result<void> {
+        written.insert(written.end(), records.begin(), records.end());
+        ++batches;
+        return cics::make_success();
+    };
+    config.ring_capacity = 8;
+    config.batch_records = 4;
+    auto& facility = cc::MonitoringFacility::instance();
+    ASSERT_TRUE(facility.start(std::move(config)).is_success());
+
+    for (UInt32 i = 1; i <= 6; ++i) {
+        cc::CicsTask task(i, i % 2 ? "INQ1" : "UPD1");
+        task.monitor().add_request(cc::RequestType::FILE_WRITE, 100);
+        ASSERT_TRUE(task.write_monitoring_record());
+    }
+    facility.flush();
+    facility.stop();
+    ASSERT_FALSE(facility.active());
+    ASSERT_EQ(written.size(), 6 * cc::PerformanceRecord::ENCODED_SIZE);
+    ASSERT_GE(batches, 2u);
+
+    std::vector<cc::PerformanceRecord> records;
+    for (cics::Size off = 0; off < written.size(); off += cc::PerformanceRecord::ENCODED_SIZE) {
+        records.push_back(cc::PerformanceRecord::decode(
+            cics::ConstByteSpan(written.data() + off, cc::PerformanceRecord::ENCODED_SIZE)).value());
+    }
+    auto summaries = cc::summarize_records(records, cc::ReportOrder::TASKS);
+    ASSERT_EQ(summaries.size(), 2u);
+    ASSERT_EQ(summaries[0].tasks, 3u);
+    ASSERT_EQ(summaries[0].request_bytes[1], 300u);
+    ASSERT_FALSE(cc::format_report(summaries).empty());
+}
+
+void test_translated_command() {
+    cc::CommandDispatcher dispatcher;
+    std::unordered_map<String, std::shared_ptr<String>> files;
+    files["CUSTFILE"] = std::make_shared<String>("customer record");
+    int lookups = 0;
+    dispatcher.register_resolver(cc::ResourceType::FILE, [&](cics::StringView name) -> cics::SharedPtr<void> {
+        ++lookups;
+        auto it = files.find(String(name));
+        return it != files.end() ? it->second : nullptr;
+    });
+    dispatcher.register_handler(cc::CicsCommand::READ,
+        [](cc::CicsTask&, const cc::ResolvedCommand& cmd, cc::CommandArgs& args) {
+            const String& data = *cmd.resource_as<String>();
+            args.returned_length = static_cast<UInt32>(data.size());
+            return cc::CicsResponse::NORMAL;
+        });
+
+    cc::CommandOptions options;
+    options.file = FixedString<8>("CUSTFILE");
+    cc::TranslatedCommand read_cust(cc::CicsCommand::READ, options, dispatcher);
+    cc::CicsTask task(1, "INQ1");
+    for (int i = 0; i < 100; ++i) {
+        cc::CommandArgs args;
+        ASSERT_EQ(read_cust.execute(task, args), cc::CicsResponse::NORMAL);
+        ASSERT_EQ(args.returned_length, 15u);
+    }
+    ASSERT_EQ(lookups, 1);
+    ASSERT_EQ(task.eib().eibrsrce.trimmed(), String("CUSTFILE"));
+    ASSERT_EQ(task.eib().eibfn.trimmed(), String("READ"));
+
+    // A discarded resource is noticed on the next execution
+    files.erase("CUSTFILE");
+    dispatcher.invalidate();
+    ASSERT_FALSE(read_cust.translated());
+    ASSERT_EQ(read_cust.execute(task), cc::CicsResponse::FILENOTFOUND);
+    ASSERT_EQ(task.eib().eibresp, cc::CicsResponse::FILENOTFOUND);
+    files["CUSTFILE"] = std::make_shared<String>("new");
+    ASSERT_EQ(read_cust.execute(task), cc::CicsResponse::NORMAL);
+    ASSERT_TRUE(read_cust.translated());
+    ASSERT_EQ(lookups, 3);
+}
+
+void test_command_validation() {
+    cc::CommandOptions options;
+    ASSERT_FALSE(cc::validate_options(cc::CicsCommand::READ, options).is_success());
+    options.file = FixedString<8>("CUSTFILE");
+    ASSERT_TRUE(cc::validate_options(cc::CicsCommand::READ, options).is_success());
+    options.rba = options.rrn = true;
+    ASSERT_FALSE(cc::validate_options(cc::CicsCommand::READ, options).is_success());
+    options.rba = options.rrn = false;
+    options.update = true;
+    ASSERT_FALSE(cc::validate_options(cc::CicsCommand::WRITE, options).is_success());
+    ASSERT_EQ(cc::command_resource_type(cc::CicsCommand::LINK), cc::ResourceType::PROGRAM);
+    ASSERT_EQ(cc::command_resource_type(cc::CicsCommand::ASKTIME), cc::ResourceType::NONE);
+
+    cc::CommandDispatcher dispatcher;
+    cc::TranslatedCommand write(cc::CicsCommand::WRITE, options, dispatcher);
+    cc::CicsTask task(1, "UPD1");
+    ASSERT_EQ(write.execute(task), cc::CicsResponse::INVREQ);
+    ASSERT_EQ(dispatcher.statistics().translation_failures.get(), 1u);
+}
+
+namespace {
+
+cc::CommandArgs from_args(const String& from, cics::ConstByteSpan ridfld = {}) {
+    cc::CommandArgs args;
+    args.ridfld = ridfld;
+    args.from = from.data();
+    args.length = static_cast<UInt32>(from.size());
+    return args;
+}
+
+cc::CommandArgs into_args(char* into, UInt32 capacity, UInt32 item = 0) {
+    cc::CommandArgs args;
+    args.into = into;
+    args.length = capacity;
+    args.item = item;
+    return args;
+}
+
+} // namespace
+
+void test_standard_commands() {
+    cc::CicsTask task(1, "STD1");
+
+    // Files: installed, opened and discarded through the file control table
+    cics::vsam::VsamDefinition def;
+    def.cluster_name = "TEST.DISPATCH.KSDS";
+    def.type = cics::vsam::VsamType::KSDS;
+    def.key_length = 4;
+    def.ci_size = 4096;
+    auto& files = cc::FileControl::instance();
+    ASSERT_TRUE(files.install("DSPFILE", cics::vsam::create_vsam_file(def, "")).is_success());
+    ASSERT_TRUE(files.open("DSPFILE").is_success());
+
+    cc::CommandOptions file_options;
+    file_options.file = FixedString<8>("DSPFILE");
+    cc::TranslatedCommand write(cc::CicsCommand::WRITE, file_options);
+    cc::TranslatedCommand read(cc::CicsCommand::READ, file_options);
+    const String key = "K001";
+    const String data = "record one";
+    const cics::ConstByteSpan ridfld(reinterpret_cast<const cics::Byte*>(key.data()), key.size());
+    ASSERT_EQ(write.execute(task, from_args(data, ridfld)), cc::CicsResponse::NORMAL);
+    char into[32] = {};
+    cc::CommandArgs read_args = into_args(into, sizeof into);
+    read_args.ridfld = ridfld;
+    ASSERT_EQ(read.execute(task, read_args), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(String(into, read_args.returned_length), data);
+    ASSERT_EQ(write.execute(task, from_args(data, ridfld)), cc::CicsResponse::DUPREC);
+
+    // Closing is a resource change, and the closed file answers NOTOPEN
+    ASSERT_TRUE(files.close("DSPFILE").is_success());
+    ASSERT_FALSE(read.translated());
+    ASSERT_EQ(read.execute(task, read_args), cc::CicsResponse::NOTOPEN);
+    ASSERT_TRUE(files.discard("DSPFILE").is_success());
+    ASSERT_EQ(read.execute(task, read_args), cc::CicsResponse::FILENOTFOUND);
+
+    // Programs: LINK passes INTO as the COMMAREA
+    auto& programs = cics::program::ProgramControlManager::instance();
+    cc::CommandOptions link_options;
+    link_options.program = FixedString<8>("DSPPGM");
+    cc::TranslatedCommand link(cc::CicsCommand::LINK, link_options);
+    ASSERT_EQ(link.execute(task), cc::CicsResponse::PGMIDERR);
+    ASSERT_TRUE(programs.define_program("DSPPGM", [](void* commarea, UInt32 length) -> cics::Int32 {
+        if (commarea != nullptr && length > 0) static_cast<char*>(commarea)[0] = 'X';
+        return 0;
+    }).is_success());
+    char commarea[4] = {'a', 'b', 'c', 'd'};
+    cc::CommandArgs link_args = into_args(commarea, sizeof commarea);
+    ASSERT_EQ(link.execute(task, link_args), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(commarea[0], 'X');
+    ASSERT_TRUE(programs.undefine_program("DSPPGM").is_success());
+    ASSERT_EQ(link.execute(task), cc::CicsResponse::PGMIDERR);
+
+    // TS queues: WRITEQ creates the queue, READQ reads by item
+    cc::CommandOptions ts_options;
+    ts_options.queue = FixedString<16>("DSPTSQ");
+    cc::TranslatedCommand writeq_ts(cc::CicsCommand::WRITEQ_TS, ts_options);
+    cc::TranslatedCommand readq_ts(cc::CicsCommand::READQ_TS, ts_options);
+    cc::TranslatedCommand deleteq_ts(cc::CicsCommand::DELETEQ_TS, ts_options);
+    cc::CommandArgs ts_write = from_args(data);
+    ASSERT_EQ(writeq_ts.execute(task, ts_write), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(ts_write.item, 1u);
+    char small[4] = {};
+    cc::CommandArgs ts_read = into_args(small, sizeof small, 1);
+    ASSERT_EQ(readq_ts.execute(task, ts_read), cc::CicsResponse::LENGERR);
+    ASSERT_EQ(ts_read.returned_length, 10u);
+    ASSERT_EQ(readq_ts.execute(task, into_args(small, sizeof small, 2)), cc::CicsResponse::ITEMERR);
+    ASSERT_EQ(deleteq_ts.execute(task), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(readq_ts.execute(task, into_args(small, sizeof small)), cc::CicsResponse::QIDERR);
+
+    // TD queues: defining and deleting a destination re-translates
+    auto& tdq = cics::tdq::TDQManager::instance();
+    ASSERT_TRUE(tdq.initialize().is_success());
+    cc::CommandOptions td_options;
+    td_options.queue = FixedString<16>("DSPQ");
+    cc::TranslatedCommand writeq_td(cc::CicsCommand::WRITEQ_TD, td_options);
+    cc::TranslatedCommand readq_td(cc::CicsCommand::READQ_TD, td_options);
+    ASSERT_EQ(writeq_td.execute(task, from_args(data)), cc::CicsResponse::QIDERR);
+    cics::tdq::TDQDefinition dest;
+    dest.dest_id = FixedString<4>("DSPQ");
+    ASSERT_TRUE(tdq.define_intrapartition(dest).is_success());
+    ASSERT_EQ(writeq_td.execute(task, from_args(data)), cc::CicsResponse::NORMAL);
+    char td_into[16] = {};
+    cc::CommandArgs td_read = into_args(td_into, sizeof td_into);
+    ASSERT_EQ(readq_td.execute(task, td_read), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(String(td_into, td_read.returned_length), data);
+    ASSERT_EQ(readq_td.execute(task, td_read), cc::CicsResponse::QZERO);
+    ASSERT_TRUE(tdq.delete_destination("DSPQ").is_success());
+    ASSERT_EQ(readq_td.execute(task, td_read), cc::CicsResponse::QIDERR);
+
+    // ENQ and DEQ name the resource in RIDFLD
+    const String resource = "DSPRES";
+    const cics::ConstByteSpan enq_ridfld(reinterpret_cast<const cics::Byte*>(resource.data()), resource.size());
+    cc::TranslatedCommand enq(cc::CicsCommand::ENQ, {});
+    cc::TranslatedCommand deq(cc::CicsCommand::DEQ, {});
+    cc::CommandArgs enq_args;
+    enq_args.ridfld = enq_ridfld;
+    cics::task::TaskControlManager::instance().set_current_task_id(1);
+    ASSERT_EQ(enq.execute(task, enq_args), cc::CicsResponse::NORMAL);
+    ASSERT_EQ(deq.execute(task, enq_args), cc::CicsResponse::NORMAL);
+    cics::task::TaskControlManager::instance().set_current_task_id(0);
+}
+
 int main() {
     ::cics::test::TestSuite suite("CICS Tests");
     
     suite.add_test("EIB Basic", test_eib_basic);
     suite.add_test("Commarea", test_commarea);
+    suite.add_test("Commarea In Place", test_commarea_in_place);
     suite.add_test("TransactionDefinition", test_transaction_definition);
     suite.add_test("ProgramDefinition", test_program_definition);
     suite.add_test("CicsTask", test_cics_task);
     suite.add_test("CicsStatistics", test_cics_statistics);
     suite.add_test("Response Names", test_response_names);
     suite.add_test("Command Names", test_command_names);
+    suite.add_test("Router Load Balancing", test_router_load_balancing);
+    suite.add_test("Router Spreads Between Samples", test_router_spreads_between_samples);
+    suite.add_test("Router Affinity", test_router_affinity);
+    suite.add_test("Statistics Probe Queue", test_statistics_probe_queue);
+    suite.add_test("Monitoring Record", test_monitoring_record);
+    suite.add_test("Monitoring Facility", test_monitoring_facility);
+    suite.add_test("Translated Command", test_translated_command);
+    suite.add_test("Command Validation", test_command_validation);
+    suite.add_test("Standard Commands", test_standard_commands);
     
     ::cics::test::TestRunner runner;
     runner.add_suite(&suite);
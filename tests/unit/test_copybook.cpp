@@ -0,0 +1,468 @@
+#include "../framework/test_framework.hpp"
+#include "cics/copybook/copybook.hpp"
+#include "cics/copybook/copybook_cache.hpp"
+#include "cics/copybook/json_transform.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace cics;
+using namespace cics::copybook;
+using namespace cics::test;
+
+namespace {
+
+CopybookDefinition parse(StringView source) {
+    CopybookParser parser;
+    auto result = parser.parse(source);
+    ASSERT_TRUE(result.is_success());
+    return std::move(result.value());
+}
+
+const CopybookField& field(const CopybookDefinition& copybook, StringView name) {
+    const CopybookField* found = copybook.find_field(name);
+    if (!found) throw std::runtime_error("No field " + String(name));
+    return *found;
+}
+
+} // namespace
+
+// =============================================================================
+// Parser
+// =============================================================================
+
+void test_picture_period() {
+    // The period ending an entry belongs to the entry, not the picture
+    auto copybook = parse(
+        "       01  REC.\n"
+        "           05  ID       PIC 9(6).\n"
+        "           05  NAME     PIC X(20).\n");
+    ASSERT_EQ(field(copybook, "ID").picture.raw_picture, "9(6)");
+    ASSERT_EQ(field(copybook, "ID").size, 6);
+    ASSERT_EQ(field(copybook, "NAME").offset, 6u);
+    ASSERT_EQ(copybook.record_length, 26u);
+
+    // An insertion period inside an edited picture is kept
+    auto edited = parse("       01  AMOUNT   PIC ZZ9.99.\n");
+    ASSERT_EQ(edited.fields[0]->picture.raw_picture, "ZZ9.99");
+}
+
+void test_group_sizes() {
+    auto copybook = parse(
+        "       01  REC.\n"
+        "           05  ADDR.\n"
+        "               10  STREET   PIC X(10).\n"
+        "               10  CITY     PIC X(8).\n"
+        "           05  ORDERS OCCURS 3 TIMES.\n"
+        "               10  ORDER-NO PIC 9(4).\n"
+        "               10  AMOUNT   PIC S9(5)V99.\n"
+        "           05  TRAILER      PIC X(2).\n");
+    ASSERT_EQ(field(copybook, "ADDR").size, 18);
+    ASSERT_EQ(field(copybook, "CITY").offset, 10u);
+    ASSERT_EQ(field(copybook, "ORDERS").offset, 18u);
+    ASSERT_EQ(field(copybook, "ORDERS").size, 11);
+    ASSERT_EQ(field(copybook, "TRAILER").offset, 18u + 3 * 11);
+    ASSERT_EQ(field(copybook, "REC").size, 53);
+    ASSERT_EQ(copybook.record_length, 53u);
+}
+
+void test_redefines_offsets() {
+    auto copybook = parse(
+        "       01  REC.\n"
+        "           05  HEADER       PIC X(4).\n"
+        "           05  BODY         PIC X(10).\n"
+        "           05  BODY-PARTS REDEFINES BODY.\n"
+        "               10  PART-A   PIC X(6).\n"
+        "               10  PART-B   PIC X(4).\n"
+        "           05  TAIL         PIC X(2).\n");
+    ASSERT_EQ(field(copybook, "BODY-PARTS").offset, 4u);
+    ASSERT_EQ(field(copybook, "PART-A").offset, 4u);
+    ASSERT_EQ(field(copybook, "PART-B").offset, 10u);
+    ASSERT_EQ(field(copybook, "TAIL").offset, 14u);
+    ASSERT_EQ(copybook.record_length, 16u);
+}
+
+void test_condition_names() {
+    auto copybook = parse(
+        "       01  REC.\n"
+        "           05  ID           PIC 9(4).\n"
+        "           05  STATUS-CODE  PIC X.\n"
+        "               88  ACTIVE   VALUE 'A', 'B'.\n"
+        "               88  CLOSED   VALUE 'C'.\n"
+        "           05  NEXT-FIELD   PIC X(3).\n");
+    const auto& status = field(copybook, "STATUS-CODE");
+    ASSERT_FALSE(status.is_group());
+    ASSERT_TRUE(status.is_elementary());
+    ASSERT_EQ(status.size, 1);
+    ASSERT_EQ(field(copybook, "ACTIVE").offset, 4u);
+    ASSERT_EQ(field(copybook, "NEXT-FIELD").offset, 5u);
+    ASSERT_EQ(copybook.record_length, 8u);
+}
+
+void test_usage_order() {
+    auto copybook = parse(
+        "       01  REC.\n"
+        "           05  BEFORE   COMP-3 PIC S9(7)V99.\n"
+        "           05  AFTER    PIC S9(7)V99 COMP-3.\n"
+        "           05  NATIVE   PIC S9(9) COMP-5.\n"
+        "           05  HALF     BINARY PIC 9(4).\n");
+    ASSERT_EQ(field(copybook, "BEFORE").picture.type, DataType::NUMERIC_PACKED);
+    ASSERT_EQ(field(copybook, "BEFORE").size, 5);
+    ASSERT_EQ(field(copybook, "AFTER").size, 5);
+    ASSERT_EQ(field(copybook, "NATIVE").usage, UsageClause::COMP_5);
+    ASSERT_EQ(field(copybook, "NATIVE").picture.type, DataType::NUMERIC_BINARY);
+    ASSERT_EQ(field(copybook, "NATIVE").size, 4);
+    ASSERT_EQ(field(copybook, "HALF").size, 2);
+    ASSERT_EQ(copybook.record_length, 16u);
+}
+
+// =============================================================================
+// JSON Transformer
+// =============================================================================
+
+namespace {
+
+const char* ORDER_COPYBOOK =
+    "       01  ORDER-REC.\n"
+    "           05  ORDER-ID     PIC 9(6).\n"
+    "           05  CUSTOMER     PIC X(10).\n"
+    "           05  BALANCE      PIC S9(7)V99 COMP-3.\n"
+    "           05  ADJUSTMENT   PIC S9(3)V9.\n"
+    "           05  LINES OCCURS 3 TIMES.\n"
+    "               10  ITEM     PIC 9(4).\n"
+    "               10  QTY      PIC S9(4) COMP.\n"
+    "           05  REF          PIC X(8).\n"
+    "           05  REF-PARTS REDEFINES REF.\n"
+    "               10  REF-A    PIC X(4).\n"
+    "               10  REF-B    PIC X(4).\n";
+
+JsonTransformer order_transformer(JsonTransformOptions options = {}) {
+    auto transformer = JsonTransformer::compile(parse(ORDER_COPYBOOK), options);
+    ASSERT_TRUE(transformer.is_success());
+    return std::move(transformer.value());
+}
+
+} // namespace
+
+void test_json_packed_decimal() {
+    auto transformer = order_transformer();
+    ASSERT_EQ(transformer.record_length(), 6u + 10 + 5 + 4 + 3 * 6 + 8);
+
+    auto record = transformer.to_record(R"({"BALANCE": -12345.67})");
+    ASSERT_TRUE(record.is_success());
+    const ByteBuffer expected{0x00, 0x12, 0x34, 0x56, 0x7D};
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), record.value().begin() + 16));
+
+    // Digits beyond the scale are truncated; too many integer digits fail
+    record = transformer.to_record(R"({"BALANCE": "1.239"})");
+    ASSERT_TRUE(record.is_success());
+    ASSERT_EQ(record.value()[19], 0x12);
+    ASSERT_EQ(record.value()[20], 0x3C);
+    ASSERT_TRUE(transformer.to_record(R"({"BALANCE": 123456789})").is_error());
+
+    auto json = transformer.to_json(transformer.to_record(R"({"BALANCE": 0.5})").value());
+    ASSERT_TRUE(json.value().find(R"("BALANCE":0.50)") != String::npos);
+}
+
+void test_json_signed_zoned() {
+    auto transformer = order_transformer();
+    auto record = transformer.to_record(R"({"ORDER-ID": 42, "ADJUSTMENT": -12.5})");
+    ASSERT_TRUE(record.is_success());
+    const auto& data = record.value();
+    ASSERT_EQ(data[0], 0xF0);
+    ASSERT_EQ(data[5], 0xF2);               // Unsigned: F zone throughout
+    ASSERT_EQ(data[21], 0xF0);
+    ASSERT_EQ(data[24], 0xD5);              // Negative: D zone on the last digit
+
+    auto json = transformer.to_json(data);
+    ASSERT_TRUE(json.value().find(R"("ORDER-ID":42)") != String::npos);
+    ASSERT_TRUE(json.value().find(R"("ADJUSTMENT":-12.5)") != String::npos);
+    ASSERT_TRUE(transformer.to_record(R"({"ORDER-ID": -1})").is_error());
+}
+
+void test_json_occurs() {
+    auto transformer = order_transformer();
+    auto record = transformer.to_record(
+        R"({"LINES": [{"ITEM": 7, "QTY": -2}, null, {"QTY": 300}]})");
+    ASSERT_TRUE(record.is_success());
+    const auto& data = record.value();
+    ASSERT_EQ(data[25 + 3], 0xF7);
+    ASSERT_EQ(data[25 + 4], 0xFF);          // -2 big-endian
+    ASSERT_EQ(data[25 + 5], 0xFE);
+    ASSERT_EQ(data[25 + 12 + 4], 0x01);     // 300
+    ASSERT_EQ(data[25 + 12 + 5], 0x2C);
+
+    auto json = transformer.to_json(data);
+    ASSERT_TRUE(json.value().find(
+        R"("LINES":[{"ITEM":7,"QTY":-2},{"ITEM":0,"QTY":0},{"ITEM":0,"QTY":300}])") != String::npos);
+
+    auto too_many = transformer.to_record(R"({"LINES": [{}, {}, {}, {}]})");
+    ASSERT_TRUE(too_many.is_error());
+    ASSERT_EQ(too_many.error().code, ErrorCode::OUT_OF_RANGE);
+}
+
+void test_json_redefines() {
+    // The redefined item carries the data; its REDEFINES has no member
+    auto transformer = order_transformer();
+    auto record = transformer.to_record(R"({"REF": "AB12CD34"})");
+    ASSERT_TRUE(record.is_success());
+    auto json = transformer.to_json(record.value());
+    ASSERT_TRUE(json.value().find(R"("REF":"AB12CD34")") != String::npos);
+    ASSERT_TRUE(json.value().find("REF-PARTS") == String::npos);
+
+    auto strict = order_transformer({.reject_unknown = true});
+    ASSERT_TRUE(strict.to_record(R"({"REF-A": "AB12"})").is_error());
+    ASSERT_TRUE(order_transformer().to_record(R"({"REF-A": "AB12"})").is_success());
+}
+
+void test_json_round_trip() {
+    auto transformer = order_transformer();
+    const char* document =
+        R"({"ORDER-ID":123456,"CUSTOMER":"M\u00fcller \"J\"","BALANCE":-0.01,)"
+        R"("ADJUSTMENT":99.9,"LINES":[{"ITEM":1,"QTY":-9999},{"ITEM":9999,"QTY":9999},)"
+        R"({"ITEM":0,"QTY":0}],"REF":"X"})";
+    auto record = transformer.to_record(document);
+    ASSERT_TRUE(record.is_success());
+    ASSERT_EQ(record.value()[6], 0xD4);     // 'M' in IBM-037
+
+    auto json = transformer.to_json(record.value());
+    ASSERT_TRUE(json.is_success());
+    ASSERT_EQ(json.value(),
+        "{\"ORDER-ID\":123456,\"CUSTOMER\":\"M\xC3\xBCller \\\"J\\\"\",\"BALANCE\":-0.01,"
+        "\"ADJUSTMENT\":99.9,\"LINES\":[{\"ITEM\":1,\"QTY\":-9999},{\"ITEM\":9999,\"QTY\":9999},"
+        "{\"ITEM\":0,\"QTY\":0}],\"REF\":\"X\"}");
+
+    auto again = transformer.to_record(json.value());
+    ASSERT_TRUE(again.is_success());
+    ASSERT_TRUE(again.value() == record.value());
+
+    // ASCII records and camel-case member names
+    auto ascii = order_transformer({.naming = JsonNaming::CAMEL_CASE, .ebcdic = false});
+    auto plain = ascii.to_record(R"({"orderId": 7, "adjustment": -1.5})");
+    ASSERT_TRUE(plain.is_success());
+    ASSERT_EQ(plain.value()[5], '7');
+    ASSERT_EQ(plain.value()[24], 0x75);     // Negative: zone 7 in ASCII
+    ASSERT_TRUE(ascii.to_json(plain.value()).value().find(R"("adjustment":-1.5)") != String::npos);
+}
+
+void test_json_errors() {
+    auto transformer = order_transformer();
+    ASSERT_TRUE(transformer.to_record(R"({"CUSTOMER": "x")").is_error());
+    ASSERT_TRUE(transformer.to_record(R"({"CUSTOMER": true})").is_error());
+    ASSERT_TRUE(transformer.to_record(R"({"CUSTOMER": "ELEVEN CHARS"})").is_error());
+    ASSERT_TRUE(transformer.to_record(R"({"BALANCE": "abc"})").is_error());
+    ASSERT_TRUE(transformer.to_record(R"({} trailing)").is_error());
+    ASSERT_TRUE(transformer.to_record(R"({"CUSTOMER": "\u4e2d"})").is_error());
+
+    ByteBuffer short_record(10);
+    auto result = transformer.to_record("{}", ByteSpan(short_record));
+    ASSERT_TRUE(result.is_error());
+    ASSERT_EQ(result.error().code, ErrorCode::LENGERR);
+
+    // Damaged packed data is reported rather than rendered
+    auto record = transformer.to_record("{}").value();
+    record[20] = 0x11;
+    ASSERT_TRUE(transformer.to_json(record).is_error());
+}
+
+// =============================================================================
+// Layout Cache
+// =============================================================================
+
+namespace {
+
+const char* const CUSTOMER_COPYBOOK =
+    "       01  CUSTOMER.\n"
+    "           05  CUST-ID      PIC 9(8).\n"
+    "           05  CUST-NAME    PIC X(30).\n"
+    "           05  BALANCE      PIC S9(7)V99 COMP-3.\n";
+
+class TempDirectory {
+public:
+    TempDirectory() {
+        path_ = std::filesystem::temp_directory_path() /
+                ("cics_copybook_test_" + std::to_string(std::random_device{}()));
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+    const Path& path() const { return path_; }
+
+private:
+    Path path_;
+};
+
+void write_text(const Path& path, StringView text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+ByteBuffer read_bytes(const Path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return ByteBuffer(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void write_bytes(const Path& path, const ByteBuffer& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Saves CUSTOMER_COPYBOOK to a fresh cache file
+void seed_cache(const Path& file) {
+    auto cache = CopybookCache::open(file).value();
+    ASSERT_TRUE(cache->get("CUSTOMER", CUSTOMER_COPYBOOK).is_success());
+    ASSERT_TRUE(cache->save().is_success());
+}
+
+} // namespace
+
+void test_cache_hit() {
+    TempDirectory dir;
+    const Path file = dir.path() / "copybooks.cache";
+    seed_cache(file);
+
+    auto cache = CopybookCache::open(file).value();
+    ASSERT_EQ(cache->size(), 1u);
+    auto copybook = cache->get("CUSTOMER", CUSTOMER_COPYBOOK);
+    ASSERT_TRUE(copybook.is_success());
+    ASSERT_EQ(cache->statistics().hits.get(), 1u);
+    ASSERT_EQ(cache->statistics().misses.get(), 0u);
+    ASSERT_EQ(copybook.value()->name, "CUSTOMER");
+    ASSERT_EQ(copybook.value()->record_length, 43u);
+    ASSERT_EQ(field(*copybook.value(), "BALANCE").offset, 38u);
+
+    // The second lookup is served from memory, as the same definition
+    auto again = cache->get("CUSTOMER", CUSTOMER_COPYBOOK);
+    ASSERT_TRUE(again.value() == copybook.value());
+    ASSERT_EQ(cache->statistics().hits.get(), 2u);
+}
+
+void test_cache_changed_source() {
+    TempDirectory dir;
+    const Path file = dir.path() / "copybooks.cache";
+    seed_cache(file);
+
+    String edited = CUSTOMER_COPYBOOK;
+    edited += "           05  REGION       PIC X(4).\n";
+    auto cache = CopybookCache::open(file).value();
+    auto copybook = cache->get("CUSTOMER", edited);
+    ASSERT_TRUE(copybook.is_success());
+    ASSERT_EQ(cache->statistics().misses.get(), 1u);
+    ASSERT_EQ(copybook.value()->record_length, 47u);
+
+    // The same source under another name is its own entry
+    auto renamed = cache->get("CLIENT", CUSTOMER_COPYBOOK);
+    ASSERT_EQ(renamed.value()->name, "CLIENT");
+    ASSERT_EQ(cache->statistics().misses.get(), 2u);
+}
+
+void test_cache_source_check() {
+    TempDirectory dir;
+    const Path file = dir.path() / "copybooks.cache";
+    seed_cache(file);
+
+    // An entry whose recorded source differs is not trusted even though its
+    // key matches: flip the CRC in the one index entry at the end of the file
+    ByteBuffer bytes = read_bytes(file);
+    bytes[bytes.size() - 8] ^= 0xFF;
+    write_bytes(file, bytes);
+
+    auto cache = CopybookCache::open(file).value();
+    auto copybook = cache->get("CUSTOMER", CUSTOMER_COPYBOOK);
+    ASSERT_TRUE(copybook.is_success());
+    ASSERT_EQ(cache->statistics().collisions.get(), 1u);
+    ASSERT_EQ(cache->statistics().hits.get(), 0u);
+    ASSERT_EQ(cache->statistics().misses.get(), 1u);
+    ASSERT_EQ(copybook.value()->record_length, 43u);
+}
+
+void test_cache_corrupt_file() {
+    TempDirectory dir;
+    const Path file = dir.path() / "copybooks.cache";
+    seed_cache(file);
+    const ByteBuffer good = read_bytes(file);
+
+    // A damaged entry is parsed again
+    ByteBuffer damaged = good;
+    for (Size i = 40; i < 56; ++i) damaged[i] = 0xEE;
+    write_bytes(file, damaged);
+    {
+        auto cache = CopybookCache::open(file).value();
+        auto copybook = cache->get("CUSTOMER", CUSTOMER_COPYBOOK);
+        ASSERT_TRUE(copybook.is_success());
+        ASSERT_EQ(copybook.value()->record_length, 43u);
+        ASSERT_EQ(cache->statistics().damaged.get() + cache->statistics().misses.get(), 2u);
+    }
+
+    // A truncated file or garbage is ignored and the cache starts empty
+    write_bytes(file, ByteBuffer(good.begin(), good.begin() + static_cast<std::ptrdiff_t>(good.size() / 2)));
+    ASSERT_EQ(CopybookCache::open(file).value()->size(), 0u);
+    write_text(file, "not a cache file at all, just some text");
+    auto cache = CopybookCache::open(file).value();
+    ASSERT_EQ(cache->size(), 0u);
+    ASSERT_TRUE(cache->get("CUSTOMER", CUSTOMER_COPYBOOK).is_success());
+    ASSERT_TRUE(cache->save().is_success());
+    ASSERT_EQ(CopybookCache::open(file).value()->size(), 1u);
+}
+
+void test_cache_parallel_library() {
+    TempDirectory dir;
+    const Path library_dir = dir.path() / "copylib";
+    std::filesystem::create_directories(library_dir);
+    constexpr int MEMBERS = 24;
+    for (int i = 0; i < MEMBERS; ++i) {
+        write_text(library_dir / std::format("MEMBER{:02}.cpy", i),
+                   std::format("       01  REC-{0}.\n           05  KEY-{0}   PIC 9({1}).\n"
+                               "           05  DATA-{0}  PIC X(10).\n", i, i % 9 + 1));
+    }
+    std::filesystem::create_directories(library_dir / "NESTED.cpy");
+    write_text(library_dir / "README.txt", "not a copybook");
+    const Path file = dir.path() / "copybooks.cache";
+
+    {
+        auto cache = CopybookCache::open(file).value();
+        auto library = cache->load_library(library_dir);
+        ASSERT_EQ(library.parsed, static_cast<UInt32>(MEMBERS));
+        ASSERT_EQ(library.from_cache, 0u);
+        ASSERT_TRUE(library.errors.empty());
+        ASSERT_TRUE(cache->save().is_success());
+    }
+
+    auto cache = CopybookCache::open(file).value();
+    auto library = cache->load_library(library_dir);
+    ASSERT_EQ(library.from_cache, static_cast<UInt32>(MEMBERS));
+    ASSERT_EQ(library.parsed, 0u);
+    ASSERT_EQ(library.copybooks.size(), static_cast<Size>(MEMBERS));
+    for (int i = 0; i < MEMBERS; ++i) {
+        const auto& copybook = library.copybooks.at(std::format("MEMBER{:02}", i));
+        ASSERT_EQ(copybook->record_length, static_cast<UInt32>(i % 9 + 1 + 10));
+        ASSERT_EQ(field(*copybook, std::format("DATA-{}", i)).offset, static_cast<UInt32>(i % 9 + 1));
+    }
+}
+
+int main() {
+    TestSuite suite("Copybook Tests");
+
+    suite.add_test("Picture Period", test_picture_period);
+    suite.add_test("Group Sizes", test_group_sizes);
+    suite.add_test("REDEFINES Offsets", test_redefines_offsets);
+    suite.add_test("Condition Names", test_condition_names);
+    suite.add_test("USAGE Order", test_usage_order);
+    suite.add_test("JSON Packed Decimal", test_json_packed_decimal);
+    suite.add_test("JSON Signed Zoned", test_json_signed_zoned);
+    suite.add_test("JSON OCCURS", test_json_occurs);
+    suite.add_test("JSON REDEFINES", test_json_redefines);
+    suite.add_test("JSON Round Trip", test_json_round_trip);
+    suite.add_test("JSON Errors", test_json_errors);
+    suite.add_test("Cache Hit", test_cache_hit);
+    suite.add_test("Cache Changed Source", test_cache_changed_source);
+    suite.add_test("Cache Source Check", test_cache_source_check);
+    suite.add_test("Cache Corrupt File", test_cache_corrupt_file);
+    suite.add_test("Cache Parallel Library", test_cache_parallel_library);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
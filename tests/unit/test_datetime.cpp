@@ -0,0 +1,271 @@
+#include "../framework/test_framework.hpp"
+#include "cics/datetime/datetime.hpp"
+
+using namespace cics;
+using namespace cics::datetime;
+using namespace cics::test;
+
+namespace {
+
+DateTime make(UInt16 year, UInt8 month, UInt8 day, UInt8 hour = 0, UInt8 minute = 0, UInt8 second = 0,
+              UInt16 millisecond = 0) {
+    DateTime dt;
+    dt.year = year;
+    dt.month = month;
+    dt.day = day;
+    dt.hour = hour;
+    dt.minute = minute;
+    dt.second = second;
+    dt.millisecond = millisecond;
+    return dt;
+}
+
+bool same_fields(const DateTime& a, const DateTime& b) {
+    return a.year == b.year && a.month == b.month && a.day == b.day && a.hour == b.hour &&
+           a.minute == b.minute && a.second == b.second && a.millisecond == b.millisecond;
+}
+
+// ABSTIME counts milliseconds from 1900-01-01 00:00 UTC
+constexpr Int64 MS_1900_TO_1970 = 2208988800000LL;
+
+AbsTime abstime_utc(Int32 year, UInt32 month, UInt32 day, Int64 ms_of_day) {
+    return static_cast<Int64>(days_from_civil(year, month, day)) * 86400000LL + ms_of_day + MS_1900_TO_1970;
+}
+
+} // namespace
+
+// =============================================================================
+// Batch Conversion
+// =============================================================================
+
+void test_convert_packed_dates() {
+    const std::vector<PackedDate> dates{PackedDate(2024001), PackedDate(2024060), PackedDate(2024366),
+                                        PackedDate(2023365)};
+    std::vector<DateTime> out(dates.size());
+    ASSERT_TRUE(convert_packed_dates(dates, out).is_success());
+
+    ASSERT_EQ(out[0].year, 2024);
+    ASSERT_EQ(out[0].month, 1);
+    ASSERT_EQ(out[0].day, 1);
+    ASSERT_EQ(out[1].month, 2);     // 2024 is a leap year
+    ASSERT_EQ(out[1].day, 29);
+    ASSERT_EQ(out[2].month, 12);
+    ASSERT_EQ(out[2].day, 31);
+    ASSERT_EQ(out[3].year, 2023);
+    ASSERT_EQ(out[3].month, 12);
+    ASSERT_EQ(out[3].day, 31);
+
+    // Agrees with the one-at-a-time form
+    for (Size i = 0; i < dates.size(); ++i) {
+        const DateTime single = from_packed_date(dates[i]);
+        ASSERT_EQ(out[i].year, single.year);
+        ASSERT_EQ(out[i].month, single.month);
+        ASSERT_EQ(out[i].day, single.day);
+    }
+}
+
+void test_packed_dates_day_of_year() {
+    std::vector<DateTime> out(2);
+    std::vector<AbsTime> times(2);
+
+    const std::vector<PackedDate> day_zero{PackedDate(2024001), PackedDate(2024000)};
+    auto result = convert_packed_dates(day_zero, out);
+    ASSERT_TRUE(result.is_error());
+    ASSERT_EQ(result.error().code, ErrorCode::INVALID_ARGUMENT);
+    ASSERT_EQ(out[0].day, 1);       // Entries before the bad one are converted
+    ASSERT_TRUE(packed_dates_to_abstimes(day_zero, times).is_error());
+
+    // Day 366 only exists in a leap year
+    const std::vector<PackedDate> past_end{PackedDate(2023366)};
+    ASSERT_TRUE(convert_packed_dates(past_end, out).is_error());
+    ASSERT_TRUE(packed_dates_to_abstimes(past_end, times).is_error());
+
+    const std::vector<PackedDate> leap_end{PackedDate(2024366)};
+    ASSERT_TRUE(convert_packed_dates(leap_end, out).is_success());
+    ASSERT_TRUE(packed_dates_to_abstimes(leap_end, times).is_success());
+
+    const std::vector<PackedDate> out_of_range{PackedDate(2024999)};
+    ASSERT_TRUE(convert_packed_dates(out_of_range, out).is_error());
+    ASSERT_TRUE(packed_dates_to_abstimes(out_of_range, times).is_error());
+}
+
+void test_packed_dates_round_trip() {
+    const std::vector<PackedDate> dates{PackedDate(1970001), PackedDate(1999365), PackedDate(2000060),
+                                        PackedDate(2038019)};
+    std::vector<AbsTime> times(dates.size());
+    std::vector<PackedDate> back(dates.size());
+    ASSERT_TRUE(packed_dates_to_abstimes(dates, times, 0).is_success());
+    ASSERT_TRUE(abstimes_to_packed_dates(times, back, 0).is_success());
+    for (Size i = 0; i < dates.size(); ++i) {
+        ASSERT_EQ(back[i].value, dates[i].value);
+    }
+}
+
+void test_output_too_short() {
+    const std::vector<PackedDate> dates{PackedDate(2024001), PackedDate(2024002)};
+    std::vector<DateTime> out(1);
+    auto result = convert_packed_dates(dates, out);
+    ASSERT_TRUE(result.is_error());
+    ASSERT_EQ(result.error().code, ErrorCode::INVALID_ARGUMENT);
+}
+
+// =============================================================================
+// Compiled Formats
+// =============================================================================
+
+void test_format_specifiers() {
+    const DateTime dt = make(2024, 3, 5, 7, 8, 9, 45);  // A Tuesday
+    auto fmt = [&dt](StringView pattern) { return CompiledFormat(pattern).format(dt); };
+
+    ASSERT_EQ(fmt("%Y"), String("2024"));
+    ASSERT_EQ(fmt("%y"), String("24"));
+    ASSERT_EQ(fmt("%m"), String("03"));
+    ASSERT_EQ(fmt("%d"), String("05"));
+    ASSERT_EQ(fmt("%H"), String("07"));
+    ASSERT_EQ(fmt("%M"), String("08"));
+    ASSERT_EQ(fmt("%S"), String("09"));
+    ASSERT_EQ(fmt("%f"), String("045"));
+    ASSERT_EQ(fmt("%j"), String("065"));   // 31 + 29 + 5
+    ASSERT_EQ(fmt("%w"), String("2"));
+    ASSERT_EQ(fmt("%W"), std::format("{:02}", dt.week_number()));
+    ASSERT_EQ(fmt("%%Y is %Y"), String("%Y is 2024"));
+    ASSERT_EQ(fmt("%Q%Y"), String("%Q2024"));   // Unknown directives are kept as text
+    ASSERT_EQ(fmt("at %H:%M"), String("at 07:08"));
+
+    // DateTime::format and the named formats go through the same code
+    ASSERT_EQ(dt.format(format::FULL), String("2024-03-05 07:08:09"));
+    ASSERT_EQ(dt.format(format::CICS_DATE), String("2024065"));
+    ASSERT_EQ(dt.format(format::DATE_US), String("03/05/2024"));
+
+    // Too small a buffer gets what fits and the full length back
+    const CompiledFormat full(format::FULL);
+    std::array<char, 10> small{};
+    ASSERT_EQ(full.format_to(dt, small), 19u);
+    ASSERT_EQ(String(small.data(), small.size()), String("2024-03-05"));
+    ASSERT_GE(full.max_length(), 19u);
+}
+
+void test_format_parse_round_trip() {
+    const std::vector<DateTime> dates{make(2024, 2, 29, 23, 59, 59, 999), make(2023, 12, 31, 0, 0, 0, 0),
+                                      make(2000, 1, 1, 12, 30, 15, 500), make(1999, 7, 14, 1, 2, 3, 4)};
+    const std::vector<StringView> patterns{"%Y-%m-%d %H:%M:%S.%f", "%Y%j%H%M%S%f", "%d/%m/%Y %H%M%S%f",
+                                           "%m.%d.%Y|%H|%M|%S|%f"};
+    for (const auto& pattern : patterns) {
+        const CompiledFormat compiled(pattern);
+        for (const auto& dt : dates) {
+            auto parsed = compiled.parse(compiled.format(dt));
+            ASSERT_TRUE(parsed.is_success());
+            ASSERT_TRUE(same_fields(parsed.value(), dt));
+
+            // The generic parse() with a format takes the same path
+            auto generic = parse(dt.format(pattern), pattern);
+            ASSERT_TRUE(generic.is_success());
+            ASSERT_TRUE(same_fields(generic.value(), dt));
+        }
+    }
+
+    // Missing fields default to 1900-01-01 00:00:00.000
+    auto time_only = CompiledFormat(format::TIME_ONLY).parse("13:14:15");
+    ASSERT_TRUE(time_only.is_success());
+    ASSERT_TRUE(same_fields(time_only.value(), make(1900, 1, 1, 13, 14, 15)));
+
+    // %y pivots at 50; weekday and week number are written but not read back
+    ASSERT_EQ(CompiledFormat("%y").parse("49").value().year, 2049);
+    ASSERT_EQ(CompiledFormat("%y").parse("50").value().year, 1950);
+    auto weekday = CompiledFormat("%Y-%m-%d %w W%W").parse("2024-03-05 6 W01");
+    ASSERT_TRUE(weekday.is_success());
+    ASSERT_EQ(weekday.value().day_of_week(), 2);
+}
+
+void test_parse_day_of_year() {
+    const CompiledFormat cics_date(format::CICS_DATE);
+    auto leap_day = cics_date.parse("2024060");
+    ASSERT_TRUE(leap_day.is_success());
+    ASSERT_EQ(leap_day.value().month, 2);
+    ASSERT_EQ(leap_day.value().day, 29);
+    auto year_end = cics_date.parse("2024366");
+    ASSERT_TRUE(year_end.is_success());
+    ASSERT_EQ(year_end.value().month, 12);
+    ASSERT_EQ(year_end.value().day, 31);
+
+    // Day 000 is given and wrong, not absent
+    auto day_zero = cics_date.parse("2024000");
+    ASSERT_TRUE(day_zero.is_error());
+    ASSERT_EQ(day_zero.error().code, ErrorCode::INVALID_ARGUMENT);
+    ASSERT_TRUE(cics_date.parse("2023366").is_error());
+    ASSERT_TRUE(cics_date.parse("2024999").is_error());
+}
+
+void test_parse_errors() {
+    const CompiledFormat full(format::FULL);
+    auto expect_invalid = [&full](StringView text) {
+        auto result = full.parse(text);
+        return result.is_error() && result.error().code == ErrorCode::INVALID_ARGUMENT;
+    };
+    ASSERT_TRUE(expect_invalid("2024/03/05 07:08:09"));    // Literal mismatch
+    ASSERT_TRUE(expect_invalid("2024-0X-05 07:08:09"));    // Not a digit
+    ASSERT_TRUE(expect_invalid("2024-03-05 07:08"));       // Too short
+    ASSERT_TRUE(expect_invalid("2024-03-05 07:08:09Z"));   // Trailing text
+    ASSERT_TRUE(expect_invalid("2024-3-05 07:08:09"));     // Fields are read at their width
+    ASSERT_TRUE(expect_invalid("2024-13-05 07:08:09"));
+    ASSERT_TRUE(expect_invalid("2023-02-29 07:08:09"));
+    ASSERT_TRUE(expect_invalid("2024-03-05 24:00:00"));
+    ASSERT_TRUE(expect_invalid(""));
+    ASSERT_TRUE(parse("", format::FULL).is_error());
+}
+
+// =============================================================================
+// ABSTIME Batch Conversion
+// =============================================================================
+
+void test_convert_abstimes() {
+    const std::vector<AbsTime> times{
+        abstime_utc(2024, 2, 29, 13 * 3600000LL + 45 * 60000 + 30 * 1000 + 250),
+        abstime_utc(2024, 1, 1, 30 * 60000),             // 00:30 on New Year's Day
+        abstime_utc(1970, 1, 1, -1),                     // Just before the Unix epoch
+        abstime_utc(1900, 1, 1, 0)};                     // ABSTIME 0
+    std::vector<DateTime> out(times.size());
+
+    ASSERT_TRUE(convert_abstimes(times, out, 0).is_success());
+    ASSERT_TRUE(same_fields(out[0], make(2024, 2, 29, 13, 45, 30, 250)));
+    ASSERT_TRUE(same_fields(out[1], make(2024, 1, 1, 0, 30, 0, 0)));
+    ASSERT_TRUE(same_fields(out[2], make(1969, 12, 31, 23, 59, 59, 999)));
+    ASSERT_TRUE(same_fields(out[3], make(1900, 1, 1)));
+    ASSERT_EQ(out[0].tz_offset_minutes, 0);
+
+    // One offset applies to the whole array, and can move the date
+    ASSERT_TRUE(convert_abstimes(times, out, 60).is_success());
+    ASSERT_TRUE(same_fields(out[0], make(2024, 2, 29, 14, 45, 30, 250)));
+    ASSERT_EQ(out[0].tz_offset_minutes, 60);
+    ASSERT_TRUE(convert_abstimes(times, out, -60).is_success());
+    ASSERT_TRUE(same_fields(out[1], make(2023, 12, 31, 23, 30, 0, 0)));
+
+    // Agrees with the packed-date form at the same offset
+    std::vector<PackedDate> packed(times.size());
+    ASSERT_TRUE(abstimes_to_packed_dates(times, packed, -60).is_success());
+    ASSERT_EQ(packed[1].value, 2023365u);
+    for (Size i = 0; i < times.size(); ++i) ASSERT_EQ(packed[i].value, out[i].to_packed_date().value);
+
+    std::vector<DateTime> short_out(times.size() - 1);
+    auto too_short = convert_abstimes(times, short_out, 0);
+    ASSERT_TRUE(too_short.is_error());
+    ASSERT_EQ(too_short.error().code, ErrorCode::INVALID_ARGUMENT);
+}
+
+int main() {
+    TestSuite suite("DateTime Tests");
+
+    suite.add_test("Convert Packed Dates", test_convert_packed_dates);
+    suite.add_test("Packed Dates Day Of Year", test_packed_dates_day_of_year);
+    suite.add_test("Packed Dates Round Trip", test_packed_dates_round_trip);
+    suite.add_test("Output Too Short", test_output_too_short);
+    suite.add_test("Format Specifiers", test_format_specifiers);
+    suite.add_test("Format Parse Round Trip", test_format_parse_round_trip);
+    suite.add_test("Parse Day Of Year", test_parse_day_of_year);
+    suite.add_test("Parse Errors", test_parse_errors);
+    suite.add_test("Convert ABSTIMEs", test_convert_abstimes);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,122 @@
+#include "../framework/test_framework.hpp"
+#include "cics/inquire/inquire.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace cics;
+using namespace cics::inquire;
+using namespace cics::test;
+
+namespace {
+
+ProgramInfo program(StringView name, UInt32 length) {
+    ProgramInfo info;
+    info.name = String(name);
+    info.language = "COBOL";
+    info.length = length;
+    return info;
+}
+
+} // namespace
+
+// =============================================================================
+// Resource Registry
+// =============================================================================
+
+void test_register_unregister() {
+    ResourceRegistry<ProgramInfo> registry;
+    ASSERT_EQ(registry.count(), 0u);
+
+    registry.register_resource("PAYROLL", program("PAYROLL", 100));
+    registry.register_resource("LEDGER", program("LEDGER", 200));
+    ASSERT_EQ(registry.count(), 2u);
+    ASSERT_TRUE(registry.exists("PAYROLL"));
+    ASSERT_EQ(registry.get("LEDGER")->length, 200u);
+
+    // Registering again replaces the entry
+    registry.register_resource("LEDGER", program("LEDGER", 250));
+    ASSERT_EQ(registry.count(), 2u);
+    ASSERT_EQ(registry.get("LEDGER")->length, 250u);
+
+    ASSERT_TRUE(registry.update("PAYROLL", [](ProgramInfo& info) { info.status = ResourceStatus::DISABLED; }));
+    ASSERT_TRUE(registry.get("PAYROLL")->status == ResourceStatus::DISABLED);
+    ASSERT_FALSE(registry.update("MISSING", [](ProgramInfo&) {}));
+
+    registry.unregister_resource("PAYROLL");
+    ASSERT_FALSE(registry.exists("PAYROLL"));
+    ASSERT_FALSE(registry.get("PAYROLL").has_value());
+    ASSERT_EQ(registry.list().size(), 1u);
+
+    registry.clear();
+    ASSERT_EQ(registry.count(), 0u);
+}
+
+void test_generation() {
+    ResourceRegistry<ProgramInfo> registry;
+    const UInt64 start = registry.generation();
+
+    registry.register_resource("PAYROLL", program("PAYROLL", 100));
+    ASSERT_EQ(registry.generation(), start + 1);
+    ASSERT_TRUE(registry.update("PAYROLL", [](ProgramInfo& info) { ++info.use_count; }));
+    ASSERT_EQ(registry.generation(), start + 2);
+    registry.unregister_resource("PAYROLL");
+    ASSERT_EQ(registry.generation(), start + 3);
+
+    // Nothing published, nothing bumped
+    registry.unregister_resource("PAYROLL");
+    ASSERT_FALSE(registry.update("PAYROLL", [](ProgramInfo&) {}));
+    (void)registry.get("PAYROLL");
+    ASSERT_EQ(registry.generation(), start + 3);
+
+    registry.clear();
+    ASSERT_EQ(registry.generation(), start + 4);
+}
+
+void test_snapshot_stability() {
+    ResourceRegistry<ProgramInfo> registry;
+    for (UInt32 i = 0; i < 50; ++i) {
+        registry.register_resource(std::format("PGM{:05}", i), program("BASE", i));
+    }
+
+    // A held snapshot does not change while a writer keeps publishing
+    auto before = registry.snapshot();
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (UInt32 i = 0; i < 2000; ++i) {
+            const String name = std::format("NEW{:05}", i % 100);
+            registry.register_resource(name, program(name, i));
+            if (i % 3 == 0) registry.unregister_resource(name);
+        }
+        done = true;
+    });
+
+    bool stable = true;
+    bool consistent = true;
+    while (!done) {
+        if (before->size() != 50) stable = false;
+        // Each reader sees one whole snapshot, whatever the writer does
+        auto current = registry.snapshot();
+        Size counted = 0;
+        registry.for_each([&counted](const String&, const ProgramInfo&) { ++counted; });
+        if (current->size() < 50 || counted < 50) consistent = false;
+    }
+    writer.join();
+
+    ASSERT_TRUE(stable);
+    ASSERT_TRUE(consistent);
+    ASSERT_EQ(before->size(), 50u);
+    ASSERT_FALSE(before->contains("NEW00001"));
+    ASSERT_TRUE(registry.exists("NEW00001"));
+}
+
+int main() {
+    TestSuite suite("Inquire Tests");
+
+    suite.add_test("Register Unregister", test_register_unregister);
+    suite.add_test("Generation", test_generation);
+    suite.add_test("Snapshot Stability", test_snapshot_stability);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,154 @@
+#include "../framework/test_framework.hpp"
+#include "cics/common/logging.hpp"
+#include <filesystem>
+#include <sstream>
+#include <unistd.h>
+
+using namespace cics;
+using namespace cics::logging;
+using namespace cics::test;
+
+namespace {
+
+// A log directory of its own, removed with the test
+struct LogDirectory {
+    Path path = std::filesystem::temp_directory_path() /
+                std::format("cics-log-test-{}", ::getpid());
+
+    LogDirectory() { std::filesystem::create_directories(path); }
+    ~LogDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+};
+
+LogEntry entry(UInt32 n) {
+    LogEntry e;
+    e.message = std::format("line {:06}", n);
+    return e;
+}
+
+String contents(const Path& file) {
+    std::ifstream in(file, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+}
+
+// Numbers of the lines in a log file, in file order
+std::vector<UInt32> line_numbers(const Path& file) {
+    std::vector<UInt32> numbers;
+    std::istringstream in(contents(file));
+    String line;
+    while (std::getline(in, line)) {
+        const auto at = line.find("line ");
+        if (at != String::npos) numbers.push_back(static_cast<UInt32>(std::stoul(line.substr(at + 5, 6))));
+    }
+    return numbers;
+}
+
+} // namespace
+
+// =============================================================================
+// MappedFileSink
+// =============================================================================
+
+void test_mapped_writes() {
+    LogDirectory dir;
+    const Path file = dir.path / "region.log";
+    {
+        MappedFileSink sink(file, LogLevel::DBG, 64 * 1024);
+        for (UInt32 i = 0; i < 100; ++i) sink.write(entry(i));
+        LogEntry quiet = entry(999);
+        quiet.level = LogLevel::TRACE;
+        sink.write(quiet);
+        ASSERT_EQ(sink.dropped(), 0u);
+    }
+
+    // Closed, the file ends at its last line with no padding
+    const String text = contents(file);
+    ASSERT_EQ(text.find('\0'), String::npos);
+    ASSERT_EQ(text.back(), '\n');
+    const auto numbers = line_numbers(file);
+    ASSERT_EQ(numbers.size(), 100u);
+    for (UInt32 i = 0; i < 100; ++i) ASSERT_EQ(numbers[i], i);
+    ASSERT_FALSE(std::filesystem::exists(file.string() + ".next"));
+}
+
+void test_mapped_rotation() {
+    LogDirectory dir;
+    const Path file = dir.path / "region.log";
+    constexpr UInt32 lines = 400;
+    UInt64 rotations = 0;
+    {
+        // The smallest segment holds only a few dozen lines
+        MappedFileSink sink(file, LogLevel::DBG, 4096, 20);
+        for (UInt32 i = 0; i < lines; ++i) sink.write(entry(i));
+        ASSERT_EQ(sink.dropped(), 0u);
+        rotations = sink.rotations();
+    }
+    ASSERT_GE(rotations, 2u);
+
+    // Oldest backup first, live file last: every line once, in order
+    std::vector<UInt32> all;
+    for (auto n = static_cast<UInt32>(rotations); n > 0; --n) {
+        const Path backup = std::format("{}.{}", file.string(), n);
+        ASSERT_TRUE(std::filesystem::exists(backup));
+        ASSERT_EQ(contents(backup).find('\0'), String::npos);
+        for (UInt32 number : line_numbers(backup)) all.push_back(number);
+    }
+    for (UInt32 number : line_numbers(file)) all.push_back(number);
+    ASSERT_EQ(all.size(), static_cast<Size>(lines));
+    for (UInt32 i = 0; i < lines; ++i) ASSERT_EQ(all[i], i);
+}
+
+void test_mapped_reopen() {
+    LogDirectory dir;
+    const Path file = dir.path / "region.log";
+    {
+        MappedFileSink sink(file, LogLevel::DBG, 64 * 1024);
+        for (UInt32 i = 0; i < 10; ++i) sink.write(entry(i));
+    }
+    const auto first_size = std::filesystem::file_size(file);
+    {
+        // A new sink carries on after the last line of the old one
+        MappedFileSink sink(file, LogLevel::DBG, 64 * 1024);
+        for (UInt32 i = 10; i < 20; ++i) sink.write(entry(i));
+    }
+    ASSERT_GT(std::filesystem::file_size(file), first_size);
+    ASSERT_EQ(contents(file).find('\0'), String::npos);
+    const auto numbers = line_numbers(file);
+    ASSERT_EQ(numbers.size(), 20u);
+    for (UInt32 i = 0; i < 20; ++i) ASSERT_EQ(numbers[i], i);
+}
+
+// =============================================================================
+// FileSink
+// =============================================================================
+
+void test_file_sink_rotation() {
+    LogDirectory dir;
+    const Path file = dir.path / "plain.log";
+    {
+        // Rotates before each write once past 200 bytes; keeps .1 and .2
+        FileSink sink(file, LogLevel::DBG, 200, 3);
+        for (UInt32 i = 0; i < 40; ++i) sink.write(entry(i));
+    }
+    ASSERT_TRUE(std::filesystem::exists(file.string() + ".1"));
+    ASSERT_TRUE(std::filesystem::exists(file.string() + ".2"));
+    ASSERT_FALSE(std::filesystem::exists(file.string() + ".3"));
+    ASSERT_EQ(line_numbers(file).back(), 39u);
+}
+
+int main() {
+    TestSuite suite("Logging Tests");
+
+    suite.add_test("Mapped Writes", test_mapped_writes);
+    suite.add_test("Mapped Rotation", test_mapped_rotation);
+    suite.add_test("Mapped Reopen", test_mapped_reopen);
+    suite.add_test("File Sink Rotation", test_file_sink_rotation);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
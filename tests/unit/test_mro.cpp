@@ -0,0 +1,231 @@
+#include "../framework/test_framework.hpp"
+#include "cics/mro/mro.hpp"
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+using namespace cics;
+using namespace cics::mro;
+using namespace cics::test;
+
+namespace {
+
+Path socket_path(StringView test) {
+    return std::filesystem::temp_directory_path() / std::format("cics-mro-{}-{}.sock", test, ::getpid());
+}
+
+ByteBuffer bytes(StringView text) {
+    return ByteBuffer(text.begin(), text.end());
+}
+
+String text(const ByteBuffer& data) {
+    return String(data.begin(), data.end());
+}
+
+// An owning region whose LINK mirror echoes the COMMAREA, after a pause
+// when the program is SLOW
+struct EchoRegion {
+    MroServer server{"OWNR"};
+    Path path;
+    std::atomic<int> links{0};
+
+    explicit EchoRegion(StringView test, Milliseconds slow = Milliseconds(200)) : path(socket_path(test)) {
+        server.register_handler(FunctionCode::LINK, [this, slow](const ShipRequest& request) {
+            ++links;
+            if (request.resource == "SLOW") std::this_thread::sleep_for(slow);
+            ShipResponse response;
+            response.data = request.data;
+            return response;
+        });
+        (void)server.listen(path);
+    }
+};
+
+} // namespace
+
+// =============================================================================
+// Messages
+// =============================================================================
+
+void test_codec_round_trip() {
+    ShipRequest request;
+    request.function = FunctionCode::FILE_REWRITE;
+    request.resource = "ACCOUNTS";
+    request.key = bytes("KEY001");
+    request.data = bytes("record body");
+    request.item = 7;
+
+    serialization::BinaryWriter writer;
+    request.serialize(writer);
+    ShipRequest decoded;
+    serialization::BinaryReader reader(writer.buffer());
+    ASSERT_TRUE(decoded.deserialize(reader).is_success());
+    ASSERT_TRUE(decoded.function == FunctionCode::FILE_REWRITE);
+    ASSERT_EQ(decoded.resource, String("ACCOUNTS"));
+    ASSERT_EQ(text(decoded.key), String("KEY001"));
+    ASSERT_EQ(text(decoded.data), String("record body"));
+    ASSERT_EQ(decoded.item, 7u);
+
+    ShipResponse response;
+    response.code = ErrorCode::RECORD_NOT_FOUND;
+    response.message = "NOTFND";
+    response.data = bytes("partial");
+    response.item = 3;
+    serialization::BinaryWriter out;
+    response.serialize(out);
+    ShipResponse back;
+    serialization::BinaryReader in(out.buffer());
+    ASSERT_TRUE(back.deserialize(in).is_success());
+    ASSERT_TRUE(back.code == ErrorCode::RECORD_NOT_FOUND);
+    ASSERT_FALSE(back.ok());
+    ASSERT_EQ(back.message, String("NOTFND"));
+    ASSERT_EQ(text(back.data), String("partial"));
+    ASSERT_EQ(back.item, 3u);
+
+    // An unknown function code and a truncated body are both refused
+    ByteBuffer unknown = writer.buffer();
+    unknown[0] = static_cast<Byte>(FUNCTION_CODE_COUNT);
+    serialization::BinaryReader bad(unknown);
+    ASSERT_TRUE(ShipRequest{}.deserialize(bad).is_error());
+    ByteBuffer truncated(writer.buffer().begin(), writer.buffer().end() - 2);
+    serialization::BinaryReader short_reader(truncated);
+    ASSERT_TRUE(ShipRequest{}.deserialize(short_reader).is_error());
+}
+
+// =============================================================================
+// Connection
+// =============================================================================
+
+void test_concurrent_calls() {
+    EchoRegion region("multiplex");
+    auto connection = MroConnection::connect(region.path);
+    ASSERT_TRUE(connection.is_success());
+    auto& mro = *connection.value();
+
+    // Many threads on one connection each get their own answers back
+    constexpr int threads = 8;
+    constexpr int calls = 200;
+    std::atomic<int> matched{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&mro, &matched, t] {
+            for (int i = 0; i < calls; ++i) {
+                const String commarea = std::format("{}:{}", t, i);
+                auto reply = mro.link("ECHO", ConstByteSpan(reinterpret_cast<const Byte*>(commarea.data()), commarea.size()));
+                if (reply && text(reply.value()) == commarea) ++matched;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    ASSERT_EQ(matched.load(), threads * calls);
+    ASSERT_EQ(mro.statistics().requests.get(), static_cast<UInt64>(threads * calls));
+    ASSERT_EQ(mro.statistics().responses.get(), static_cast<UInt64>(threads * calls));
+    ASSERT_EQ(region.server.connection_count(), 1u);
+}
+
+void test_batching() {
+    EchoRegion region("batch");
+    MroConnectionConfig config;
+    config.max_batch_requests = 10;
+    config.batch_window = std::chrono::duration_cast<Microseconds>(Milliseconds(500));
+    auto connection = MroConnection::connect(region.path, config);
+    ASSERT_TRUE(connection.is_success());
+    auto& mro = *connection.value();
+
+    // 25 requests shipped at once travel as frames of 10, 10 and 5
+    ShipRequest request;
+    request.resource = "ECHO";
+    std::vector<std::future<ShipResponse>> replies;
+    for (int i = 0; i < 25; ++i) replies.push_back(mro.ship(request));
+    for (auto& reply : replies) ASSERT_TRUE(reply.get().ok());
+
+    ASSERT_EQ(mro.statistics().requests.get(), 25u);
+    ASSERT_EQ(mro.statistics().frames_sent.get(), 3u);
+    ASSERT_EQ(mro.statistics().frames_received.get(), 3u);
+    ASSERT_EQ(mro.statistics().requests_per_frame(), 25.0 / 3.0);
+    ASSERT_EQ(region.server.statistics().frames_received.get(), 3u);
+    ASSERT_EQ(region.server.statistics().requests.get(), 25u);
+}
+
+void test_call_timeout() {
+    EchoRegion region("timeout", Milliseconds(300));
+    MroConnectionConfig config;
+    config.timeout = Milliseconds(50);
+    auto connection = MroConnection::connect(region.path, config);
+    ASSERT_TRUE(connection.is_success());
+    auto& mro = *connection.value();
+
+    auto slow = mro.link("SLOW", {});
+    ASSERT_TRUE(slow.is_error());
+    ASSERT_TRUE(slow.error().code == ErrorCode::TIMEDOUT);
+
+    // The late answer is dropped; the connection carries on
+    std::this_thread::sleep_for(Milliseconds(400));
+    auto fast = mro.link("ECHO", ByteBuffer{'o', 'k'});
+    ASSERT_TRUE(fast.is_success());
+    ASSERT_EQ(text(fast.value()), String("ok"));
+    ASSERT_TRUE(mro.is_open());
+}
+
+void test_close_waits_for_sent_requests() {
+    EchoRegion region("close");
+    auto connection = MroConnection::connect(region.path);
+    ASSERT_TRUE(connection.is_success());
+
+    // Shipped before close, answered after it started: the answer arrives
+    ShipRequest request;
+    request.resource = "SLOW";
+    request.data = bytes("done");
+    auto reply = connection.value()->ship(request);
+    connection.value()->close();
+    ASSERT_FALSE(connection.value()->is_open());
+    const ShipResponse response = reply.get();
+    ASSERT_TRUE(response.ok());
+    ASSERT_EQ(text(response.data), String("done"));
+
+    // Nothing can be shipped once closed
+    ASSERT_TRUE(connection.value()->ship(request).get().code == ErrorCode::SYSIDERR);
+}
+
+void test_sysiderr_when_server_stops() {
+    EchoRegion region("stop");
+    auto connection = MroConnection::connect(region.path);
+    ASSERT_TRUE(connection.is_success());
+    auto& mro = *connection.value();
+    ASSERT_TRUE(mro.link("ECHO", {}).is_success());
+
+    // A request in flight when the owning region goes away fails with SYSIDERR
+    ShipRequest request;
+    request.resource = "SLOW";
+    auto in_flight = mro.ship(request);
+    while (region.links.load() < 2) std::this_thread::yield();
+    region.server.stop();
+    ASSERT_TRUE(in_flight.get().code == ErrorCode::SYSIDERR);
+    ASSERT_FALSE(mro.is_open());
+
+    auto after = mro.link("ECHO", {});
+    ASSERT_TRUE(after.is_error());
+    ASSERT_TRUE(after.error().code == ErrorCode::SYSIDERR);
+
+    // As does connecting to a region that is not listening
+    auto refused = MroConnection::connect(region.path);
+    ASSERT_TRUE(refused.is_error());
+    ASSERT_TRUE(refused.error().code == ErrorCode::SYSIDERR);
+}
+
+int main() {
+    TestSuite suite("MRO Tests");
+
+    suite.add_test("Codec Round Trip", test_codec_round_trip);
+    suite.add_test("Concurrent Calls", test_concurrent_calls);
+    suite.add_test("Batching", test_batching);
+    suite.add_test("Call Timeout", test_call_timeout);
+    suite.add_test("Close Waits For Sent Requests", test_close_waits_for_sent_requests);
+    suite.add_test("SYSIDERR When Server Stops", test_sysiderr_when_server_stops);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,114 @@
+#include "../framework/test_framework.hpp"
+#include "cics/program/program_control.hpp"
+#include <filesystem>
+#include <unistd.h>
+
+using namespace cics;
+using namespace cics::program;
+using namespace cics::test;
+
+namespace {
+
+const Path version_one = TEST_PROGRAM_V1;
+const Path version_two = TEST_PROGRAM_V2;
+
+// A library directory of its own, removed with the test
+struct LibraryDirectory {
+    Path path = std::filesystem::temp_directory_path() /
+                std::format("cics-rpl-test-{}", ::getpid());
+
+    LibraryDirectory() { std::filesystem::create_directories(path); }
+    ~LibraryDirectory() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    void install(const Path& module, StringView member) const {
+        std::filesystem::copy_file(module, path / std::format("{}.so", member),
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+};
+
+} // namespace
+
+// =============================================================================
+// Load Module
+// =============================================================================
+
+void test_load_module() {
+    auto module = LoadModule::open(version_one, "TESTPGM");
+    ASSERT_TRUE(module.is_success());
+    ASSERT_EQ(module.value()->entry_symbol(), String("testpgm"));
+    ASSERT_GT(module.value()->size(), 0u);
+
+    char commarea[4] = {};
+    ASSERT_EQ(module.value()->entry()(commarea, sizeof commarea), 1);
+    ASSERT_EQ(commarea[0], '1');
+
+    // Each load is a private copy with its own entry point
+    auto second = LoadModule::open(version_one, "TESTPGM");
+    ASSERT_TRUE(second.is_success());
+    ASSERT_TRUE(second.value()->entry() != module.value()->entry());
+    module.value().reset();
+    ASSERT_EQ(second.value()->entry()(commarea, sizeof commarea), 1);
+}
+
+void test_missing_symbol() {
+    auto by_name = LoadModule::open(version_one, "OTHERPGM");
+    ASSERT_TRUE(by_name.is_error());
+    ASSERT_EQ(by_name.error().code, ErrorCode::CICS_PROGRAM_NOT_FOUND);
+
+    auto by_symbol = LoadModule::open(version_one, "TESTPGM", "no_such_entry");
+    ASSERT_TRUE(by_symbol.is_error());
+    ASSERT_EQ(by_symbol.error().code, ErrorCode::CICS_PROGRAM_NOT_FOUND);
+
+    auto missing = LoadModule::open(version_one.parent_path() / "no-such-module.so", "TESTPGM");
+    ASSERT_TRUE(missing.is_error());
+    ASSERT_EQ(missing.error().code, ErrorCode::FILE_NOT_FOUND);
+}
+
+// =============================================================================
+// Program Library
+// =============================================================================
+
+void test_newcopy() {
+    LibraryDirectory library;
+    library.install(version_one, "TESTPGM");
+
+    ProgramControlManager programs;
+    programs.library().set_search_path({library.path});
+    ProgramDefinition def;
+    def.program_name = FixedString<8>("TESTPGM");
+    ASSERT_TRUE(programs.define_program(def).is_success());
+
+    char commarea[4] = {};
+    auto first = programs.link("TESTPGM", commarea, sizeof commarea);
+    ASSERT_TRUE(first.is_success());
+    ASSERT_EQ(first.value(), 1);
+
+    // The library member is replaced; LINK keeps the loaded copy until NEWCOPY
+    library.install(version_two, "TESTPGM");
+    ASSERT_EQ(programs.link("TESTPGM", commarea, sizeof commarea).value(), 1);
+    ASSERT_TRUE(programs.newcopy_program("TESTPGM").is_success());
+    auto second = programs.link("TESTPGM", commarea, sizeof commarea);
+    ASSERT_TRUE(second.is_success());
+    ASSERT_EQ(second.value(), 2);
+    ASSERT_EQ(commarea[0], '2');
+
+    // A member that vanished fails the NEWCOPY and leaves the old copy in use
+    std::filesystem::remove(library.path / "TESTPGM.so");
+    ASSERT_TRUE(programs.newcopy_program("TESTPGM").is_error());
+    ASSERT_EQ(programs.link("TESTPGM", commarea, sizeof commarea).value(), 2);
+}
+
+int main() {
+    TestSuite suite("Program Library Tests");
+
+    suite.add_test("Load Module", test_load_module);
+    suite.add_test("Missing Symbol", test_missing_symbol);
+    suite.add_test("NEWCOPY", test_newcopy);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,291 @@
+#include "../framework/test_framework.hpp"
+#include "cics/tsq/shared_pool.hpp"
+#include "cics/tsq/tsq_types.hpp"
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace cics;
+using namespace cics::tsq;
+using namespace cics::test;
+
+namespace {
+
+// A pool segment of its own, unlinked with the test
+struct PoolName {
+    String name;
+
+    explicit PoolName(StringView test) : name(std::format("cics-tsp-{}-{}", test, ::getpid())) {
+        (void)SharedTSPool::remove(name);
+    }
+    ~PoolName() { (void)SharedTSPool::remove(name); }
+};
+
+SharedPtr<SharedTSPool> open_pool(const PoolName& pool, const SharedTSPoolConfig& config = {}) {
+    auto opened = SharedTSPool::open(pool.name, config);
+    return opened ? opened.value() : nullptr;
+}
+
+ConstByteSpan bytes(StringView text) {
+    return ConstByteSpan(reinterpret_cast<const Byte*>(text.data()), text.size());
+}
+
+String text(const Result<ByteBuffer>& data) {
+    if (data.is_error()) return "<" + data.error().message + ">";
+    return String(reinterpret_cast<const char*>(data.value().data()), data.value().size());
+}
+
+} // namespace
+
+// =============================================================================
+// Queue Operations
+// =============================================================================
+
+void test_write_read_rewrite() {
+    PoolName name("ops");
+    auto pool = open_pool(name);
+    ASSERT_TRUE(pool != nullptr);
+    ASSERT_TRUE(pool->created());
+
+    ASSERT_EQ(pool->writeq("orders", bytes("first")).value(), 1u);
+    ASSERT_EQ(pool->writeq("ORDERS", bytes("second")).value(), 2u);
+    ASSERT_EQ(pool->item_count("Orders"), 2u);
+    ASSERT_EQ(text(pool->readq("ORDERS", 1)), String("first"));
+    ASSERT_EQ(text(pool->readq("ORDERS", 2)), String("second"));
+
+    ASSERT_TRUE(pool->rewriteq("ORDERS", 1, bytes("replaced")).is_success());
+    ASSERT_EQ(text(pool->readq("ORDERS", 1)), String("replaced"));
+    ASSERT_EQ(pool->rewriteq("ORDERS", 3, bytes("x")).error().code, ErrorCode::RECORD_NOT_FOUND);
+    ASSERT_EQ(pool->readq("ORDERS", 0).error().code, ErrorCode::RECORD_NOT_FOUND);
+
+    // READQ NEXT walks the items, then reports the end
+    UInt32 cursor = 0;
+    ASSERT_EQ(text(pool->readq_next("ORDERS", cursor)), String("replaced"));
+    ASSERT_EQ(text(pool->readq_next("ORDERS", cursor)), String("second"));
+    ASSERT_EQ(pool->readq_next("ORDERS", cursor).error().code, ErrorCode::VSAM_END_OF_FILE);
+
+    auto names = pool->list_queues();
+    ASSERT_EQ(names.size(), 1u);
+    ASSERT_EQ(names[0], String("ORDERS"));
+
+    ASSERT_TRUE(pool->deleteq("ORDERS").is_success());
+    ASSERT_FALSE(pool->queue_exists("ORDERS"));
+    ASSERT_EQ(pool->readq("ORDERS", 1).error().code, ErrorCode::CICS_QUEUE_NOT_FOUND);
+    ASSERT_EQ(pool->deleteq("ORDERS").error().code, ErrorCode::CICS_QUEUE_NOT_FOUND);
+    ASSERT_EQ(pool->writeq("", bytes("x")).error().code, ErrorCode::INVALID_ARGUMENT);
+    ASSERT_EQ(pool->writeq("A_NAME_OVER_16_CHARS", bytes("x")).error().code, ErrorCode::INVALID_ARGUMENT);
+
+    // The one remaining block is the item table, which is never freed
+    auto stats = pool->statistics();
+    ASSERT_EQ(stats.writes, 2u);
+    ASSERT_EQ(stats.rewrites, 1u);
+    ASSERT_EQ(stats.deleteqs, 1u);
+    ASSERT_EQ(stats.blocks_in_use, 1u);
+}
+
+void test_revival_after_deleteq() {
+    PoolName name("revive");
+    auto pool = open_pool(name);
+    ASSERT_TRUE(pool != nullptr);
+
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(pool->writeq("WORK", bytes("old")).is_success());
+    ASSERT_TRUE(pool->deleteq("WORK").is_success());
+
+    // The next WRITEQ starts the queue again at item 1, with none of the old items
+    ASSERT_EQ(pool->writeq("WORK", bytes("new")).value(), 1u);
+    ASSERT_EQ(pool->item_count("WORK"), 1u);
+    ASSERT_EQ(text(pool->readq("WORK", 1)), String("new"));
+    ASSERT_EQ(pool->readq("WORK", 2).error().code, ErrorCode::RECORD_NOT_FOUND);
+}
+
+void test_deleteq_during_writes() {
+    PoolName name("race");
+    auto pool = open_pool(name);
+    ASSERT_TRUE(pool != nullptr);
+
+    // Writers race DELETEQ; once quiet, every item the live queue has handed
+    // out must read back, whichever epoch its writer started in
+    std::atomic<int> writing{4};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&pool, &writing] {
+            for (int i = 0; i < 20000; ++i) (void)pool->writeq("HOT", bytes("payload"));
+            --writing;
+        });
+    }
+    while (writing > 0) {
+        (void)pool->deleteq("HOT");
+        std::this_thread::yield();
+    }
+    for (auto& writer : writers) writer.join();
+
+    const UInt32 count = pool->item_count("HOT");
+    UInt32 readable = 0;
+    for (UInt32 i = 1; i <= count; ++i) {
+        if (text(pool->readq("HOT", i)) == "payload") ++readable;
+    }
+    ASSERT_EQ(readable, count);
+}
+
+// =============================================================================
+// Sharing
+// =============================================================================
+
+void test_two_mappings() {
+    PoolName name("share");
+    auto first = open_pool(name);
+    auto second = open_pool(name);
+    ASSERT_TRUE(first != nullptr && second != nullptr);
+    ASSERT_TRUE(first->created());
+    ASSERT_FALSE(second->created());
+
+    // Two mappings writing one queue hand out each number once
+    constexpr UInt32 per_writer = 500;
+    std::vector<UInt32> numbers[2];
+    auto write = [](SharedTSPool& pool, std::vector<UInt32>& out, char tag) {
+        for (UInt32 i = 0; i < per_writer; ++i) {
+            auto number = pool.writeq("SHARED", bytes(String(1, tag)));
+            if (number) out.push_back(number.value());
+        }
+    };
+    std::thread a(write, std::ref(*first), std::ref(numbers[0]), 'a');
+    std::thread b(write, std::ref(*second), std::ref(numbers[1]), 'b');
+    a.join();
+    b.join();
+
+    ASSERT_EQ(numbers[0].size() + numbers[1].size(), static_cast<Size>(2 * per_writer));
+    ASSERT_EQ(first->item_count("SHARED"), 2 * per_writer);
+    for (UInt32 n : numbers[0]) ASSERT_EQ(text(second->readq("SHARED", n)), String("a"));
+    for (UInt32 n : numbers[1]) ASSERT_EQ(text(first->readq("SHARED", n)), String("b"));
+}
+
+void test_forked_writer() {
+    PoolName name("fork");
+    auto pool = open_pool(name);
+    ASSERT_TRUE(pool != nullptr);
+
+    const pid_t child = ::fork();
+    if (child == 0) {
+        // A separate process with its own mapping
+        auto own = SharedTSPool::open(name.name);
+        int failed = own ? 0 : 1;
+        for (int i = 0; own && i < 100; ++i) {
+            if (!own.value()->writeq("FROMCHILD", bytes(std::format("item {}", i)))) failed = 1;
+        }
+        ::_exit(failed);
+    }
+    ASSERT_GT(child, 0);
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    ASSERT_EQ(pool->item_count("FROMCHILD"), 100u);
+    ASSERT_EQ(text(pool->readq("FROMCHILD", 1)), String("item 0"));
+    ASSERT_EQ(text(pool->readq("FROMCHILD", 100)), String("item 99"));
+}
+
+// =============================================================================
+// Exhaustion and Recovery
+// =============================================================================
+
+void test_heap_exhaustion() {
+    PoolName name("heap");
+    SharedTSPoolConfig config;
+    config.segment_bytes = 256 * 1024;
+    config.max_queues = 4;
+    auto pool = open_pool(name, config);
+    ASSERT_TRUE(pool != nullptr);
+
+    const ByteBuffer big(MAX_ITEM_LENGTH, 'x');
+    UInt32 written = 0;
+    for (;;) {
+        auto number = pool->writeq("BIG", big);
+        if (number.is_error()) {
+            ASSERT_EQ(number.error().code, ErrorCode::RESOURCE_EXHAUSTED);
+            break;
+        }
+        ++written;
+    }
+    ASSERT_GT(written, 0u);
+
+    // DELETEQ returns the blocks, and the free lists hand them out again
+    const UInt64 carved = pool->statistics().heap_used;
+    ASSERT_TRUE(pool->deleteq("BIG").is_success());
+    for (UInt32 i = 0; i < written; ++i) ASSERT_TRUE(pool->writeq("BIG", big).is_success());
+    ASSERT_EQ(pool->statistics().heap_used, carved);
+}
+
+void test_directory_exhaustion() {
+    PoolName name("dir");
+    SharedTSPoolConfig config;
+    config.segment_bytes = 1024 * 1024;
+    config.max_queues = 4;
+    auto pool = open_pool(name, config);
+    ASSERT_TRUE(pool != nullptr);
+
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(pool->writeq(std::format("Q{}", i), bytes("x")).is_success());
+    auto full = pool->writeq("Q4", bytes("x"));
+    ASSERT_TRUE(full.is_error());
+    ASSERT_EQ(full.error().code, ErrorCode::RESOURCE_EXHAUSTED);
+
+    // Names are never removed, so a deleted queue's slot serves only that name
+    ASSERT_TRUE(pool->deleteq("Q0").is_success());
+    ASSERT_TRUE(pool->writeq("Q4", bytes("x")).is_error());
+    ASSERT_TRUE(pool->writeq("Q0", bytes("y")).is_success());
+}
+
+void test_dead_claimer_recovery() {
+    PoolName name("claim");
+    auto pool = open_pool(name);
+    ASSERT_TRUE(pool != nullptr);
+    ASSERT_TRUE(pool->writeq("DEADCLAIM", bytes("old")).is_success());
+    ASSERT_TRUE(pool->deleteq("DEADCLAIM").is_success());
+
+    // A process that has exited and been reaped
+    const pid_t dead = ::fork();
+    if (dead == 0) ::_exit(0);
+    ASSERT_GT(dead, 0);
+    ASSERT_EQ(::waitpid(dead, nullptr, 0), dead);
+
+    // Leave the queue's directory slot as if that process had died naming it:
+    // the claim word just before the name says "claiming, pid", no name yet
+    const Size size = pool->statistics().segment_bytes;
+    const int fd = ::shm_open(("/" + name.name).c_str(), O_RDWR, 0);
+    ASSERT_TRUE(fd >= 0);
+    void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_TRUE(mapped != MAP_FAILED);
+    auto* base = static_cast<Byte*>(mapped);
+    auto* found = static_cast<Byte*>(::memmem(base, size, "DEADCLAIM", 9));
+    ASSERT_TRUE(found != nullptr);
+    auto* claim = reinterpret_cast<std::atomic<UInt64>*>(found - sizeof(UInt64));
+    claim->store((UInt64{1} << 63) | static_cast<UInt64>(dead));
+    std::memset(found, 0, MAX_QUEUE_NAME_LENGTH);
+    ::munmap(mapped, size);
+
+    // The next request for the name takes the slot back rather than waiting
+    ASSERT_FALSE(pool->queue_exists("DEADCLAIM"));
+    ASSERT_EQ(pool->writeq("DEADCLAIM", bytes("new")).value(), 1u);
+    ASSERT_EQ(text(pool->readq("DEADCLAIM", 1)), String("new"));
+}
+
+int main() {
+    TestSuite suite("Shared TS Pool Tests");
+
+    suite.add_test("Write Read Rewrite", test_write_read_rewrite);
+    suite.add_test("Revival After DELETEQ", test_revival_after_deleteq);
+    suite.add_test("DELETEQ During Writes", test_deleteq_during_writes);
+    suite.add_test("Two Mappings", test_two_mappings);
+    suite.add_test("Forked Writer", test_forked_writer);
+    suite.add_test("Heap Exhaustion", test_heap_exhaustion);
+    suite.add_test("Directory Exhaustion", test_directory_exhaustion);
+    suite.add_test("Dead Claimer Recovery", test_dead_claimer_recovery);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,216 @@
+#include "../framework/test_framework.hpp"
+#include "cics/storage/storage_control.hpp"
+#include "cics/task/task_control.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace cics;
+using namespace cics::storage;
+using namespace cics::test;
+
+namespace {
+
+constexpr UInt32 KB = 1024;
+
+// Getmains of size bytes in cls until count are held
+std::vector<void*> fill(StorageControlManager& storage, StorageClass cls, UInt32 size, Size count) {
+    std::vector<void*> blocks;
+    for (Size i = 0; i < count; ++i) {
+        auto block = storage.getmain(size, cls);
+        if (!block) break;
+        blocks.push_back(block.value());
+    }
+    return blocks;
+}
+
+const StoragePool& pool_of(const StorageControlManager& storage, StorageClass cls) {
+    return *storage.get_pool(cls);
+}
+
+void free_down_to(StorageControlManager& storage, std::vector<void*>& blocks, Size keep) {
+    while (blocks.size() > keep) {
+        (void)storage.freemain(blocks.back());
+        blocks.pop_back();
+    }
+}
+
+} // namespace
+
+// =============================================================================
+// Short On Storage
+// =============================================================================
+
+void test_cushion_hysteresis() {
+    StorageControlManager storage;
+    std::vector<bool> transitions;
+    storage.set_sos_listener([&transitions](bool entered) { transitions.push_back(entered); });
+    storage.set_dsa_limit(StorageClass::UDSA, 64 * KB, 8 * KB);
+    const StoragePool& udsa = pool_of(storage, StorageClass::UDSA);
+
+    // Up to the cushion is fine; the first block into it sets SOS
+    auto blocks = fill(storage, StorageClass::UDSA, KB, 56);
+    ASSERT_EQ(blocks.size(), 56u);
+    ASSERT_FALSE(storage.is_short_on_storage());
+    blocks.push_back(storage.getmain(KB, StorageClass::UDSA).value());
+    ASSERT_TRUE(storage.is_short_on_storage());
+    ASSERT_TRUE(storage.is_short_on_storage(StorageClass::UDSA));
+    ASSERT_EQ(udsa.cushion_allocations(), 1u);
+    ASSERT_EQ(udsa.sos_count(), 1u);
+
+    // Leaving the cushion is not enough; twice the cushion must be free
+    free_down_to(storage, blocks, 56);
+    ASSERT_TRUE(storage.is_short_on_storage());
+    free_down_to(storage, blocks, 49);
+    ASSERT_TRUE(storage.is_short_on_storage());
+    free_down_to(storage, blocks, 48);
+    ASSERT_FALSE(storage.is_short_on_storage());
+
+    ASSERT_EQ(transitions.size(), 2u);
+    ASSERT_TRUE(transitions[0]);
+    ASSERT_FALSE(transitions[1]);
+    free_down_to(storage, blocks, 0);
+}
+
+void test_refusals() {
+    StorageControlManager storage;
+    storage.set_dsa_limit(StorageClass::UDSA, 64 * KB, 8 * KB);
+    const StoragePool& udsa = pool_of(storage, StorageClass::UDSA);
+
+    // More than the whole limit: refused, and no FREEMAIN could change that
+    auto blocks = fill(storage, StorageClass::UDSA, KB, 1);
+    auto huge = storage.getmain(128 * KB, StorageClass::UDSA);
+    ASSERT_TRUE(huge.is_error());
+    ASSERT_EQ(huge.error().code, ErrorCode::OUT_OF_MEMORY);
+    ASSERT_FALSE(storage.is_short_on_storage());
+
+    // Within the limit but refused in a nearly empty area: not short either,
+    // or an idle region would stay short until its next GETMAIN or FREEMAIN
+    ASSERT_TRUE(storage.getmain(64 * KB, StorageClass::UDSA).is_error());
+    ASSERT_FALSE(storage.is_short_on_storage());
+    ASSERT_EQ(udsa.refused(), 2u);
+
+    // Refused while the area is this full: short until the exit rule clears it
+    auto more = fill(storage, StorageClass::UDSA, KB, 49);
+    blocks.insert(blocks.end(), more.begin(), more.end());
+    ASSERT_FALSE(storage.is_short_on_storage());
+    ASSERT_TRUE(storage.getmain(20 * KB, StorageClass::UDSA).is_error());
+    ASSERT_TRUE(storage.is_short_on_storage());
+    free_down_to(storage, blocks, 48);
+    ASSERT_FALSE(storage.is_short_on_storage());
+    free_down_to(storage, blocks, 0);
+
+    // The same holds for the region's overall maximum
+    storage.set_max_storage(128 * KB);
+    ASSERT_TRUE(storage.getmain(256 * KB).is_error());
+    ASSERT_FALSE(storage.is_short_on_storage());
+}
+
+void test_per_class_limits() {
+    StorageControlManager storage;
+    storage.set_dsa_limit(StorageClass::CDSA, 16 * KB);
+    auto cdsa = fill(storage, StorageClass::CDSA, KB, 16);
+    ASSERT_EQ(cdsa.size(), 16u);
+
+    // One DSA full does not stop another
+    ASSERT_TRUE(storage.getmain(KB, StorageClass::CDSA).is_error());
+    auto user = storage.getmain(KB, StorageClass::USER);
+    ASSERT_TRUE(user.is_success());
+    ASSERT_EQ(pool_of(storage, StorageClass::CDSA).current_used(), 16u * KB);
+    ASSERT_EQ(pool_of(storage, StorageClass::USER).current_used(), static_cast<UInt64>(KB));
+    ASSERT_EQ(storage.current_allocated(), 17u * KB);
+
+    // Lifting the limit lets the class grow again
+    storage.set_dsa_limit(StorageClass::CDSA, 0);
+    ASSERT_TRUE(storage.getmain(KB, StorageClass::CDSA).is_success());
+    (void)storage.freemain(user.value());
+    free_down_to(storage, cdsa, 0);
+}
+
+// =============================================================================
+// Block Pooling
+// =============================================================================
+
+void test_thread_cache_pooling() {
+    StorageControlManager storage;
+    const StoragePool& pool = pool_of(storage, StorageClass::SDSA);
+
+    // A freed block comes straight back to the next GETMAIN of its size
+    void* first = storage.getmain(200, StorageClass::SDSA).value();
+    (void)storage.freemain(first);
+    const UInt64 hits = pool.cache_hits();
+    void* again = storage.getmain(200, StorageClass::SDSA).value();
+    ASSERT_EQ(again, first);
+    ASSERT_EQ(pool.cache_hits(), hits + 1);
+    (void)storage.freemain(again);
+
+    // Blocks one thread frees past its own cache are shared with others
+    std::thread([&storage] {
+        auto blocks = fill(storage, StorageClass::SDSA, 512, 2 * StoragePool::THREAD_CACHED_PER_CLASS);
+        free_down_to(storage, blocks, 0);
+    }).join();
+    const UInt64 before = pool.cache_hits();
+    std::atomic<Size> reused{0};
+    std::thread([&storage, &reused] {
+        auto blocks = fill(storage, StorageClass::SDSA, 512, 8);
+        reused = blocks.size();
+        free_down_to(storage, blocks, 0);
+    }).join();
+    ASSERT_EQ(reused.load(), 8u);
+    ASSERT_GE(pool.cache_hits(), before + 8);
+    ASSERT_EQ(pool.current_used(), 0u);
+}
+
+// =============================================================================
+// Admission Control
+// =============================================================================
+
+void test_admission_control() {
+    auto& storage = StorageControlManager::instance();
+    auto& tasks = task::TaskControlManager::instance();
+    enable_sos_admission_control(std::chrono::milliseconds(100));
+    storage.set_dsa_limit(StorageClass::RDSA, 64 * KB, 8 * KB);
+    auto attach = [&tasks] {
+        auto task = tasks.create_task(FixedString<4>("ADMT"));
+        if (task) (void)tasks.end_task(task.value());
+        return task.is_success() ? ErrorCode::SUCCESS : task.error().code;
+    };
+
+    // Not short on storage: attaches go straight through, even after a
+    // refusal no FREEMAIN could satisfy
+    ASSERT_TRUE(storage.getmain(128 * KB, StorageClass::RDSA).is_error());
+    ASSERT_EQ(attach(), ErrorCode::SUCCESS);
+
+    // Short on storage: held for the wait, then refused
+    auto blocks = fill(storage, StorageClass::RDSA, KB, 60);
+    ASSERT_TRUE(storage.is_short_on_storage());
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(attach(), ErrorCode::RESOURCE_EXHAUSTED);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(90));
+
+    // Recovering lets a held attach in at once
+    enable_sos_admission_control(std::chrono::milliseconds(5000));
+    std::atomic<ErrorCode> held{ErrorCode::INVALID_STATE};
+    std::thread waiter([&] { held = attach(); });
+    while (tasks.admission_queue_depth() == 0) std::this_thread::yield();
+    free_down_to(storage, blocks, 0);
+    waiter.join();
+    ASSERT_EQ(held.load(), ErrorCode::SUCCESS);
+
+    tasks.set_admission_check(nullptr);
+    storage.set_sos_listener(nullptr);
+    storage.set_dsa_limit(StorageClass::RDSA, 0);
+}
+
+int main() {
+    TestSuite suite("Storage Control Tests");
+
+    suite.add_test("Cushion Hysteresis", test_cushion_hysteresis);
+    suite.add_test("Refusals", test_refusals);
+    suite.add_test("Per Class Limits", test_per_class_limits);
+    suite.add_test("Thread Cache Pooling", test_thread_cache_pooling);
+    suite.add_test("Admission Control", test_admission_control);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
@@ -0,0 +1,171 @@
+#include "../framework/test_framework.hpp"
+#include "cics/tdq/tdq_types.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace cics;
+using namespace cics::tdq;
+using namespace cics::test;
+
+namespace {
+
+TDQDefinition triggered_queue(StringView name, UInt32 level, TriggerDefinition::TriggerCallback callback) {
+    TDQDefinition def;
+    def.dest_id = FixedString<4>(name);
+    def.type = TDQType::INTRAPARTITION;
+    TriggerDefinition trigger;
+    trigger.transaction_id = "ATIT";
+    trigger.trigger_level = level;
+    trigger.callback = std::move(callback);
+    def.trigger = trigger;
+    return def;
+}
+
+} // namespace
+
+// =============================================================================
+// Trigger Level
+// =============================================================================
+
+void test_trigger_level() {
+    IntrapartitionQueue queue(triggered_queue("LVL3", 3, nullptr));
+    std::vector<String> posts;
+    queue.set_trigger_sink([&posts](const String& dest) { posts.push_back(dest); });
+
+    // Only the write that reaches the level posts
+    ASSERT_TRUE(queue.write(StringView("one")).is_success());
+    ASSERT_TRUE(queue.write(StringView("two")).is_success());
+    ASSERT_EQ(posts.size(), 0u);
+    ASSERT_TRUE(queue.write(StringView("three")).is_success());
+    ASSERT_EQ(posts.size(), 1u);
+    ASSERT_EQ(posts[0], String("LVL3"));
+    ASSERT_TRUE(queue.write(StringView("four")).is_success());
+    ASSERT_EQ(posts.size(), 1u);
+
+    // Rearmed, the next write posts above the level too, once
+    queue.rearm_trigger();
+    ASSERT_TRUE(queue.write(StringView("five")).is_success());
+    ASSERT_TRUE(queue.write(StringView("six")).is_success());
+    ASSERT_EQ(posts.size(), 2u);
+
+    // Drained and refilled, the level is reached again
+    while (queue.read().is_success()) {}
+    for (int i = 0; i < 3; ++i) ASSERT_TRUE(queue.write(StringView("again")).is_success());
+    ASSERT_EQ(posts.size(), 3u);
+    ASSERT_EQ(queue.statistics().trigger_count.get(), 3u);
+}
+
+void test_trigger_without_sink() {
+    String started;
+    IntrapartitionQueue queue(triggered_queue("SYNC", 1,
+        [&started](StringView transaction, StringView dest) {
+            started = std::format("{} {}", transaction, dest);
+        }));
+
+    ASSERT_TRUE(queue.write(StringView("record")).is_success());
+    ASSERT_EQ(started, String("ATIT SYNC"));
+}
+
+// =============================================================================
+// Trigger Dispatcher
+// =============================================================================
+
+void test_no_retrigger_after_failure() {
+    TDQManager manager;
+    std::atomic<int> calls{0};
+    ASSERT_TRUE(manager.define_intrapartition(triggered_queue("FAIL", 2,
+        [&calls](StringView, StringView) {
+            ++calls;
+            throw std::runtime_error("trigger transaction abended");
+        })).is_success());
+
+    ASSERT_TRUE(manager.writeq("FAIL", StringView("first")).is_success());
+    ASSERT_TRUE(manager.writeq("FAIL", StringView("second")).is_success());
+    auto& ati = manager.trigger_dispatcher();
+    ati.wait_idle();
+
+    // The records are still there, but the failed consumer is not rerun
+    // until a write after its failure
+    ASSERT_EQ(calls.load(), 1);
+    ASSERT_EQ(ati.statistics().failures.get(), 1u);
+    ASSERT_EQ(ati.statistics().retriggered.get(), 0u);
+    ASSERT_EQ(manager.get_queue_depth("FAIL").value(), 2u);
+
+    // A new write starts it again
+    ASSERT_TRUE(manager.writeq("FAIL", StringView("third")).is_success());
+    ati.wait_idle();
+    ASSERT_EQ(calls.load(), 2);
+}
+
+void test_no_retrigger_without_progress() {
+    TDQManager manager;
+    std::atomic<int> calls{0};
+    ASSERT_TRUE(manager.define_intrapartition(triggered_queue("IDLE", 1,
+        [&calls](StringView, StringView) { ++calls; })).is_success());
+
+    ASSERT_TRUE(manager.writeq("IDLE", StringView("unread")).is_success());
+    manager.trigger_dispatcher().wait_idle();
+    ASSERT_EQ(calls.load(), 1);
+    ASSERT_EQ(manager.trigger_dispatcher().statistics().stalled.get(), 1u);
+}
+
+void test_retrigger_drains_queue() {
+    TDQManager manager;
+    // Each run reads a single record; runs that read are started again
+    ASSERT_TRUE(manager.define_intrapartition(triggered_queue("ONE", 1,
+        [&manager](StringView, StringView dest) { (void)manager.readq(dest); })).is_success());
+
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(manager.writeq("ONE", StringView("record")).is_success());
+    manager.trigger_dispatcher().wait_idle();
+    ASSERT_EQ(manager.get_queue_depth("ONE").value(), 0u);
+}
+
+void test_dispatcher_shutdown() {
+    std::atomic<bool> running{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> second_runs{0};
+
+    TriggerDefinition blocking;
+    blocking.callback = [&](StringView, StringView) {
+        running = true;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+    TriggerDefinition counting;
+    counting.callback = [&](StringView, StringView) { ++second_runs; };
+
+    TriggerDispatcher ati([&](const String& dest) -> Optional<TriggerCheck> {
+        return TriggerCheck{dest == "A" ? blocking : counting, 1, 0, 0};
+    }, nullptr, 1);
+
+    ati.post("A");
+    while (!running) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ati.post("B");
+
+    // Stop waits for the running consumer and drops the queued trigger
+    std::thread stopper([&ati] { ati.stop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    stopper.join();
+    ASSERT_EQ(ati.statistics().started.get(), 1u);
+    ASSERT_EQ(second_runs.load(), 0);
+
+    // A later post starts the workers again
+    ati.post("B");
+    ati.wait_idle();
+    ASSERT_EQ(second_runs.load(), 1);
+}
+
+int main() {
+    TestSuite suite("TDQ Tests");
+
+    suite.add_test("Trigger Level", test_trigger_level);
+    suite.add_test("Trigger Without Sink", test_trigger_without_sink);
+    suite.add_test("No Retrigger After Failure", test_no_retrigger_after_failure);
+    suite.add_test("No Retrigger Without Progress", test_no_retrigger_without_progress);
+    suite.add_test("Retrigger Drains Queue", test_retrigger_drains_queue);
+    suite.add_test("Dispatcher Shutdown", test_dispatcher_shutdown);
+
+    TestRunner runner;
+    runner.add_suite(&suite);
+    return runner.run_all();
+}
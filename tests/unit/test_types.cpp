@@ -1,5 +1,6 @@
 #include "../framework/test_framework.hpp"
 #include "cics/common/types.hpp"
+#include "cics/common/name_table.hpp"
 
 using namespace cics;
 using namespace cics::test;
@@ -38,6 +39,38 @@ void test_fixed_string() {
     FixedString<4> fs3("AB");
     fs3[2] = 'C';
     ASSERT_EQ(fs3[2], 'C');
+    
+    std::hash<FixedString<8>> hasher;
+    ASSERT_EQ(hasher(fs1), hasher(fs2));
+    ASSERT_NE(hasher(fs1), hasher(FixedString<8>("HELLP")));
+    ASSERT_FALSE(FixedString<16>("CUSTOMER.FILE") == FixedString<16>("CUSTOMER.FILF"));
+}
+
+void test_name_table() {
+    auto& names = NameTable::instance();
+    
+    NameId queue = names.intern("PAYQ");
+    ASSERT_NE(queue, NameId::NONE);
+    ASSERT_EQ(names.intern("PAYQ    "), queue);
+    ASSERT_EQ(names.find("PAYQ"), queue);
+    ASSERT_EQ(names.name(queue), "PAYQ");
+    ASSERT_NE(names.intern("payq"), queue);
+    
+    NameId long_name = names.intern("A.RESOURCE.NAME.PAST.SIXTEEN");
+    ASSERT_EQ(names.find("A.RESOURCE.NAME.PAST.SIXTEEN"), long_name);
+    ASSERT_EQ(names.name(long_name), "A.RESOURCE.NAME.PAST.SIXTEEN");
+    
+    ASSERT_EQ(names.find("NEVERSEEN"), NameId::NONE);
+    ASSERT_EQ(names.intern("   "), NameId::NONE);
+    ASSERT_TRUE(names.name(NameId::NONE).empty());
+    
+    NameIndex<int> index;
+    int value = 7;
+    index.set(long_name, &value);
+    ASSERT_EQ(index.find(long_name), &value);
+    ASSERT_TRUE(index.find(queue) == nullptr);
+    index.erase(long_name);
+    ASSERT_TRUE(index.find(long_name) == nullptr);
 }
 
 void test_uuid() {
@@ -135,6 +168,7 @@ int main() {
     
     suite.add_test("String Utilities", test_string_utilities);
     suite.add_test("FixedString", test_fixed_string);
+    suite.add_test("NameTable", test_name_table);
     suite.add_test("UUID", test_uuid);
     suite.add_test("EBCDIC Conversion", test_ebcdic_conversion);
     suite.add_test("Packed Decimal", test_packed_decimal);
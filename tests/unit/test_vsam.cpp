@@ -106,6 +106,188 @@ void test_browse_context() {
     ASSERT_EQ(ctx.records_read(), 1u);
 }
 
+void test_key_block_compression() {
+    KeyBlock::Builder builder;
+    ByteBuffer value = {0xAA};
+    for (int i = 0; i < 40; i++) {
+        String key = std::format("BR01ACCT{:06d}", i);
+        builder.add(ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size()),
+                    ConstByteSpan(value.data(), value.size()));
+    }
+    KeyBlock block = builder.finish();
+    
+    ASSERT_EQ(block.count(), 40u);
+    ASSERT_LT(block.stored_key_bytes(), block.raw_key_bytes());
+    
+    KeyBlock::Iterator it(&block);
+    String target = "BR01ACCT000025";
+    it.seek(ConstByteSpan(reinterpret_cast<const Byte*>(target.data()), target.size()));
+    ASSERT_TRUE(it.valid());
+    ASSERT_EQ(it.index(), 25u);
+    it.prev();
+    ASSERT_EQ(it.index(), 24u);
+}
+
+void test_ksds_index_splits() {
+    KsdsIndex index(512, 512);
+    ByteBuffer data(40, 0x40);
+    for (int i = 0; i < 500; i++) {
+        String key = std::format("BR01ACCT{:06d}", i);
+        ASSERT_TRUE(index.insert(ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size()),
+                                 ConstByteSpan(data.data(), data.size()), static_cast<RBA>(i)));
+    }
+    ASSERT_EQ(index.size(), 500u);
+    ASSERT_GT(index.layout().data_cis, 1u);
+    ASSERT_GE(index.layout().index_levels, 1u);
+    ASSERT_LT(index.layout().data_key_bytes_stored, index.layout().data_key_bytes_raw);
+    
+    UInt64 count = 0;
+    for (auto cursor = index.first(); cursor.valid(); cursor.next()) ++count;
+    ASSERT_EQ(count, 500u);
+    
+    String probe = "BR01ACCT000321";
+    auto rec = index.find(ConstByteSpan(reinterpret_cast<const Byte*>(probe.data()), probe.size()));
+    ASSERT_TRUE(rec.has_value());
+    ASSERT_EQ(rec->rba(), 321u);
+}
+
+void test_ksds_index_snapshot() {
+    KsdsIndex index(512, 512);
+    ByteBuffer data(40, 0x40);
+    auto key_of = [](int i) { return std::format("BR01ACCT{:06d}", i); };
+    auto span_of = [](const String& key) {
+        return ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size());
+    };
+    for (int i = 0; i < 300; i += 2) {
+        ASSERT_TRUE(index.insert(span_of(key_of(i)), ConstByteSpan(data.data(), data.size()), i));
+    }
+    
+    auto snapshot = index.snapshot();
+    ByteBuffer changed(60, 0x5C);
+    for (int i = 1; i < 300; i += 2) {
+        ASSERT_TRUE(index.insert(span_of(key_of(i)), ConstByteSpan(data.data(), data.size()), i));
+    }
+    for (int i = 0; i < 100; i += 2) {
+        ASSERT_TRUE(index.erase(span_of(key_of(i))));
+    }
+    ASSERT_TRUE(index.replace(span_of(key_of(200)), ConstByteSpan(changed.data(), changed.size())));
+    ASSERT_GT(index.snapshot_copies(), 0u);
+    
+    // The snapshot still sees exactly the even keys with their old data
+    int expected = 0;
+    for (auto cursor = snapshot.first(); cursor.valid(); cursor.next(), expected += 2) {
+        ASSERT_TRUE(compare_keys(cursor.key(), span_of(key_of(expected))) == 0);
+        ASSERT_EQ(cursor.data().size(), data.size());
+    }
+    ASSERT_EQ(expected, 300);
+    ASSERT_EQ(snapshot.size(), 150u);
+    
+    UInt64 live = 0;
+    for (auto cursor = index.first(); cursor.valid(); cursor.next()) ++live;
+    ASSERT_EQ(live, index.size());
+    ASSERT_EQ(index.find(span_of(key_of(200)))->length(), changed.size());
+}
+
+void test_ksds_index_spanned() {
+    KsdsIndex index(512, 512);
+    ByteBuffer data(40, 0x40);
+    ByteBuffer big(2000, 0x5A);
+    auto key_of = [](int i) { return std::format("BR01ACCT{:06d}", i); };
+    auto span_of = [](const String& key) {
+        return ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size());
+    };
+    for (int i = 0; i < 40; i += 2) {
+        ASSERT_TRUE(index.insert(span_of(key_of(i)), ConstByteSpan(data.data(), data.size()), i));
+    }
+    ASSERT_TRUE(index.needs_spanning(14, big.size()));
+    ASSERT_FALSE(index.needs_spanning(14, data.size()));
+    const UInt32 cis_before = index.layout().data_cis;
+    ASSERT_TRUE(index.insert(span_of(key_of(21)), ConstByteSpan(big.data(), big.size()), 21));
+    ASSERT_EQ(index.layout().spanned_records, 1u);
+    ASSERT_GE(index.layout().data_cis, cis_before + 4);
+    ASSERT_EQ(index.find(span_of(key_of(21)))->length(), big.size());
+    
+    // Neighbours inserted next to it land in other CIs
+    ASSERT_TRUE(index.insert(span_of(key_of(23)), ConstByteSpan(data.data(), data.size()), 23));
+    ASSERT_EQ(index.layout().spanned_records, 1u);
+    UInt64 count = 0;
+    for (auto cursor = index.first(); cursor.valid(); cursor.next()) ++count;
+    ASSERT_EQ(count, 22u);
+    
+    ASSERT_TRUE(index.replace(span_of(key_of(21)), ConstByteSpan(data.data(), data.size())));
+    ASSERT_EQ(index.layout().spanned_records, 0u);
+}
+
+void test_ksds_index_reclaim() {
+    KsdsIndex index(512, 512, 20);
+    ByteBuffer data(40, 0x40);
+    auto key_of = [](int i) { return std::format("BR01ACCT{:06d}", i); };
+    auto span_of = [](const String& key) {
+        return ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size());
+    };
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(index.insert(span_of(key_of(i)), ConstByteSpan(data.data(), data.size()), i));
+    }
+    // Sequential load leaves FREESPACE in every CI
+    const auto& layout = index.layout();
+    ASSERT_LE(layout.data_bytes, static_cast<UInt64>(layout.data_cis) * 512 * 80 / 100 + 512);
+    const UInt32 loaded_cis = layout.data_cis;
+    
+    for (int i = 0; i < 1000; i++) {
+        if (i % 5 != 0) ASSERT_TRUE(index.erase(span_of(key_of(i))));
+    }
+    ASSERT_GT(index.ci_reclaims(), 0u);
+    ASSERT_LT(layout.data_cis, loaded_cis);
+    
+    const UInt32 before = layout.data_cis;
+    ByteBuffer resume;
+    UInt32 freed = 0;
+    int steps = 0;
+    do {
+        freed += index.reorganize(resume, 8);
+        ++steps;
+    } while (!resume.empty());
+    ASSERT_GT(steps, 1);
+    ASSERT_EQ(layout.data_cis, before - freed);
+    ASSERT_LT(layout.data_cis, loaded_cis / 2);
+    
+    int expected = 0;
+    for (auto cursor = index.first(); cursor.valid(); cursor.next(), expected += 5) {
+        ASSERT_TRUE(compare_keys(cursor.key(), span_of(key_of(expected))) == 0);
+    }
+    ASSERT_EQ(expected, 1000);
+    ASSERT_EQ(index.find(span_of(key_of(505)))->rba(), 505u);
+}
+
+void test_ksds_index_sorted_probe() {
+    KsdsIndex index(512, 512);
+    ByteBuffer data(30, 0x40);
+    auto key_of = [](int i) { return std::format("CUST{:06d}", i); };
+    auto span_of = [](const String& key) {
+        return ConstByteSpan(reinterpret_cast<const Byte*>(key.data()), key.size());
+    };
+    for (int i = 0; i < 2000; i += 2) {
+        data[0] = static_cast<Byte>(i);
+        ASSERT_TRUE(index.insert(span_of(key_of(i)), ConstByteSpan(data.data(), data.size()), i));
+    }
+    
+    auto snapshot = index.snapshot();
+    KsdsIndex::SortedProbe probe(snapshot);
+    int found = 0;
+    for (int i = 0; i < 2000; i++) {
+        const bool hit = probe.find(span_of(key_of(i)));
+        ASSERT_EQ(hit, i % 2 == 0);
+        if (!hit) continue;
+        ASSERT_EQ(probe.rba(), static_cast<RBA>(i));
+        ASSERT_EQ(probe.data()[0], static_cast<Byte>(i));
+        ++found;
+    }
+    ASSERT_EQ(found, 1000);
+    // Per data CI, not per key: one in, and one for a miss past its high key
+    ASSERT_LE(probe.descents(), 2u * index.layout().data_cis);
+    ASSERT_FALSE(probe.find(span_of(key_of(5000))));
+}
+
 int main() {
     TestSuite suite("VSAM Tests");
     
@@ -117,6 +299,12 @@ int main() {
     suite.add_test("ControlInterval", test_control_interval);
     suite.add_test("VsamStatistics", test_vsam_statistics);
     suite.add_test("BrowseContext", test_browse_context);
+    suite.add_test("KeyBlock Compression", test_key_block_compression);
+    suite.add_test("KsdsIndex Splits", test_ksds_index_splits);
+    suite.add_test("KsdsIndex Snapshot", test_ksds_index_snapshot);
+    suite.add_test("KsdsIndex Spanned Records", test_ksds_index_spanned);
+    suite.add_test("KsdsIndex CI Reclaim", test_ksds_index_reclaim);
+    suite.add_test("KsdsIndex Sorted Probe", test_ksds_index_sorted_probe);
     
     TestRunner runner;
     runner.add_suite(&suite);